@@ -4,7 +4,9 @@
       "target_name": "fake6502_addon",
       "sources": [
         "native/fake6502_addon.cc",
-        "native/fake6502.c"
+        "native/fake6502.c",
+        "native/fake6502_thread.cc",
+        "native/fake6502_batch.c"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")",
@@ -16,6 +18,49 @@
       "cflags!": [ "-fno-exceptions" ],
       "cflags_cc!": [ "-fno-exceptions" ],
       "defines": [ "NAPI_DISABLE_CPP_EXCEPTIONS" ]
+    },
+    {
+      "target_name": "fake6502_core",
+      "type": "static_library",
+      "sources": [
+        "native/fake6502.c",
+        "native/fake6502_machine.cc",
+        "native/fake6502_batch.c"
+      ],
+      "include_dirs": [
+        "native"
+      ],
+      "direct_dependent_settings": {
+        "include_dirs": [
+          "native"
+        ]
+      },
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions", "-fno-rtti" ]
+    },
+    {
+      "target_name": "fake6502_run",
+      "type": "executable",
+      "sources": [
+        "native/fake6502_run.cc"
+      ],
+      "dependencies": [
+        "fake6502_core"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ]
+    },
+    {
+      "target_name": "fake6502_bench",
+      "type": "executable",
+      "sources": [
+        "native/fake6502_bench.cc"
+      ],
+      "dependencies": [
+        "fake6502_core"
+      ],
+      "cflags!": [ "-fno-exceptions" ],
+      "cflags_cc!": [ "-fno-exceptions" ]
     }
   ]
 }
\ No newline at end of file
@@ -5,6 +5,7 @@
 
 #include "fake6502.h"
 #include <string.h>
+#include <stdatomic.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -14,9 +15,36 @@ extern "C" {
 static read_func_t memory_read = NULL;
 static write_func_t memory_write = NULL;
 
-// Interrupt state
-static int irq_pending = 0;
-static int nmi_pending = 0;
+// Interrupt state; may be raised from another thread while the CPU runs
+static atomic_int irq_pending = 0;
+static atomic_int nmi_pending = 0;
+
+// Page table (256 pages of 256 bytes)
+static uint8_t* page_data[256];
+static uint8_t page_kind[256];
+static uint8_t* page_dirty[256];
+static uint32_t* page_version[256];
+
+// Per-PC profile counters (NULL when profiling is off)
+static uint32_t* profile_counts = NULL;
+static uint32_t* profile_cycles = NULL;
+
+// Coverage flags per PC (NULL when coverage is off)
+static uint8_t* coverage = NULL;
+
+// Call graph arrays (calls is NULL when the call graph is off)
+static cpu_callgraph_t callgraph;
+
+// Execution trace ring (records is NULL when tracing is off)
+static cpu_trace_t trace;
+
+// Runtime hooks (map is NULL when hooks are off)
+static cpu_hooks_t hooks;
+
+// BRK host-call trap
+static int brk_trap_enabled = 0;
+static uint8_t brk_trap_signature;
+static uint16_t brk_trap_address;
 
 // Default memory functions (return 0xFF for reads, ignore writes)
 static uint8_t default_read(uint16_t address) {
@@ -31,10 +59,29 @@ static void default_write(uint16_t address, uint8_t value) {
 
 // Bridge functions for the improved fake6502 core
 uint8_t read6502(uint16_t address) {
+    uint8_t* data = page_data[address >> 8];
+    if (data) {
+        return data[address & 0xFF];
+    }
     return memory_read ? memory_read(address) : default_read(address);
 }
 
 void write6502(uint16_t address, uint8_t value) {
+    uint8_t page = (uint8_t)(address >> 8);
+    if (page_kind[page] == CPU_PAGE_RAM) {
+        page_data[page][address & 0xFF] = value;
+        if (page_dirty[page]) {
+            *page_dirty[page] = 1;
+        }
+        if (page_version[page]) {
+            (*page_version[page])++;
+        }
+        return;
+    }
+    if (page_kind[page] == CPU_PAGE_ROM) {
+        return; // ROM writes are ignored
+    }
+
     if (memory_write) {
         memory_write(address, value);
     } else {
@@ -54,6 +101,437 @@ typedef unsigned int uint32;
 // Include the complete implementation (this will define static variables)
 #include "fake6502_improved.h"
 
+// Edge slot for caller -> callee, or -1 when the table is full
+static int callgraph_edge(uint32_t key) {
+    uint32_t slot = (key * 2654435761u) >> 20;
+    for (int probe = 0; probe < CPU_CALL_EDGE_SLOTS; probe++) {
+        uint32_t* edge = &callgraph.edges[slot * 2];
+        if (edge[1] == 0 || edge[0] == key) {
+            edge[0] = key;
+            return (int)slot;
+        }
+        slot = (slot + 1) & (CPU_CALL_EDGE_SLOTS - 1);
+    }
+    return -1;
+}
+
+static void callgraph_enter(uint16_t address) {
+    uint32_t* stack = callgraph.stack;
+    uint32_t depth = stack[0];
+    uint32_t caller = stack[CPU_CALL_HEADER + (depth - 1) * CPU_CALL_FRAME];
+    int edge = callgraph_edge((caller << 16) | address);
+
+    callgraph.calls[address]++;
+    if (edge >= 0) {
+        callgraph.edges[edge * 2 + 1]++;
+    }
+    if (depth == CPU_CALL_STACK_DEPTH) {
+        stack[1]++; // Too deep; the caller keeps the cycles
+        return;
+    }
+    uint32_t* frame = &stack[CPU_CALL_HEADER + depth * CPU_CALL_FRAME];
+    frame[0] = address;
+    frame[1] = sp;
+    callgraph.clock[1 + depth] = callgraph.clock[0];
+    stack[0] = depth + 1;
+}
+
+// Pop every frame whose return address the stack has unwound past; SP
+// rather than the return address decides, so return address tricks and
+// routines that drop their return address do not desynchronize the stack
+static void callgraph_leave(void) {
+    uint32_t* stack = callgraph.stack;
+    uint32_t depth = stack[0];
+    while (depth > 1) {
+        uint32_t* frame = &stack[CPU_CALL_HEADER + (depth - 1) * CPU_CALL_FRAME];
+        if (sp <= frame[1]) {
+            break;
+        }
+        uint32_t address = frame[0];
+        double elapsed = callgraph.clock[0] - callgraph.clock[depth];
+        uint32_t caller = frame[-CPU_CALL_FRAME];
+        depth--;
+
+        // Recursive calls are counted once, by the outermost frame
+        uint32_t outer = 0;
+        while (outer < depth && stack[CPU_CALL_HEADER + outer * CPU_CALL_FRAME] != address) {
+            outer++;
+        }
+        if (outer == depth) {
+            callgraph.inclusive[address] += elapsed;
+        }
+        int edge = callgraph_edge((caller << 16) | address);
+        if (edge >= 0) {
+            callgraph.edge_cycles[edge] += elapsed;
+        }
+    }
+    stack[0] = depth;
+}
+
+static void callgraph_charge(uint32_t cycles) {
+    uint32_t* stack = callgraph.stack;
+    callgraph.exclusive[stack[CPU_CALL_HEADER + (stack[0] - 1) * CPU_CALL_FRAME]] += cycles;
+    callgraph.clock[0] += cycles;
+}
+
+// Interrupt entry is charged to the handler
+static void callgraph_interrupt(uint8_t old_sp) {
+    if (sp != old_sp) {
+        callgraph_enter(pc);
+    }
+    callgraph_charge(7);
+}
+
+static void callgraph_instruction(uint32_t cycles) {
+    callgraph_charge(cycles);
+    switch (opcode) {
+        case 0x00: // BRK
+        case 0x20: // JSR
+            callgraph_enter(pc);
+            break;
+        case 0x40: // RTI
+        case 0x60: // RTS
+        case 0x9A: // TXS
+            callgraph_leave();
+            break;
+    }
+}
+
+static uint8_t instruction_length(uint8_t op) {
+    void (*mode)() = addrtable[op];
+    if (mode == imp || mode == acc) {
+        return 1;
+    }
+    if (mode == abso || mode == absx || mode == absy || mode == ind) {
+        return 3;
+    }
+    return 2;
+}
+
+static int trace_wanted(uint16_t address) {
+    if (trace.filter_count == 0) {
+        return 1;
+    }
+    for (uint32_t i = 0; i < trace.filter_count; i++) {
+        if (address >= trace.filters[i * 2] && address <= trace.filters[i * 2 + 1]) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Start a record with the registers as they were before the step
+static uint8_t* trace_begin(uint16_t start_pc, const uint8_t regs[5]) {
+    uint64_t clock = trace.counters[1];
+    uint8_t* record = trace.records + (trace.counters[0] % trace.capacity) * CPU_TRACE_RECORD_SIZE;
+    trace.counters[0]++;
+
+    memset(record, 0, CPU_TRACE_RECORD_SIZE);
+    for (int i = 0; i < 8; i++) {
+        record[i] = (uint8_t)(clock >> (i * 8));
+    }
+    record[8] = (uint8_t)start_pc;
+    record[9] = (uint8_t)(start_pc >> 8);
+    memcpy(&record[13], regs, 5);
+    return record;
+}
+
+static void trace_interrupt(uint16_t start_pc, const uint8_t regs[5], uint8_t old_sp, uint8_t kind) {
+    if (sp != old_sp && trace_wanted(start_pc)) {
+        uint8_t* record = trace_begin(start_pc, regs);
+        record[18] = 7;
+        record[19] = kind;
+    }
+    trace.counters[1] += 7;
+}
+
+// Operands are read back after execution, so self-modified operands show
+// their new value
+static void trace_instruction(uint16_t start_pc, const uint8_t regs[5], uint32_t cycles) {
+    if (trace_wanted(start_pc)) {
+        uint8_t* record = trace_begin(start_pc, regs);
+        uint8_t length = instruction_length(opcode);
+        record[10] = opcode;
+        if (length > 1) {
+            record[11] = read6502((uint16_t)(start_pc + 1));
+        }
+        if (length > 2) {
+            record[12] = read6502((uint16_t)(start_pc + 2));
+        }
+        record[18] = (uint8_t)cycles;
+        record[19] = CPU_TRACE_INSTRUCTION;
+        record[20] = length;
+    }
+    trace.counters[1] += cycles;
+}
+
+// Return registers a hook produced and the cycles the routine would take
+#define HOOK_OUT_A 1
+#define HOOK_OUT_X 2
+#define HOOK_OUT_Y 4
+
+typedef struct {
+    uint8_t a, x, y;
+    uint8_t outputs;        // HOOK_OUT_* the routine returns
+    uint32_t cycles;
+} hook_result_t;
+
+// Routine call being validated; id is 0 when there is none
+static struct {
+    uint8_t id;
+    uint16_t return_pc;
+    uint8_t sp;
+    uint32_t elapsed;       // Cycles the routine has taken so far
+    hook_result_t result;
+} hook_check;
+
+// Hooks write to shadow instead of memory while validating
+static int hook_shadowing = 0;
+
+static uint8_t hook_read(uint16_t address) {
+    if (hook_shadowing && (hooks.written[address >> 3] & (1 << (address & 7)))) {
+        return hooks.shadow[address];
+    }
+    return read6502(address);
+}
+
+static void hook_write(uint16_t address, uint8_t byte) {
+    if (hook_shadowing) {
+        hooks.shadow[address] = byte;
+        hooks.written[address >> 3] |= (uint8_t)(1 << (address & 7));
+    } else {
+        write6502(address, byte);
+    }
+}
+
+static uint16_t hook_word(uint16_t address) {
+    return (uint16_t)(hook_read(address) | (hook_read((uint16_t)(address + 1)) << 8));
+}
+
+static void hook_set_word(uint16_t address, uint16_t word) {
+    hook_write(address, (uint8_t)word);
+    hook_write((uint16_t)(address + 1), (uint8_t)(word >> 8));
+}
+
+// Pop a word from the C stack
+static uint16_t hook_pop(void) {
+    uint16_t zp = (uint16_t)hooks.config[CPU_HOOK_ZP_SP];
+    uint16_t stack = hook_word(zp);
+    hook_set_word(zp, (uint16_t)(stack + 2));
+    return hook_word(stack);
+}
+
+// Perform routine id on the current registers; 0 when the hook declines.
+// Cycle estimates are for the cc65 2.x runtime, RTS included.
+static int hook_run(uint8_t id, hook_result_t* r) {
+    uint16_t ax = (uint16_t)(a | (x << 8));
+    uint16_t address;
+    uint32_t i;
+    r->a = a;
+    r->x = x;
+    r->y = y;
+    r->outputs = HOOK_OUT_A | HOOK_OUT_X;
+
+    switch (id) {
+        case CPU_HOOK_PUSHAX: {
+            uint16_t zp = (uint16_t)hooks.config[CPU_HOOK_ZP_SP];
+            uint16_t stack = (uint16_t)(hook_word(zp) - 2);
+            hook_set_word(zp, stack);
+            hook_set_word(stack, ax);
+            r->y = 0;
+            r->outputs |= HOOK_OUT_Y;
+            r->cycles = 39;
+            return 1;
+        }
+        case CPU_HOOK_POPAX:
+            address = hook_pop();
+            r->a = (uint8_t)address;
+            r->x = (uint8_t)(address >> 8);
+            r->y = 0;
+            r->outputs |= HOOK_OUT_Y;
+            r->cycles = 33;
+            return 1;
+        case CPU_HOOK_MEMCPY: {
+            uint16_t source = hook_pop();
+            address = hook_pop();
+            // Forward a byte at a time like the routine, so overlapping
+            // copies leave the same bytes
+            for (i = 0; i < ax; i++) {
+                hook_write((uint16_t)(address + i), hook_read((uint16_t)(source + i)));
+            }
+            r->a = (uint8_t)address;
+            r->x = (uint8_t)(address >> 8);
+            r->cycles = 90 + 16 * (uint32_t)ax;
+            return 1;
+        }
+        case CPU_HOOK_MEMSET:
+        case CPU_HOOK_BZERO: {
+            uint8_t fill = id == CPU_HOOK_MEMSET ? (uint8_t)hook_pop() : 0;
+            address = hook_pop();
+            for (i = 0; i < ax; i++) {
+                hook_write((uint16_t)(address + i), fill);
+            }
+            r->a = (uint8_t)address;
+            r->x = (uint8_t)(address >> 8);
+            r->outputs = id == CPU_HOOK_MEMSET ? HOOK_OUT_A | HOOK_OUT_X : 0;
+            r->cycles = 70 + 11 * (uint32_t)ax;
+            return 1;
+        }
+        case CPU_HOOK_STRLEN:
+            for (i = 0; hook_read((uint16_t)(ax + i)) != 0; i++) {
+                if (i == 0xFFFF) {
+                    return 0; // No terminator anywhere
+                }
+            }
+            r->a = (uint8_t)i;
+            r->x = (uint8_t)(i >> 8);
+            r->cycles = 30 + 13 * i;
+            return 1;
+        case CPU_HOOK_TOSMULAX: {
+            uint32_t product = (uint32_t)hook_pop() * ax;
+            r->a = (uint8_t)product;
+            r->x = (uint8_t)(product >> 8);
+            r->cycles = x == 0 ? 200 : 320;
+            return 1;
+        }
+        case CPU_HOOK_UDIV16: {
+            uint16_t divisor = hook_word((uint16_t)hooks.config[CPU_HOOK_ZP_PTR4]);
+            uint16_t dividend = hook_word((uint16_t)hooks.config[CPU_HOOK_ZP_PTR1]);
+            if (divisor == 0) {
+                return 0;
+            }
+            hook_set_word((uint16_t)hooks.config[CPU_HOOK_ZP_PTR1], (uint16_t)(dividend / divisor));
+            hook_set_word((uint16_t)hooks.config[CPU_HOOK_ZP_SREG], (uint16_t)(dividend % divisor));
+            r->outputs = 0;
+            r->cycles = divisor < 0x100 ? 280 : 480;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+// Address the RTS at the top of the hardware stack returns to
+static uint16_t hook_return_address(void) {
+    uint16_t low = read6502((uint16_t)(0x100 | (uint8_t)(sp + 1)));
+    uint16_t high = read6502((uint16_t)(0x100 | (uint8_t)(sp + 2)));
+    return (uint16_t)(((high << 8) | low) + 1);
+}
+
+// Handle the routine entry at pc; returns the cycles charged, or 0 when
+// the routine is to run normally
+static uint32_t hook_enter(uint8_t id) {
+    hook_result_t r;
+    if (id >= CPU_HOOK_COUNT) {
+        return 0;
+    }
+
+    if (hooks.config[CPU_HOOK_VALIDATE]) {
+        memset(hooks.written, 0, 0x10000 / 8);
+        hook_shadowing = 1;
+        int handled = hook_run(id, &r);
+        hook_shadowing = 0;
+        if (handled) {
+            hook_check.id = id;
+            hook_check.return_pc = hook_return_address();
+            hook_check.sp = (uint8_t)(sp + 2);
+            hook_check.elapsed = 0;
+            hook_check.result = r;
+        }
+        return 0;
+    }
+
+    if (!hook_run(id, &r)) {
+        return 0;
+    }
+    pc = hook_return_address();
+    sp = (uint8_t)(sp + 2);
+    a = r.a;
+    x = r.x;
+    y = r.y;
+
+    uint32_t cycles = hooks.costs[id] ? hooks.costs[id] : r.cycles;
+    hooks.stats[id * CPU_HOOK_STATS]++;
+    hooks.stats[id * CPU_HOOK_STATS + 1] += cycles;
+    return cycles;
+}
+
+static int hook_compare(uint8_t id, uint32_t where, uint8_t expected, uint8_t actual) {
+    if (expected == actual) {
+        return 0;
+    }
+    hooks.mismatch[0] = id;
+    hooks.mismatch[1] = where;
+    hooks.mismatch[2] = expected;
+    hooks.mismatch[3] = actual;
+    return 1;
+}
+
+// The validated routine has returned: compare with what the hook produced
+static void hook_validate(void) {
+    uint8_t id = hook_check.id;
+    const hook_result_t* r = &hook_check.result;
+    uint32_t* stats = &hooks.stats[id * CPU_HOOK_STATS];
+    int differs = 0;
+    hook_check.id = 0;
+
+    stats[2]++;
+    stats[4] += hook_check.elapsed;
+    if (r->outputs & HOOK_OUT_A) {
+        differs |= hook_compare(id, CPU_HOOK_REGISTER, r->a, a);
+    }
+    if (r->outputs & HOOK_OUT_X) {
+        differs |= hook_compare(id, CPU_HOOK_REGISTER + 1, r->x, x);
+    }
+    for (uint32_t i = 0; i < 0x10000 / 8 && !differs; i++) {
+        uint8_t bits = hooks.written[i];
+        for (uint32_t bit = 0; bits && bit < 8 && !differs; bit++, bits >>= 1) {
+            if (bits & 1) {
+                uint16_t address = (uint16_t)(i * 8 + bit);
+                differs |= hook_compare(id, address, hooks.shadow[address], read6502(address));
+            }
+        }
+    }
+    if (differs) {
+        stats[3]++;
+    }
+}
+
+// Work done on the host for the instruction at start_pc, taking cycles:
+// charged to that address; the trace only keeps time
+static uint32_t host_step_done(uint16_t start_pc, uint32_t cycles) {
+    if (coverage) {
+        coverage[start_pc] |= CPU_COVERAGE_EXECUTED;
+    }
+    if (profile_counts) {
+        profile_counts[start_pc]++;
+        profile_cycles[start_pc] += cycles;
+    }
+    if (callgraph.calls) {
+        callgraph_charge(cycles);
+        callgraph_leave();
+    }
+    if (trace.records) {
+        trace.counters[1] += cycles;
+    }
+    hook_check.elapsed += cycles;
+    return cycles;
+}
+
+// BRK sig: pass A/X and service Y to the host-call device through its
+// registers, then return RESULT in A/X and a failed STATUS in carry
+static void brk_host_call(void) {
+    write6502((uint16_t)(brk_trap_address + CPU_HOST_CALL_ARG), a);
+    write6502((uint16_t)(brk_trap_address + CPU_HOST_CALL_ARG + 1), x);
+    write6502((uint16_t)(brk_trap_address + CPU_HOST_CALL_SERVICE), y);
+    a = read6502((uint16_t)(brk_trap_address + CPU_HOST_CALL_RESULT));
+    x = read6502((uint16_t)(brk_trap_address + CPU_HOST_CALL_RESULT + 1));
+    if (read6502((uint16_t)(brk_trap_address + CPU_HOST_CALL_STATUS))) {
+        status |= FLAG_CARRY;
+    } else {
+        status &= (uint8_t)~FLAG_CARRY;
+    }
+}
+
 // CPU control functions
 void cpu_reset(void) {
     // Initialize CPU state without reading from memory
@@ -70,22 +548,87 @@ void cpu_reset(void) {
     nmi_pending = 0;
 }
 
-uint8_t cpu_step(void) {
+uint32_t cpu_step(void) {
+    // Registers before the step, for the call graph and the trace
+    uint8_t start_sp = sp;
+    uint16_t start_pc = pc;
+
+    if (hooks.map) {
+        if (hook_check.id) {
+            if (pc == hook_check.return_pc && sp == hook_check.sp) {
+                hook_validate();
+            }
+        } else if (hooks.map[pc]) {
+            uint32_t cycles = hook_enter(hooks.map[pc]);
+            if (cycles) {
+                return host_step_done(start_pc, cycles);
+            }
+        }
+    }
+    uint8_t regs[5];
+    if (trace.records) {
+        regs[0] = a;
+        regs[1] = x;
+        regs[2] = y;
+        regs[3] = status;
+        regs[4] = sp;
+    }
+
     // Handle pending interrupts
-    if (nmi_pending) {
+    // Take the latch atomically so a line raised concurrently is not lost
+    if (atomic_exchange(&nmi_pending, 0)) {
         nmi6502();
-        nmi_pending = 0;
+        if (callgraph.calls) {
+            callgraph_interrupt(start_sp);
+        }
+        if (trace.records) {
+            trace_interrupt(start_pc, regs, start_sp, CPU_TRACE_NMI);
+        }
+        hook_check.elapsed += 7;
         return 7; // Standard interrupt cycles
-    } else if (irq_pending) {
+    } else if (atomic_exchange(&irq_pending, 0)) {
         irq6502();
-        irq_pending = 0;
+        if (callgraph.calls) {
+            callgraph_interrupt(start_sp);
+        }
+        if (trace.records) {
+            trace_interrupt(start_pc, regs, start_sp, CPU_TRACE_IRQ);
+        }
+        hook_check.elapsed += 7;
         return 7; // Standard interrupt cycles
     }
     
     // Execute one instruction and return cycles
     // step6502() returns the cycles for this instruction directly
+    uint8_t start_status = status;
     uint32_t cycles = step6502();
-    return (uint8_t)cycles;
+    if (opcode == 0x00 && brk_trap_enabled && read6502((uint16_t)(start_pc + 1)) == brk_trap_signature) {
+        // Undo the interrupt entry; the stack bytes it wrote are below SP
+        pc = (uint16_t)(start_pc + 2);
+        sp = start_sp;
+        status = start_status;
+        brk_host_call();
+        return host_step_done(start_pc, cycles);
+    }
+    if (profile_counts) {
+        profile_counts[start_pc]++;
+        profile_cycles[start_pc] += cycles;
+    }
+    if (coverage) {
+        uint8_t flags = CPU_COVERAGE_EXECUTED;
+        if (addrtable[opcode] == rel) {
+            flags |= pc == (uint16_t)(start_pc + 2) ? CPU_COVERAGE_NOT_TAKEN : CPU_COVERAGE_TAKEN;
+        }
+        coverage[start_pc] |= flags;
+    }
+    if (callgraph.calls) {
+        callgraph_instruction(cycles);
+    }
+    if (trace.records) {
+        trace_instruction(start_pc, regs, cycles);
+    }
+    hook_check.elapsed += cycles;
+    return cycles;
 }
 
 // Accessor functions for the static variables in fake6502_improved.h
@@ -115,6 +658,8 @@ void cpu_get_state(cpu_state_t* state) {
         state->y = get_y_6502();
         state->status = get_status_6502();
         state->cycles = get_cycles_6502();
+        state->irq_pending = (uint8_t)irq_pending;
+        state->nmi_pending = (uint8_t)nmi_pending;
     }
 }
 
@@ -127,6 +672,8 @@ void cpu_set_state(const cpu_state_t* state) {
         set_y_6502(state->y);
         set_status_6502(state->status);
         set_cycles_6502(state->cycles);
+        irq_pending = state->irq_pending ? 1 : 0;
+        nmi_pending = state->nmi_pending ? 1 : 0;
     }
 }
 
@@ -135,6 +682,74 @@ void cpu_set_memory_callbacks(read_func_t read_func, write_func_t write_func) {
     memory_write = write_func;
 }
 
+void cpu_map_page(uint8_t page, uint8_t kind, uint8_t* data, uint8_t* dirty, uint32_t* version) {
+    if (kind == CPU_PAGE_CALLBACK || data == NULL) {
+        page_kind[page] = CPU_PAGE_CALLBACK;
+        page_data[page] = NULL;
+        page_dirty[page] = NULL;
+        page_version[page] = NULL;
+        return;
+    }
+    page_kind[page] = kind;
+    page_data[page] = data;
+    page_dirty[page] = kind == CPU_PAGE_RAM ? dirty : NULL;
+    page_version[page] = kind == CPU_PAGE_RAM ? version : NULL;
+}
+
+void cpu_clear_page_map(void) {
+    memset(page_data, 0, sizeof(page_data));
+    memset(page_kind, CPU_PAGE_CALLBACK, sizeof(page_kind));
+    memset(page_dirty, 0, sizeof(page_dirty));
+    memset(page_version, 0, sizeof(page_version));
+}
+
+void cpu_set_profile(uint32_t* counts, uint32_t* cycles) {
+    if (counts == NULL || cycles == NULL) {
+        counts = NULL;
+        cycles = NULL;
+    }
+    profile_counts = counts;
+    profile_cycles = cycles;
+}
+
+void cpu_set_callgraph(const cpu_callgraph_t* graph) {
+    if (graph && graph->calls && graph->inclusive && graph->exclusive && graph->edges && graph->edge_cycles &&
+        graph->stack && graph->clock) {
+        callgraph = *graph;
+    } else {
+        memset(&callgraph, 0, sizeof(callgraph));
+    }
+}
+
+void cpu_set_trace(const cpu_trace_t* config) {
+    if (config && config->records && config->capacity > 0 && config->counters &&
+        (config->filter_count == 0 || config->filters) && config->filter_count <= CPU_TRACE_MAX_FILTERS) {
+        trace = *config;
+    } else {
+        memset(&trace, 0, sizeof(trace));
+    }
+}
+
+void cpu_set_coverage(uint8_t* map) {
+    coverage = map;
+}
+
+void cpu_set_hooks(const cpu_hooks_t* config) {
+    if (config && config->map && config->config && config->costs && config->stats && config->mismatch &&
+        config->shadow && config->written) {
+        hooks = *config;
+    } else {
+        memset(&hooks, 0, sizeof(hooks));
+    }
+    hook_check.id = 0;
+}
+
+void cpu_set_brk_trap(int signature, uint16_t address) {
+    brk_trap_enabled = signature >= 0 && signature <= 0xFF;
+    brk_trap_signature = (uint8_t)signature;
+    brk_trap_address = address;
+}
+
 void cpu_trigger_irq(void) {
     irq_pending = 1;
 }
@@ -21,6 +21,8 @@ typedef struct {
     uint8_t y;      // Y register
     uint8_t status; // Status flags
     uint64_t cycles; // Total cycles executed
+    uint8_t irq_pending; // IRQ latched, serviced before the next instruction
+    uint8_t nmi_pending; // NMI latched, serviced before the next instruction
 } cpu_state_t;
 
 // Memory access function pointers
@@ -29,13 +31,151 @@ typedef void (*write_func_t)(uint16_t address, uint8_t value);
 
 // CPU control functions
 void cpu_reset(void);
-uint8_t cpu_step(void);
+uint32_t cpu_step(void);
 void cpu_get_state(cpu_state_t* state);
 void cpu_set_state(const cpu_state_t* state);
 
 // Memory callback setup
 void cpu_set_memory_callbacks(read_func_t read_func, write_func_t write_func);
 
+// Page table: pages mapped to host buffers are accessed directly, all
+// other pages go through the memory callbacks. Writes to RAM pages set
+// *dirty and increment *version when those are given.
+#define CPU_PAGE_CALLBACK 0
+#define CPU_PAGE_RAM      1
+#define CPU_PAGE_ROM      2
+
+void cpu_map_page(uint8_t page, uint8_t kind, uint8_t* data, uint8_t* dirty, uint32_t* version);
+void cpu_clear_page_map(void);
+
+// Per-PC profile: cpu_step adds one to counts[pc] and the instruction's
+// cycles to cycles[pc], both 65536 entries, for the PC each instruction
+// starts at. Interrupt entry is not counted. NULL turns profiling off.
+void cpu_set_profile(uint32_t* counts, uint32_t* cycles);
+
+// Coverage: cpu_step ORs flags into map[pc], 65536 entries, for the PC each
+// instruction starts at; conditional branches also record whether they were
+// taken. Interrupt entry is not recorded. NULL turns coverage off.
+#define CPU_COVERAGE_EXECUTED 0x01
+#define CPU_COVERAGE_TAKEN 0x02
+#define CPU_COVERAGE_NOT_TAKEN 0x04
+void cpu_set_coverage(uint8_t* map);
+
+// Call graph: cpu_step keeps a shadow call stack, pushing a frame on JSR,
+// BRK and interrupt entry and popping frames once an RTS, RTI or TXS
+// leaves SP above the stack pointer the frame was entered with. Cycles go
+// to the routine on top of the stack. Cycle counts are doubles, exact up
+// to 2^53, so long runs do not wrap them. All arrays are owned by the
+// caller; stack must hold the root frame before the graph is installed.
+#define CPU_CALL_STACK_DEPTH 256
+#define CPU_CALL_EDGE_SLOTS  4096  // Power of two
+#define CPU_CALL_HEADER      2     // stack[]: depth, dropped calls
+#define CPU_CALL_FRAME       2     // Then per frame: address, SP
+
+typedef struct {
+    uint32_t* calls;        // 65536: times each routine was entered
+    double* inclusive;      // 65536: cycles in returned calls, callees included
+    double* exclusive;      // 65536: cycles spent in the routine itself
+    uint32_t* edges;        // CPU_CALL_EDGE_SLOTS x {caller << 16 | callee, calls}
+    double* edge_cycles;    // CPU_CALL_EDGE_SLOTS: cycles in the callee per edge
+    uint32_t* stack;        // CPU_CALL_HEADER + CPU_CALL_STACK_DEPTH x CPU_CALL_FRAME
+    double* clock;          // 1 + CPU_CALL_STACK_DEPTH: cycle clock, then the clock at entry per frame
+} cpu_callgraph_t;
+
+// NULL turns the call graph off
+void cpu_set_callgraph(const cpu_callgraph_t* graph);
+
+// Execution trace: cpu_step appends one fixed-size record per instruction
+// or interrupt entry to a ring owned by the caller, overwriting the oldest
+// records once it is full. Records hold the registers before execution.
+// counters[0] counts records ever written; counters[1] is the cycle clock,
+// which advances on every step, recorded or not. With filters, only
+// instructions whose PC lies in one of the inclusive ranges are recorded.
+#define CPU_TRACE_RECORD_SIZE 24
+#define CPU_TRACE_MAX_FILTERS 8
+
+// Record layout, little-endian:
+//   0 cycle (u64)   8 pc (u16)   10 opcode   11-12 operands   13 a   14 x
+//   15 y   16 p   17 sp   18 cycles taken   19 kind   20 length   21-23 zero
+#define CPU_TRACE_INSTRUCTION 0
+#define CPU_TRACE_IRQ         1
+#define CPU_TRACE_NMI         2
+
+typedef struct {
+    uint8_t* records;       // capacity x CPU_TRACE_RECORD_SIZE
+    uint32_t capacity;
+    uint64_t* counters;     // Records written, cycle clock
+    uint16_t* filters;      // filter_count x {first, last}
+    uint32_t filter_count;
+} cpu_trace_t;
+
+// NULL turns tracing off
+void cpu_set_trace(const cpu_trace_t* trace);
+
+// Runtime hooks: when cpu_step reaches an address whose map entry is a
+// hook id, it performs that cc65 runtime routine directly, returns to the
+// caller as the routine's RTS would and charges costs[id] cycles, or an
+// estimate of the routine's own cycles when that is 0. A hook declines
+// inputs it does not reproduce exactly (e.g. division by zero) and the
+// routine then runs normally. Only the documented results are produced:
+// return registers, C stack and memory, not the scratch zero page.
+//
+// With config[CPU_HOOK_VALIDATE] set, routines always run normally; the
+// hook writes its results to shadow instead, and when the routine returns
+// the bytes the hook wrote and its return registers are compared with the
+// real ones. The last difference is kept in mismatch.
+#define CPU_HOOK_PUSHAX   1
+#define CPU_HOOK_POPAX    2
+#define CPU_HOOK_MEMCPY   3
+#define CPU_HOOK_MEMSET   4
+#define CPU_HOOK_BZERO    5
+#define CPU_HOOK_STRLEN   6
+#define CPU_HOOK_TOSMULAX 7
+#define CPU_HOOK_UDIV16   8
+#define CPU_HOOK_COUNT    9    // Ids are below this
+
+// config[]: zero page addresses of the cc65 runtime, then the mode
+#define CPU_HOOK_ZP_SP    0    // C stack pointer (sp, c_sp since cc65 2.19)
+#define CPU_HOOK_ZP_PTR1  1
+#define CPU_HOOK_ZP_PTR4  2
+#define CPU_HOOK_ZP_SREG  3
+#define CPU_HOOK_VALIDATE 4
+#define CPU_HOOK_CONFIG   5
+
+// stats[]: per hook id, calls handled, cycles charged, calls validated,
+// mismatches, and cycles the validated calls really took
+#define CPU_HOOK_STATS    5
+
+// mismatch[]: hook id, address or CPU_HOOK_REGISTER + 0 (A) / 1 (X),
+// expected value, actual value
+#define CPU_HOOK_REGISTER 0x10000
+
+typedef struct {
+    uint8_t* map;           // 65536: hook id per routine entry, 0 for none
+    uint32_t* config;       // CPU_HOOK_CONFIG
+    uint32_t* costs;        // CPU_HOOK_COUNT: cycles per call, 0 for the estimate
+    uint32_t* stats;        // CPU_HOOK_COUNT x CPU_HOOK_STATS
+    uint32_t* mismatch;     // 4
+    uint8_t* shadow;        // 65536: bytes as the hook wrote them
+    uint8_t* written;       // 8192: bitmap of the bytes written to shadow
+} cpu_hooks_t;
+
+// NULL turns the hooks off
+void cpu_set_hooks(const cpu_hooks_t* hooks);
+
+// BRK host-call trap: a BRK whose signature byte matches does not enter
+// the interrupt handler. A and X are written to the host-call device's ARG
+// register at address, then Y to SERVICE; RESULT is read back into A/X and
+// carry set when STATUS is not 0. The BRK takes two bytes and its cycles.
+// Layout matches src/peripherals/host-call.ts.
+#define CPU_HOST_CALL_SERVICE 0
+#define CPU_HOST_CALL_STATUS  1
+#define CPU_HOST_CALL_ARG     2
+#define CPU_HOST_CALL_RESULT  4
+
+// A signature outside 0-255 turns the trap off
+void cpu_set_brk_trap(int signature, uint16_t address);
+
 // Interrupt control
 void cpu_trigger_irq(void);
 void cpu_trigger_nmi(void);
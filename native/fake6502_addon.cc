@@ -1,5 +1,8 @@
 #include <napi.h>
 #include "fake6502.h"
+#include "fake6502_thread.h"
+#include "fake6502_batch.h"
+#include <vector>
 
 // Global memory callback functions for the C code
 static Napi::FunctionReference g_read_callback;
@@ -8,6 +11,9 @@ static napi_env g_env;
 
 // C callback functions that bridge to JavaScript
 uint8_t memory_read_bridge(uint16_t address) {
+    if (thread_on_worker()) {
+        return thread_memory_read(address);
+    }
     if (!g_read_callback.IsEmpty()) {
         Napi::Env env(g_env);
         Napi::Value result = g_read_callback.Call({Napi::Number::New(env, address)});
@@ -19,6 +25,10 @@ uint8_t memory_read_bridge(uint16_t address) {
 }
 
 void memory_write_bridge(uint16_t address, uint8_t value) {
+    if (thread_on_worker()) {
+        thread_memory_write(address, value);
+        return;
+    }
     if (!g_write_callback.IsEmpty()) {
         Napi::Env env(g_env);
         g_write_callback.Call({
@@ -28,20 +38,37 @@ void memory_write_bridge(uint16_t address, uint8_t value) {
     }
 }
 
+// The running worker owns the CPU core; direct control must wait for a pause
+static bool RejectWhileRunning(const Napi::CallbackInfo& info) {
+    if (thread_is_running()) {
+        Napi::Error::New(info.Env(), "CPU is running on the worker thread").ThrowAsJavaScriptException();
+        return true;
+    }
+    return false;
+}
+
 // JavaScript-callable functions
 Napi::Value Reset(const Napi::CallbackInfo& info) {
+    if (RejectWhileRunning(info)) {
+        return info.Env().Undefined();
+    }
     cpu_reset();
     return info.Env().Undefined();
 }
 
 Napi::Value Step(const Napi::CallbackInfo& info) {
-    uint8_t cycles = cpu_step();
+    if (RejectWhileRunning(info)) {
+        return info.Env().Undefined();
+    }
+    uint32_t cycles = cpu_step();
     return Napi::Number::New(info.Env(), cycles);
 }
 
 Napi::Value GetState(const Napi::CallbackInfo& info) {
     cpu_state_t state;
-    cpu_get_state(&state);
+    if (!thread_get_snapshot(&state)) {
+        cpu_get_state(&state);
+    }
     
     Napi::Object obj = Napi::Object::New(info.Env());
     obj.Set("pc", Napi::Number::New(info.Env(), state.pc));
@@ -51,6 +78,8 @@ Napi::Value GetState(const Napi::CallbackInfo& info) {
     obj.Set("y", Napi::Number::New(info.Env(), state.y));
     obj.Set("status", Napi::Number::New(info.Env(), state.status));
     obj.Set("cycles", Napi::Number::New(info.Env(), state.cycles));
+    obj.Set("irqPending", Napi::Boolean::New(info.Env(), state.irq_pending != 0));
+    obj.Set("nmiPending", Napi::Boolean::New(info.Env(), state.nmi_pending != 0));
     
     return obj;
 }
@@ -60,6 +89,9 @@ Napi::Value SetState(const Napi::CallbackInfo& info) {
         Napi::TypeError::New(info.Env(), "Expected object argument").ThrowAsJavaScriptException();
         return info.Env().Undefined();
     }
+    if (RejectWhileRunning(info)) {
+        return info.Env().Undefined();
+    }
     
     Napi::Object obj = info[0].As<Napi::Object>();
     cpu_state_t state;
@@ -72,6 +104,8 @@ Napi::Value SetState(const Napi::CallbackInfo& info) {
     if (obj.Has("y")) state.y = obj.Get("y").As<Napi::Number>().Uint32Value();
     if (obj.Has("status")) state.status = obj.Get("status").As<Napi::Number>().Uint32Value();
     if (obj.Has("cycles")) state.cycles = obj.Get("cycles").As<Napi::Number>().Uint32Value();
+    if (obj.Has("irqPending")) state.irq_pending = obj.Get("irqPending").ToBoolean().Value() ? 1 : 0;
+    if (obj.Has("nmiPending")) state.nmi_pending = obj.Get("nmiPending").ToBoolean().Value() ? 1 : 0;
     
     cpu_set_state(&state);
     return info.Env().Undefined();
@@ -115,6 +149,286 @@ Napi::Value IsNMIPending(const Napi::CallbackInfo& info) {
     return Napi::Boolean::New(info.Env(), cpu_is_nmi_pending());
 }
 
+// Profile arrays are held here so they outlive the JavaScript references
+// while the core writes to them
+static Napi::Reference<Napi::Uint32Array> g_profile_counts;
+static Napi::Reference<Napi::Uint32Array> g_profile_cycles;
+
+// setProfile(counts, cycles): two Uint32Array(65536), or nulls to stop
+Napi::Value SetProfile(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (RejectWhileRunning(info)) {
+        return env.Undefined();
+    }
+    if (info.Length() >= 2 && info[0].IsNull() && info[1].IsNull()) {
+        cpu_set_profile(NULL, NULL);
+        g_profile_counts.Reset();
+        g_profile_cycles.Reset();
+        return env.Undefined();
+    }
+    if (info.Length() < 2 || !info[0].IsTypedArray() || !info[1].IsTypedArray()) {
+        Napi::TypeError::New(env, "Expected two Uint32Array arguments or nulls").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::TypedArray counts = info[0].As<Napi::TypedArray>();
+    Napi::TypedArray cycles = info[1].As<Napi::TypedArray>();
+    if (counts.TypedArrayType() != napi_uint32_array || cycles.TypedArrayType() != napi_uint32_array ||
+        counts.ElementLength() < 0x10000 || cycles.ElementLength() < 0x10000) {
+        Napi::TypeError::New(env, "Profile arrays must be Uint32Array(65536)").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    g_profile_counts = Napi::Persistent(counts.As<Napi::Uint32Array>());
+    g_profile_cycles = Napi::Persistent(cycles.As<Napi::Uint32Array>());
+    cpu_set_profile(counts.As<Napi::Uint32Array>().Data(), cycles.As<Napi::Uint32Array>().Data());
+    return env.Undefined();
+}
+
+// Coverage map, held like the profile arrays
+static Napi::Reference<Napi::Uint8Array> g_coverage;
+
+// setCoverage(map): Uint8Array(65536), or null to stop
+Napi::Value SetCoverage(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (RejectWhileRunning(info)) {
+        return env.Undefined();
+    }
+    if (info.Length() >= 1 && info[0].IsNull()) {
+        cpu_set_coverage(NULL);
+        g_coverage.Reset();
+        return env.Undefined();
+    }
+    if (info.Length() < 1 || !info[0].IsTypedArray() ||
+        info[0].As<Napi::TypedArray>().TypedArrayType() != napi_uint8_array ||
+        info[0].As<Napi::TypedArray>().ElementLength() < 0x10000) {
+        Napi::TypeError::New(env, "Coverage map must be Uint8Array(65536) or null").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Uint8Array map = info[0].As<Napi::Uint8Array>();
+    g_coverage = Napi::Persistent(map);
+    cpu_set_coverage(map.Data());
+    return env.Undefined();
+}
+
+// References to typed arrays the core keeps writing into after the call
+// that handed them over
+typedef std::vector<Napi::Reference<Napi::TypedArray>> HeldArrays;
+
+// Typed array property of an object, or NULL when it is missing, of the
+// wrong type or shorter than length elements. With held, a reference to
+// the array is added to it, so the buffer stays alive even if the property
+// is later replaced.
+template <typename T>
+static T* TypedArrayField(Napi::Object object, const char* name, napi_typedarray_type type, size_t length,
+                          HeldArrays* held = NULL) {
+    Napi::Value value = object.Get(name);
+    if (!value.IsTypedArray()) {
+        return NULL;
+    }
+    Napi::TypedArray array = value.As<Napi::TypedArray>();
+    if (array.TypedArrayType() != type || array.ElementLength() < length) {
+        return NULL;
+    }
+    if (held) {
+        held->push_back(Napi::Persistent(array));
+    }
+    return reinterpret_cast<T*>(static_cast<uint8_t*>(array.ArrayBuffer().Data()) + array.ByteOffset());
+}
+
+// batchRun(state, maxCycles) -> lanes still running
+// state holds the structure-of-arrays registers, lane memory and output
+// buffers owned by the JavaScript side (see src/core/batch.ts)
+Napi::Value BatchRun(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected batch state and cycle budget").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Object state = info[0].As<Napi::Object>();
+    batch_t batch;
+    batch.lanes = state.Get("lanes").ToNumber().Uint32Value();
+    batch.output_capacity = state.Get("outputCapacity").ToNumber().Uint32Value();
+    batch.stop_address = state.Get("stopAddress").ToNumber().Int32Value();
+    batch.output_address = state.Get("outputAddress").ToNumber().Int32Value();
+
+    size_t lanes = batch.lanes;
+    batch.pc = TypedArrayField<uint16_t>(state, "pc", napi_uint16_array, lanes);
+    batch.a = TypedArrayField<uint8_t>(state, "a", napi_uint8_array, lanes);
+    batch.x = TypedArrayField<uint8_t>(state, "x", napi_uint8_array, lanes);
+    batch.y = TypedArrayField<uint8_t>(state, "y", napi_uint8_array, lanes);
+    batch.sp = TypedArrayField<uint8_t>(state, "sp", napi_uint8_array, lanes);
+    batch.status = TypedArrayField<uint8_t>(state, "status", napi_uint8_array, lanes);
+    batch.cycles = TypedArrayField<double>(state, "cycles", napi_float64_array, lanes);
+    batch.lane_status = TypedArrayField<uint8_t>(state, "laneStatus", napi_uint8_array, lanes);
+    batch.memory = TypedArrayField<uint8_t>(state, "memory", napi_uint8_array, lanes * BATCH_MEMORY_SIZE);
+    batch.writable = TypedArrayField<uint8_t>(state, "writable", napi_uint8_array, 256);
+    batch.output = TypedArrayField<uint8_t>(state, "output", napi_uint8_array, lanes * batch.output_capacity);
+    batch.output_length = TypedArrayField<uint32_t>(state, "outputLength", napi_uint32_array, lanes);
+
+    if (!batch.pc || !batch.a || !batch.x || !batch.y || !batch.sp || !batch.status || !batch.cycles ||
+        !batch.lane_status || !batch.memory || !batch.writable ||
+        (batch.output_address >= 0 && (!batch.output || !batch.output_length))) {
+        Napi::TypeError::New(env, "Invalid batch state").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    batch_scratch_t* scratch = batch_scratch_create(batch.lanes);
+    if (!scratch) {
+        Napi::Error::New(env, "Out of memory for batch scratch").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    uint32_t running = batch_run(&batch, scratch, info[1].As<Napi::Number>().DoubleValue());
+    batch_scratch_destroy(scratch);
+
+    return Napi::Number::New(env, running);
+}
+
+// The call graph's arrays, held while the core writes to them
+static HeldArrays g_callgraph;
+
+// setCallGraph(graph): the arrays of src/core/call-graph.ts, or null to stop
+Napi::Value SetCallGraph(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (RejectWhileRunning(info)) {
+        return env.Undefined();
+    }
+    if (info.Length() >= 1 && info[0].IsNull()) {
+        cpu_set_callgraph(NULL);
+        g_callgraph.clear();
+        return env.Undefined();
+    }
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected a call graph object or null").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Object object = info[0].As<Napi::Object>();
+    cpu_callgraph_t graph;
+    HeldArrays held;
+    graph.calls = TypedArrayField<uint32_t>(object, "calls", napi_uint32_array, 0x10000, &held);
+    graph.inclusive = TypedArrayField<double>(object, "inclusive", napi_float64_array, 0x10000, &held);
+    graph.exclusive = TypedArrayField<double>(object, "exclusive", napi_float64_array, 0x10000, &held);
+    graph.edges = TypedArrayField<uint32_t>(object, "edges", napi_uint32_array, CPU_CALL_EDGE_SLOTS * 2, &held);
+    graph.edge_cycles = TypedArrayField<double>(object, "edgeCycles", napi_float64_array, CPU_CALL_EDGE_SLOTS, &held);
+    graph.stack = TypedArrayField<uint32_t>(object, "stack", napi_uint32_array,
+                                            CPU_CALL_HEADER + CPU_CALL_STACK_DEPTH * CPU_CALL_FRAME, &held);
+    graph.clock = TypedArrayField<double>(object, "clock", napi_float64_array, 1 + CPU_CALL_STACK_DEPTH, &held);
+    if (!graph.calls || !graph.inclusive || !graph.exclusive || !graph.edges || !graph.edge_cycles ||
+        !graph.stack || !graph.clock || graph.stack[0] < 1 || graph.stack[0] > CPU_CALL_STACK_DEPTH) {
+        Napi::TypeError::New(env, "Invalid call graph").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    g_callgraph = std::move(held);
+    cpu_set_callgraph(&graph);
+    return env.Undefined();
+}
+
+// The trace's buffers, held while the core writes to them
+static HeldArrays g_trace;
+
+// setTrace(trace): the buffers of src/debug/trace-buffer.ts, or null to stop
+Napi::Value SetTrace(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (RejectWhileRunning(info)) {
+        return env.Undefined();
+    }
+    if (info.Length() >= 1 && info[0].IsNull()) {
+        cpu_set_trace(NULL);
+        g_trace.clear();
+        return env.Undefined();
+    }
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected a trace object or null").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Object object = info[0].As<Napi::Object>();
+    cpu_trace_t trace;
+    HeldArrays held;
+    trace.capacity = object.Get("capacity").ToNumber().Uint32Value();
+    trace.filter_count = object.Get("filterCount").ToNumber().Uint32Value();
+    trace.records = TypedArrayField<uint8_t>(object, "records", napi_uint8_array, (size_t)trace.capacity * CPU_TRACE_RECORD_SIZE, &held);
+    trace.counters = TypedArrayField<uint64_t>(object, "counters", napi_biguint64_array, 2, &held);
+    trace.filters = TypedArrayField<uint16_t>(object, "filters", napi_uint16_array, CPU_TRACE_MAX_FILTERS * 2, &held);
+    if (!trace.records || trace.capacity == 0 || !trace.counters || !trace.filters ||
+        trace.filter_count > CPU_TRACE_MAX_FILTERS) {
+        Napi::TypeError::New(env, "Invalid trace buffer").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    g_trace = std::move(held);
+    cpu_set_trace(&trace);
+    return env.Undefined();
+}
+
+// The hooks' arrays, held while the core uses them
+static HeldArrays g_hooks;
+
+// setHooks(hooks): the arrays of src/cc65/runtime-hooks.ts, or null to stop
+Napi::Value SetHooks(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (RejectWhileRunning(info)) {
+        return env.Undefined();
+    }
+    if (info.Length() >= 1 && info[0].IsNull()) {
+        cpu_set_hooks(NULL);
+        g_hooks.clear();
+        return env.Undefined();
+    }
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        Napi::TypeError::New(env, "Expected a hooks object or null").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    Napi::Object object = info[0].As<Napi::Object>();
+    cpu_hooks_t hooks;
+    HeldArrays held;
+    hooks.map = TypedArrayField<uint8_t>(object, "map", napi_uint8_array, 0x10000, &held);
+    hooks.config = TypedArrayField<uint32_t>(object, "config", napi_uint32_array, CPU_HOOK_CONFIG, &held);
+    hooks.costs = TypedArrayField<uint32_t>(object, "costs", napi_uint32_array, CPU_HOOK_COUNT, &held);
+    hooks.stats = TypedArrayField<uint32_t>(object, "stats", napi_uint32_array, CPU_HOOK_COUNT * CPU_HOOK_STATS, &held);
+    hooks.mismatch = TypedArrayField<uint32_t>(object, "mismatch", napi_uint32_array, 4, &held);
+    hooks.shadow = TypedArrayField<uint8_t>(object, "shadow", napi_uint8_array, 0x10000, &held);
+    hooks.written = TypedArrayField<uint8_t>(object, "written", napi_uint8_array, 0x10000 / 8, &held);
+    if (!hooks.map || !hooks.config || !hooks.costs || !hooks.stats || !hooks.mismatch ||
+        !hooks.shadow || !hooks.written) {
+        Napi::TypeError::New(env, "Invalid runtime hooks").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    g_hooks = std::move(held);
+    cpu_set_hooks(&hooks);
+    return env.Undefined();
+}
+
+// setBrkTrap(signature, address): BRK signature host calls to the device
+// at address, or setBrkTrap(null) to stop
+Napi::Value SetBrkTrap(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (RejectWhileRunning(info)) {
+        return env.Undefined();
+    }
+    if (info.Length() >= 1 && info[0].IsNull()) {
+        cpu_set_brk_trap(-1, 0);
+        return env.Undefined();
+    }
+    if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected a signature byte and an address, or null").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    int signature = info[0].As<Napi::Number>().Int32Value();
+    if (signature < 0 || signature > 0xFF) {
+        Napi::RangeError::New(env, "BRK signature must be a byte").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    cpu_set_brk_trap(signature, (uint16_t)info[1].As<Napi::Number>().Uint32Value());
+    return env.Undefined();
+}
+
 // Module initialization
 Napi::Object Init(Napi::Env env, Napi::Object exports) {
     exports.Set("reset", Napi::Function::New(env, Reset));
@@ -127,6 +441,14 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     exports.Set("clearIRQ", Napi::Function::New(env, ClearIRQ));
     exports.Set("isIRQPending", Napi::Function::New(env, IsIRQPending));
     exports.Set("isNMIPending", Napi::Function::New(env, IsNMIPending));
+    exports.Set("setProfile", Napi::Function::New(env, SetProfile));
+    exports.Set("setCoverage", Napi::Function::New(env, SetCoverage));
+    exports.Set("setCallGraph", Napi::Function::New(env, SetCallGraph));
+    exports.Set("setTrace", Napi::Function::New(env, SetTrace));
+    exports.Set("setHooks", Napi::Function::New(env, SetHooks));
+    exports.Set("setBrkTrap", Napi::Function::New(env, SetBrkTrap));
+    exports.Set("batchRun", Napi::Function::New(env, BatchRun));
+    InitThread(env, exports);
     
     return exports;
 }
@@ -0,0 +1,540 @@
+/*
+ * fake6502 batch engine
+ *
+ * Each step fetches the next opcode of every running lane and groups the
+ * lanes by opcode. Every group is then executed as a loop over its lanes:
+ * one pass for the addressing mode, one for the operation and one for the
+ * cycle count, so decode and dispatch are paid once per opcode rather than
+ * once per lane. Lanes that share a program stay in the same group while
+ * their control flow agrees; divergent lanes simply land in other groups.
+ *
+ * Semantics follow the single-instance core (fake6502_improved.h built with
+ * NES_CPU and UNDOCUMENTED): no decimal mode, the same cycle table and
+ * page-crossing penalties. There are no interrupts and no peripherals.
+ */
+
+#include "fake6502_batch.h"
+#include "fake6502.h"
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct batch_scratch {
+    uint32_t lanes;
+    uint32_t* live;         // Lanes still executing in this run
+    uint32_t* order;        // Live lanes grouped by opcode
+    uint8_t* opcode;        // Opcode fetched this step
+    uint16_t* start_pc;     // PC before this step
+    uint16_t* ea;           // Effective address (branch offset for rel)
+    uint8_t* crossed;       // Addressing mode crossed a page
+    double* limit;          // Cycle count at which the lane stops this run
+    uint32_t count[256];
+    uint32_t offset[256];
+    uint8_t used[256];
+};
+
+// Addressing modes
+enum {
+    M_IMP, M_ACC, M_IMM, M_ZP, M_ZPX, M_ZPY, M_REL, M_ABSO, M_ABSX, M_ABSY,
+    M_IND, M_INDX, M_INDY
+};
+
+// Operations
+enum {
+    O_ADC, O_AND, O_ASL, O_BCC, O_BCS, O_BEQ, O_BIT, O_BMI, O_BNE, O_BPL,
+    O_BRK, O_BVC, O_BVS, O_CLC, O_CLD, O_CLI, O_CLV, O_CMP, O_CPX, O_CPY,
+    O_DEC, O_DEX, O_DEY, O_EOR, O_INC, O_INX, O_INY, O_JMP, O_JSR, O_LDA,
+    O_LDX, O_LDY, O_LSR, O_NOP, O_ORA, O_PHA, O_PHP, O_PLA, O_PLP, O_ROL,
+    O_ROR, O_RTI, O_RTS, O_SBC, O_SEC, O_SED, O_SEI, O_STA, O_STX, O_STY,
+    O_TAX, O_TAY, O_TSX, O_TXA, O_TXS, O_TYA,
+    // Undocumented
+    O_LAX, O_SAX, O_DCP, O_ISB, O_SLO, O_RLA, O_SRE, O_RRA
+};
+
+// Mode, operation and cycle tables, generated from the single-instance core
+#include "fake6502_batch_tables.h"
+
+// Operations that take the extra cycle when their addressing mode crosses
+// a page. The undocumented read-modify-write ops cancel it in the original.
+static int batch_has_penalty(uint8_t opcode) {
+    switch (batch_ops[opcode]) {
+        case O_ADC: case O_AND: case O_CMP: case O_EOR: case O_LDA:
+        case O_LDX: case O_LDY: case O_ORA: case O_SBC: case O_LAX:
+            return 1;
+        case O_NOP:
+            return opcode == 0x1C || opcode == 0x3C || opcode == 0x5C ||
+                   opcode == 0x7C || opcode == 0xDC || opcode == 0xFC;
+        default:
+            return 0;
+    }
+}
+
+/* memory access */
+
+static inline uint8_t rd(const batch_t* b, uint32_t lane, uint16_t address) {
+    return b->memory[((size_t)lane << 16) | address];
+}
+
+static inline uint16_t rd16(const batch_t* b, uint32_t lane, uint16_t address) {
+    return (uint16_t)(rd(b, lane, address) | (rd(b, lane, (uint16_t)(address + 1)) << 8));
+}
+
+static inline void wr(batch_t* b, uint32_t lane, uint16_t address, uint8_t value) {
+    if ((int32_t)address == b->output_address) {
+        // The length keeps counting past the capacity so overflow is visible
+        uint32_t length = b->output_length[lane]++;
+        if (length < b->output_capacity) {
+            b->output[(size_t)lane * b->output_capacity + length] = value;
+        }
+        return;
+    }
+    if (b->writable[address >> 8]) {
+        b->memory[((size_t)lane << 16) | address] = value;
+    }
+}
+
+static inline void push8(batch_t* b, uint32_t lane, uint8_t value) {
+    wr(b, lane, (uint16_t)(0x100 + b->sp[lane]), value);
+    b->sp[lane]--;
+}
+
+static inline void push16(batch_t* b, uint32_t lane, uint16_t value) {
+    push8(b, lane, (uint8_t)(value >> 8));
+    push8(b, lane, (uint8_t)value);
+}
+
+static inline uint8_t pull8(batch_t* b, uint32_t lane) {
+    b->sp[lane]++;
+    return rd(b, lane, (uint16_t)(0x100 + b->sp[lane]));
+}
+
+static inline uint16_t pull16(batch_t* b, uint32_t lane) {
+    uint16_t low = pull8(b, lane);
+    return (uint16_t)(low | (pull8(b, lane) << 8));
+}
+
+/* flag helpers */
+
+static inline uint8_t nz(uint8_t status, uint8_t value) {
+    return (uint8_t)((status & ~(FLAG_ZERO | FLAG_SIGN)) | (value ? 0 : FLAG_ZERO) | (value & FLAG_SIGN));
+}
+
+static inline void adc(batch_t* b, uint32_t lane, uint8_t value) {
+    uint8_t a = b->a[lane];
+    uint16_t result = (uint16_t)(a + value + (b->status[lane] & FLAG_CARRY));
+    uint8_t status = nz(b->status[lane], (uint8_t)result) & ~(FLAG_CARRY | FLAG_OVERFLOW);
+    if (result & 0xFF00) status |= FLAG_CARRY;
+    if ((result ^ a) & (result ^ value) & 0x80) status |= FLAG_OVERFLOW;
+    b->status[lane] = status;
+    b->a[lane] = (uint8_t)result;
+}
+
+static inline void compare(batch_t* b, uint32_t lane, uint8_t reg, uint8_t value) {
+    uint8_t status = b->status[lane] & ~(FLAG_CARRY | FLAG_ZERO | FLAG_SIGN);
+    if (reg >= value) status |= FLAG_CARRY;
+    if (reg == value) status |= FLAG_ZERO;
+    status |= (uint8_t)(reg - value) & FLAG_SIGN;
+    b->status[lane] = status;
+}
+
+static inline uint8_t shift_left(batch_t* b, uint32_t lane, uint8_t value, uint8_t carry_in) {
+    uint8_t result = (uint8_t)((value << 1) | carry_in);
+    b->status[lane] = (uint8_t)((nz(b->status[lane], result) & ~FLAG_CARRY) | (value >> 7));
+    return result;
+}
+
+static inline uint8_t shift_right(batch_t* b, uint32_t lane, uint8_t value, uint8_t carry_in) {
+    uint8_t result = (uint8_t)((value >> 1) | (carry_in << 7));
+    b->status[lane] = (uint8_t)((nz(b->status[lane], result) & ~FLAG_CARRY) | (value & 1));
+    return result;
+}
+
+/* group execution */
+
+static void batch_address(batch_t* b, batch_scratch_t* s, uint8_t mode, const uint32_t* list, uint32_t n) {
+    uint16_t* pc = b->pc;
+    uint16_t* ea = s->ea;
+    uint32_t i;
+
+    switch (mode) {
+        case M_IMP:
+        case M_ACC:
+            break;
+        case M_IMM:
+            for (i = 0; i < n; i++) { uint32_t l = list[i]; ea[l] = pc[l]++; }
+            break;
+        case M_ZP:
+            for (i = 0; i < n; i++) { uint32_t l = list[i]; ea[l] = rd(b, l, pc[l]++); }
+            break;
+        case M_ZPX:
+            for (i = 0; i < n; i++) { uint32_t l = list[i]; ea[l] = (uint8_t)(rd(b, l, pc[l]++) + b->x[l]); }
+            break;
+        case M_ZPY:
+            for (i = 0; i < n; i++) { uint32_t l = list[i]; ea[l] = (uint8_t)(rd(b, l, pc[l]++) + b->y[l]); }
+            break;
+        case M_REL:
+            for (i = 0; i < n; i++) { uint32_t l = list[i]; ea[l] = (uint16_t)(int8_t)rd(b, l, pc[l]++); }
+            break;
+        case M_ABSO:
+            for (i = 0; i < n; i++) { uint32_t l = list[i]; ea[l] = rd16(b, l, pc[l]); pc[l] += 2; }
+            break;
+        case M_ABSX:
+        case M_ABSY: {
+            const uint8_t* index = mode == M_ABSX ? b->x : b->y;
+            for (i = 0; i < n; i++) {
+                uint32_t l = list[i];
+                uint16_t base = rd16(b, l, pc[l]);
+                ea[l] = (uint16_t)(base + index[l]);
+                s->crossed[l] = (base ^ ea[l]) >> 8 != 0;
+                pc[l] += 2;
+            }
+            break;
+        }
+        case M_IND:
+            for (i = 0; i < n; i++) {
+                uint32_t l = list[i];
+                uint16_t pointer = rd16(b, l, pc[l]);
+                // Replicate the 6502 page-boundary wraparound bug
+                uint16_t high = (uint16_t)((pointer & 0xFF00) | ((pointer + 1) & 0x00FF));
+                ea[l] = (uint16_t)(rd(b, l, pointer) | (rd(b, l, high) << 8));
+                pc[l] += 2;
+            }
+            break;
+        case M_INDX:
+            for (i = 0; i < n; i++) {
+                uint32_t l = list[i];
+                uint8_t pointer = (uint8_t)(rd(b, l, pc[l]++) + b->x[l]);
+                ea[l] = (uint16_t)(rd(b, l, pointer) | (rd(b, l, (uint8_t)(pointer + 1)) << 8));
+            }
+            break;
+        case M_INDY:
+            for (i = 0; i < n; i++) {
+                uint32_t l = list[i];
+                uint8_t pointer = rd(b, l, pc[l]++);
+                uint16_t base = (uint16_t)(rd(b, l, pointer) | (rd(b, l, (uint8_t)(pointer + 1)) << 8));
+                ea[l] = (uint16_t)(base + b->y[l]);
+                s->crossed[l] = (base ^ ea[l]) >> 8 != 0;
+            }
+            break;
+    }
+}
+
+// Taken branches cost one extra cycle, two when they cross a page
+static void batch_branch(batch_t* b, batch_scratch_t* s, const uint32_t* list, uint32_t n,
+                         uint8_t flag, uint8_t want) {
+    uint32_t i;
+    for (i = 0; i < n; i++) {
+        uint32_t l = list[i];
+        if ((b->status[l] & flag) == want) {
+            uint16_t old = b->pc[l];
+            b->pc[l] = (uint16_t)(old + s->ea[l]);
+            b->cycles[l] += ((old ^ b->pc[l]) & 0xFF00) ? 2 : 1;
+        }
+    }
+}
+
+static void batch_operate(batch_t* b, batch_scratch_t* s, uint8_t opcode, const uint32_t* list, uint32_t n) {
+    const int acc = batch_modes[opcode] == M_ACC;
+    uint16_t* ea = s->ea;
+    uint8_t* st = b->status;
+    uint32_t i;
+
+// Operand and result of the current lane, honouring accumulator mode
+#define OPERAND(l) (acc ? b->a[l] : rd(b, l, ea[l]))
+#define STORE(l, v) do { if (acc) b->a[l] = (v); else wr(b, l, ea[l], (v)); } while (0)
+#define EACH_LANE for (i = 0; i < n; i++)
+
+    switch (batch_ops[opcode]) {
+        /* loads, stores and transfers */
+        case O_LDA: EACH_LANE { uint32_t l = list[i]; b->a[l] = OPERAND(l); st[l] = nz(st[l], b->a[l]); } break;
+        case O_LDX: EACH_LANE { uint32_t l = list[i]; b->x[l] = OPERAND(l); st[l] = nz(st[l], b->x[l]); } break;
+        case O_LDY: EACH_LANE { uint32_t l = list[i]; b->y[l] = OPERAND(l); st[l] = nz(st[l], b->y[l]); } break;
+        case O_STA: EACH_LANE { uint32_t l = list[i]; wr(b, l, ea[l], b->a[l]); } break;
+        case O_STX: EACH_LANE { uint32_t l = list[i]; wr(b, l, ea[l], b->x[l]); } break;
+        case O_STY: EACH_LANE { uint32_t l = list[i]; wr(b, l, ea[l], b->y[l]); } break;
+        case O_TAX: EACH_LANE { uint32_t l = list[i]; b->x[l] = b->a[l]; st[l] = nz(st[l], b->x[l]); } break;
+        case O_TAY: EACH_LANE { uint32_t l = list[i]; b->y[l] = b->a[l]; st[l] = nz(st[l], b->y[l]); } break;
+        case O_TSX: EACH_LANE { uint32_t l = list[i]; b->x[l] = b->sp[l]; st[l] = nz(st[l], b->x[l]); } break;
+        case O_TXA: EACH_LANE { uint32_t l = list[i]; b->a[l] = b->x[l]; st[l] = nz(st[l], b->a[l]); } break;
+        case O_TYA: EACH_LANE { uint32_t l = list[i]; b->a[l] = b->y[l]; st[l] = nz(st[l], b->a[l]); } break;
+        case O_TXS: EACH_LANE { uint32_t l = list[i]; b->sp[l] = b->x[l]; } break;
+
+        /* arithmetic and logic */
+        case O_ADC: EACH_LANE { uint32_t l = list[i]; adc(b, l, OPERAND(l)); } break;
+        case O_SBC: EACH_LANE { uint32_t l = list[i]; adc(b, l, (uint8_t)~OPERAND(l)); } break;
+        case O_AND: EACH_LANE { uint32_t l = list[i]; b->a[l] &= OPERAND(l); st[l] = nz(st[l], b->a[l]); } break;
+        case O_ORA: EACH_LANE { uint32_t l = list[i]; b->a[l] |= OPERAND(l); st[l] = nz(st[l], b->a[l]); } break;
+        case O_EOR: EACH_LANE { uint32_t l = list[i]; b->a[l] ^= OPERAND(l); st[l] = nz(st[l], b->a[l]); } break;
+        case O_CMP: EACH_LANE { uint32_t l = list[i]; compare(b, l, b->a[l], OPERAND(l)); } break;
+        case O_CPX: EACH_LANE { uint32_t l = list[i]; compare(b, l, b->x[l], OPERAND(l)); } break;
+        case O_CPY: EACH_LANE { uint32_t l = list[i]; compare(b, l, b->y[l], OPERAND(l)); } break;
+        case O_BIT:
+            EACH_LANE {
+                uint32_t l = list[i];
+                uint8_t value = OPERAND(l);
+                uint8_t status = (st[l] & ~FLAG_ZERO) | ((b->a[l] & value) ? 0 : FLAG_ZERO);
+                st[l] = (uint8_t)((status & 0x3F) | (value & 0xC0));
+            }
+            break;
+
+        /* increments and shifts */
+        case O_INC: EACH_LANE { uint32_t l = list[i]; uint8_t v = (uint8_t)(OPERAND(l) + 1); st[l] = nz(st[l], v); STORE(l, v); } break;
+        case O_DEC: EACH_LANE { uint32_t l = list[i]; uint8_t v = (uint8_t)(OPERAND(l) - 1); st[l] = nz(st[l], v); STORE(l, v); } break;
+        case O_INX: EACH_LANE { uint32_t l = list[i]; b->x[l]++; st[l] = nz(st[l], b->x[l]); } break;
+        case O_INY: EACH_LANE { uint32_t l = list[i]; b->y[l]++; st[l] = nz(st[l], b->y[l]); } break;
+        case O_DEX: EACH_LANE { uint32_t l = list[i]; b->x[l]--; st[l] = nz(st[l], b->x[l]); } break;
+        case O_DEY: EACH_LANE { uint32_t l = list[i]; b->y[l]--; st[l] = nz(st[l], b->y[l]); } break;
+        case O_ASL: EACH_LANE { uint32_t l = list[i]; STORE(l, shift_left(b, l, OPERAND(l), 0)); } break;
+        case O_ROL: EACH_LANE { uint32_t l = list[i]; STORE(l, shift_left(b, l, OPERAND(l), st[l] & FLAG_CARRY)); } break;
+        case O_LSR: EACH_LANE { uint32_t l = list[i]; STORE(l, shift_right(b, l, OPERAND(l), 0)); } break;
+        case O_ROR: EACH_LANE { uint32_t l = list[i]; STORE(l, shift_right(b, l, OPERAND(l), st[l] & FLAG_CARRY)); } break;
+
+        /* flags */
+        case O_CLC: EACH_LANE { st[list[i]] &= ~FLAG_CARRY; } break;
+        case O_CLD: EACH_LANE { st[list[i]] &= ~FLAG_DECIMAL; } break;
+        case O_CLI: EACH_LANE { st[list[i]] &= ~FLAG_INTERRUPT; } break;
+        case O_CLV: EACH_LANE { st[list[i]] &= ~FLAG_OVERFLOW; } break;
+        case O_SEC: EACH_LANE { st[list[i]] |= FLAG_CARRY; } break;
+        case O_SED: EACH_LANE { st[list[i]] |= FLAG_DECIMAL; } break;
+        case O_SEI: EACH_LANE { st[list[i]] |= FLAG_INTERRUPT; } break;
+
+        /* branches and jumps */
+        case O_BPL: batch_branch(b, s, list, n, FLAG_SIGN, 0); break;
+        case O_BMI: batch_branch(b, s, list, n, FLAG_SIGN, FLAG_SIGN); break;
+        case O_BVC: batch_branch(b, s, list, n, FLAG_OVERFLOW, 0); break;
+        case O_BVS: batch_branch(b, s, list, n, FLAG_OVERFLOW, FLAG_OVERFLOW); break;
+        case O_BCC: batch_branch(b, s, list, n, FLAG_CARRY, 0); break;
+        case O_BCS: batch_branch(b, s, list, n, FLAG_CARRY, FLAG_CARRY); break;
+        case O_BNE: batch_branch(b, s, list, n, FLAG_ZERO, 0); break;
+        case O_BEQ: batch_branch(b, s, list, n, FLAG_ZERO, FLAG_ZERO); break;
+        case O_JMP: EACH_LANE { uint32_t l = list[i]; b->pc[l] = ea[l]; } break;
+        case O_JSR: EACH_LANE { uint32_t l = list[i]; push16(b, l, (uint16_t)(b->pc[l] - 1)); b->pc[l] = ea[l]; } break;
+        case O_RTS: EACH_LANE { uint32_t l = list[i]; b->pc[l] = (uint16_t)(pull16(b, l) + 1); } break;
+        case O_RTI: EACH_LANE { uint32_t l = list[i]; st[l] = pull8(b, l); b->pc[l] = pull16(b, l); } break;
+        case O_BRK:
+            EACH_LANE {
+                uint32_t l = list[i];
+                push16(b, l, (uint16_t)(b->pc[l] + 1));
+                push8(b, l, st[l] | FLAG_BREAK);
+                st[l] |= FLAG_INTERRUPT;
+                b->pc[l] = rd16(b, l, 0xFFFE);
+            }
+            break;
+
+        /* stack */
+        case O_PHA: EACH_LANE { uint32_t l = list[i]; push8(b, l, b->a[l]); } break;
+        case O_PHP: EACH_LANE { uint32_t l = list[i]; push8(b, l, st[l] | FLAG_BREAK); } break;
+        case O_PLA: EACH_LANE { uint32_t l = list[i]; b->a[l] = pull8(b, l); st[l] = nz(st[l], b->a[l]); } break;
+        case O_PLP: EACH_LANE { uint32_t l = list[i]; st[l] = pull8(b, l) | FLAG_CONSTANT; } break;
+
+        case O_NOP:
+            break;
+
+        /* undocumented: the memory operand is re-read after the write, as in the original */
+        case O_LAX:
+            EACH_LANE {
+                uint32_t l = list[i];
+                b->a[l] = OPERAND(l);
+                b->x[l] = OPERAND(l);
+                st[l] = nz(st[l], b->x[l]);
+            }
+            break;
+        case O_SAX:
+            EACH_LANE {
+                uint32_t l = list[i];
+                wr(b, l, ea[l], b->a[l]);
+                wr(b, l, ea[l], b->x[l]);
+                wr(b, l, ea[l], b->a[l] & b->x[l]);
+            }
+            break;
+        case O_DCP:
+            EACH_LANE {
+                uint32_t l = list[i];
+                uint8_t v = (uint8_t)(OPERAND(l) - 1);
+                st[l] = nz(st[l], v);
+                STORE(l, v);
+                compare(b, l, b->a[l], OPERAND(l));
+            }
+            break;
+        case O_ISB:
+            EACH_LANE {
+                uint32_t l = list[i];
+                uint8_t v = (uint8_t)(OPERAND(l) + 1);
+                st[l] = nz(st[l], v);
+                STORE(l, v);
+                adc(b, l, (uint8_t)~OPERAND(l));
+            }
+            break;
+        case O_SLO:
+            EACH_LANE {
+                uint32_t l = list[i];
+                STORE(l, shift_left(b, l, OPERAND(l), 0));
+                b->a[l] |= OPERAND(l);
+                st[l] = nz(st[l], b->a[l]);
+            }
+            break;
+        case O_RLA:
+            EACH_LANE {
+                uint32_t l = list[i];
+                STORE(l, shift_left(b, l, OPERAND(l), st[l] & FLAG_CARRY));
+                b->a[l] &= OPERAND(l);
+                st[l] = nz(st[l], b->a[l]);
+            }
+            break;
+        case O_SRE:
+            EACH_LANE {
+                uint32_t l = list[i];
+                STORE(l, shift_right(b, l, OPERAND(l), 0));
+                b->a[l] ^= OPERAND(l);
+                st[l] = nz(st[l], b->a[l]);
+            }
+            break;
+        case O_RRA:
+            EACH_LANE {
+                uint32_t l = list[i];
+                STORE(l, shift_right(b, l, OPERAND(l), st[l] & FLAG_CARRY));
+                adc(b, l, OPERAND(l));
+            }
+            break;
+    }
+
+#undef OPERAND
+#undef STORE
+#undef EACH_LANE
+}
+
+static void batch_execute(batch_t* b, batch_scratch_t* s, uint8_t opcode, const uint32_t* list, uint32_t n) {
+    const uint8_t mode = batch_modes[opcode];
+    const double ticks = batch_ticks[opcode];
+    uint32_t i;
+
+    batch_address(b, s, mode, list, n);
+    batch_operate(b, s, opcode, list, n);
+
+    if (batch_has_penalty(opcode) && (mode == M_ABSX || mode == M_ABSY || mode == M_INDY)) {
+        for (i = 0; i < n; i++) { uint32_t l = list[i]; b->cycles[l] += ticks + s->crossed[l]; }
+    } else {
+        for (i = 0; i < n; i++) { b->cycles[list[i]] += ticks; }
+    }
+}
+
+/* public interface */
+
+batch_scratch_t* batch_scratch_create(uint32_t lanes) {
+    batch_scratch_t* s = (batch_scratch_t*)calloc(1, sizeof(batch_scratch_t));
+    if (!s) {
+        return NULL;
+    }
+    s->lanes = lanes;
+    s->live = (uint32_t*)calloc(lanes ? lanes : 1, sizeof(uint32_t));
+    s->order = (uint32_t*)calloc(lanes ? lanes : 1, sizeof(uint32_t));
+    s->opcode = (uint8_t*)calloc(lanes ? lanes : 1, sizeof(uint8_t));
+    s->start_pc = (uint16_t*)calloc(lanes ? lanes : 1, sizeof(uint16_t));
+    s->ea = (uint16_t*)calloc(lanes ? lanes : 1, sizeof(uint16_t));
+    s->crossed = (uint8_t*)calloc(lanes ? lanes : 1, sizeof(uint8_t));
+    s->limit = (double*)calloc(lanes ? lanes : 1, sizeof(double));
+    if (!s->live || !s->order || !s->opcode || !s->start_pc || !s->ea || !s->crossed || !s->limit) {
+        batch_scratch_destroy(s);
+        return NULL;
+    }
+    return s;
+}
+
+void batch_scratch_destroy(batch_scratch_t* s) {
+    if (!s) {
+        return;
+    }
+    free(s->live);
+    free(s->order);
+    free(s->opcode);
+    free(s->start_pc);
+    free(s->ea);
+    free(s->crossed);
+    free(s->limit);
+    free(s);
+}
+
+uint32_t batch_run(batch_t* b, batch_scratch_t* s, double max_cycles) {
+    uint32_t live = 0;
+    uint32_t running = 0;
+    uint32_t lane, i;
+
+    for (lane = 0; lane < b->lanes && lane < s->lanes; lane++) {
+        if (b->lane_status[lane] == BATCH_LANE_RUNNING) {
+            s->limit[lane] = b->cycles[lane] + max_cycles;
+            s->live[live++] = lane;
+        }
+    }
+
+    while (live > 0) {
+        uint32_t kept = 0;
+        uint32_t distinct = 0;
+        uint32_t offset = 0;
+
+        // Fetch: halt lanes at the stop address, count the rest by opcode
+        for (i = 0; i < live; i++) {
+            uint32_t l = s->live[i];
+            uint8_t opcode;
+            if (b->stop_address >= 0 && b->pc[l] == (uint16_t)b->stop_address) {
+                b->lane_status[l] = BATCH_LANE_STOPPED;
+                continue;
+            }
+            opcode = rd(b, l, b->pc[l]);
+            s->opcode[l] = opcode;
+            s->start_pc[l] = b->pc[l]++;
+            b->status[l] |= FLAG_CONSTANT;
+            if (s->count[opcode]++ == 0) {
+                s->used[distinct++] = opcode;
+            }
+            s->live[kept++] = l;
+        }
+        live = kept;
+
+        // Group the lanes by opcode, keeping lane order within each group
+        for (i = 0; i < distinct; i++) {
+            s->offset[s->used[i]] = offset;
+            offset += s->count[s->used[i]];
+        }
+        for (i = 0; i < live; i++) {
+            uint32_t l = s->live[i];
+            s->order[s->offset[s->opcode[l]]++] = l;
+        }
+
+        offset = 0;
+        for (i = 0; i < distinct; i++) {
+            uint8_t opcode = s->used[i];
+            uint32_t n = s->count[opcode];
+            batch_execute(b, s, opcode, s->order + offset, n);
+            offset += n;
+            s->count[opcode] = 0;
+        }
+
+        // Retire lanes that spin in place or have used their budget
+        kept = 0;
+        for (i = 0; i < live; i++) {
+            uint32_t l = s->live[i];
+            if (b->pc[l] == s->start_pc[l]) {
+                b->lane_status[l] = BATCH_LANE_SPIN;
+                continue;
+            }
+            if (b->cycles[l] < s->limit[l]) {
+                s->live[kept++] = l;
+            }
+        }
+        live = kept;
+    }
+
+    for (lane = 0; lane < b->lanes; lane++) {
+        if (b->lane_status[lane] == BATCH_LANE_RUNNING) {
+            running++;
+        }
+    }
+    return running;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,70 @@
+/*
+ * fake6502 batch engine
+ * Runs many independent 6502 instances in lockstep. Registers are kept in
+ * structure-of-arrays form (one array per register, indexed by lane) and
+ * every lane has its own flat 64K memory image. The engine has no global
+ * state, so any number of batches may run on any thread.
+ */
+
+#ifndef FAKE6502_BATCH_H
+#define FAKE6502_BATCH_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Lane status
+#define BATCH_LANE_RUNNING 0  // Still executing (or out of cycle budget)
+#define BATCH_LANE_STOPPED 1  // Reached the stop address
+#define BATCH_LANE_SPIN    2  // Executed an instruction that jumps to itself
+
+#define BATCH_MEMORY_SIZE 65536
+
+typedef struct {
+    uint32_t lanes;
+
+    // Registers, one entry per lane
+    uint16_t* pc;
+    uint8_t* a;
+    uint8_t* x;
+    uint8_t* y;
+    uint8_t* sp;
+    uint8_t* status;
+    double* cycles;           // Total cycles executed
+    uint8_t* lane_status;     // BATCH_LANE_*
+
+    // lanes * BATCH_MEMORY_SIZE bytes; lane n starts at n << 16
+    uint8_t* memory;
+
+    // 256 entries shared by all lanes; writes to pages with 0 are ignored (ROM)
+    const uint8_t* writable;
+
+    int32_t stop_address;     // Lanes halt when PC reaches it; -1 for none
+
+    // Writes to output_address are appended to the lane's output buffer
+    // (output + lane * output_capacity) instead of reaching memory
+    int32_t output_address;   // -1 for none
+    uint8_t* output;
+    uint32_t* output_length;
+    uint32_t output_capacity;
+} batch_t;
+
+// Per-lane scratch for batch_run; opaque to callers
+typedef struct batch_scratch batch_scratch_t;
+
+// Scratch buffers sized for the given lane count; NULL when out of memory
+batch_scratch_t* batch_scratch_create(uint32_t lanes);
+void batch_scratch_destroy(batch_scratch_t* scratch);
+
+// Run every running lane for up to max_cycles more cycles.
+// Returns the number of lanes still running afterwards.
+uint32_t batch_run(batch_t* batch, batch_scratch_t* scratch, double max_cycles);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FAKE6502_BATCH_H
@@ -0,0 +1,69 @@
+/*
+ * fake6502 batch engine opcode tables
+ * GENERATED by scripts/generate-batch-tables.js from addrtable, optable and
+ * ticktable in fake6502_improved.h; do not edit by hand.
+ *
+ * Included by fake6502_batch.c after its M_* and O_* enums.
+ */
+
+#ifndef FAKE6502_BATCH_TABLES_H
+#define FAKE6502_BATCH_TABLES_H
+
+static const uint8_t batch_modes[256] = {
+/* 0 */  M_IMP, M_INDX,  M_IMP, M_INDX,   M_ZP,   M_ZP,   M_ZP,   M_ZP,  M_IMP,  M_IMM,  M_ACC,  M_IMM, M_ABSO, M_ABSO, M_ABSO, M_ABSO,
+/* 1 */  M_REL, M_INDY,  M_IMP, M_INDY,  M_ZPX,  M_ZPX,  M_ZPX,  M_ZPX,  M_IMP, M_ABSY,  M_IMP, M_ABSY, M_ABSX, M_ABSX, M_ABSX, M_ABSX,
+/* 2 */ M_ABSO, M_INDX,  M_IMP, M_INDX,   M_ZP,   M_ZP,   M_ZP,   M_ZP,  M_IMP,  M_IMM,  M_ACC,  M_IMM, M_ABSO, M_ABSO, M_ABSO, M_ABSO,
+/* 3 */  M_REL, M_INDY,  M_IMP, M_INDY,  M_ZPX,  M_ZPX,  M_ZPX,  M_ZPX,  M_IMP, M_ABSY,  M_IMP, M_ABSY, M_ABSX, M_ABSX, M_ABSX, M_ABSX,
+/* 4 */  M_IMP, M_INDX,  M_IMP, M_INDX,   M_ZP,   M_ZP,   M_ZP,   M_ZP,  M_IMP,  M_IMM,  M_ACC,  M_IMM, M_ABSO, M_ABSO, M_ABSO, M_ABSO,
+/* 5 */  M_REL, M_INDY,  M_IMP, M_INDY,  M_ZPX,  M_ZPX,  M_ZPX,  M_ZPX,  M_IMP, M_ABSY,  M_IMP, M_ABSY, M_ABSX, M_ABSX, M_ABSX, M_ABSX,
+/* 6 */  M_IMP, M_INDX,  M_IMP, M_INDX,   M_ZP,   M_ZP,   M_ZP,   M_ZP,  M_IMP,  M_IMM,  M_ACC,  M_IMM,  M_IND, M_ABSO, M_ABSO, M_ABSO,
+/* 7 */  M_REL, M_INDY,  M_IMP, M_INDY,  M_ZPX,  M_ZPX,  M_ZPX,  M_ZPX,  M_IMP, M_ABSY,  M_IMP, M_ABSY, M_ABSX, M_ABSX, M_ABSX, M_ABSX,
+/* 8 */  M_IMM, M_INDX,  M_IMM, M_INDX,   M_ZP,   M_ZP,   M_ZP,   M_ZP,  M_IMP,  M_IMM,  M_IMP,  M_IMM, M_ABSO, M_ABSO, M_ABSO, M_ABSO,
+/* 9 */  M_REL, M_INDY,  M_IMP, M_INDY,  M_ZPX,  M_ZPX,  M_ZPY,  M_ZPY,  M_IMP, M_ABSY,  M_IMP, M_ABSY, M_ABSX, M_ABSX, M_ABSY, M_ABSY,
+/* A */  M_IMM, M_INDX,  M_IMM, M_INDX,   M_ZP,   M_ZP,   M_ZP,   M_ZP,  M_IMP,  M_IMM,  M_IMP,  M_IMM, M_ABSO, M_ABSO, M_ABSO, M_ABSO,
+/* B */  M_REL, M_INDY,  M_IMP, M_INDY,  M_ZPX,  M_ZPX,  M_ZPY,  M_ZPY,  M_IMP, M_ABSY,  M_IMP, M_ABSY, M_ABSX, M_ABSX, M_ABSY, M_ABSY,
+/* C */  M_IMM, M_INDX,  M_IMM, M_INDX,   M_ZP,   M_ZP,   M_ZP,   M_ZP,  M_IMP,  M_IMM,  M_IMP,  M_IMM, M_ABSO, M_ABSO, M_ABSO, M_ABSO,
+/* D */  M_REL, M_INDY,  M_IMP, M_INDY,  M_ZPX,  M_ZPX,  M_ZPX,  M_ZPX,  M_IMP, M_ABSY,  M_IMP, M_ABSY, M_ABSX, M_ABSX, M_ABSX, M_ABSX,
+/* E */  M_IMM, M_INDX,  M_IMM, M_INDX,   M_ZP,   M_ZP,   M_ZP,   M_ZP,  M_IMP,  M_IMM,  M_IMP,  M_IMM, M_ABSO, M_ABSO, M_ABSO, M_ABSO,
+/* F */  M_REL, M_INDY,  M_IMP, M_INDY,  M_ZPX,  M_ZPX,  M_ZPX,  M_ZPX,  M_IMP, M_ABSY,  M_IMP, M_ABSY, M_ABSX, M_ABSX, M_ABSX, M_ABSX
+};
+
+static const uint8_t batch_ops[256] = {
+/* 0 */ O_BRK, O_ORA, O_NOP, O_SLO, O_NOP, O_ORA, O_ASL, O_SLO, O_PHP, O_ORA, O_ASL, O_NOP, O_NOP, O_ORA, O_ASL, O_SLO,
+/* 1 */ O_BPL, O_ORA, O_NOP, O_SLO, O_NOP, O_ORA, O_ASL, O_SLO, O_CLC, O_ORA, O_NOP, O_SLO, O_NOP, O_ORA, O_ASL, O_SLO,
+/* 2 */ O_JSR, O_AND, O_NOP, O_RLA, O_BIT, O_AND, O_ROL, O_RLA, O_PLP, O_AND, O_ROL, O_NOP, O_BIT, O_AND, O_ROL, O_RLA,
+/* 3 */ O_BMI, O_AND, O_NOP, O_RLA, O_NOP, O_AND, O_ROL, O_RLA, O_SEC, O_AND, O_NOP, O_RLA, O_NOP, O_AND, O_ROL, O_RLA,
+/* 4 */ O_RTI, O_EOR, O_NOP, O_SRE, O_NOP, O_EOR, O_LSR, O_SRE, O_PHA, O_EOR, O_LSR, O_NOP, O_JMP, O_EOR, O_LSR, O_SRE,
+/* 5 */ O_BVC, O_EOR, O_NOP, O_SRE, O_NOP, O_EOR, O_LSR, O_SRE, O_CLI, O_EOR, O_NOP, O_SRE, O_NOP, O_EOR, O_LSR, O_SRE,
+/* 6 */ O_RTS, O_ADC, O_NOP, O_RRA, O_NOP, O_ADC, O_ROR, O_RRA, O_PLA, O_ADC, O_ROR, O_NOP, O_JMP, O_ADC, O_ROR, O_RRA,
+/* 7 */ O_BVS, O_ADC, O_NOP, O_RRA, O_NOP, O_ADC, O_ROR, O_RRA, O_SEI, O_ADC, O_NOP, O_RRA, O_NOP, O_ADC, O_ROR, O_RRA,
+/* 8 */ O_NOP, O_STA, O_NOP, O_SAX, O_STY, O_STA, O_STX, O_SAX, O_DEY, O_NOP, O_TXA, O_NOP, O_STY, O_STA, O_STX, O_SAX,
+/* 9 */ O_BCC, O_STA, O_NOP, O_NOP, O_STY, O_STA, O_STX, O_SAX, O_TYA, O_STA, O_TXS, O_NOP, O_NOP, O_STA, O_NOP, O_NOP,
+/* A */ O_LDY, O_LDA, O_LDX, O_LAX, O_LDY, O_LDA, O_LDX, O_LAX, O_TAY, O_LDA, O_TAX, O_NOP, O_LDY, O_LDA, O_LDX, O_LAX,
+/* B */ O_BCS, O_LDA, O_NOP, O_LAX, O_LDY, O_LDA, O_LDX, O_LAX, O_CLV, O_LDA, O_TSX, O_LAX, O_LDY, O_LDA, O_LDX, O_LAX,
+/* C */ O_CPY, O_CMP, O_NOP, O_DCP, O_CPY, O_CMP, O_DEC, O_DCP, O_INY, O_CMP, O_DEX, O_NOP, O_CPY, O_CMP, O_DEC, O_DCP,
+/* D */ O_BNE, O_CMP, O_NOP, O_DCP, O_NOP, O_CMP, O_DEC, O_DCP, O_CLD, O_CMP, O_NOP, O_DCP, O_NOP, O_CMP, O_DEC, O_DCP,
+/* E */ O_CPX, O_SBC, O_NOP, O_ISB, O_CPX, O_SBC, O_INC, O_ISB, O_INX, O_SBC, O_NOP, O_SBC, O_CPX, O_SBC, O_INC, O_ISB,
+/* F */ O_BEQ, O_SBC, O_NOP, O_ISB, O_NOP, O_SBC, O_INC, O_ISB, O_SED, O_SBC, O_NOP, O_ISB, O_NOP, O_SBC, O_INC, O_ISB
+};
+
+static const uint8_t batch_ticks[256] = {
+/* 0 */ 7, 6, 2, 8, 3, 3, 5, 5, 3, 2, 2, 2, 4, 4, 6, 6,
+/* 1 */ 2, 5, 2, 8, 4, 4, 6, 6, 2, 4, 2, 7, 4, 4, 7, 7,
+/* 2 */ 6, 6, 2, 8, 3, 3, 5, 5, 4, 2, 2, 2, 4, 4, 6, 6,
+/* 3 */ 2, 5, 2, 8, 4, 4, 6, 6, 2, 4, 2, 7, 4, 4, 7, 7,
+/* 4 */ 6, 6, 2, 8, 3, 3, 5, 5, 3, 2, 2, 2, 3, 4, 6, 6,
+/* 5 */ 2, 5, 2, 8, 4, 4, 6, 6, 2, 4, 2, 7, 4, 4, 7, 7,
+/* 6 */ 6, 6, 2, 8, 3, 3, 5, 5, 4, 2, 2, 2, 5, 4, 6, 6,
+/* 7 */ 2, 5, 2, 8, 4, 4, 6, 6, 2, 4, 2, 7, 4, 4, 7, 7,
+/* 8 */ 2, 6, 2, 6, 3, 3, 3, 3, 2, 2, 2, 2, 4, 4, 4, 4,
+/* 9 */ 2, 6, 2, 6, 4, 4, 4, 4, 2, 5, 2, 5, 5, 5, 5, 5,
+/* A */ 2, 6, 2, 6, 3, 3, 3, 3, 2, 2, 2, 2, 4, 4, 4, 4,
+/* B */ 2, 5, 2, 5, 4, 4, 4, 4, 2, 4, 2, 4, 4, 4, 4, 4,
+/* C */ 2, 6, 2, 8, 3, 3, 5, 5, 2, 2, 2, 2, 4, 4, 6, 6,
+/* D */ 2, 5, 2, 8, 4, 4, 6, 6, 2, 4, 2, 7, 4, 4, 7, 7,
+/* E */ 2, 6, 2, 8, 3, 3, 5, 5, 2, 2, 2, 2, 4, 4, 6, 6,
+/* F */ 2, 5, 2, 8, 4, 4, 6, 6, 2, 4, 2, 7, 4, 4, 7, 7
+};
+
+#endif // FAKE6502_BATCH_TABLES_H
@@ -0,0 +1,863 @@
+/*
+ * fake6502_bench - interpreter microbenchmarks without Node
+ * Runs fixed 6502 workloads on each native engine and reports instructions
+ * per second, emulated cycles per second and nanoseconds per instruction,
+ * the median of repeated runs after warm-up. Workloads check their results
+ * so a fast but broken engine does not go unnoticed.
+ *
+ * Engines:
+ *   core       fake6502 core with every page mapped directly
+ *   callbacks  fake6502 core with every access through the bus callbacks,
+ *              the path the addon takes when memory lives in JavaScript
+ *   batch      batch engine, many lanes of the same workload in lockstep
+ *
+ * With --perf, hardware counters (perf_event_open, Linux only) are read
+ * around each run and reported per emulated instruction.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sched.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "fake6502.h"
+#include "fake6502_batch.h"
+
+extern "C" uint16_t get_pc_6502(void);
+
+static const char* USAGE =
+    "Usage: fake6502_bench [options]\n"
+    "  --engine <name>             core, callbacks or batch (repeatable; default all)\n"
+    "  --workload <name>           sieve, crc32, memcpy, bcd or functional (repeatable;\n"
+    "                              default all available)\n"
+    "  --runs <count>              Timed runs per benchmark (default 5)\n"
+    "  --warmup <count>            Untimed runs first (default 1)\n"
+    "  --lanes <count>             Batch engine lanes (default 8)\n"
+    "  --functional-test <file>    Klaus Dormann's 6502_functional_test.bin, loaded at\n"
+    "                              $0000 and started at $0400\n"
+    "  --functional-success <hex>  Address the test loops at on success (default 3469)\n"
+    "  --cpu <index>               Pin to a CPU for steadier numbers (Linux)\n"
+    "  --perf                      Read hardware counters (Linux)\n"
+    "  --json                      Print results as JSON\n";
+
+/* 6502 assembly
+ * Enough of an assembler to write the workloads legibly: named opcodes,
+ * labels and fixups for branches and absolute jumps.
+ */
+
+enum Opcode : uint8_t {
+    ADC_IMM = 0x69, ADC_ZP = 0x65, BCC = 0x90, BCS = 0xB0, BNE = 0xD0,
+    CLC = 0x18, CLD = 0xD8, CMP_IMM = 0xC9, CPX_IMM = 0xE0, DEC_ZP = 0xC6,
+    DEX = 0xCA, DEY = 0x88, EOR_IMM = 0x49, EOR_ZP = 0x45, INC_ZP = 0xE6,
+    INY = 0xC8, JMP_ABS = 0x4C, LDA_IMM = 0xA9, LDA_IZY = 0xB1, LDA_ZP = 0xA5,
+    LDX_IMM = 0xA2, LDX_ZP = 0xA6, LDY_IMM = 0xA0, LSR_ZP = 0x46, ROR_ZP = 0x66,
+    SBC_IMM = 0xE9, SEC = 0x38, SED = 0xF8, STA_IZY = 0x91, STA_ZP = 0x85
+};
+
+class Assembler {
+public:
+    explicit Assembler(uint16_t origin) : origin_(origin) {}
+
+    Assembler& op(uint8_t opcode) {
+        code_.push_back(opcode);
+        return *this;
+    }
+
+    Assembler& op(uint8_t opcode, uint8_t operand) {
+        code_.push_back(opcode);
+        code_.push_back(operand);
+        return *this;
+    }
+
+    Assembler& label(const std::string& name) {
+        labels_[name] = pc();
+        return *this;
+    }
+
+    Assembler& branch(uint8_t opcode, const std::string& target) {
+        code_.push_back(opcode);
+        fixups_.push_back({ code_.size(), target, true });
+        code_.push_back(0);
+        return *this;
+    }
+
+    Assembler& jump(uint8_t opcode, const std::string& target) {
+        code_.push_back(opcode);
+        fixups_.push_back({ code_.size(), target, false });
+        code_.push_back(0);
+        code_.push_back(0);
+        return *this;
+    }
+
+    // Resolve labels; exits on unknown labels and branches out of range,
+    // which are mistakes in the workloads themselves
+    std::vector<uint8_t> finish() {
+        for (const Fixup& fixup : fixups_) {
+            auto label = labels_.find(fixup.target);
+            if (label == labels_.end()) {
+                fprintf(stderr, "Unknown label %s\n", fixup.target.c_str());
+                exit(1);
+            }
+            if (fixup.relative) {
+                int offset = label->second - (origin_ + (int)fixup.at + 1);
+                if (offset < -128 || offset > 127) {
+                    fprintf(stderr, "Branch to %s out of range\n", fixup.target.c_str());
+                    exit(1);
+                }
+                code_[fixup.at] = (uint8_t)offset;
+            } else {
+                code_[fixup.at] = (uint8_t)label->second;
+                code_[fixup.at + 1] = (uint8_t)(label->second >> 8);
+            }
+        }
+        return code_;
+    }
+
+    uint16_t pc() const { return (uint16_t)(origin_ + code_.size()); }
+
+private:
+    struct Fixup {
+        size_t at;
+        std::string target;
+        bool relative;
+    };
+
+    uint16_t origin_;
+    std::vector<uint8_t> code_;
+    std::map<std::string, uint16_t> labels_;
+    std::vector<Fixup> fixups_;
+};
+
+/* Workloads
+ * Each is a 64K memory image started at a fixed address that finishes by
+ * jumping to itself. Outer pass counts size them at several million
+ * instructions.
+ */
+
+struct Workload {
+    std::string name;
+    std::vector<uint8_t> memory;
+    uint16_t start;
+    std::function<bool(const uint8_t* memory, uint16_t pc)> verify;
+    std::string note;   // Printed with the result, if any
+};
+
+static const uint16_t ORIGIN = 0x0200;
+
+// Zero page
+static const uint8_t PTR = 0x00;      // Pointer, two bytes
+static const uint8_t PTR2 = 0x02;     // Second pointer, two bytes
+static const uint8_t INDEX = 0x04;    // Two bytes
+static const uint8_t PASSES = 0x06;
+static const uint8_t RESULT = 0x10;   // Up to four bytes
+
+static Workload make_workload(const std::string& name, Assembler& assembler) {
+    Workload workload;
+    workload.name = name;
+    workload.memory.assign(BATCH_MEMORY_SIZE, 0);
+    workload.start = ORIGIN;
+    std::vector<uint8_t> code = assembler.finish();
+    memcpy(&workload.memory[ORIGIN], code.data(), code.size());
+    workload.memory[0xFFFC] = (uint8_t)ORIGIN;
+    workload.memory[0xFFFD] = (uint8_t)(ORIGIN >> 8);
+    return workload;
+}
+
+// Sieve of Eratosthenes over 8192 flags at $2000, counting the primes
+static Workload sieve_workload() {
+    const int passes = 48;
+    Assembler s(ORIGIN);
+    s.op(LDA_IMM, passes).op(STA_ZP, PASSES);
+    s.label("pass");
+    // Clear the flags
+    s.op(LDA_IMM, 0x00).op(STA_ZP, PTR).op(LDA_IMM, 0x20).op(STA_ZP, PTR + 1);
+    s.op(LDA_IMM, 0).op(LDY_IMM, 0);
+    s.label("clear").op(STA_IZY, PTR).op(INY).branch(BNE, "clear");
+    s.op(INC_ZP, PTR + 1).op(LDX_ZP, PTR + 1).op(CPX_IMM, 0x40).branch(BNE, "clear");
+    s.op(STA_ZP, RESULT).op(STA_ZP, RESULT + 1);
+    s.op(LDA_IMM, 2).op(STA_ZP, INDEX).op(LDA_IMM, 0).op(STA_ZP, INDEX + 1);
+    // PTR = flags + index; skip composites
+    s.label("candidate");
+    s.op(LDA_ZP, INDEX).op(STA_ZP, PTR).op(LDA_ZP, INDEX + 1).op(CLC).op(ADC_IMM, 0x20).op(STA_ZP, PTR + 1);
+    s.op(LDY_IMM, 0).op(LDA_IZY, PTR).branch(BNE, "next");
+    s.op(INC_ZP, RESULT).branch(BNE, "mark").op(INC_ZP, RESULT + 1);
+    // Mark the multiples
+    s.label("mark");
+    s.op(LDA_ZP, PTR).op(CLC).op(ADC_ZP, INDEX).op(STA_ZP, PTR);
+    s.op(LDA_ZP, PTR + 1).op(ADC_ZP, INDEX + 1).op(STA_ZP, PTR + 1);
+    s.op(CMP_IMM, 0x40).branch(BCS, "next");
+    s.op(LDA_IMM, 1).op(STA_IZY, PTR).jump(JMP_ABS, "mark");
+    s.label("next");
+    s.op(INC_ZP, INDEX).branch(BNE, "check").op(INC_ZP, INDEX + 1);
+    s.label("check").op(LDA_ZP, INDEX + 1).op(CMP_IMM, 0x20).branch(BNE, "candidate");
+    s.op(DEC_ZP, PASSES).branch(BNE, "again");
+    s.label("done").jump(JMP_ABS, "done");
+    s.label("again").jump(JMP_ABS, "pass");
+
+    Workload workload = make_workload("sieve", s);
+    workload.verify = [](const uint8_t* memory, uint16_t) {
+        return (memory[RESULT] | (memory[RESULT + 1] << 8)) == 1028;  // Primes below 8192
+    };
+    return workload;
+}
+
+static uint32_t crc32(const uint8_t* data, size_t length) {
+    uint32_t crc = 0xFFFFFFFF;
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc >> 1) ^ (crc & 1 ? 0xEDB88320 : 0);
+        }
+    }
+    return ~crc;
+}
+
+// Bitwise CRC-32 (zlib's polynomial) of 1K at $4000
+static Workload crc32_workload() {
+    const int passes = 96;
+    Assembler s(ORIGIN);
+    s.op(LDA_IMM, passes).op(STA_ZP, PASSES);
+    s.label("pass");
+    s.op(LDA_IMM, 0xFF);
+    for (int i = 0; i < 4; i++) {
+        s.op(STA_ZP, RESULT + i);
+    }
+    s.op(LDA_IMM, 0x00).op(STA_ZP, PTR).op(LDA_IMM, 0x40).op(STA_ZP, PTR + 1).op(LDY_IMM, 0);
+    s.label("byte");
+    s.op(LDA_IZY, PTR).op(EOR_ZP, RESULT).op(STA_ZP, RESULT).op(LDX_IMM, 8);
+    s.label("bit");
+    s.op(LSR_ZP, RESULT + 3).op(ROR_ZP, RESULT + 2).op(ROR_ZP, RESULT + 1).op(ROR_ZP, RESULT);
+    s.branch(BCC, "shifted");
+    static const uint8_t POLYNOMIAL[4] = { 0x20, 0x83, 0xB8, 0xED };
+    for (int i = 0; i < 4; i++) {
+        s.op(LDA_ZP, RESULT + i).op(EOR_IMM, POLYNOMIAL[i]).op(STA_ZP, RESULT + i);
+    }
+    s.label("shifted").op(DEX).branch(BNE, "bit");
+    s.op(INY).branch(BNE, "byte");
+    s.op(INC_ZP, PTR + 1).op(LDA_ZP, PTR + 1).op(CMP_IMM, 0x44).branch(BNE, "byte");
+    for (int i = 0; i < 4; i++) {
+        s.op(LDA_ZP, RESULT + i).op(EOR_IMM, 0xFF).op(STA_ZP, RESULT + i);
+    }
+    s.op(DEC_ZP, PASSES).branch(BNE, "again");
+    s.label("done").jump(JMP_ABS, "done");
+    s.label("again").jump(JMP_ABS, "pass");
+
+    Workload workload = make_workload("crc32", s);
+    for (int i = 0; i < 0x400; i++) {
+        workload.memory[0x4000 + i] = (uint8_t)(i * 7 + (i >> 8) * 13);
+    }
+    uint32_t expected = crc32(&workload.memory[0x4000], 0x400);
+    workload.verify = [expected](const uint8_t* memory, uint16_t) {
+        uint32_t crc = memory[RESULT] | (memory[RESULT + 1] << 8) | (memory[RESULT + 2] << 16) |
+            ((uint32_t)memory[RESULT + 3] << 24);
+        return crc == expected;
+    };
+    return workload;
+}
+
+// Copy 8K from $4000 to $6000 through two indirect pointers
+static Workload memcpy_workload() {
+    const int passes = 255;
+    Assembler s(ORIGIN);
+    s.op(LDA_IMM, passes).op(STA_ZP, PASSES);
+    s.label("pass");
+    s.op(LDA_IMM, 0x00).op(STA_ZP, PTR).op(STA_ZP, PTR2);
+    s.op(LDA_IMM, 0x40).op(STA_ZP, PTR + 1).op(LDA_IMM, 0x60).op(STA_ZP, PTR2 + 1);
+    s.op(LDX_IMM, 0x20).op(LDY_IMM, 0);
+    s.label("copy").op(LDA_IZY, PTR).op(STA_IZY, PTR2).op(INY).branch(BNE, "copy");
+    s.op(INC_ZP, PTR + 1).op(INC_ZP, PTR2 + 1).op(DEX).branch(BNE, "copy");
+    s.op(DEC_ZP, PASSES).branch(BNE, "pass");
+    s.label("done").jump(JMP_ABS, "done");
+
+    Workload workload = make_workload("memcpy", s);
+    for (int i = 0; i < 0x2000; i++) {
+        workload.memory[0x4000 + i] = (uint8_t)(i ^ (i >> 8) ^ 0x5A);
+    }
+    workload.verify = [](const uint8_t* memory, uint16_t) {
+        return memcmp(&memory[0x4000], &memory[0x6000], 0x2000) == 0;
+    };
+    return workload;
+}
+
+// Decimal-mode arithmetic: a six-digit BCD sum and a two-digit BCD
+// difference, 65536 iterations per pass
+static Workload bcd_workload() {
+    const int passes = 16;
+    Assembler s(ORIGIN);
+    s.op(LDA_IMM, passes).op(STA_ZP, PASSES).op(SED);
+    s.op(LDA_IMM, 0);
+    for (int i = 0; i < 4; i++) {
+        s.op(STA_ZP, RESULT + i);
+    }
+    s.label("pass").op(LDY_IMM, 0);
+    s.label("outer").op(LDX_IMM, 0);
+    s.label("inner").op(CLC);
+    s.op(LDA_ZP, RESULT).op(ADC_IMM, 0x37).op(STA_ZP, RESULT);
+    s.op(LDA_ZP, RESULT + 1).op(ADC_IMM, 0).op(STA_ZP, RESULT + 1);
+    s.op(LDA_ZP, RESULT + 2).op(ADC_IMM, 0).op(STA_ZP, RESULT + 2);
+    s.op(SEC).op(LDA_ZP, RESULT + 3).op(SBC_IMM, 0x19).op(STA_ZP, RESULT + 3);
+    s.op(DEX).branch(BNE, "inner");
+    s.op(DEY).branch(BNE, "outer");
+    s.op(DEC_ZP, PASSES).branch(BNE, "pass");
+    s.op(CLD);
+    s.label("done").jump(JMP_ABS, "done");
+
+    Workload workload = make_workload("bcd", s);
+
+    // The core is built for the NES (no decimal mode), so accept binary
+    // results too and say which arithmetic ran
+    const uint64_t count = 65536ull * passes;
+    auto bcd = [](uint64_t value) {
+        uint32_t packed = 0;
+        for (int digit = 0; digit < 6; digit++, value /= 10) {
+            packed |= (uint32_t)(value % 10) << (digit * 4);
+        }
+        return packed;
+    };
+    uint32_t decimal = bcd(37 * count % 1000000) | (bcd((100 - 19 * count % 100) % 100) << 24);
+    uint32_t binary = (uint32_t)(0x37 * count & 0xFFFFFF) | (uint32_t)((0x100 - 0x19 * count % 0x100) & 0xFF) << 24;
+    workload.verify = [decimal, binary](const uint8_t* memory, uint16_t) {
+        uint32_t result = memory[RESULT] | (memory[RESULT + 1] << 8) | (memory[RESULT + 2] << 16) |
+            ((uint32_t)memory[RESULT + 3] << 24);
+        return result == decimal || result == binary;
+    };
+    workload.note = "decimal";
+    return workload;
+}
+
+static bool bcd_ran_decimal(const uint8_t* memory) {
+    // The sum's low byte is $37 * count mod 256 in binary: $00
+    return memory[RESULT] != 0x00;
+}
+
+// Klaus Dormann's functional test; it loops at the success address when
+// every test passes and at the failing test otherwise
+static bool functional_workload(const std::string& file, uint16_t success, Workload* workload) {
+    std::ifstream input(file, std::ios::binary);
+    if (!input) {
+        fprintf(stderr, "Cannot read functional test: %s\n", file.c_str());
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(input)), std::istreambuf_iterator<char>());
+    if (data.empty() || data.size() > BATCH_MEMORY_SIZE) {
+        fprintf(stderr, "Functional test image must be 1 to 65536 bytes: %s\n", file.c_str());
+        return false;
+    }
+    workload->name = "functional";
+    workload->memory.assign(BATCH_MEMORY_SIZE, 0);
+    memcpy(workload->memory.data(), data.data(), data.size());
+    workload->start = 0x0400;
+    workload->verify = [success](const uint8_t*, uint16_t pc) { return pc == success; };
+    return true;
+}
+
+/* Hardware counters */
+
+struct PerfCounts {
+    bool valid = false;
+    double cycles = 0;
+    double instructions = 0;
+    double branch_misses = 0;
+    double cache_misses = 0;
+};
+
+class PerfCounters {
+public:
+    bool open() {
+#ifdef __linux__
+        static const uint64_t EVENTS[COUNTERS] = {
+            PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+            PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES
+        };
+        for (int i = 0; i < COUNTERS; i++) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = EVENTS[i];
+            attr.disabled = i == 0;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_GROUP;
+            fds_[i] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, i == 0 ? -1 : fds_[0], 0);
+            if (fds_[i] < 0) {
+                close();
+                return false;
+            }
+        }
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void close() {
+#ifdef __linux__
+        for (int i = 0; i < COUNTERS; i++) {
+            if (fds_[i] >= 0) {
+                ::close(fds_[i]);
+                fds_[i] = -1;
+            }
+        }
+#endif
+    }
+
+    void start() {
+#ifdef __linux__
+        if (fds_[0] >= 0) {
+            ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+            ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+        }
+#endif
+    }
+
+    PerfCounts stop() {
+        PerfCounts counts;
+#ifdef __linux__
+        if (fds_[0] >= 0) {
+            ioctl(fds_[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+            uint64_t values[1 + COUNTERS];
+            if (::read(fds_[0], values, sizeof(values)) == (ssize_t)sizeof(values) && values[0] == COUNTERS) {
+                counts.valid = true;
+                counts.cycles = (double)values[1];
+                counts.instructions = (double)values[2];
+                counts.branch_misses = (double)values[3];
+                counts.cache_misses = (double)values[4];
+            }
+        }
+#endif
+        return counts;
+    }
+
+    ~PerfCounters() { close(); }
+
+private:
+    static const int COUNTERS = 4;
+    int fds_[COUNTERS] = { -1, -1, -1, -1 };
+};
+
+/* Engines
+ * An engine runs a workload from a fresh copy of its image to the end and
+ * leaves the final memory of (the first lane of) the run in `memory`.
+ */
+
+struct RunResult {
+    double seconds;
+    uint64_t instructions;   // Emulated, all lanes
+    uint64_t cycles;
+    uint16_t pc;
+    bool finished;
+    PerfCounts perf;
+};
+
+static const uint64_t MAX_INSTRUCTIONS = 2000000000ull;   // Per lane
+
+namespace {
+uint8_t* g_memory = nullptr;   // Flat memory for the callback engine
+}
+
+static uint8_t callback_read(uint16_t address) {
+    return g_memory[address];
+}
+
+static void callback_write(uint16_t address, uint8_t value) {
+    g_memory[address] = value;
+}
+
+static RunResult run_core(const Workload& workload, bool direct, std::vector<uint8_t>& memory, PerfCounters& perf) {
+    memory = workload.memory;
+    g_memory = memory.data();
+    cpu_set_memory_callbacks(callback_read, callback_write);
+    cpu_clear_page_map();
+    if (direct) {
+        for (int page = 0; page < 256; page++) {
+            cpu_map_page((uint8_t)page, CPU_PAGE_RAM, &memory[page << 8], NULL, NULL);
+        }
+    }
+    cpu_reset();
+    cpu_state_t state;
+    cpu_get_state(&state);
+    state.pc = workload.start;
+    cpu_set_state(&state);
+
+    RunResult result = { 0, 0, 0, 0, false, PerfCounts() };
+    perf.start();
+    auto start = std::chrono::steady_clock::now();
+    while (result.instructions < MAX_INSTRUCTIONS) {
+        uint16_t pc = get_pc_6502();
+        result.cycles += cpu_step();
+        result.instructions++;
+        if (get_pc_6502() == pc) {
+            result.finished = true;
+            break;
+        }
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.perf = perf.stop();
+    result.pc = get_pc_6502();
+
+    cpu_clear_page_map();
+    cpu_set_memory_callbacks(NULL, NULL);
+    return result;
+}
+
+// The batch engine does not count instructions, so the per-lane count is
+// taken from a core run of the same workload
+static RunResult run_batch(const Workload& workload, uint32_t lanes, uint64_t lane_instructions,
+        std::vector<uint8_t>& memory, PerfCounters& perf) {
+    std::vector<uint16_t> pc(lanes, workload.start);
+    std::vector<uint8_t> a(lanes, 0), x(lanes, 0), y(lanes, 0), sp(lanes, 0xFD);
+    std::vector<uint8_t> status(lanes, FLAG_CONSTANT | FLAG_INTERRUPT), lane_status(lanes, BATCH_LANE_RUNNING);
+    std::vector<double> cycles(lanes, 0);
+    std::vector<uint8_t> lane_memory((size_t)lanes * BATCH_MEMORY_SIZE);
+    for (uint32_t lane = 0; lane < lanes; lane++) {
+        memcpy(&lane_memory[(size_t)lane * BATCH_MEMORY_SIZE], workload.memory.data(), BATCH_MEMORY_SIZE);
+    }
+    std::vector<uint8_t> writable(256, 1);
+
+    batch_t batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.lanes = lanes;
+    batch.pc = pc.data();
+    batch.a = a.data();
+    batch.x = x.data();
+    batch.y = y.data();
+    batch.sp = sp.data();
+    batch.status = status.data();
+    batch.cycles = cycles.data();
+    batch.lane_status = lane_status.data();
+    batch.memory = lane_memory.data();
+    batch.writable = writable.data();
+    batch.stop_address = -1;
+    batch.output_address = -1;
+
+    batch_scratch_t* scratch = batch_scratch_create(lanes);
+    if (!scratch) {
+        fprintf(stderr, "Out of memory for %u lanes\n", lanes);
+        exit(1);
+    }
+
+    RunResult result = { 0, 0, 0, 0, false, PerfCounts() };
+    perf.start();
+    auto start = std::chrono::steady_clock::now();
+    uint32_t running = batch_run(&batch, scratch, (double)MAX_INSTRUCTIONS * 7);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.perf = perf.stop();
+    batch_scratch_destroy(scratch);
+
+    result.finished = running == 0;
+    result.instructions = lane_instructions * lanes;
+    for (uint32_t lane = 0; lane < lanes; lane++) {
+        result.cycles += (uint64_t)cycles[lane];
+    }
+    result.pc = pc[0];
+    memory.assign(lane_memory.begin(), lane_memory.begin() + BATCH_MEMORY_SIZE);
+    return result;
+}
+
+/* Reporting */
+
+struct Benchmark {
+    std::string engine;
+    std::string workload;
+    uint32_t lanes;
+    bool verified;
+    std::string note;
+    std::vector<RunResult> runs;
+};
+
+static double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t middle = values.size() / 2;
+    return values.size() % 2 ? values[middle] : (values[middle - 1] + values[middle]) / 2;
+}
+
+static std::vector<double> rates(const Benchmark& benchmark) {
+    std::vector<double> ips;
+    for (const RunResult& run : benchmark.runs) {
+        ips.push_back(run.seconds > 0 ? run.instructions / run.seconds : 0);
+    }
+    return ips;
+}
+
+static void print_table(const std::vector<Benchmark>& benchmarks, bool perf) {
+    printf("%-10s %-11s %14s %9s %9s %9s %9s %9s", "engine", "workload", "instructions",
+        "MIPS", "min", "max", "ns/inst", "MHz");
+    if (perf) {
+        printf(" %9s %9s %9s %9s", "host i/i", "host c/i", "br-miss/i", "$-miss/i");
+    }
+    printf("  result\n");
+
+    for (const Benchmark& benchmark : benchmarks) {
+        std::vector<double> ips = rates(benchmark);
+        std::vector<double> seconds;
+        for (const RunResult& run : benchmark.runs) {
+            seconds.push_back(run.seconds);
+        }
+        const RunResult& first = benchmark.runs[0];
+        double mips = median(ips) / 1e6;
+        double time = median(seconds);
+        printf("%-10s %-11s %14llu %9.2f %9.2f %9.2f %9.2f %9.2f", benchmark.engine.c_str(), benchmark.workload.c_str(),
+            (unsigned long long)first.instructions, mips,
+            *std::min_element(ips.begin(), ips.end()) / 1e6, *std::max_element(ips.begin(), ips.end()) / 1e6,
+            mips > 0 ? 1000.0 / mips : 0.0, time > 0 ? first.cycles / time / 1e6 : 0.0);
+        if (perf) {
+            const PerfCounts& counts = first.perf;
+            double n = (double)first.instructions;
+            if (counts.valid) {
+                printf(" %9.2f %9.2f %9.4f %9.4f", counts.instructions / n, counts.cycles / n,
+                    counts.branch_misses / n, counts.cache_misses / n);
+            } else {
+                printf(" %9s %9s %9s %9s", "-", "-", "-", "-");
+            }
+        }
+        printf("  %s%s%s\n", benchmark.verified ? "ok" : "FAILED",
+            benchmark.note.empty() ? "" : ", ", benchmark.note.c_str());
+    }
+}
+
+static void print_json(const std::vector<Benchmark>& benchmarks, int warmup) {
+    printf("{\n  \"warmup\": %d,\n  \"benchmarks\": [", warmup);
+    for (size_t i = 0; i < benchmarks.size(); i++) {
+        const Benchmark& benchmark = benchmarks[i];
+        std::vector<double> ips = rates(benchmark);
+        std::vector<double> seconds;
+        for (const RunResult& run : benchmark.runs) {
+            seconds.push_back(run.seconds);
+        }
+        const RunResult& first = benchmark.runs[0];
+        double rate = median(ips);
+        double time = median(seconds);
+        printf("%s\n    {\n", i ? "," : "");
+        printf("      \"engine\": \"%s\",\n      \"workload\": \"%s\",\n      \"lanes\": %u,\n",
+            benchmark.engine.c_str(), benchmark.workload.c_str(), benchmark.lanes);
+        printf("      \"verified\": %s,\n", benchmark.verified ? "true" : "false");
+        if (!benchmark.note.empty()) {
+            printf("      \"note\": \"%s\",\n", benchmark.note.c_str());
+        }
+        printf("      \"instructions\": %llu,\n      \"cycles\": %llu,\n",
+            (unsigned long long)first.instructions, (unsigned long long)first.cycles);
+        printf("      \"instructionsPerSecond\": %.0f,\n      \"cyclesPerSecond\": %.0f,\n",
+            rate, time > 0 ? first.cycles / time : 0.0);
+        printf("      \"nsPerInstruction\": %.4f,\n", rate > 0 ? 1e9 / rate : 0.0);
+        printf("      \"minInstructionsPerSecond\": %.0f,\n      \"maxInstructionsPerSecond\": %.0f,\n",
+            *std::min_element(ips.begin(), ips.end()), *std::max_element(ips.begin(), ips.end()));
+        printf("      \"seconds\": [");
+        for (size_t run = 0; run < seconds.size(); run++) {
+            printf("%s%.6f", run ? ", " : "", seconds[run]);
+        }
+        printf("]");
+        if (first.perf.valid) {
+            double n = (double)first.instructions;
+            printf(",\n      \"perf\": { \"hostInstructionsPerInstruction\": %.4f, \"hostCyclesPerInstruction\": %.4f, "
+                "\"branchMissesPerInstruction\": %.6f, \"cacheMissesPerInstruction\": %.6f }",
+                first.perf.instructions / n, first.perf.cycles / n,
+                first.perf.branch_misses / n, first.perf.cache_misses / n);
+        }
+        printf("\n    }");
+    }
+    printf("\n  ]\n}\n");
+}
+
+static int usage(const char* message, const std::string& argument) {
+    fprintf(stderr, "%s%s\n%s", message, argument.c_str(), USAGE);
+    return 2;
+}
+
+static bool parse_count(const std::string& text, unsigned long minimum, unsigned long maximum, unsigned long* value) {
+    char* end;
+    unsigned long parsed = strtoul(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || parsed < minimum || parsed > maximum) {
+        return false;
+    }
+    *value = parsed;
+    return true;
+}
+
+int main(int argc, char** argv) {
+    static const char* ENGINES[] = { "core", "callbacks", "batch" };
+    std::vector<std::string> engines;
+    std::vector<std::string> workloads;
+    unsigned long runs = 5;
+    unsigned long warmup = 1;
+    unsigned long lanes = 8;
+    unsigned long cpu = 0;
+    bool pin = false;
+    bool use_perf = false;
+    bool json = false;
+    std::string functional_file;
+    unsigned long functional_success = 0x3469;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help") {
+            fputs(USAGE, stdout);
+            return 0;
+        }
+        if (arg == "--perf") {
+            use_perf = true;
+            continue;
+        }
+        if (arg == "--json") {
+            json = true;
+            continue;
+        }
+        if (arg.compare(0, 2, "--") != 0) {
+            return usage("Unexpected argument ", arg);
+        }
+        if (i + 1 >= argc) {
+            return usage("Missing value for ", arg);
+        }
+        std::string value = argv[++i];
+        if (arg == "--engine") {
+            if (std::find(std::begin(ENGINES), std::end(ENGINES), value) == std::end(ENGINES)) {
+                return usage("Unknown engine ", value);
+            }
+            engines.push_back(value);
+        } else if (arg == "--workload") {
+            workloads.push_back(value);
+        } else if (arg == "--runs") {
+            if (!parse_count(value, 1, 1000, &runs)) {
+                return usage("Invalid value for --runs: ", value);
+            }
+        } else if (arg == "--warmup") {
+            if (!parse_count(value, 0, 1000, &warmup)) {
+                return usage("Invalid value for --warmup: ", value);
+            }
+        } else if (arg == "--lanes") {
+            if (!parse_count(value, 1, 4096, &lanes)) {
+                return usage("Invalid value for --lanes: ", value);
+            }
+        } else if (arg == "--cpu") {
+            if (!parse_count(value, 0, 4095, &cpu)) {
+                return usage("Invalid value for --cpu: ", value);
+            }
+            pin = true;
+        } else if (arg == "--functional-test") {
+            functional_file = value;
+        } else if (arg == "--functional-success") {
+            char* end;
+            const char* digits = value.c_str() + (value[0] == '$');
+            functional_success = strtoul(digits, &end, 16);
+            if (*digits == '\0' || *end != '\0' || functional_success > 0xFFFF) {
+                return usage("Invalid value for --functional-success: ", value);
+            }
+        } else {
+            return usage("Unknown option ", arg);
+        }
+    }
+    if (engines.empty()) {
+        engines.assign(std::begin(ENGINES), std::end(ENGINES));
+    }
+
+    std::vector<Workload> available = { sieve_workload(), crc32_workload(), memcpy_workload(), bcd_workload() };
+    if (!functional_file.empty()) {
+        Workload functional;
+        if (!functional_workload(functional_file, (uint16_t)functional_success, &functional)) {
+            return 1;
+        }
+        available.push_back(functional);
+    }
+    std::vector<Workload> selected;
+    if (workloads.empty()) {
+        selected = available;
+    }
+    for (const std::string& name : workloads) {
+        auto workload = std::find_if(available.begin(), available.end(),
+            [&name](const Workload& w) { return w.name == name; });
+        if (workload == available.end()) {
+            return usage(name == "functional" ? "The functional workload needs --functional-test" :
+                "Unknown workload ", name == "functional" ? "" : name);
+        }
+        selected.push_back(*workload);
+    }
+
+    if (pin) {
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(set), &set) != 0) {
+            fprintf(stderr, "Cannot pin to CPU %lu; running unpinned\n", cpu);
+        }
+#else
+        fprintf(stderr, "CPU pinning is not supported here; running unpinned\n");
+#endif
+    }
+    PerfCounters perf;
+    bool perf_available = use_perf && perf.open();
+    if (use_perf && !perf_available) {
+        fprintf(stderr, "Hardware counters are unavailable (perf_event_open failed); reporting time only\n");
+    }
+    PerfCounters no_perf;
+
+    std::vector<Benchmark> benchmarks;
+    bool all_verified = true;
+    for (const Workload& workload : selected) {
+        // Instruction count per lane for the batch engine, from an untimed
+        // reference run
+        uint64_t lane_instructions = 0;
+        std::vector<uint8_t> memory;
+        for (const std::string& engine : engines) {
+            if (engine == "batch" && lane_instructions == 0) {
+                lane_instructions = run_core(workload, true, memory, no_perf).instructions;
+            }
+
+            Benchmark benchmark;
+            benchmark.engine = engine;
+            benchmark.workload = workload.name;
+            benchmark.lanes = engine == "batch" ? (uint32_t)lanes : 1;
+            benchmark.verified = true;
+            for (unsigned long run = 0; run < warmup + runs; run++) {
+                bool timed = run >= warmup;
+                PerfCounters& counters = timed && perf_available ? perf : no_perf;
+                RunResult result = engine == "batch" ?
+                    run_batch(workload, (uint32_t)lanes, lane_instructions, memory, counters) :
+                    run_core(workload, engine == "core", memory, counters);
+                if (engine != "batch") {
+                    lane_instructions = result.instructions;
+                }
+                benchmark.verified = benchmark.verified && result.finished && workload.verify(memory.data(), result.pc);
+                if (timed) {
+                    benchmark.runs.push_back(result);
+                }
+            }
+            if (workload.note == "decimal") {
+                benchmark.note = bcd_ran_decimal(memory.data()) ? "decimal mode" : "binary (no decimal mode)";
+            }
+            if (!benchmark.verified && workload.name == "functional") {
+                char note[40];
+                snprintf(note, sizeof(note), "trapped at $%04X", benchmark.runs.back().pc);
+                benchmark.note = note;
+            }
+            all_verified = all_verified && benchmark.verified;
+            benchmarks.push_back(benchmark);
+            if (!json) {
+                fprintf(stderr, "%s/%s done\n", engine.c_str(), workload.name.c_str());
+            }
+        }
+    }
+
+    if (json) {
+        print_json(benchmarks, (int)warmup);
+    } else {
+        print_table(benchmarks, perf_available);
+    }
+    return all_verified ? 0 : 1;
+}
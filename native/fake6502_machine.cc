@@ -0,0 +1,389 @@
+/*
+ * fake6502 machine
+ *
+ * Pages wholly RAM or ROM are mapped into the core's page table and
+ * accessed directly; pages holding device registers, mixed pages and
+ * unmapped pages go through the bus callbacks.
+ */
+
+#include "fake6502_machine.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+extern "C" uint16_t get_pc_6502(void);
+
+namespace fake6502 {
+
+Machine* Machine::active_ = nullptr;
+
+// Serial port
+
+bool SerialStdio::poll_input() {
+    if (pending_ >= 0) {
+        return true;
+    }
+    if (eof_) {
+        return false;
+    }
+
+    // The guest is waiting for input, so show what it has written so far
+    fflush(stdout);
+#ifdef _WIN32
+    int c = getchar();
+    if (c == EOF) {
+        eof_ = true;
+        return false;
+    }
+    pending_ = c;
+    return true;
+#else
+    struct pollfd fd = { 0, POLLIN, 0 };
+    if (poll(&fd, 1, 0) <= 0) {
+        return false;
+    }
+    unsigned char c;
+    if (::read(0, &c, 1) != 1) {
+        eof_ = true;
+        return false;
+    }
+    pending_ = c;
+    return true;
+#endif
+}
+
+void SerialStdio::tick(uint32_t cycles) {
+    // Look for input now and then while the guest waits for an interrupt
+    if ((control_ & RIE) && pending_ < 0) {
+        idle_cycles_ += cycles;
+        if (idle_cycles_ >= POLL_CYCLES) {
+            idle_cycles_ = 0;
+            poll_input();
+        }
+    }
+}
+
+bool SerialStdio::interrupt() const {
+    return (control_ & RIE) && pending_ >= 0;
+}
+
+uint8_t SerialStdio::read(uint16_t offset) {
+    if (offset == 0) {
+        return (uint8_t)(TDRE | DCD | CTS | (poll_input() ? RDRF : 0));
+    }
+    if (offset == 1 && poll_input()) {
+        uint8_t data = (uint8_t)pending_;
+        pending_ = -1;
+        return data;
+    }
+    return 0;
+}
+
+void SerialStdio::write(uint16_t offset, uint8_t value) {
+    if (offset == 0) {
+        // Master reset clears the interrupt enable
+        control_ = (value & 0x03) == 0x03 ? 0 : value;
+    } else if (offset == 1) {
+        putchar(value);
+        if (value == '\n') {
+            fflush(stdout);
+        }
+    }
+}
+
+// Machine
+
+Machine::Machine() : memory_(0x10000, 0), kind_(0x10000, KIND_NONE) {
+    memset(device_pages_, 0, sizeof(device_pages_));
+    memset(&saved_, 0, sizeof(saved_));
+    saved_.sp = 0xFD;
+    saved_.status = FLAG_CONSTANT | FLAG_INTERRUPT;
+}
+
+Machine::~Machine() {
+    if (active_ == this) {
+        cpu_clear_page_map();
+        cpu_set_memory_callbacks(NULL, NULL);
+        active_ = nullptr;
+    }
+}
+
+void Machine::map_ram(uint16_t start, uint32_t size) {
+    uint32_t end = start + size > 0x10000 ? 0x10000 : start + size;
+    memset(&kind_[start], KIND_RAM, end - start);
+    for (uint32_t page = start >> 8; page < (end + 0xFF) >> 8; page++) {
+        remap((uint8_t)page);
+    }
+}
+
+void Machine::load_rom(const uint8_t* data, size_t length, uint16_t address) {
+    if (address + length > 0x10000) {
+        throw std::runtime_error("ROM does not fit in memory");
+    }
+    memcpy(&memory_[address], data, length);
+    memset(&kind_[address], KIND_ROM, length);
+    for (uint32_t page = address >> 8; page < (address + length + 0xFF) >> 8; page++) {
+        remap((uint8_t)page);
+    }
+}
+
+void Machine::attach(Device* device, uint16_t start, uint16_t end) {
+    devices_.push_back({ device, start, end });
+    for (uint32_t page = start >> 8; page <= (uint32_t)(end >> 8); page++) {
+        device_pages_[page] = 1;
+        remap((uint8_t)page);
+    }
+}
+
+void Machine::load_binary_file(const std::string& path, uint16_t address) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Cannot read ROM file: " + path);
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    load_rom(data.data(), data.size(), address);
+}
+
+static int hex_byte(const std::string& line, size_t position) {
+    if (position + 2 > line.size()) {
+        throw std::runtime_error("Unexpected end of record");
+    }
+    int value = 0;
+    for (size_t i = position; i < position + 2; i++) {
+        char c = line[i];
+        int digit = c >= '0' && c <= '9' ? c - '0' :
+            c >= 'A' && c <= 'F' ? c - 'A' + 10 :
+            c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+        if (digit < 0) {
+            throw std::runtime_error("Invalid hex digit");
+        }
+        value = (value << 4) | digit;
+    }
+    return value;
+}
+
+// Intel HEX data records are joined into one block from the lowest to the
+// highest address, gaps filled with $FF, as the TypeScript loader does
+void Machine::load_ihex_file(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("Cannot read ROM file: " + path);
+    }
+
+    std::map<uint16_t, uint8_t> bytes;
+    std::string line;
+    while (std::getline(file, line)) {
+        while (!line.empty() && (line.back() == '\r' || line.back() == ' ' || line.back() == '\t')) {
+            line.pop_back();
+        }
+        if (line.empty() || line[0] != ':') {
+            continue;
+        }
+
+        try {
+            if (line.size() < 11) {
+                throw std::runtime_error("Record too short");
+            }
+            int length = hex_byte(line, 1);
+            int address = (hex_byte(line, 3) << 8) | hex_byte(line, 5);
+            int type = hex_byte(line, 7);
+            int sum = length + (address >> 8) + (address & 0xFF) + type;
+            std::vector<uint8_t> data;
+            for (int i = 0; i < length; i++) {
+                data.push_back((uint8_t)hex_byte(line, 9 + i * 2));
+                sum += data.back();
+            }
+            if (((256 - (sum & 0xFF)) & 0xFF) != hex_byte(line, 9 + length * 2)) {
+                throw std::runtime_error("Checksum mismatch");
+            }
+
+            if (type == 0x00) {
+                for (int i = 0; i < length; i++) {
+                    bytes[(uint16_t)(address + i)] = data[i];
+                }
+            } else if (type != 0x01 && type != 0x05) {
+                fprintf(stderr, "Unsupported Intel HEX record type: 0x%02x\n", type);
+            }
+        } catch (const std::runtime_error& error) {
+            throw std::runtime_error("Invalid Intel HEX record: " + line + " - " + error.what());
+        }
+    }
+
+    if (bytes.empty()) {
+        throw std::runtime_error("No data found in Intel HEX file");
+    }
+    uint16_t first = bytes.begin()->first;
+    std::vector<uint8_t> data(bytes.rbegin()->first - first + 1, 0xFF);
+    for (const auto& entry : bytes) {
+        data[entry.first - first] = entry.second;
+    }
+    load_rom(data.data(), data.size(), first);
+}
+
+Device* Machine::device_at(uint16_t address, uint16_t* offset) {
+    if (device_pages_[address >> 8]) {
+        // Latest attachment wins, like the other mappings
+        for (size_t i = devices_.size(); i-- > 0;) {
+            if (address >= devices_[i].start && address <= devices_[i].end) {
+                *offset = (uint16_t)(address - devices_[i].start);
+                return devices_[i].device;
+            }
+        }
+    }
+    return nullptr;
+}
+
+uint8_t Machine::read(uint16_t address) {
+    uint16_t offset;
+    Device* device = device_at(address, &offset);
+    if (device) {
+        return device->read(offset);
+    }
+    return kind_[address] == KIND_NONE ? 0xFF : memory_[address];
+}
+
+void Machine::write(uint16_t address, uint8_t value) {
+    uint16_t offset;
+    Device* device = device_at(address, &offset);
+    if (device) {
+        device->write(offset, value);
+    } else if (kind_[address] == KIND_RAM) {
+        memory_[address] = value;
+    }
+}
+
+uint8_t Machine::bus_read(uint16_t address) {
+    return active_->read(address);
+}
+
+void Machine::bus_write(uint16_t address, uint8_t value) {
+    active_->write(address, value);
+}
+
+void Machine::remap(uint8_t page) {
+    if (active_ != this) {
+        return;  // Mapped by install()
+    }
+
+    uint16_t base = (uint16_t)(page << 8);
+    uint8_t kind = kind_[base];
+    bool uniform = !device_pages_[page] && kind != KIND_NONE &&
+        memchr(&kind_[base], kind == KIND_RAM ? KIND_ROM : KIND_RAM, 0x100) == NULL &&
+        memchr(&kind_[base], KIND_NONE, 0x100) == NULL;
+    if (uniform) {
+        cpu_map_page(page, kind == KIND_RAM ? CPU_PAGE_RAM : CPU_PAGE_ROM, &memory_[base], NULL, NULL);
+    } else {
+        cpu_map_page(page, CPU_PAGE_CALLBACK, NULL, NULL, NULL);
+    }
+}
+
+void Machine::install() {
+    if (active_ == this) {
+        return;
+    }
+    if (active_) {
+        cpu_get_state(&active_->saved_);
+    }
+    active_ = this;
+    cpu_set_memory_callbacks(bus_read, bus_write);
+    cpu_clear_page_map();
+    for (uint32_t page = 0; page < 256; page++) {
+        remap((uint8_t)page);
+    }
+    cpu_set_state(&saved_);
+}
+
+void Machine::reset() {
+    install();
+    cpu_reset();
+    cpu_state_t state;
+    cpu_get_state(&state);
+    state.pc = (uint16_t)(read(0xFFFC) | (read(0xFFFD) << 8));
+    cpu_set_state(&state);
+    cycles_ = 0;
+}
+
+uint32_t Machine::step() {
+    install();
+    uint32_t cycles = cpu_step();
+    cycles_ += cycles;
+
+    bool interrupt = false;
+    for (const Mapping& mapping : devices_) {
+        mapping.device->tick(cycles);
+        interrupt = interrupt || mapping.device->interrupt();
+    }
+
+    // The core consumes a latched IRQ even while it is masked, so the line
+    // is only latched once the guest can take it
+    if (interrupt) {
+        cpu_state_t state;
+        cpu_get_state(&state);
+        interrupt = (state.status & FLAG_INTERRUPT) == 0;
+    }
+    if (interrupt) {
+        cpu_trigger_irq();
+    } else {
+        cpu_clear_irq();
+    }
+    return cycles;
+}
+
+RunResult Machine::run(const RunOptions& options) {
+    std::vector<bool> breakpoints(0x10000, false);
+    for (uint16_t address : options.breakpoints) {
+        breakpoints[address] = true;
+    }
+
+    install();
+    RunResult result = { STOP_CYCLES, 0, 0 };
+    while (options.max_cycles == 0 || result.cycles < options.max_cycles) {
+        uint16_t start_pc = get_pc_6502();
+        if (breakpoints[start_pc]) {
+            result.reason = STOP_BREAKPOINT;
+            break;
+        }
+        result.cycles += step();
+        result.instructions++;
+        if (options.stop_on_spin && get_pc_6502() == start_pc) {
+            result.reason = STOP_SPIN;
+            break;
+        }
+    }
+    fflush(stdout);
+    return result;
+}
+
+Registers Machine::registers() {
+    cpu_state_t state = saved_;
+    if (active_ == this) {
+        cpu_get_state(&state);
+    }
+    Registers registers = { state.pc, state.a, state.x, state.y, state.sp, state.status };
+    return registers;
+}
+
+void Machine::set_registers(const Registers& registers) {
+    install();
+    cpu_state_t state;
+    cpu_get_state(&state);
+    state.pc = registers.pc;
+    state.a = registers.a;
+    state.x = registers.x;
+    state.y = registers.y;
+    state.sp = registers.sp;
+    state.status = registers.status;
+    cpu_set_state(&state);
+}
+
+}  // namespace fake6502
@@ -0,0 +1,153 @@
+/*
+ * fake6502 machine
+ * C++ API over the fake6502 core for use without Node: a 64K memory map of
+ * RAM, ROM and devices, ROM loading and a run loop with stop conditions.
+ * Built as the fake6502_core static library together with the core.
+ *
+ * The core keeps its CPU in globals, so only one machine runs at a time;
+ * a machine installs itself (memory map and registers) when it steps after
+ * another one has.
+ */
+
+#ifndef FAKE6502_MACHINE_H
+#define FAKE6502_MACHINE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "fake6502.h"
+
+namespace fake6502 {
+
+// Memory-mapped peripheral; offsets are relative to the base address
+class Device {
+public:
+    virtual ~Device() {}
+    virtual uint8_t read(uint16_t offset) = 0;
+    virtual void write(uint16_t offset, uint8_t value) = 0;
+    virtual void tick(uint32_t cycles) { (void)cycles; }
+    virtual bool interrupt() const { return false; }  // IRQ line, level-triggered
+};
+
+// 68B50-compatible serial port on the host's stdin/stdout, with the ACIA's
+// register layout (status/control, data) and no baud-rate delay: output is
+// written as soon as the guest stores it, and input is reported ready as
+// soon as the host has it. Setting the receive interrupt enable bit in the
+// control register raises IRQ while a byte is waiting.
+class SerialStdio : public Device {
+public:
+    static const uint8_t RDRF = 0x01;
+    static const uint8_t TDRE = 0x02;
+    static const uint8_t DCD = 0x04;
+    static const uint8_t CTS = 0x08;
+    static const uint8_t RIE = 0x80;           // Control register
+    static const uint32_t POLL_CYCLES = 1000;  // Between stdin polls while interrupt driven
+
+    uint8_t read(uint16_t offset) override;
+    void write(uint16_t offset, uint8_t value) override;
+    void tick(uint32_t cycles) override;
+    bool interrupt() const override;
+
+    bool input_closed() const { return eof_; }
+
+private:
+    bool poll_input();
+
+    int pending_ = -1;   // Byte read from stdin, not yet taken by the guest
+    bool eof_ = false;
+    uint8_t control_ = 0;
+    uint32_t idle_cycles_ = 0;
+};
+
+struct Registers {
+    uint16_t pc;
+    uint8_t a;
+    uint8_t x;
+    uint8_t y;
+    uint8_t sp;
+    uint8_t status;
+};
+
+enum StopReason {
+    STOP_CYCLES = 0,      // Cycle limit reached
+    STOP_BREAKPOINT = 1,  // PC reached a breakpoint, before executing it
+    STOP_SPIN = 2         // Instruction jumped to itself
+};
+
+struct RunOptions {
+    uint64_t max_cycles = 0;           // 0 for no limit
+    std::vector<uint16_t> breakpoints;
+    bool stop_on_spin = true;          // Off for programs that idle waiting for interrupts
+};
+
+struct RunResult {
+    StopReason reason;
+    uint64_t cycles;                   // Executed by this run
+    uint64_t instructions;
+};
+
+class Machine {
+public:
+    Machine();
+    ~Machine();
+
+    Machine(const Machine&) = delete;
+    Machine& operator=(const Machine&) = delete;
+
+    // Memory map; unmapped addresses read $FF and ignore writes. Later
+    // mappings replace earlier ones.
+    void map_ram(uint16_t start, uint32_t size);
+    void load_rom(const uint8_t* data, size_t length, uint16_t address);
+    void attach(Device* device, uint16_t start, uint16_t end);  // Not owned
+
+    // ROM files, as the TypeScript ROM loader reads them; throw
+    // std::runtime_error when the file cannot be read or parsed
+    void load_binary_file(const std::string& path, uint16_t address);
+    void load_ihex_file(const std::string& path);
+
+    // Bus access, devices included
+    uint8_t read(uint16_t address);
+    void write(uint16_t address, uint8_t value);
+
+    // Reset the CPU and jump through the reset vector
+    void reset();
+
+    // Execute one instruction, then tick the devices and update the IRQ line
+    uint32_t step();
+    RunResult run(const RunOptions& options);
+
+    Registers registers();
+    void set_registers(const Registers& registers);
+    uint64_t cycles() const { return cycles_; }
+
+private:
+    enum Kind { KIND_NONE = 0, KIND_RAM = 1, KIND_ROM = 2 };
+
+    struct Mapping {
+        Device* device;
+        uint16_t start;
+        uint16_t end;
+    };
+
+    static uint8_t bus_read(uint16_t address);
+    static void bus_write(uint16_t address, uint8_t value);
+
+    void install();
+    void remap(uint8_t page);
+    Device* device_at(uint16_t address, uint16_t* offset);
+
+    static Machine* active_;
+
+    std::vector<uint8_t> memory_;
+    std::vector<uint8_t> kind_;        // Kind per address
+    std::vector<Mapping> devices_;
+    uint8_t device_pages_[256];        // Pages holding device registers
+    cpu_state_t saved_;                // CPU state while another machine is active
+    uint64_t cycles_ = 0;
+};
+
+}  // namespace fake6502
+
+#endif // FAKE6502_MACHINE_H
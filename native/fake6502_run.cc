@@ -0,0 +1,175 @@
+/*
+ * fake6502_run - headless runner without Node
+ * Runs binary or Intel HEX ROMs from reset with a serial port on
+ * stdin/stdout, until the program jumps to itself, reaches a stop address
+ * or uses up its cycles. Exit codes follow `6502-emulator run`: 0 when the
+ * program stops, 124 on the cycle limit, 2 for usage errors.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include "fake6502_machine.h"
+
+static const char* USAGE =
+    "Usage: fake6502_run [options] <rom>[@address]...\n"
+    "  --ram <start>:<size>   RAM, hex (default 0000:8000)\n"
+    "  --acia <address>       Serial port on stdin/stdout, hex (default 8000), or none\n"
+    "  --until-pc <address>   Stop before executing an address, hex (repeatable)\n"
+    "  --max-cycles <count>   Cycle limit (default 100000000)\n"
+    "  --no-spin-stop         Keep running when an instruction jumps to itself\n"
+    "  --stats                Print registers and statistics to stderr\n"
+    "ROMs ending in .hex or .ihex are Intel HEX; others are binary and need an address.\n";
+
+static const int TIMEOUT_EXIT_CODE = 124;
+
+static bool parse_hex(const std::string& text, uint32_t limit, uint32_t* value) {
+    const char* digits = text.c_str();
+    if (*digits == '$') {
+        digits++;
+    }
+    char* end;
+    unsigned long parsed = strtoul(digits, &end, 16);
+    if (*digits == '\0' || *end != '\0' || parsed > limit) {
+        return false;
+    }
+    *value = (uint32_t)parsed;
+    return true;
+}
+
+static bool has_suffix(const std::string& text, const char* suffix) {
+    size_t length = strlen(suffix);
+    if (text.size() < length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        if (tolower((unsigned char)text[text.size() - length + i]) != suffix[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static int usage(const char* message, const std::string& argument) {
+    fprintf(stderr, "%s%s\n%s", message, argument.c_str(), USAGE);
+    return 2;
+}
+
+int main(int argc, char** argv) {
+    fake6502::Machine machine;
+    fake6502::SerialStdio serial;
+    fake6502::RunOptions options;
+    options.max_cycles = 100000000;
+    uint32_t ram_start = 0x0000;
+    uint32_t ram_size = 0x8000;
+    uint32_t acia = 0x8000;
+    bool use_acia = true;
+    bool stats = false;
+    int roms = 0;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help") {
+            fputs(USAGE, stdout);
+            return 0;
+        }
+        if (arg == "--no-spin-stop") {
+            options.stop_on_spin = false;
+            continue;
+        }
+        if (arg == "--stats") {
+            stats = true;
+            continue;
+        }
+        if (arg.compare(0, 2, "--") == 0) {
+            if (i + 1 >= argc) {
+                return usage("Missing value for ", arg);
+            }
+            std::string value = argv[++i];
+            uint32_t number;
+            if (arg == "--ram") {
+                size_t colon = value.find(':');
+                if (colon == std::string::npos || !parse_hex(value.substr(0, colon), 0xFFFF, &ram_start) ||
+                        !parse_hex(value.substr(colon + 1), 0x10000, &ram_size)) {
+                    return usage("Invalid value for --ram: ", value);
+                }
+            } else if (arg == "--acia") {
+                use_acia = value != "none";
+                if (use_acia && !parse_hex(value, 0xFFFE, &acia)) {
+                    return usage("Invalid value for --acia: ", value);
+                }
+            } else if (arg == "--until-pc") {
+                if (!parse_hex(value, 0xFFFF, &number)) {
+                    return usage("Invalid value for --until-pc: ", value);
+                }
+                options.breakpoints.push_back((uint16_t)number);
+            } else if (arg == "--max-cycles") {
+                char* end;
+                options.max_cycles = strtoull(value.c_str(), &end, 10);
+                if (value.empty() || *end != '\0' || options.max_cycles == 0) {
+                    return usage("Invalid value for --max-cycles: ", value);
+                }
+            } else {
+                return usage("Unknown option ", arg);
+            }
+            continue;
+        }
+
+        // ROMs are loaded after the RAM is mapped, in command line order
+        roms++;
+    }
+    if (roms == 0) {
+        return usage("No ROM given", "");
+    }
+
+    machine.map_ram((uint16_t)ram_start, ram_size);
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg.compare(0, 2, "--") == 0) {
+                if (arg != "--no-spin-stop" && arg != "--stats") {
+                    i++;
+                }
+                continue;
+            }
+            size_t at = arg.rfind('@');
+            std::string file = at != std::string::npos && at > 0 ? arg.substr(0, at) : arg;
+            if (has_suffix(file, ".hex") || has_suffix(file, ".ihex")) {
+                machine.load_ihex_file(file);
+            } else {
+                uint32_t address;
+                if (file == arg || !parse_hex(arg.substr(at + 1), 0xFFFF, &address)) {
+                    return usage("Binary ROM needs a load address: ", arg);
+                }
+                machine.load_binary_file(file, (uint16_t)address);
+            }
+        }
+    } catch (const std::runtime_error& error) {
+        fprintf(stderr, "%s\n", error.what());
+        return 1;
+    }
+    if (use_acia) {
+        machine.attach(&serial, (uint16_t)acia, (uint16_t)(acia + 1));
+    }
+
+    machine.reset();
+    auto start = std::chrono::steady_clock::now();
+    fake6502::RunResult result = machine.run(options);
+    double elapsed_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    if (stats) {
+        static const char* REASONS[] = { "cycles", "pc", "spin" };
+        fake6502::Registers r = machine.registers();
+        fprintf(stderr, "Stopped (%s) at $%04X  A=$%02X X=$%02X Y=$%02X SP=$%02X P=$%02X\n",
+            REASONS[result.reason], r.pc, r.a, r.x, r.y, r.sp, r.status);
+        fprintf(stderr, "%llu cycles, %llu instructions in %.3f ms (%.2f MHz)\n",
+            (unsigned long long)result.cycles, (unsigned long long)result.instructions, elapsed_ms,
+            elapsed_ms > 0 ? result.cycles / elapsed_ms / 1000.0 : 0.0);
+    }
+    return result.reason == fake6502::STOP_CYCLES ? TIMEOUT_EXIT_CODE : 0;
+}
@@ -0,0 +1,516 @@
+/*
+ * fake6502 worker thread
+ *
+ * The worker executes instructions until it is paused, stopped or reaches a
+ * breakpoint. It talks to the main thread through a single-slot mailbox:
+ * each request (IO-page read/write, periodic sync, stop report) is posted
+ * under the mutex, the event loop is woken through a ThreadSafeFunction and
+ * the worker blocks until the request has been serviced. Synchronous
+ * commands issued from the main thread (pause, stop) service pending
+ * requests while they wait, so they cannot deadlock against the worker.
+ */
+
+#include "fake6502_thread.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+extern "C" uint16_t get_pc_6502(void);
+
+namespace {
+
+enum RequestKind {
+    REQUEST_READ = 0,
+    REQUEST_WRITE = 1,
+    REQUEST_SYNC = 2,
+    REQUEST_STOPPED = 3
+};
+
+enum StopReason {
+    STOP_PAUSE = 0,
+    STOP_BREAKPOINT = 1
+};
+
+enum WorkerState {
+    WORKER_IDLE = 0,
+    WORKER_RUNNING = 1,
+    WORKER_PAUSED = 2,
+    WORKER_EXITED = 3
+};
+
+enum Command {
+    COMMAND_RUN = 0,
+    COMMAND_PAUSE = 1,
+    COMMAND_STOP = 2
+};
+
+struct Request {
+    int kind;
+    uint16_t address;
+    uint8_t value;
+    uint32_t cycles;        // Cycles executed since the previous request
+    uint32_t instructions;  // Instructions executed since the previous request
+};
+
+std::mutex g_mutex;
+std::condition_variable g_cv;
+std::thread g_worker;
+Napi::ThreadSafeFunction g_tsfn;
+Napi::FunctionReference g_handler;
+
+std::atomic<int> g_state{WORKER_IDLE};
+std::atomic<int> g_command{COMMAND_RUN};
+
+// Mailbox, guarded by g_mutex
+Request g_request;
+bool g_request_pending = false;
+bool g_request_in_service = false;
+uint8_t g_request_result = 0xFF;
+bool g_stop_unreported = false;
+int g_stop_reason = STOP_PAUSE;
+uint16_t g_stop_pc = 0;
+bool g_pause_async = false;
+cpu_state_t g_snapshot;
+
+// Worker-only
+uint32_t g_pending_cycles = 0;
+uint32_t g_pending_instructions = 0;
+uint32_t g_slice_cycles = 10000;
+double g_clock_hz = 0;
+
+std::atomic<uint8_t> g_breakpoints[65536 / 8];
+
+// Keeps buffers mapped into the page table alive
+Napi::ObjectReference g_page_data[256];
+Napi::ObjectReference g_page_dirty[256];
+Napi::ObjectReference g_page_version[256];
+
+thread_local bool t_on_worker = false;
+
+bool IsBreakpoint(uint16_t address) {
+    return (g_breakpoints[address >> 3].load(std::memory_order_relaxed) >> (address & 7)) & 1;
+}
+
+uint8_t CallHandler(Napi::Env env, const Request& request) {
+    if (g_handler.IsEmpty()) {
+        return 0xFF;
+    }
+
+    Napi::Value result = g_handler.Call({
+        Napi::Number::New(env, request.kind),
+        Napi::Number::New(env, request.address),
+        Napi::Number::New(env, request.value),
+        Napi::Number::New(env, request.cycles),
+        Napi::Number::New(env, request.instructions)
+    });
+
+    if (!result.IsEmpty() && result.IsNumber()) {
+        return result.As<Napi::Number>().Uint32Value() & 0xFF;
+    }
+    return 0xFF;
+}
+
+// Main thread: run the pending worker request through the handler
+bool ServiceRequest(Napi::Env env) {
+    std::unique_lock<std::mutex> lock(g_mutex);
+    if (!g_request_pending || g_request_in_service) {
+        return false;
+    }
+
+    Request request = g_request;
+    g_request_in_service = true;
+    lock.unlock();
+
+    uint8_t result = CallHandler(env, request);
+
+    lock.lock();
+    g_request_result = result;
+    g_request_pending = false;
+    g_request_in_service = false;
+    g_cv.notify_all();
+    return true;
+}
+
+// Main thread: tell the handler the worker has parked on its own
+void ReportStop(Napi::Env env) {
+    std::unique_lock<std::mutex> lock(g_mutex);
+    if (!g_stop_unreported) {
+        return;
+    }
+
+    Request request = { REQUEST_STOPPED, g_stop_pc, (uint8_t)g_stop_reason, 0, 0 };
+    g_stop_unreported = false;
+    lock.unlock();
+
+    CallHandler(env, request);
+}
+
+void OnWake(Napi::Env env, Napi::Function) {
+    ServiceRequest(env);
+    ReportStop(env);
+}
+
+// Main thread: block until done() holds, servicing worker requests meanwhile
+template <typename Predicate>
+void WaitServicing(Napi::Env env, Predicate done) {
+    std::unique_lock<std::mutex> lock(g_mutex);
+    while (!done()) {
+        if (g_request_pending && !g_request_in_service) {
+            lock.unlock();
+            ServiceRequest(env);
+            lock.lock();
+            continue;
+        }
+        g_cv.wait(lock);
+    }
+}
+
+// Worker: post a request and wait for the main thread to service it
+uint8_t PostRequest(int kind, uint16_t address, uint8_t value) {
+    std::unique_lock<std::mutex> lock(g_mutex);
+    g_request = { kind, address, value, g_pending_cycles, g_pending_instructions };
+    g_pending_cycles = 0;
+    g_pending_instructions = 0;
+    cpu_get_state(&g_snapshot);
+    g_request_pending = true;
+    g_cv.notify_all();
+    lock.unlock();
+
+    g_tsfn.NonBlockingCall(OnWake);
+
+    lock.lock();
+    g_cv.wait(lock, [] { return !g_request_pending; });
+    return g_request_result;
+}
+
+// Worker: wait for resume or stop; peripherals are synced first so the
+// main thread sees a consistent machine while the worker is parked
+void Park(int reason) {
+    if (g_pending_cycles > 0) {
+        PostRequest(REQUEST_SYNC, 0, 0);
+    }
+
+    std::unique_lock<std::mutex> lock(g_mutex);
+    cpu_get_state(&g_snapshot);
+    bool report = reason == STOP_BREAKPOINT || g_pause_async;
+    if (report) {
+        g_stop_unreported = true;
+        g_stop_reason = reason;
+        g_stop_pc = g_snapshot.pc;
+        g_pause_async = false;
+    }
+    g_state = WORKER_PAUSED;
+    g_cv.notify_all();
+    lock.unlock();
+
+    if (report) {
+        g_tsfn.NonBlockingCall(OnWake);
+    }
+
+    lock.lock();
+    g_cv.wait(lock, [] {
+        return g_state != WORKER_PAUSED || g_command.load() == COMMAND_STOP;
+    });
+}
+
+void WorkerMain() {
+    using Clock = std::chrono::steady_clock;
+
+    t_on_worker = true;
+    Clock::time_point baseline = Clock::now();
+    uint64_t baseline_cycles = 0;
+
+    for (;;) {
+        int command = g_command.load();
+        if (command == COMMAND_STOP) {
+            break;
+        }
+
+        if (command == COMMAND_PAUSE || IsBreakpoint(get_pc_6502())) {
+            Park(command == COMMAND_PAUSE ? STOP_PAUSE : STOP_BREAKPOINT);
+            baseline = Clock::now();
+            baseline_cycles = 0;
+            continue;
+        }
+
+        uint32_t cycles = cpu_step();
+        g_pending_cycles += cycles;
+        g_pending_instructions++;
+        baseline_cycles += cycles;
+
+        if (g_pending_cycles >= g_slice_cycles) {
+            PostRequest(REQUEST_SYNC, 0, 0);
+
+            if (g_clock_hz > 0) {
+                std::chrono::duration<double> emulated(baseline_cycles / g_clock_hz);
+                std::this_thread::sleep_until(
+                    baseline + std::chrono::duration_cast<Clock::duration>(emulated));
+            }
+        }
+    }
+
+    if (g_pending_cycles > 0) {
+        PostRequest(REQUEST_SYNC, 0, 0);
+    }
+
+    std::unique_lock<std::mutex> lock(g_mutex);
+    cpu_get_state(&g_snapshot);
+    g_state = WORKER_EXITED;
+    g_cv.notify_all();
+    lock.unlock();
+
+    g_tsfn.Release();
+}
+
+Napi::Value ThrowError(Napi::Env env, const char* message) {
+    Napi::Error::New(env, message).ThrowAsJavaScriptException();
+    return env.Undefined();
+}
+
+// threadStart(handler, { sliceCycles, clockHz })
+Napi::Value ThreadStart(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (info.Length() < 1 || !info[0].IsFunction()) {
+        Napi::TypeError::New(env, "Expected handler function").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    if (g_state == WORKER_RUNNING || g_state == WORKER_PAUSED) {
+        return ThrowError(env, "Worker thread is already started");
+    }
+    if (g_worker.joinable()) {
+        g_worker.join();
+    }
+
+    g_slice_cycles = 10000;
+    g_clock_hz = 0;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Napi::Object options = info[1].As<Napi::Object>();
+        if (options.Has("sliceCycles") && options.Get("sliceCycles").IsNumber()) {
+            g_slice_cycles = options.Get("sliceCycles").As<Napi::Number>().Uint32Value();
+        }
+        if (options.Has("clockHz") && options.Get("clockHz").IsNumber()) {
+            g_clock_hz = options.Get("clockHz").As<Napi::Number>().DoubleValue();
+        }
+    }
+    if (g_slice_cycles == 0) {
+        g_slice_cycles = 1;
+    }
+
+    Napi::Function handler = info[0].As<Napi::Function>();
+    g_handler = Napi::Persistent(handler);
+    g_tsfn = Napi::ThreadSafeFunction::New(env, handler, "fake6502-worker", 0, 1);
+
+    g_request_pending = false;
+    g_request_in_service = false;
+    g_stop_unreported = false;
+    g_pause_async = false;
+    g_pending_cycles = 0;
+    g_pending_instructions = 0;
+    cpu_get_state(&g_snapshot);
+
+    g_command = COMMAND_RUN;
+    g_state = WORKER_RUNNING;
+    g_worker = std::thread(WorkerMain);
+    return env.Undefined();
+}
+
+// threadPause() -> true once parked, false if the pause completes later
+// (called from inside the handler, where waiting would deadlock)
+Napi::Value ThreadPause(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (g_state != WORKER_RUNNING) {
+        return Napi::Boolean::New(env, g_state == WORKER_PAUSED);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        g_command = COMMAND_PAUSE;
+        if (g_request_in_service) {
+            g_pause_async = true;
+            return Napi::Boolean::New(env, false);
+        }
+    }
+
+    WaitServicing(env, [] { return g_state != WORKER_RUNNING; });
+    return Napi::Boolean::New(env, true);
+}
+
+Napi::Value ThreadResume(const Napi::CallbackInfo& info) {
+    std::lock_guard<std::mutex> lock(g_mutex);
+    if (g_state == WORKER_PAUSED) {
+        g_command = COMMAND_RUN;
+        g_state = WORKER_RUNNING;
+        g_cv.notify_all();
+    }
+    return info.Env().Undefined();
+}
+
+Napi::Value ThreadStop(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (g_state == WORKER_IDLE) {
+        return env.Undefined();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_mutex);
+        if (g_request_in_service) {
+            return ThrowError(env, "Cannot stop the worker thread from its own handler");
+        }
+        g_command = COMMAND_STOP;
+        g_cv.notify_all();
+    }
+
+    WaitServicing(env, [] { return g_state == WORKER_EXITED; });
+    g_worker.join();
+    g_state = WORKER_IDLE;
+    g_command = COMMAND_RUN;
+    g_handler.Reset();
+    return env.Undefined();
+}
+
+Napi::Value ThreadStatus(const Napi::CallbackInfo& info) {
+    switch (g_state.load()) {
+        case WORKER_RUNNING: return Napi::String::New(info.Env(), "running");
+        case WORKER_PAUSED: return Napi::String::New(info.Env(), "paused");
+        default: return Napi::String::New(info.Env(), "idle");
+    }
+}
+
+// mapPage(page, kind, data?, dirty?, versions?, index?)
+// dirty (Uint8Array) and versions (Uint32Array) are per-page arrays; index
+// selects this page's entry in both
+Napi::Value MapPage(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (g_state == WORKER_RUNNING) {
+        return ThrowError(env, "Cannot change the page map while the worker is running");
+    }
+    if (info.Length() < 2 || !info[0].IsNumber() || !info[1].IsNumber()) {
+        Napi::TypeError::New(env, "Expected page and kind").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+
+    uint32_t page = info[0].As<Napi::Number>().Uint32Value() & 0xFF;
+    uint32_t kind = info[1].As<Napi::Number>().Uint32Value();
+    g_page_data[page].Reset();
+    g_page_dirty[page].Reset();
+    g_page_version[page].Reset();
+
+    if (kind == CPU_PAGE_CALLBACK) {
+        cpu_map_page((uint8_t)page, CPU_PAGE_CALLBACK, NULL, NULL, NULL);
+        return env.Undefined();
+    }
+
+    if (info.Length() < 3 || !info[2].IsTypedArray()) {
+        Napi::TypeError::New(env, "Expected Uint8Array page data").ThrowAsJavaScriptException();
+        return env.Undefined();
+    }
+    Napi::Uint8Array data = info[2].As<Napi::Uint8Array>();
+    if (data.ElementLength() < 256) {
+        return ThrowError(env, "Page data must be at least 256 bytes");
+    }
+
+    uint32_t index = info.Length() > 5 && info[5].IsNumber() ? info[5].As<Napi::Number>().Uint32Value() : 0;
+
+    uint8_t* dirty = NULL;
+    if (info.Length() > 3 && info[3].IsTypedArray() &&
+        info[3].As<Napi::TypedArray>().TypedArrayType() == napi_uint8_array) {
+        Napi::Uint8Array dirtyArray = info[3].As<Napi::Uint8Array>();
+        if (index < dirtyArray.ElementLength()) {
+            dirty = dirtyArray.Data() + index;
+            g_page_dirty[page] = Napi::Persistent(dirtyArray.As<Napi::Object>());
+        }
+    }
+
+    uint32_t* version = NULL;
+    if (info.Length() > 4 && info[4].IsTypedArray() &&
+        info[4].As<Napi::TypedArray>().TypedArrayType() == napi_uint32_array) {
+        Napi::Uint32Array versionArray = info[4].As<Napi::Uint32Array>();
+        if (index < versionArray.ElementLength()) {
+            version = versionArray.Data() + index;
+            g_page_version[page] = Napi::Persistent(versionArray.As<Napi::Object>());
+        }
+    }
+
+    g_page_data[page] = Napi::Persistent(data.As<Napi::Object>());
+    cpu_map_page((uint8_t)page, (uint8_t)kind, data.Data(), dirty, version);
+    return env.Undefined();
+}
+
+Napi::Value ClearPageMap(const Napi::CallbackInfo& info) {
+    Napi::Env env = info.Env();
+    if (g_state == WORKER_RUNNING) {
+        return ThrowError(env, "Cannot change the page map while the worker is running");
+    }
+    cpu_clear_page_map();
+    for (int page = 0; page < 256; page++) {
+        g_page_data[page].Reset();
+        g_page_dirty[page].Reset();
+        g_page_version[page].Reset();
+    }
+    return env.Undefined();
+}
+
+// setBreakpoint(address, enabled)
+Napi::Value SetBreakpoint(const Napi::CallbackInfo& info) {
+    if (info.Length() < 2 || !info[0].IsNumber()) {
+        Napi::TypeError::New(info.Env(), "Expected address and flag").ThrowAsJavaScriptException();
+        return info.Env().Undefined();
+    }
+    uint16_t address = (uint16_t)(info[0].As<Napi::Number>().Uint32Value() & 0xFFFF);
+    uint8_t bit = (uint8_t)(1 << (address & 7));
+    if (info[1].ToBoolean().Value()) {
+        g_breakpoints[address >> 3].fetch_or(bit);
+    } else {
+        g_breakpoints[address >> 3].fetch_and((uint8_t)~bit);
+    }
+    return info.Env().Undefined();
+}
+
+Napi::Value ClearBreakpoints(const Napi::CallbackInfo& info) {
+    for (auto& entry : g_breakpoints) {
+        entry.store(0);
+    }
+    return info.Env().Undefined();
+}
+
+} // namespace
+
+bool thread_on_worker(void) {
+    return t_on_worker;
+}
+
+bool thread_is_running(void) {
+    return g_state == WORKER_RUNNING;
+}
+
+uint8_t thread_memory_read(uint16_t address) {
+    return PostRequest(REQUEST_READ, address, 0);
+}
+
+void thread_memory_write(uint16_t address, uint8_t value) {
+    PostRequest(REQUEST_WRITE, address, value);
+}
+
+bool thread_get_snapshot(cpu_state_t* state) {
+    if (g_state != WORKER_RUNNING) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(g_mutex);
+    *state = g_snapshot;
+    return true;
+}
+
+void InitThread(Napi::Env env, Napi::Object exports) {
+    exports.Set("threadStart", Napi::Function::New(env, ThreadStart));
+    exports.Set("threadPause", Napi::Function::New(env, ThreadPause));
+    exports.Set("threadResume", Napi::Function::New(env, ThreadResume));
+    exports.Set("threadStop", Napi::Function::New(env, ThreadStop));
+    exports.Set("threadStatus", Napi::Function::New(env, ThreadStatus));
+    exports.Set("mapPage", Napi::Function::New(env, MapPage));
+    exports.Set("clearPageMap", Napi::Function::New(env, ClearPageMap));
+    exports.Set("setBreakpoint", Napi::Function::New(env, SetBreakpoint));
+    exports.Set("clearBreakpoints", Napi::Function::New(env, ClearBreakpoints));
+}
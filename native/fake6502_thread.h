@@ -0,0 +1,31 @@
+/*
+ * fake6502 worker thread
+ * Runs the CPU loop on a native thread. Accesses to pages without a direct
+ * mapping, periodic peripheral syncs and breakpoint stops are marshalled to
+ * a JavaScript handler on the main thread.
+ */
+
+#ifndef FAKE6502_THREAD_H
+#define FAKE6502_THREAD_H
+
+#include <napi.h>
+#include <stdint.h>
+#include "fake6502.h"
+
+// True when called on the emulation worker thread
+bool thread_on_worker(void);
+
+// True while the worker is executing instructions (not parked)
+bool thread_is_running(void);
+
+// Memory access from the worker, serviced by the JavaScript handler
+uint8_t thread_memory_read(uint16_t address);
+void thread_memory_write(uint16_t address, uint8_t value);
+
+// CPU state published by the running worker; false if it is not running
+bool thread_get_snapshot(cpu_state_t* state);
+
+// Register page map, breakpoint and worker functions on the addon exports
+void InitThread(Napi::Env env, Napi::Object exports);
+
+#endif // FAKE6502_THREAD_H
@@ -0,0 +1,58 @@
+#!/usr/bin/env node
+/**
+ * Generate native/fake6502_batch_tables.h from the native core's tables
+ *
+ * The batch engine decodes with its own addressing mode, operation and
+ * cycle tables; they are emitted from addrtable, optable and ticktable in
+ * native/fake6502_improved.h so both engines follow the same tables.
+ *
+ * Usage: node scripts/generate-batch-tables.js [--check]
+ *   --check  exit with status 1 if the file on disk is out of date
+ */
+
+const fs = require('fs');
+const path = require('path');
+const { readNativeTables } = require('./native-tables');
+
+const root = path.join(__dirname, '..');
+const outputPath = path.join(root, 'native', 'fake6502_batch_tables.h');
+
+const { modes, ops, ticks } = readNativeTables();
+
+function table(name, entries) {
+  const width = Math.max(...entries.map(entry => entry.length));
+  const rows = Array.from({ length: 16 }, (_, row) =>
+    `/* ${row.toString(16).toUpperCase()} */ ${entries.slice(row * 16, row * 16 + 16).map(entry => entry.padStart(width)).join(', ')}`);
+  return `static const uint8_t ${name}[256] = {\n${rows.join(',\n')}\n};`;
+}
+
+const output = `/*
+ * fake6502 batch engine opcode tables
+ * GENERATED by scripts/generate-batch-tables.js from addrtable, optable and
+ * ticktable in fake6502_improved.h; do not edit by hand.
+ *
+ * Included by fake6502_batch.c after its M_* and O_* enums.
+ */
+
+#ifndef FAKE6502_BATCH_TABLES_H
+#define FAKE6502_BATCH_TABLES_H
+
+${table('batch_modes', modes.map(mode => `M_${mode.toUpperCase()}`))}
+
+${table('batch_ops', ops.map(op => `O_${op.toUpperCase()}`))}
+
+${table('batch_ticks', ticks.map(String))}
+
+#endif // FAKE6502_BATCH_TABLES_H
+`;
+
+if (process.argv.includes('--check')) {
+  const current = fs.existsSync(outputPath) ? fs.readFileSync(outputPath, 'utf8') : '';
+  if (current !== output) {
+    console.error(`${path.relative(root, outputPath)} is out of date; run node scripts/generate-batch-tables.js`);
+    process.exit(1);
+  }
+} else {
+  fs.writeFileSync(outputPath, output);
+  console.log(`Wrote ${path.relative(root, outputPath)}`);
+}
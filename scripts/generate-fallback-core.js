@@ -0,0 +1,347 @@
+#!/usr/bin/env node
+/**
+ * Generate src/core/fallback-core.ts from the native core's tables
+ *
+ * Reads addrtable, optable and ticktable from native/fake6502_improved.h and
+ * emits a TypeScript interpreter with one flat switch over all 256 opcodes.
+ * Each case inlines its addressing mode, operation and cycle count, so the
+ * fallback follows the native core (NES_CPU, UNDOCUMENTED) instruction for
+ * instruction, including the order of memory accesses.
+ *
+ * Usage: node scripts/generate-fallback-core.js [--check]
+ *   --check  exit with status 1 if the file on disk is out of date
+ */
+
+const fs = require('fs');
+const path = require('path');
+const { readNativeTables } = require('./native-tables');
+
+const root = path.join(__dirname, '..');
+const outputPath = path.join(root, 'src', 'core', 'fallback-core.ts');
+
+const { modes, ops, ticks } = readNativeTables();
+
+/* code fragments; locals: a x y sp p pc ea value result crossed cycles */
+
+const group = v => (/^\w+$/.test(v) ? v : `(${v})`);
+const nz = v => `p = (p & 0x7D) | (${v} === 0 ? 0x02 : 0) | (${v} & 0x80);`;
+const push = v => [`write(0x100 + sp, ${v});`, 'sp = (sp - 1) & 0xFF;'];
+const push16 = v => [
+  `write(0x100 + sp, ${group(v)} >> 8);`,
+  `write(0x100 + ((sp - 1) & 0xFF), ${group(v)} & 0xFF);`,
+  'sp = (sp - 2) & 0xFF;'
+];
+const pull = target => ['sp = (sp + 1) & 0xFF;', `${target} = read(0x100 + sp);`];
+const pull16 = target => [
+  `${target} = read(0x100 + ((sp + 1) & 0xFF)) | (read(0x100 + ((sp + 2) & 0xFF)) << 8);`,
+  'sp = (sp + 2) & 0xFF;'
+];
+const word = at => `read(${at}) | (read((${at} + 1) & 0xFFFF) << 8)`;
+
+const addressing = {
+  imp: () => [],
+  acc: () => [],
+  imm: () => ['ea = pc;', 'pc = (pc + 1) & 0xFFFF;'],
+  zp: () => ['ea = read(pc);', 'pc = (pc + 1) & 0xFFFF;'],
+  zpx: () => ['ea = (read(pc) + x) & 0xFF;', 'pc = (pc + 1) & 0xFFFF;'],
+  zpy: () => ['ea = (read(pc) + y) & 0xFF;', 'pc = (pc + 1) & 0xFFFF;'],
+  rel: () => ['ea = read(pc);', 'pc = (pc + 1) & 0xFFFF;'],
+  abso: () => [`ea = ${word('pc')};`, 'pc = (pc + 2) & 0xFFFF;'],
+  absx: penalty => indexed('x', penalty),
+  absy: penalty => indexed('y', penalty),
+  // The 6502 does not carry into the high byte of the pointer
+  ind: () => [
+    `value = ${word('pc')};`,
+    'ea = read(value) | (read((value & 0xFF00) | ((value + 1) & 0xFF)) << 8);',
+    'pc = (pc + 2) & 0xFFFF;'
+  ],
+  indx: () => [
+    'value = (read(pc) + x) & 0xFF;',
+    'pc = (pc + 1) & 0xFFFF;',
+    'ea = read(value) | (read((value + 1) & 0xFF) << 8);'
+  ],
+  indy: penalty => [
+    'value = read(pc);',
+    'pc = (pc + 1) & 0xFFFF;',
+    'value = read(value) | (read((value + 1) & 0xFF) << 8);',
+    'ea = (value + y) & 0xFFFF;',
+    ...(penalty ? ['crossed = (value ^ ea) & 0xFF00;'] : [])
+  ]
+};
+
+function indexed(register, penalty) {
+  return [
+    `value = ${word('pc')};`,
+    `ea = (value + ${register}) & 0xFFFF;`,
+    ...(penalty ? ['crossed = (value ^ ea) & 0xFF00;'] : []),
+    'pc = (pc + 2) & 0xFFFF;'
+  ];
+}
+
+// ctx.acc: operand is the accumulator
+const operand = ctx => (ctx.acc ? 'a' : 'read(ea)');
+const store = (ctx, v) => (ctx.acc ? `a = ${v};` : `write(ea, ${v});`);
+const adc = v => [
+  `value = ${v};`,
+  'result = a + value + (p & 0x01);',
+  'p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |',
+  '  ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);',
+  'a = result & 0xFF;'
+];
+const compare = (register, v) => [
+  `value = ${v};`,
+  `p = (p & 0x7C) | (${register} >= value ? 0x01 : 0) | (${register} === value ? 0x02 : 0) | ((${register} - value) & 0x80);`
+];
+const logic = (operator, ctx) => [`a = a ${operator} ${operand(ctx)};`, nz('a')];
+const load = (register, ctx) => [`${register} = ${operand(ctx)};`, nz(register)];
+const transfer = (to, from) => [`${to} = ${from};`, nz(to)];
+const shift = (ctx, expression, carry) => [
+  `value = ${operand(ctx)};`,
+  `result = ${expression};`,
+  `p = (p & 0x7C) | (${carry}) | (result === 0 ? 0x02 : 0) | (result & 0x80);`,
+  store(ctx, 'result')
+];
+const step = (ctx, delta) => [
+  `result = (${operand(ctx)} ${delta}) & 0xFF;`,
+  nz('result'),
+  store(ctx, 'result')
+];
+const branch = condition => [
+  `if (${condition}) {`,
+  '  result = (pc + ((ea ^ 0x80) - 0x80)) & 0xFFFF;',
+  '  cycles += (pc ^ result) & 0xFF00 ? 2 : 1;',
+  '  pc = result;',
+  '}'
+];
+
+const operations = {
+  adc: ctx => adc(operand(ctx)),
+  and: ctx => logic('&', ctx),
+  asl: ctx => shift(ctx, '(value << 1) & 0xFF', 'value >> 7'),
+  bcc: () => branch('(p & 0x01) === 0'),
+  bcs: () => branch('(p & 0x01) !== 0'),
+  beq: () => branch('(p & 0x02) !== 0'),
+  bit: ctx => [
+    `value = ${operand(ctx)};`,
+    'p = (p & 0x3D) | ((a & value) === 0 ? 0x02 : 0) | (value & 0xC0);'
+  ],
+  bmi: () => branch('(p & 0x80) !== 0'),
+  bne: () => branch('(p & 0x02) === 0'),
+  bpl: () => branch('(p & 0x80) === 0'),
+  brk: () => [
+    'pc = (pc + 1) & 0xFFFF;',
+    ...push16('pc'),
+    ...push('p | 0x10'),
+    'p |= 0x04;',
+    'pc = read(0xFFFE) | (read(0xFFFF) << 8);'
+  ],
+  bvc: () => branch('(p & 0x40) === 0'),
+  bvs: () => branch('(p & 0x40) !== 0'),
+  clc: () => ['p &= ~0x01;'],
+  cld: () => ['p &= ~0x08;'],
+  cli: () => ['p &= ~0x04;'],
+  clv: () => ['p &= ~0x40;'],
+  cmp: ctx => compare('a', operand(ctx)),
+  cpx: ctx => compare('x', operand(ctx)),
+  cpy: ctx => compare('y', operand(ctx)),
+  dec: ctx => step(ctx, '- 1'),
+  dex: () => ['x = (x - 1) & 0xFF;', nz('x')],
+  dey: () => ['y = (y - 1) & 0xFF;', nz('y')],
+  eor: ctx => logic('^', ctx),
+  inc: ctx => step(ctx, '+ 1'),
+  inx: () => ['x = (x + 1) & 0xFF;', nz('x')],
+  iny: () => ['y = (y + 1) & 0xFF;', nz('y')],
+  jmp: () => ['pc = ea;'],
+  jsr: () => [...push16('(pc - 1) & 0xFFFF'), 'pc = ea;'],
+  lda: ctx => load('a', ctx),
+  ldx: ctx => load('x', ctx),
+  ldy: ctx => load('y', ctx),
+  lsr: ctx => shift(ctx, 'value >> 1', 'value & 0x01'),
+  nop: () => [],
+  ora: ctx => logic('|', ctx),
+  pha: () => push('a'),
+  php: () => push('p | 0x10'),
+  pla: () => [...pull('a'), nz('a')],
+  plp: () => [...pull('p'), 'p |= 0x20;'],
+  rol: ctx => shift(ctx, '((value << 1) | (p & 0x01)) & 0xFF', 'value >> 7'),
+  ror: ctx => shift(ctx, '(value >> 1) | ((p & 0x01) << 7)', 'value & 0x01'),
+  rti: () => [...pull('p'), ...pull16('pc')],
+  rts: () => [...pull16('pc'), 'pc = (pc + 1) & 0xFFFF;'],
+  sbc: ctx => adc(`${operand(ctx)} ^ 0xFF`),
+  sec: () => ['p |= 0x01;'],
+  sed: () => ['p |= 0x08;'],
+  sei: () => ['p |= 0x04;'],
+  sta: ctx => [store(ctx, 'a')],
+  stx: ctx => [store(ctx, 'x')],
+  sty: ctx => [store(ctx, 'y')],
+  tax: () => transfer('x', 'a'),
+  tay: () => transfer('y', 'a'),
+  tsx: () => transfer('x', 'sp'),
+  txa: () => transfer('a', 'x'),
+  txs: () => ['sp = x;'],
+  tya: () => transfer('a', 'y'),
+  // Undocumented: combinations of the above, with the same memory accesses
+  lax: ctx => [...load('a', ctx), ...load('x', ctx)],
+  sax: ctx => [store(ctx, 'a'), store(ctx, 'x'), store(ctx, 'a & x')],
+  dcp: ctx => [...operations.dec(ctx), ...operations.cmp(ctx)],
+  isb: ctx => [...operations.inc(ctx), ...operations.sbc(ctx)],
+  slo: ctx => [...operations.asl(ctx), ...operations.ora(ctx)],
+  rla: ctx => [...operations.rol(ctx), ...operations.and(ctx)],
+  sre: ctx => [...operations.lsr(ctx), ...operations.eor(ctx)],
+  rra: ctx => [...operations.ror(ctx), ...operations.adc(ctx)]
+};
+
+// Operations that take an extra cycle when the address crosses a page;
+// the undocumented read-modify-write ops cancel it in the native core
+const PENALTY_OPS = new Set(['adc', 'and', 'cmp', 'eor', 'lda', 'ldx', 'ldy', 'ora', 'sbc', 'lax']);
+const PENALTY_NOPS = new Set([0x1C, 0x3C, 0x5C, 0x7C, 0xDC, 0xFC]);
+const PENALTY_MODES = new Set(['absx', 'absy', 'indy']);
+
+const hex = n => `0x${n.toString(16).toUpperCase().padStart(2, '0')}`;
+
+function generateCase(opcode) {
+  const mode = modes[opcode];
+  const op = ops[opcode];
+  if (!addressing[mode] || !operations[op]) {
+    throw new Error(`Unsupported opcode ${hex(opcode)}: ${op} ${mode}`);
+  }
+
+  const penalty = PENALTY_MODES.has(mode) && (PENALTY_OPS.has(op) || (op === 'nop' && PENALTY_NOPS.has(opcode)));
+  const lines = [
+    ...addressing[mode](penalty),
+    `cycles = ${ticks[opcode]}${penalty ? ' + (crossed ? 1 : 0)' : ''};`,
+    ...operations[op]({ acc: mode === 'acc' }),
+    'break;'
+  ];
+  return [`      case ${hex(opcode)}: // ${op.toUpperCase()} ${mode}`, ...lines.map(line => `        ${line}`)].join('\n');
+}
+
+const cases = Array.from({ length: 256 }, (_, opcode) => generateCase(opcode)).join('\n');
+
+const LENGTHS = { imp: 1, acc: 1, imm: 2, zp: 2, zpx: 2, zpy: 2, rel: 2, indx: 2, indy: 2, abso: 3, absx: 3, absy: 3, ind: 3 };
+const lengthRows = Array.from({ length: 16 }, (_, row) =>
+  `  ${modes.slice(row * 16, row * 16 + 16).map(mode => LENGTHS[mode]).join(', ')}`).join(',\n');
+const nameRows = names => Array.from({ length: 16 }, (_, row) =>
+  `  ${names.slice(row * 16, row * 16 + 16).map(name => `'${name}'`).join(', ')}`).join(',\n');
+
+const output = `/**
+ * Pure TypeScript 6502 core
+ * GENERATED by scripts/generate-fallback-core.js from the tables in
+ * native/fake6502_improved.h; do not edit by hand.
+ *
+ * Used by CPU6502Emulator when the native addon is unavailable. It follows
+ * the native core instruction for instruction (no decimal mode, undocumented
+ * opcodes, the same cycle counts and page-crossing penalties, the same
+ * interrupt handling). Registers live in typed arrays and step() allocates
+ * nothing.
+ */
+
+export type CoreReadCallback = (address: number) => number;
+export type CoreWriteCallback = (address: number, value: number) => void;
+
+// Indices into FallbackCore.registers
+export const REG_A = 0;
+export const REG_X = 1;
+export const REG_Y = 2;
+export const REG_SP = 3;
+export const REG_P = 4;
+
+// Bytes per instruction, opcode and operands, by opcode
+export const INSTRUCTION_LENGTH = Uint8Array.from([
+${lengthRows}
+]);
+
+// Addressing mode and operation by opcode, as named in the native tables
+export const ADDRESSING_MODE: readonly string[] = [
+${nameRows(modes)}
+];
+
+export const OPERATION: readonly string[] = [
+${nameRows(ops)}
+];
+
+export class FallbackCore {
+  readonly registers = new Uint8Array(5);
+  readonly pc = new Uint16Array(1);
+  cycles = 0;
+  opcode = -1;  // Last instruction executed; -1 after interrupt entry
+  irqPending = false;
+  nmiPending = false;
+  read: CoreReadCallback = () => 0xFF;
+  write: CoreWriteCallback = () => {};
+
+  /**
+   * Power-on state of the native core, starting at the given address
+   */
+  reset(pc: number): void {
+    this.registers.set([0, 0, 0, 0xFD, 0x24]);
+    this.pc[0] = pc;
+    this.cycles = 0;
+    this.opcode = -1;
+    this.irqPending = false;
+    this.nmiPending = false;
+  }
+
+  /**
+   * Service a latched interrupt or execute one instruction
+   * @returns Cycles consumed
+   */
+  step(): number {
+    const registers = this.registers;
+    const read = this.read;
+    const write = this.write;
+    let a = registers[REG_A];
+    let x = registers[REG_X];
+    let y = registers[REG_Y];
+    let sp = registers[REG_SP];
+    let p = registers[REG_P];
+    let pc = this.pc[0];
+    let ea = 0;
+    let value = 0;
+    let result = 0;
+    let crossed = 0;
+    let cycles = 7;
+    let opcode = -1;
+
+    if (this.nmiPending) {
+      this.nmiPending = false;
+${[...push16('pc'), ...push('p & ~0x10'), 'p |= 0x04;', 'pc = read(0xFFFA) | (read(0xFFFB) << 8);'].map(l => `      ${l}`).join('\n')}
+    } else if (this.irqPending) {
+      // A masked IRQ is dropped, as in the native core
+      this.irqPending = false;
+      if ((p & 0x04) === 0) {
+${[...push16('pc'), ...push('p & ~0x10'), 'p |= 0x04;', 'pc = read(0xFFFE) | (read(0xFFFF) << 8);'].map(l => `        ${l}`).join('\n')}
+      }
+    } else {
+      opcode = read(pc);
+      pc = (pc + 1) & 0xFFFF;
+      p |= 0x20;
+
+      switch (opcode) {
+${cases.replace(/^/gm, '  ')}
+      }
+    }
+
+    registers[REG_A] = a;
+    registers[REG_X] = x;
+    registers[REG_Y] = y;
+    registers[REG_SP] = sp;
+    registers[REG_P] = p;
+    this.pc[0] = pc;
+    this.cycles += cycles;
+    this.opcode = opcode;
+    return cycles;
+  }
+}
+`;
+
+if (process.argv.includes('--check')) {
+  const current = fs.existsSync(outputPath) ? fs.readFileSync(outputPath, 'utf8') : '';
+  if (current !== output) {
+    console.error(`${path.relative(root, outputPath)} is out of date; run node scripts/generate-fallback-core.js`);
+    process.exit(1);
+  }
+} else {
+  fs.writeFileSync(outputPath, output);
+  console.log(`Wrote ${path.relative(root, outputPath)}`);
+}
@@ -0,0 +1,39 @@
+/**
+ * Opcode tables of the native core
+ *
+ * Reads addrtable, optable and ticktable from native/fake6502_improved.h for
+ * the generators that derive other cores from them.
+ */
+
+const fs = require('fs');
+const path = require('path');
+
+const headerPath = path.join(__dirname, '..', 'native', 'fake6502_improved.h');
+
+function readTable(source, name) {
+  const match = source.match(new RegExp(`${name}\\[256\\]\\)?(?:\\(\\))? = \\{([\\s\\S]*?)\\};`));
+  if (!match) {
+    throw new Error(`Table ${name} not found in ${headerPath}`);
+  }
+  const entries = match[1]
+    .replace(/\/\*[\s\S]*?\*\//g, '')
+    .split(/[\s,]+/)
+    .filter(entry => entry.length > 0);
+  if (entries.length !== 256) {
+    throw new Error(`Table ${name} has ${entries.length} entries`);
+  }
+  return entries;
+}
+
+// Addressing mode, operation and base cycle count by opcode, named as in
+// the header (brk_6502 becomes brk)
+function readNativeTables() {
+  const source = fs.readFileSync(headerPath, 'utf8');
+  return {
+    modes: readTable(source, 'addrtable'),
+    ops: readTable(source, 'optable').map(op => (op === 'brk_6502' ? 'brk' : op)),
+    ticks: readTable(source, 'ticktable').map(Number)
+  };
+}
+
+module.exports = { headerPath, readNativeTables };
@@ -3,11 +3,14 @@
  * Integrates symbol parsing and memory layout for CC65 toolchain compatibility
  */
 
+import fs from 'fs';
 import { CC65SymbolParser, CC65SymbolTable, CC65Symbol } from './symbol-parser';
+import { CC65DebugInfoParser, CC65LineRange } from './debug-info';
 import { CC65MemoryConfigurator, CC65MemoryLayout, CC65Runtime } from './memory-layout';
 
 export interface CC65Config {
   symbolFile?: string;
+  debugFile?: string;     // ld65 --dbgfile output, for source line mapping
   memoryLayout: 'apple2' | 'c64' | 'homebrew' | 'custom';
   customLayout?: {
     ramStart: number;
@@ -29,6 +32,7 @@ export interface CC65DebugInfo {
 export class CC65CompatibilityManager {
   private symbolParser: CC65SymbolParser;
   private symbols?: CC65SymbolTable;
+  private debugInfo?: CC65DebugInfoParser;
   private layout?: CC65MemoryLayout;
   private runtime?: CC65Runtime;
 
@@ -50,6 +54,9 @@ export class CC65CompatibilityManager {
     if (config.symbolFile) {
       await this.loadSymbolFile(config.symbolFile);
     }
+    if (config.debugFile) {
+      await this.loadDebugFile(config.debugFile);
+    }
 
     return {
       symbols: this.symbols || { symbols: new Map(), addressToSymbol: new Map(), fileSymbols: new Map() },
@@ -72,6 +79,42 @@ export class CC65CompatibilityManager {
     }
   }
 
+  /**
+   * Load an ld65 debug info file for source line mapping
+   * Its labels and equates replace the loaded symbols.
+   */
+  async loadDebugFile(filePath: string): Promise<void> {
+    try {
+      const debugInfo = new CC65DebugInfoParser();
+      await debugInfo.parseDebugStream(fs.createReadStream(filePath, 'utf8'));
+      this.debugInfo = debugInfo;
+      this.symbols = this.symbolParser.loadDebugInfo(debugInfo);
+    } catch (error) {
+      throw new Error(`Failed to load debug info file ${filePath}: ${error}`);
+    }
+  }
+
+  /**
+   * Source line and innermost named scope of the code at address
+   */
+  getSourceLocation(address: number): { file: string; line: number; scope?: string } | undefined {
+    const location = this.debugInfo ? this.debugInfo.getLineAt(address) : undefined;
+    if (!location) {
+      return undefined;
+    }
+    const scope = this.debugInfo!.getScopeAt(address);
+    const scopeName = scope ? this.debugInfo!.getScopeName(scope) : '';
+    return { file: location.file, line: location.line, scope: scopeName || undefined };
+  }
+
+  /**
+   * Address ranges of the source lines that generated code, empty without
+   * a debug info file
+   */
+  getLineRanges(segmentNames?: string[]): CC65LineRange[] {
+    return this.debugInfo ? this.debugInfo.getLineRanges(segmentNames) : [];
+  }
+
   /**
    * Create memory layout based on configuration
    */
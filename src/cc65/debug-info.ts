@@ -0,0 +1,568 @@
+/**
+ * CC65 Debug Info Parser
+ * Parses the debug info files written by ld65 --dbgfile: files, libraries,
+ * modules, segments, spans, scopes, lines, symbols, C symbols and types.
+ * Records are parsed one line at a time so large files can be streamed,
+ * then spans are indexed as sorted, non-overlapping address intervals for
+ * O(log n) address to scope and address to line lookups.
+ */
+
+import readline from 'readline';
+
+export interface CC65SourceFile {
+  id: number;
+  name: string;
+  size: number;
+  mtime: number;
+  modules: number[];
+}
+
+export interface CC65Library {
+  id: number;
+  name: string;
+}
+
+export interface CC65Module {
+  id: number;
+  name: string;
+  file: number;         // Main source file
+  library: number;      // -1 when not linked from a library
+}
+
+export interface CC65Segment {
+  id: number;
+  name: string;
+  start: number;
+  size: number;
+  addressSize: string;
+  type: string;         // ro or rw
+  outputName?: string;
+  outputOffset?: number;
+}
+
+export interface CC65Span {
+  id: number;
+  segment: number;
+  start: number;        // Absolute address
+  size: number;
+  type: number;         // -1 when untyped
+}
+
+export interface CC65Scope {
+  id: number;
+  name: string;
+  module: number;
+  type: string;         // global, file, scope, struct or enum
+  size: number;
+  parent: number;       // -1 for a module's root scope
+  symbol: number;       // Symbol naming the scope (.proc), -1 if none
+  spans: number[];
+}
+
+export interface CC65SourceLine {
+  id: number;
+  file: number;
+  line: number;
+  type: number;         // 0 assembler, 1 external (C) source, 2 macro expansion
+  count: number;        // Macro nesting
+  spans: number[];
+}
+
+export interface CC65DebugSymbol {
+  id: number;
+  name: string;
+  type: string;         // lab, equ or imp
+  addressSize: string;
+  value: number;        // NaN for imports
+  size: number;
+  scope: number;
+  parent: number;       // Parent of a cheap local symbol, -1 if none
+  segment: number;      // -1 for equates and imports
+  definitions: number[];  // Line ids
+  references: number[];
+  exportId: number;     // Export an import resolves to, -1 if none
+}
+
+export interface CC65CSymbol {
+  id: number;
+  name: string;
+  scope: number;
+  type: number;
+  storage: string;      // auto, reg, static or ext
+  offset: number;
+  symbol: number;       // Assembler symbol, -1 if none
+}
+
+export interface CC65DebugType {
+  id: number;
+  value: string;        // Encoded type string
+}
+
+/**
+ * Source position of an address
+ */
+export interface CC65SourceLocation {
+  file: string;
+  line: number;
+  type: number;
+}
+
+/**
+ * Bytes generated for one source line, end exclusive
+ */
+export interface CC65LineRange {
+  file: string;
+  line: number;
+  start: number;
+  end: number;
+}
+
+// Segments that hold code in the standard cc65 linker configurations
+export const CC65_CODE_SEGMENTS = ['STARTUP', 'ONCE', 'LOWCODE', 'CODE'];
+
+export const LINE_TYPE_ASSEMBLER = 0;
+export const LINE_TYPE_EXTERNAL = 1;
+export const LINE_TYPE_MACRO = 2;
+
+interface Interval {
+  start: number;
+  end: number;
+  id: number;
+}
+
+/**
+ * Disjoint address intervals sorted by start, each owned by the innermost
+ * (smallest) entry that covered it
+ */
+class IntervalIndex {
+  private starts: Uint32Array;
+  private ends: Uint32Array;
+  private ids: Int32Array;
+
+  constructor(intervals: Interval[]) {
+    // Elementary intervals between every pair of adjacent boundaries
+    const bounds = Array.from(new Set(intervals.flatMap(interval => [interval.start, interval.end]))).sort((a, b) => a - b);
+    const owners = new Int32Array(Math.max(0, bounds.length - 1)).fill(-1);
+
+    // Paint the largest first so inner entries overwrite the outer ones
+    const sorted = intervals.slice().sort((a, b) => (b.end - b.start) - (a.end - a.start) || a.id - b.id);
+    for (const interval of sorted) {
+      for (let i = lowerBound(bounds, interval.start); bounds[i] < interval.end; i++) {
+        owners[i] = interval.id;
+      }
+    }
+
+    const starts: number[] = [];
+    const ends: number[] = [];
+    const ids: number[] = [];
+    for (let i = 0; i < owners.length; i++) {
+      const last = ids.length - 1;
+      if (owners[i] < 0) {
+        continue;
+      }
+      if (last >= 0 && ids[last] === owners[i] && ends[last] === bounds[i]) {
+        ends[last] = bounds[i + 1];
+      } else {
+        starts.push(bounds[i]);
+        ends.push(bounds[i + 1]);
+        ids.push(owners[i]);
+      }
+    }
+    this.starts = Uint32Array.from(starts);
+    this.ends = Uint32Array.from(ends);
+    this.ids = Int32Array.from(ids);
+  }
+
+  /**
+   * Entry covering address, or -1
+   */
+  find(address: number): number {
+    let low = 0;
+    let high = this.starts.length - 1;
+    while (low <= high) {
+      const middle = (low + high) >>> 1;
+      if (this.starts[middle] <= address) {
+        low = middle + 1;
+      } else {
+        high = middle - 1;
+      }
+    }
+    return high >= 0 && address < this.ends[high] ? this.ids[high] : -1;
+  }
+}
+
+function lowerBound(values: number[], value: number): number {
+  let low = 0;
+  let high = values.length;
+  while (low < high) {
+    const middle = (low + high) >>> 1;
+    if (values[middle] < value) {
+      low = middle + 1;
+    } else {
+      high = middle;
+    }
+  }
+  return low;
+}
+
+export class CC65DebugInfoParser {
+  private files = new Map<number, CC65SourceFile>();
+  private libraries = new Map<number, CC65Library>();
+  private modules = new Map<number, CC65Module>();
+  private segments = new Map<number, CC65Segment>();
+  private spans = new Map<number, CC65Span>();
+  private scopes = new Map<number, CC65Scope>();
+  private lines = new Map<number, CC65SourceLine>();
+  private symbols = new Map<number, CC65DebugSymbol>();
+  private cSymbols = new Map<number, CC65CSymbol>();
+  private types = new Map<number, CC65DebugType>();
+  private symbolsByName = new Map<string, CC65DebugSymbol[]>();
+
+  // Built by finish()
+  private scopeIndex = new IntervalIndex([]);
+  private assemblerLineIndex = new IntervalIndex([]);
+  private externalLineIndex = new IntervalIndex([]);
+  private labelAddresses = new Uint32Array(0);
+  private labelIds = new Int32Array(0);
+
+  /**
+   * Parse debug info file content
+   * Format: one record per line, a type then comma separated key=value
+   * pairs, e.g. line\tid=3,file=0,line=12,span=4+5
+   */
+  parseDebugFile(content: string): void {
+    this.clear();
+    let start = 0;
+    while (start < content.length) {
+      let end = content.indexOf('\n', start);
+      if (end === -1) {
+        end = content.length;
+      }
+      this.addRecord(content.substring(start, end));
+      start = end + 1;
+    }
+    this.finish();
+  }
+
+  /**
+   * Parse a debug info file as it is read, without holding its text
+   */
+  async parseDebugStream(input: NodeJS.ReadableStream): Promise<void> {
+    this.clear();
+    const lines = readline.createInterface({ input, crlfDelay: Infinity });
+    for await (const line of lines) {
+      this.addRecord(line);
+    }
+    this.finish();
+  }
+
+  private clear(): void {
+    for (const map of [this.files, this.libraries, this.modules, this.segments, this.spans, this.scopes,
+      this.lines, this.symbols, this.cSymbols, this.types, this.symbolsByName]) {
+      map.clear();
+    }
+  }
+
+  private addRecord(record: string): void {
+    const tab = record.search(/\s/);
+    if (tab <= 0) {
+      return;
+    }
+    const fields = this.parseFields(record.substring(tab + 1));
+    const id = this.number(fields, 'id');
+    switch (record.substring(0, tab)) {
+      case 'version':
+        if (this.number(fields, 'major') !== 2) {
+          throw new Error(`Unsupported debug info version ${fields.get('major')}.${fields.get('minor')}`);
+        }
+        break;
+      case 'file':
+        this.files.set(id, {
+          id, name: fields.get('name') || '', size: this.number(fields, 'size'), mtime: this.number(fields, 'mtime'),
+          modules: this.list(fields, 'mod')
+        });
+        break;
+      case 'lib':
+        this.libraries.set(id, { id, name: fields.get('name') || '' });
+        break;
+      case 'mod':
+        this.modules.set(id, {
+          id, name: fields.get('name') || '', file: this.number(fields, 'file'), library: this.number(fields, 'lib', -1)
+        });
+        break;
+      case 'seg':
+        this.segments.set(id, {
+          id,
+          name: fields.get('name') || '',
+          start: this.number(fields, 'start'),
+          size: this.number(fields, 'size'),
+          addressSize: fields.get('addrsize') || 'absolute',
+          type: fields.get('type') || 'ro',
+          outputName: fields.get('oname'),
+          outputOffset: fields.has('ooffs') ? this.number(fields, 'ooffs') : undefined
+        });
+        break;
+      case 'span':
+        // Relative to the segment until finish(), as segments may come later
+        this.spans.set(id, {
+          id, segment: this.number(fields, 'seg'), start: this.number(fields, 'start'), size: this.number(fields, 'size'),
+          type: this.number(fields, 'type', -1)
+        });
+        break;
+      case 'scope':
+        this.scopes.set(id, {
+          id,
+          name: fields.get('name') || '',
+          module: this.number(fields, 'mod'),
+          type: fields.get('type') || 'scope',
+          size: this.number(fields, 'size'),
+          parent: this.number(fields, 'parent', -1),
+          symbol: this.number(fields, 'sym', -1),
+          spans: this.list(fields, 'span')
+        });
+        break;
+      case 'line':
+        this.lines.set(id, {
+          id, file: this.number(fields, 'file'), line: this.number(fields, 'line'), type: this.number(fields, 'type'),
+          count: this.number(fields, 'count'), spans: this.list(fields, 'span')
+        });
+        break;
+      case 'sym': {
+        const symbol: CC65DebugSymbol = {
+          id,
+          name: fields.get('name') || '',
+          type: fields.get('type') || 'lab',
+          addressSize: fields.get('addrsize') || 'absolute',
+          value: fields.has('val') ? this.number(fields, 'val') : NaN,
+          size: this.number(fields, 'size'),
+          scope: this.number(fields, 'scope', -1),
+          parent: this.number(fields, 'parent', -1),
+          segment: this.number(fields, 'seg', -1),
+          definitions: this.list(fields, 'def'),
+          references: this.list(fields, 'ref'),
+          exportId: this.number(fields, 'exp', -1)
+        };
+        this.symbols.set(id, symbol);
+        const named = this.symbolsByName.get(symbol.name);
+        if (named) {
+          named.push(symbol);
+        } else {
+          this.symbolsByName.set(symbol.name, [symbol]);
+        }
+        break;
+      }
+      case 'csym':
+        this.cSymbols.set(id, {
+          id, name: fields.get('name') || '', scope: this.number(fields, 'scope', -1), type: this.number(fields, 'type'),
+          storage: fields.get('sc') || 'auto', offset: this.number(fields, 'offs'), symbol: this.number(fields, 'sym', -1)
+        });
+        break;
+      case 'type':
+        this.types.set(id, { id, value: fields.get('val') || '' });
+        break;
+    }
+  }
+
+  private parseFields(text: string): Map<string, string> {
+    const fields = new Map<string, string>();
+    // Quoted values may contain commas
+    const pattern = /([a-z]+)=("(?:[^"\\]|\\.)*"|[^,\r]*)/g;
+    let match;
+    while ((match = pattern.exec(text)) !== null) {
+      const value = match[2];
+      fields.set(match[1], value.startsWith('"') ? value.slice(1, -1).replace(/\\(.)/g, '$1') : value);
+    }
+    return fields;
+  }
+
+  private number(fields: Map<string, string>, key: string, missing: number = 0): number {
+    const value = fields.get(key);
+    // Decimal or 0x hex
+    return value ? Number(value) || 0 : missing;
+  }
+
+  // Ids joined with +
+  private list(fields: Map<string, string>, key: string): number[] {
+    const value = fields.get(key);
+    return value ? value.split('+').map(id => parseInt(id, 10)) : [];
+  }
+
+  /**
+   * Make span addresses absolute and build the lookup indexes
+   */
+  private finish(): void {
+    for (const span of this.spans.values()) {
+      const segment = this.segments.get(span.segment);
+      span.start += segment ? segment.start : 0;
+    }
+
+    const intervals = (ids: number[], owner: number) => ids.map(id => this.spans.get(id))
+      .filter((span): span is CC65Span => span !== undefined && span.size > 0)
+      .map(span => ({ start: span.start, end: span.start + span.size, id: owner }));
+
+    this.scopeIndex = new IntervalIndex(Array.from(this.scopes.values()).flatMap(scope => intervals(scope.spans, scope.id)));
+    const assembler: Interval[] = [];
+    const external: Interval[] = [];
+    for (const line of this.lines.values()) {
+      if (line.type === LINE_TYPE_ASSEMBLER) {
+        assembler.push(...intervals(line.spans, line.id));
+      } else if (line.type === LINE_TYPE_EXTERNAL) {
+        external.push(...intervals(line.spans, line.id));
+      }
+    }
+    this.assemblerLineIndex = new IntervalIndex(assembler);
+    this.externalLineIndex = new IntervalIndex(external);
+
+    const labels = Array.from(this.symbols.values())
+      .filter(symbol => symbol.type === 'lab' && !isNaN(symbol.value))
+      .sort((a, b) => a.value - b.value || a.id - b.id);
+    this.labelAddresses = Uint32Array.from(labels, symbol => symbol.value);
+    this.labelIds = Int32Array.from(labels, symbol => symbol.id);
+  }
+
+  /**
+   * Innermost scope containing address
+   */
+  getScopeAt(address: number): CC65Scope | undefined {
+    return this.scopes.get(this.scopeIndex.find(address));
+  }
+
+  /**
+   * Fully qualified name of a scope, e.g. "main::loop"; empty for the
+   * global scope
+   */
+  getScopeName(scope: CC65Scope): string {
+    const names: string[] = [];
+    for (let current: CC65Scope | undefined = scope; current && current.name; current = this.scopes.get(current.parent)) {
+      names.unshift(current.name);
+    }
+    return names.join('::');
+  }
+
+  /**
+   * Source line that generated the byte at address; the C line when the
+   * code was compiled from C, unless assembler is set
+   */
+  getLineAt(address: number, assembler: boolean = false): CC65SourceLocation | undefined {
+    let id = assembler ? -1 : this.externalLineIndex.find(address);
+    if (id < 0) {
+      id = this.assemblerLineIndex.find(address);
+    }
+    const line = this.lines.get(id);
+    const file = line ? this.files.get(line.file) : undefined;
+    return line && file ? { file: file.name, line: line.line, type: line.type } : undefined;
+  }
+
+  /**
+   * Label at or before address, with the offset of address from it
+   */
+  getNearestLabel(address: number): { symbol: CC65DebugSymbol; offset: number } | undefined {
+    let low = 0;
+    let high = this.labelAddresses.length - 1;
+    while (low <= high) {
+      const middle = (low + high) >>> 1;
+      if (this.labelAddresses[middle] <= address) {
+        low = middle + 1;
+      } else {
+        high = middle - 1;
+      }
+    }
+    if (high < 0) {
+      return undefined;
+    }
+    // The first label defined at that address
+    const value = this.labelAddresses[high];
+    while (high > 0 && this.labelAddresses[high - 1] === value) {
+      high--;
+    }
+    return { symbol: this.symbols.get(this.labelIds[high])!, offset: address - value };
+  }
+
+  /**
+   * Symbols with a name, one per scope that defines it
+   */
+  getSymbolsByName(name: string): CC65DebugSymbol[] {
+    return this.symbolsByName.get(name) || [];
+  }
+
+  getSymbol(id: number): CC65DebugSymbol | undefined {
+    return this.symbols.get(id);
+  }
+
+  getScope(id: number): CC65Scope | undefined {
+    return this.scopes.get(id);
+  }
+
+  getLine(id: number): CC65SourceLine | undefined {
+    return this.lines.get(id);
+  }
+
+  getFile(id: number): CC65SourceFile | undefined {
+    return this.files.get(id);
+  }
+
+  getModule(id: number): CC65Module | undefined {
+    return this.modules.get(id);
+  }
+
+  getLibrary(id: number): CC65Library | undefined {
+    return this.libraries.get(id);
+  }
+
+  getSpan(id: number): CC65Span | undefined {
+    return this.spans.get(id);
+  }
+
+  getType(id: number): CC65DebugType | undefined {
+    return this.types.get(id);
+  }
+
+  getFiles(): CC65SourceFile[] {
+    return Array.from(this.files.values());
+  }
+
+  getSegments(): CC65Segment[] {
+    return Array.from(this.segments.values());
+  }
+
+  getScopes(): CC65Scope[] {
+    return Array.from(this.scopes.values());
+  }
+
+  getSymbols(): CC65DebugSymbol[] {
+    return Array.from(this.symbols.values());
+  }
+
+  getCSymbols(): CC65CSymbol[] {
+    return Array.from(this.cSymbols.values());
+  }
+
+  /**
+   * Address ranges of the source lines that generated code
+   * Macro expansion lines are skipped; their bytes belong to the line that
+   * invoked the macro.
+   */
+  getLineRanges(segmentNames: string[] = CC65_CODE_SEGMENTS): CC65LineRange[] {
+    const segments = new Set<number>();
+    for (const segment of this.segments.values()) {
+      if (segmentNames.includes(segment.name)) {
+        segments.add(segment.id);
+      }
+    }
+
+    const ranges: CC65LineRange[] = [];
+    for (const line of this.lines.values()) {
+      const file = this.files.get(line.file);
+      if (!file || line.type === LINE_TYPE_MACRO) {
+        continue;
+      }
+      for (const id of line.spans) {
+        const span = this.spans.get(id);
+        if (span && span.size > 0 && segments.has(span.segment)) {
+          ranges.push({ file: file.name, line: line.line, start: span.start, end: span.start + span.size });
+        }
+      }
+    }
+    return ranges;
+  }
+}
@@ -0,0 +1,405 @@
+/**
+ * Host-accelerated cc65 runtime routines
+ * The layout matches cpu_hooks_t in native/fake6502.h: the native core
+ * runs the hooks itself, and runtimeHookStep below does the same for the
+ * TypeScript fallback core. When the PC reaches the entry of a hooked
+ * routine, the core performs the routine directly, returns as its RTS
+ * would and charges a fixed cycle cost instead of interpreting it. Only the
+ * routine's documented results are produced (return registers, C stack and
+ * memory), so code that relies on the scratch zero page a routine leaves
+ * behind must not be hooked; validation mode checks exactly that.
+ */
+
+import { CC65SymbolParser } from './symbol-parser';
+import { FallbackCore, REG_A, REG_X, REG_Y, REG_SP } from '../core/fallback-core';
+
+// Hook ids, matching CPU_HOOK_* in fake6502.h
+export const HOOK_PUSHAX = 1;
+export const HOOK_POPAX = 2;
+export const HOOK_MEMCPY = 3;
+export const HOOK_MEMSET = 4;
+export const HOOK_BZERO = 5;
+export const HOOK_STRLEN = 6;
+export const HOOK_TOSMULAX = 7;
+export const HOOK_UDIV16 = 8;
+export const HOOK_COUNT = 9;
+
+// config[]: zero page addresses of the runtime, then the mode
+export const HOOK_ZP_SP = 0;
+export const HOOK_ZP_PTR1 = 1;
+export const HOOK_ZP_PTR4 = 2;
+export const HOOK_ZP_SREG = 3;
+export const HOOK_VALIDATE = 4;
+export const HOOK_CONFIG = 5;
+
+// stats[]: per id, calls handled, cycles charged, calls validated,
+// mismatches, cycles the validated calls really took
+export const HOOK_STATS = 5;
+
+// mismatch[1] for a return register rather than an address
+export const HOOK_REGISTER = 0x10000;
+
+/**
+ * Routines that can be hooked: entry symbols, tried in order, and the zero
+ * page locations the hook uses
+ */
+export const RUNTIME_HOOK_ROUTINES: Record<string, { id: number; symbols: string[]; zeroPage: string[] }> = {
+  pushax: { id: HOOK_PUSHAX, symbols: ['pushax'], zeroPage: ['sp'] },
+  popax: { id: HOOK_POPAX, symbols: ['popax'], zeroPage: ['sp'] },
+  memcpy: { id: HOOK_MEMCPY, symbols: ['_memcpy'], zeroPage: ['sp'] },
+  memset: { id: HOOK_MEMSET, symbols: ['_memset'], zeroPage: ['sp'] },
+  bzero: { id: HOOK_BZERO, symbols: ['__bzero', '_bzero'], zeroPage: ['sp'] },
+  strlen: { id: HOOK_STRLEN, symbols: ['_strlen'], zeroPage: [] },
+  tosmulax: { id: HOOK_TOSMULAX, symbols: ['tosmulax', 'tosumulax'], zeroPage: ['sp'] },
+  udiv16: { id: HOOK_UDIV16, symbols: ['udiv16'], zeroPage: ['ptr1', 'ptr4', 'sreg'] }
+};
+
+// Zero page symbols per config entry; the C stack pointer was renamed to
+// c_sp in cc65 2.19
+const ZERO_PAGE_SYMBOLS: Record<string, { index: number; symbols: string[] }> = {
+  sp: { index: HOOK_ZP_SP, symbols: ['c_sp', 'sp'] },
+  ptr1: { index: HOOK_ZP_PTR1, symbols: ['ptr1'] },
+  ptr4: { index: HOOK_ZP_PTR4, symbols: ['ptr4'] },
+  sreg: { index: HOOK_ZP_SREG, symbols: ['sreg'] }
+};
+
+const OUT_A = 1;
+const OUT_X = 2;
+const OUT_Y = 4;
+
+interface HookResult {
+  a: number;
+  x: number;
+  y: number;
+  outputs: number;
+  cycles: number;
+}
+
+export interface CPURuntimeHooks {
+  map: Uint8Array;         // Per address: hook id of the routine entered there
+  config: Uint32Array;
+  costs: Uint32Array;      // Per id: cycles charged per call, 0 for the estimate
+  stats: Uint32Array;
+  mismatch: Uint32Array;   // Last difference: id, address, expected, actual
+  shadow: Uint8Array;      // Bytes as the hook wrote them while validating
+  written: Uint8Array;     // Bitmap of the bytes written to shadow
+  // Validated call still running, for the fallback core
+  check?: { id: number; returnPc: number; sp: number; start: number; result: HookResult };
+}
+
+export interface RuntimeHookOptions {
+  routines?: string[];               // Names from RUNTIME_HOOK_ROUTINES, default all
+  costs?: Record<string, number>;    // Cycles charged per call, by name
+  validate?: boolean;
+}
+
+export interface RuntimeHookStats {
+  routine: string;
+  address: number;
+  calls: number;
+  cycles: number;
+  validated: number;
+  mismatches: number;
+  realCycles: number;
+}
+
+export function createRuntimeHooks(): CPURuntimeHooks {
+  return {
+    map: new Uint8Array(0x10000),
+    config: new Uint32Array(HOOK_CONFIG),
+    costs: new Uint32Array(HOOK_COUNT),
+    stats: new Uint32Array(HOOK_COUNT * HOOK_STATS),
+    mismatch: new Uint32Array(4),
+    shadow: new Uint8Array(0x10000),
+    written: new Uint8Array(0x10000 / 8)
+  };
+}
+
+function findAddress(symbols: CC65SymbolParser, names: string[]): number | undefined {
+  for (const name of names) {
+    const address = symbols.getAddressForSymbol(name);
+    if (address !== undefined) {
+      return address;
+    }
+  }
+  return undefined;
+}
+
+/**
+ * Hooks for the runtime routines found in the program's symbols
+ * Routines whose entry or zero page locations are missing are left out;
+ * asking for an unknown routine name throws.
+ */
+export function resolveRuntimeHooks(symbols: CC65SymbolParser, options: RuntimeHookOptions = {}): CPURuntimeHooks {
+  const hooks = createRuntimeHooks();
+  const names = options.routines || Object.keys(RUNTIME_HOOK_ROUTINES);
+  for (const name of names) {
+    const routine = RUNTIME_HOOK_ROUTINES[name];
+    if (!routine) {
+      throw new Error(`Unknown runtime routine: ${name}`);
+    }
+    const entry = findAddress(symbols, routine.symbols);
+    const zeroPage = routine.zeroPage.map(location => findAddress(symbols, ZERO_PAGE_SYMBOLS[location].symbols));
+    if (entry === undefined || zeroPage.some(address => address === undefined || address > 0xFE)) {
+      continue;
+    }
+    routine.zeroPage.forEach((location, index) => {
+      hooks.config[ZERO_PAGE_SYMBOLS[location].index] = zeroPage[index]!;
+    });
+    hooks.map[entry & 0xFFFF] = routine.id;
+  }
+  for (const [name, cycles] of Object.entries(options.costs || {})) {
+    const routine = RUNTIME_HOOK_ROUTINES[name];
+    if (!routine) {
+      throw new Error(`Unknown runtime routine: ${name}`);
+    }
+    hooks.costs[routine.id] = cycles;
+  }
+  hooks.config[HOOK_VALIDATE] = options.validate ? 1 : 0;
+  return hooks;
+}
+
+/**
+ * Calls, charged cycles and validation results per hooked routine
+ */
+export function getRuntimeHookStats(hooks: CPURuntimeHooks): RuntimeHookStats[] {
+  const stats: RuntimeHookStats[] = [];
+  for (const [routine, { id }] of Object.entries(RUNTIME_HOOK_ROUTINES)) {
+    const address = hooks.map.indexOf(id);
+    if (address < 0) {
+      continue;
+    }
+    const base = id * HOOK_STATS;
+    stats.push({
+      routine,
+      address,
+      calls: hooks.stats[base],
+      cycles: hooks.stats[base + 1],
+      validated: hooks.stats[base + 2],
+      mismatches: hooks.stats[base + 3],
+      realCycles: hooks.stats[base + 4]
+    });
+  }
+  return stats;
+}
+
+/**
+ * Last validation difference, or null when every validated call matched
+ * @returns location is an address, or 'A'/'X' for a return register
+ */
+export function getRuntimeHookMismatch(hooks: CPURuntimeHooks):
+    { routine: string; location: number | 'A' | 'X'; expected: number; actual: number } | null {
+  const [id, where, expected, actual] = hooks.mismatch;
+  if (id === 0) {
+    return null;
+  }
+  const routine = Object.keys(RUNTIME_HOOK_ROUTINES).find(name => RUNTIME_HOOK_ROUTINES[name].id === id) || `${id}`;
+  const location = where === HOOK_REGISTER ? 'A' : where === HOOK_REGISTER + 1 ? 'X' : where;
+  return { routine, location, expected, actual };
+}
+
+/**
+ * Memory as a hook sees it: through shadow while validating
+ */
+class HookMemory {
+  constructor(private hooks: CPURuntimeHooks, private shadowing: boolean,
+              private read: (address: number) => number, private write: (address: number, value: number) => void) {}
+
+  byte(address: number): number {
+    address &= 0xFFFF;
+    if (this.shadowing && (this.hooks.written[address >> 3] & (1 << (address & 7)))) {
+      return this.hooks.shadow[address];
+    }
+    return this.read(address);
+  }
+
+  setByte(address: number, value: number): void {
+    address &= 0xFFFF;
+    if (this.shadowing) {
+      this.hooks.shadow[address] = value;
+      this.hooks.written[address >> 3] |= 1 << (address & 7);
+    } else {
+      this.write(address, value & 0xFF);
+    }
+  }
+
+  word(address: number): number {
+    return this.byte(address) | (this.byte(address + 1) << 8);
+  }
+
+  setWord(address: number, value: number): void {
+    this.setByte(address, value & 0xFF);
+    this.setByte(address + 1, (value >> 8) & 0xFF);
+  }
+
+  // Pop a word from the C stack
+  pop(): number {
+    const zp = this.hooks.config[HOOK_ZP_SP];
+    const stack = this.word(zp);
+    this.setWord(zp, (stack + 2) & 0xFFFF);
+    return this.word(stack);
+  }
+}
+
+// Same as hook_run in fake6502.c, estimates included
+function runHook(id: number, core: FallbackCore, memory: HookMemory, config: Uint32Array): HookResult | null {
+  const registers = core.registers;
+  const ax = registers[REG_A] | (registers[REG_X] << 8);
+  const result: HookResult = { a: registers[REG_A], x: registers[REG_X], y: registers[REG_Y], outputs: OUT_A | OUT_X, cycles: 0 };
+  const returnWord = (word: number) => {
+    result.a = word & 0xFF;
+    result.x = (word >> 8) & 0xFF;
+  };
+
+  switch (id) {
+    case HOOK_PUSHAX: {
+      const stack = (memory.word(config[HOOK_ZP_SP]) - 2) & 0xFFFF;
+      memory.setWord(config[HOOK_ZP_SP], stack);
+      memory.setWord(stack, ax);
+      result.y = 0;
+      result.outputs |= OUT_Y;
+      result.cycles = 39;
+      return result;
+    }
+    case HOOK_POPAX:
+      returnWord(memory.pop());
+      result.y = 0;
+      result.outputs |= OUT_Y;
+      result.cycles = 33;
+      return result;
+    case HOOK_MEMCPY: {
+      const source = memory.pop();
+      const destination = memory.pop();
+      for (let i = 0; i < ax; i++) {
+        memory.setByte(destination + i, memory.byte(source + i));
+      }
+      returnWord(destination);
+      result.cycles = 90 + 16 * ax;
+      return result;
+    }
+    case HOOK_MEMSET:
+    case HOOK_BZERO: {
+      const fill = id === HOOK_MEMSET ? memory.pop() & 0xFF : 0;
+      const destination = memory.pop();
+      for (let i = 0; i < ax; i++) {
+        memory.setByte(destination + i, fill);
+      }
+      returnWord(destination);
+      result.outputs = id === HOOK_MEMSET ? OUT_A | OUT_X : 0;
+      result.cycles = 70 + 11 * ax;
+      return result;
+    }
+    case HOOK_STRLEN: {
+      let length = 0;
+      while (memory.byte(ax + length) !== 0) {
+        if (length === 0xFFFF) {
+          return null;  // No terminator anywhere
+        }
+        length++;
+      }
+      returnWord(length);
+      result.cycles = 30 + 13 * length;
+      return result;
+    }
+    case HOOK_TOSMULAX:
+      returnWord(Math.imul(memory.pop(), ax) & 0xFFFF);
+      result.cycles = registers[REG_X] === 0 ? 200 : 320;
+      return result;
+    case HOOK_UDIV16: {
+      const divisor = memory.word(config[HOOK_ZP_PTR4]);
+      const dividend = memory.word(config[HOOK_ZP_PTR1]);
+      if (divisor === 0) {
+        return null;
+      }
+      memory.setWord(config[HOOK_ZP_PTR1], Math.floor(dividend / divisor));
+      memory.setWord(config[HOOK_ZP_SREG], dividend % divisor);
+      result.outputs = 0;
+      result.cycles = divisor < 0x100 ? 280 : 480;
+      return result;
+    }
+  }
+  return null;
+}
+
+function compare(hooks: CPURuntimeHooks, id: number, where: number, expected: number, actual: number): boolean {
+  if (expected === actual) {
+    return false;
+  }
+  hooks.mismatch.set([id, where, expected, actual]);
+  return true;
+}
+
+function validate(hooks: CPURuntimeHooks, core: FallbackCore, read: (address: number) => number): void {
+  const check = hooks.check!;
+  const base = check.id * HOOK_STATS;
+  hooks.check = undefined;
+
+  hooks.stats[base + 2]++;
+  hooks.stats[base + 4] += core.cycles - check.start;
+  let differs = false;
+  if (check.result.outputs & OUT_A) {
+    differs = compare(hooks, check.id, HOOK_REGISTER, check.result.a, core.registers[REG_A]) || differs;
+  }
+  if (check.result.outputs & OUT_X) {
+    differs = compare(hooks, check.id, HOOK_REGISTER + 1, check.result.x, core.registers[REG_X]) || differs;
+  }
+  for (let i = 0; i < hooks.written.length && !differs; i++) {
+    for (let bits = hooks.written[i], bit = 0; bits && !differs; bit++, bits >>= 1) {
+      if (bits & 1) {
+        const address = i * 8 + bit;
+        differs = compare(hooks, check.id, address, hooks.shadow[address], read(address));
+      }
+    }
+  }
+  if (differs) {
+    hooks.stats[base + 3]++;
+  }
+}
+
+/**
+ * Run the hook for the routine at the fallback core's PC, before the core
+ * steps; the same as the start of cpu_step in fake6502.c
+ * @returns Cycles charged, or 0 when the core is to step normally
+ */
+export function runtimeHookStep(hooks: CPURuntimeHooks, core: FallbackCore,
+                                read: (address: number) => number, write: (address: number, value: number) => void): number {
+  const pc = core.pc[0];
+  const registers = core.registers;
+  if (hooks.check) {
+    if (pc === hooks.check.returnPc && registers[REG_SP] === hooks.check.sp) {
+      validate(hooks, core, read);
+    }
+    return 0;
+  }
+  const id = hooks.map[pc];
+  if (id === 0 || id >= HOOK_COUNT) {
+    return 0;
+  }
+
+  const sp = registers[REG_SP];
+  const returnPc = ((read(0x100 | ((sp + 1) & 0xFF)) | (read(0x100 | ((sp + 2) & 0xFF)) << 8)) + 1) & 0xFFFF;
+  if (hooks.config[HOOK_VALIDATE]) {
+    hooks.written.fill(0);
+    const result = runHook(id, core, new HookMemory(hooks, true, read, write), hooks.config);
+    if (result) {
+      hooks.check = { id, returnPc, sp: (sp + 2) & 0xFF, start: core.cycles, result };
+    }
+    return 0;
+  }
+
+  const result = runHook(id, core, new HookMemory(hooks, false, read, write), hooks.config);
+  if (!result) {
+    return 0;
+  }
+  core.pc[0] = returnPc;
+  registers[REG_SP] = sp + 2;
+  registers[REG_A] = result.a;
+  registers[REG_X] = result.x;
+  registers[REG_Y] = result.y;
+
+  const cycles = hooks.costs[id] || result.cycles;
+  core.cycles += cycles;
+  hooks.stats[id * HOOK_STATS]++;
+  hooks.stats[id * HOOK_STATS + 1] += cycles;
+  return cycles;
+}
@@ -3,6 +3,8 @@
  * Parses CC65 debug symbol files for source-level debugging support
  */
 
+import { CC65DebugInfoParser } from './debug-info';
+
 export interface CC65Symbol {
   name: string;
   address: number;
@@ -22,15 +24,15 @@ export class CC65SymbolParser {
   private symbols = new Map<string, CC65Symbol>();
   private addressToSymbol = new Map<number, CC65Symbol>();
   private fileSymbols = new Map<string, CC65Symbol[]>();
+  private debugInfo?: CC65DebugInfoParser;
+  private labels?: CC65Symbol[];  // Sorted by address, built on first use
 
   /**
    * Parse CC65 symbol file content
    * Format: name=value type [scope] [file:line]
    */
   parseSymbolFile(content: string): CC65SymbolTable {
-    this.symbols.clear();
-    this.addressToSymbol.clear();
-    this.fileSymbols.clear();
+    this.clear();
 
     const lines = content.split('\n');
     
@@ -53,6 +55,49 @@ export class CC65SymbolParser {
     };
   }
 
+  /**
+   * Take the labels and equates from parsed ld65 debug info
+   * Names inside scopes are qualified, e.g. "main::loop"; addresses inside
+   * routines then resolve through the debug info scopes, see
+   * findSymbolForAddress.
+   */
+  loadDebugInfo(debugInfo: CC65DebugInfoParser): CC65SymbolTable {
+    this.clear();
+    this.debugInfo = debugInfo;
+
+    // Equates first so a label at the same address takes precedence
+    const symbols = debugInfo.getSymbols().filter(symbol => !isNaN(symbol.value))
+      .sort((a, b) => (a.type === 'equ' ? 0 : 1) - (b.type === 'equ' ? 0 : 1) || a.id - b.id);
+    for (const symbol of symbols) {
+      const scope = debugInfo.getScope(symbol.scope);
+      const scopeName = scope ? debugInfo.getScopeName(scope) : '';
+      const definition = debugInfo.getLine(symbol.definitions[0]);
+      const file = definition ? debugInfo.getFile(definition.file) : undefined;
+      this.addSymbol({
+        name: scopeName ? `${scopeName}::${symbol.name}` : symbol.name,
+        address: symbol.value,
+        type: symbol.type === 'equ' ? 'equate' : 'label',
+        scope: scopeName || undefined,
+        file: file ? file.name : undefined,
+        line: definition ? definition.line : undefined
+      });
+    }
+
+    return {
+      symbols: this.symbols,
+      addressToSymbol: this.addressToSymbol,
+      fileSymbols: this.fileSymbols
+    };
+  }
+
+  private clear(): void {
+    this.symbols.clear();
+    this.addressToSymbol.clear();
+    this.fileSymbols.clear();
+    this.debugInfo = undefined;
+    this.labels = undefined;
+  }
+
   private parseSymbolLine(line: string): CC65Symbol | null {
     // Parse format: name=value type [scope] [file:line]
     const parts = line.split(/\s+/);
@@ -154,6 +199,52 @@ export class CC65SymbolParser {
     return this.addressToSymbol.get(address);
   }
 
+  /**
+   * Symbol for any address inside the code it names, with the offset of
+   * address from it: the symbol at address, else the routine (.proc scope)
+   * containing it when debug info is loaded, else the nearest label below
+   * it. O(log n), for attributing profile and trace samples.
+   */
+  findSymbolForAddress(address: number): { symbol: CC65Symbol; offset: number } | undefined {
+    const exact = this.addressToSymbol.get(address);
+    if (exact) {
+      return { symbol: exact, offset: 0 };
+    }
+
+    if (this.debugInfo) {
+      for (let scope = this.debugInfo.getScopeAt(address); scope; scope = this.debugInfo.getScope(scope.parent)) {
+        const named = this.debugInfo.getSymbol(scope.symbol);
+        const symbol = named ? this.addressToSymbol.get(named.value) : undefined;
+        if (symbol) {
+          return { symbol, offset: address - symbol.address };
+        }
+      }
+    }
+
+    if (!this.labels) {
+      this.labels = Array.from(this.addressToSymbol.values()).filter(symbol => symbol.type !== 'equate')
+        .sort((a, b) => a.address - b.address);
+    }
+    let low = 0;
+    let high = this.labels.length - 1;
+    while (low <= high) {
+      const middle = (low + high) >>> 1;
+      if (this.labels[middle].address <= address) {
+        low = middle + 1;
+      } else {
+        high = middle - 1;
+      }
+    }
+    return high >= 0 ? { symbol: this.labels[high], offset: address - this.labels[high].address } : undefined;
+  }
+
+  /**
+   * Source line of the code at address, when debug info is loaded
+   */
+  getSourceLocation(address: number): { file: string; line: number } | undefined {
+    return this.debugInfo ? this.debugInfo.getLineAt(address) : undefined;
+  }
+
   /**
    * Get all symbols for a specific file
    */
@@ -10,6 +10,14 @@ import path from 'path';
 import readline from 'readline';
 import { Emulator, EmulatorState } from './emulator';
 import { SystemConfigLoader } from './config/system';
+import { InputLog } from './debug/input-log';
+import { getInstructionHotspots } from './performance/profiler';
+import { TraceFilter, formatTraceRecord } from './debug/trace-buffer';
+import { COVERAGE_EXECUTED, COVERAGE_NOT_TAKEN, COVERAGE_TAKEN, formatLcov, writeCoverageHtml } from './debug/coverage';
+import { CC65DebugInfoParser } from './cc65/debug-info';
+import { CC65SymbolParser } from './cc65/symbol-parser';
+import { getRuntimeHookMismatch, getRuntimeHookStats } from './cc65/runtime-hooks';
+import { main as runHeadlessCommand } from './headless';
 
 /**
  * CLI command interface
@@ -34,6 +42,7 @@ export class EmulatorCLI {
   private lastDisasmAddress: number = 0;
   private lastDisasmLength: number = 32;
   private lastCommand: string = '';
+  private traceFilters: TraceFilter[] = [];  // Applied by the next "trace on"
 
   constructor() {
     this.emulator = new Emulator();
@@ -128,6 +137,64 @@ export class EmulatorCLI {
       handler: this.handleStep.bind(this)
     });
 
+    this.addCommand({
+      name: 'mode',
+      description: 'Run on the event loop or on a native worker thread',
+      usage: 'mode [event-loop|native-thread]',
+      handler: this.handleMode.bind(this)
+    });
+
+    this.addCommand({
+      name: 'clock',
+      description: 'Pace to the wall clock or run on a virtual clock',
+      usage: 'clock [real-time|virtual]',
+      handler: this.handleClock.bind(this)
+    });
+
+    this.addCommand({
+      name: 'runfor',
+      description: 'Run for a span of emulated time at full speed',
+      usage: 'runfor <ms>',
+      handler: this.handleRunFor.bind(this)
+    });
+
+    // Reverse execution commands
+    this.addCommand({
+      name: 'history',
+      description: 'Enable/disable execution history for reverse debugging',
+      usage: 'history [on|off]',
+      handler: this.handleHistory.bind(this)
+    });
+
+    this.addCommand({
+      name: 'rstep',
+      description: 'Step backwards',
+      usage: 'rstep [count]',
+      handler: this.handleReverseStep.bind(this)
+    });
+
+    this.addCommand({
+      name: 'rcontinue',
+      description: 'Run backwards to the previous breakpoint',
+      usage: 'rcontinue',
+      handler: this.handleReverseContinue.bind(this)
+    });
+
+    // Input record/replay commands
+    this.addCommand({
+      name: 'record',
+      description: 'Reset and record external inputs, or save the recording',
+      usage: 'record start | record stop <file>',
+      handler: this.handleRecord.bind(this)
+    });
+
+    this.addCommand({
+      name: 'replay',
+      description: 'Reset and replay recorded inputs (maximum speed unless paced)',
+      usage: 'replay <file> [paced]',
+      handler: this.handleReplay.bind(this)
+    });
+
     // ROM loading commands
     this.addCommand({
       name: 'loadrom',
@@ -250,6 +317,41 @@ export class EmulatorCLI {
       handler: this.handleSpeed.bind(this)
     });
 
+    this.addCommand({
+      name: 'profile',
+      description: 'Profile cycles per instruction address and per subroutine',
+      usage: 'profile [on|off|top [count]|calls [count]|save <pprof|trace> <file>]',
+      handler: this.handleProfile.bind(this)
+    });
+
+    this.addCommand({
+      name: 'trace',
+      description: 'Record executed instructions, optionally to a binary trace file',
+      usage: 'trace [on [file]|off|filter <start> <end>|filter clear|show [count]]',
+      handler: this.handleTrace.bind(this)
+    });
+
+    this.addCommand({
+      name: 'coverage',
+      description: 'Record executed code and branch outcomes, exported per source line',
+      usage: 'coverage [on|off|lcov <dbg-file> <file>|html <dbg-file> <dir>]',
+      handler: this.handleCoverage.bind(this)
+    });
+
+    this.addCommand({
+      name: 'hooks',
+      description: 'Perform cc65 runtime routines (memcpy, pushax, ...) on the host',
+      usage: 'hooks [on <dbg-file> [validate] [routine...]|off]',
+      handler: this.handleHooks.bind(this)
+    });
+
+    this.addCommand({
+      name: 'turbo',
+      description: 'Run as fast as the host allows, ignoring the clock speed',
+      usage: 'turbo [on|off] [latency-ms]',
+      handler: this.handleTurbo.bind(this)
+    });
+
     // Help and utility commands
     this.addCommand({
       name: 'regions',
@@ -381,6 +483,22 @@ export class EmulatorCLI {
     console.log(`Execution Time: ${stats.executionTimeMs} ms`);
     console.log(`Average IPS: ${Math.round(stats.averageIPS)}`);
     console.log(`Actual Clock: ${Math.round(stats.clockSpeed)} Hz`);
+    if (this.emulator.isTurboMode()) {
+      console.log(`Turbo: ${(stats.clockSpeed / 1000000).toFixed(2)} MHz effective`);
+    }
+
+    const pacing = this.emulator.getPacingStats();
+    if (pacing.samples > 0) {
+      console.log(`Pacing: ${(pacing.effectiveHz / 1000000).toFixed(4)} MHz (${pacing.clockErrorPercent >= 0 ? '+' : ''}${pacing.clockErrorPercent.toFixed(3)}%), ` +
+        `wake-up error p50 ${pacing.p50.toFixed(3)} ms, p99 ${pacing.p99.toFixed(3)} ms, ${pacing.resyncs} resyncs`);
+    }
+
+    const speedController = this.emulator.getOptimizer().getSpeedController();
+    if (speedController.getCostPerCycle() > 0) {
+      const lag = speedController.getEventLoopLag();
+      console.log(`Chunk: ${speedController.getCyclesPerChunk()} cycles, event loop lag p99 ${lag.p99.toFixed(2)} ms ` +
+        `(budget ${speedController.getMaxStall()} ms)`);
+    }
   }
 
   private handleRun(args: string[]): void {
@@ -441,6 +559,179 @@ export class EmulatorCLI {
     }
   }
 
+  private handleMode(args: string[]): void {
+    if (args.length === 0) {
+      console.log(`Execution mode: ${this.emulator.getExecutionMode()}`);
+      return;
+    }
+
+    if (args.length !== 1 || (args[0] !== 'event-loop' && args[0] !== 'native-thread')) {
+      console.log('Usage: mode [event-loop|native-thread]');
+      return;
+    }
+
+    try {
+      this.emulator.setExecutionMode(args[0]);
+      console.log(`Execution mode: ${this.emulator.getExecutionMode()}`);
+    } catch (error) {
+      console.error(`Mode error: ${error}`);
+    }
+  }
+
+  private handleClock(args: string[]): void {
+    if (args.length === 0) {
+      console.log(`Clock mode: ${this.emulator.getClockMode()}`);
+      return;
+    }
+
+    if (args.length !== 1 || (args[0] !== 'real-time' && args[0] !== 'virtual')) {
+      console.log('Usage: clock [real-time|virtual]');
+      return;
+    }
+
+    try {
+      this.emulator.setClockMode(args[0]);
+      console.log(`Clock mode: ${this.emulator.getClockMode()}`);
+    } catch (error) {
+      console.error(`Clock error: ${error}`);
+    }
+  }
+
+  private async handleRunFor(args: string[]): Promise<void> {
+    const ms = args.length === 1 ? parseFloat(args[0]) : NaN;
+    if (!(ms > 0)) {
+      console.log('Usage: runfor <ms>');
+      return;
+    }
+
+    try {
+      const startTime = performance.now();
+      const startEmulated = this.emulator.getEmulatedTime();
+      const completed = await this.emulator.runFor(ms);
+      const emulatedMs = this.emulator.getEmulatedTime() - startEmulated;
+      const hostMs = performance.now() - startTime;
+      console.log(`${completed ? 'Ran' : 'Stopped after'} ${emulatedMs.toFixed(3)} ms of emulated time in ${hostMs.toFixed(1)} ms`);
+    } catch (error) {
+      console.error(`Run error: ${error}`);
+    }
+  }
+
+  private handleHistory(args: string[]): void {
+    const history = this.emulator.getExecutionHistory();
+
+    if (args.length === 1 && (args[0] === 'on' || args[0] === 'off')) {
+      this.emulator.enableReverseExecution(args[0] === 'on');
+      console.log(`Execution history ${args[0] === 'on' ? 'enabled' : 'disabled'}`);
+      return;
+    }
+
+    if (args.length !== 0) {
+      console.log('Usage: history [on|off]');
+      return;
+    }
+
+    if (!history.isEnabled()) {
+      console.log('Execution history: disabled');
+      return;
+    }
+
+    console.log('Execution history: enabled');
+    console.log(`  Instruction:  ${history.getInstructionIndex()} (recorded ${history.getEarliestInstruction()}-${history.getHorizon()})`);
+    console.log(`  Checkpoints:  ${history.getCheckpointCount()}`);
+    console.log(`  Input events: ${history.getInputLog().length}`);
+  }
+
+  private handleReverseStep(args: string[]): void {
+    const count = args.length > 0 ? parseInt(args[0]) : 1;
+    if (isNaN(count) || count < 1) {
+      console.log('Usage: rstep [count]');
+      return;
+    }
+
+    const history = this.emulator.getExecutionHistory();
+    if (!history.isEnabled()) {
+      console.log('Execution history is disabled. Use "history on" first.');
+      return;
+    }
+
+    this.emulator.pause();
+    if (!this.emulator.getDebugInspector().reverseStep(count)) {
+      console.log('At start of recorded history');
+      return;
+    }
+
+    const regs = this.emulator.getSystemBus().getCPU().getRegisters();
+    console.log(`Reverse step: PC=${regs.PC.toString(16).toUpperCase().padStart(4, '0')} (instruction ${history.getInstructionIndex()})`);
+    this.displayRegisters(regs);
+  }
+
+  private handleReverseContinue(args: string[]): void {
+    if (args.length !== 0) {
+      console.log('Usage: rcontinue');
+      return;
+    }
+
+    const history = this.emulator.getExecutionHistory();
+    if (!history.isEnabled()) {
+      console.log('Execution history is disabled. Use "history on" first.');
+      return;
+    }
+
+    this.emulator.pause();
+    const found = this.emulator.getDebugInspector().reverseContinue();
+    const regs = this.emulator.getSystemBus().getCPU().getRegisters();
+    const pc = regs.PC.toString(16).toUpperCase().padStart(4, '0');
+
+    if (found) {
+      console.log(`Breakpoint hit at ${pc} (instruction ${history.getInstructionIndex()})`);
+    } else {
+      console.log(`Reached start of recorded history at ${pc}`);
+    }
+    this.displayRegisters(regs);
+  }
+
+  private handleRecord(args: string[]): void {
+    if (args.length === 1 && args[0] === 'start') {
+      this.emulator.startRecording();
+      console.log('Recording external inputs from reset');
+      return;
+    }
+
+    if (args.length === 2 && args[0] === 'stop') {
+      if (!this.emulator.getInputRecorder().isRecording()) {
+        console.log('Not recording');
+        return;
+      }
+
+      try {
+        const log = this.emulator.stopRecording();
+        log.saveToFile(args[1]);
+        console.log(`Saved ${log.length} input event${log.length === 1 ? '' : 's'} to ${args[1]}`);
+      } catch (error) {
+        console.error(`Failed to save recording: ${error}`);
+      }
+      return;
+    }
+
+    console.log('Usage: record start | record stop <file>');
+  }
+
+  private handleReplay(args: string[]): void {
+    if (args.length < 1 || args.length > 2 || (args.length === 2 && args[1] !== 'paced')) {
+      console.log('Usage: replay <file> [paced]');
+      return;
+    }
+
+    try {
+      const log = InputLog.loadFromFile(args[0]);
+      this.emulator.startReplay(log, args.length === 1);
+      console.log(`Replaying ${log.length} input event${log.length === 1 ? '' : 's'} from ${args[0]}`);
+      this.emulator.start();
+    } catch (error) {
+      console.error(`Failed to replay: ${error}`);
+    }
+  }
+
   private displayRegisters(regs: any): void {
     console.log(`A:${regs.A.toString(16).toUpperCase().padStart(2, '0')} X:${regs.X.toString(16).toUpperCase().padStart(2, '0')} Y:${regs.Y.toString(16).toUpperCase().padStart(2, '0')} SP:${regs.SP.toString(16).toUpperCase().padStart(2, '0')} P:${regs.P.toString(2).padStart(8, '0')}`);
     this.displayFlags(regs.P);
@@ -888,6 +1179,284 @@ export class EmulatorCLI {
     console.log(`Clock speed set to ${speed} Hz`);
   }
 
+  private handleProfile(args: string[]): void {
+    if (args.length === 1 && (args[0] === 'on' || args[0] === 'off')) {
+      try {
+        this.emulator.enableInstructionProfiling(args[0] === 'on');
+        this.emulator.enableCallGraphProfiling(args[0] === 'on');
+        this.emulator.enableProfiling(args[0] === 'on');
+        console.log(`Instruction profiling ${args[0] === 'on' ? 'enabled' : 'disabled'}`);
+      } catch (error) {
+        console.error(`Profile error: ${error}`);
+      }
+      return;
+    }
+
+    if (args[0] === 'save') {
+      this.saveProfile(args.slice(1));
+      return;
+    }
+
+    const limit = args.length === 2 ? parseInt(args[1]) : 20;
+    if (args.length > 2 || (args.length > 0 && args[0] !== 'top' && args[0] !== 'calls') || isNaN(limit) || limit <= 0) {
+      console.log('Usage: profile [on|off|top [count]|calls [count]|save <pprof|trace> <file>]');
+      return;
+    }
+
+    if (args[0] === 'calls') {
+      this.showCallGraph(limit);
+      return;
+    }
+
+    const profile = this.emulator.getInstructionProfile();
+    if (!profile) {
+      console.log('Instruction profiling: disabled');
+      return;
+    }
+
+    const symbols = this.emulator.getSymbolParser();
+    console.log('Address  Executions      Cycles   Cycles%  Symbol');
+    for (const hotspot of getInstructionHotspots(profile, limit)) {
+      const found = symbols ? symbols.findSymbolForAddress(hotspot.address) : undefined;
+      const name = found ? `${found.symbol.name}${found.offset ? `+${found.offset}` : ''}` : '';
+      console.log(`$${hotspot.address.toString(16).toUpperCase().padStart(4, '0')}    ` +
+        `${hotspot.count.toString().padStart(10)}  ${hotspot.cycles.toString().padStart(10)}  ` +
+        `${hotspot.cyclePercent.toFixed(2).padStart(7)}%  ${name}`);
+    }
+  }
+
+  private saveProfile(args: string[]): void {
+    if (args.length !== 2 || (args[0] !== 'pprof' && args[0] !== 'trace')) {
+      console.log('Usage: profile save <pprof|trace> <file>');
+      return;
+    }
+
+    try {
+      if (args[0] === 'pprof') {
+        fs.writeFileSync(args[1], this.emulator.exportPprof());
+        console.log(`Saved pprof profile to ${args[1]} (view with: pprof -http=: ${args[1]})`);
+      } else {
+        const trace = this.emulator.exportTraceEvents();
+        fs.writeFileSync(args[1], JSON.stringify(trace));
+        console.log(`Saved ${trace.traceEvents.length} trace events to ${args[1]} (open in Perfetto or chrome://tracing)`);
+      }
+    } catch (error) {
+      console.error(`Profile error: ${error}`);
+    }
+  }
+
+  private showCallGraph(limit: number): void {
+    const report = this.emulator.getCallGraphReport();
+    if (!report) {
+      console.log('Call graph profiling: disabled');
+      return;
+    }
+
+    const symbols = this.emulator.getSymbolParser();
+    const name = (address: number) => {
+      const symbol = symbols ? symbols.getSymbolByAddress(address) : undefined;
+      return symbol ? symbol.name : `$${address.toString(16).toUpperCase().padStart(4, '0')}`;
+    };
+
+    console.log('Routine               Calls   Inclusive   Incl%   Exclusive   Excl%');
+    for (const routine of report.routines.slice(0, limit)) {
+      console.log(`${name(routine.address).padEnd(16)}  ${routine.calls.toString().padStart(9)}  ` +
+        `${routine.inclusive.toString().padStart(10)}  ${routine.inclusivePercent.toFixed(1).padStart(5)}%  ` +
+        `${routine.exclusive.toString().padStart(10)}  ${routine.exclusivePercent.toFixed(1).padStart(5)}%`);
+    }
+
+    console.log('\nCaller -> callee                        Calls      Cycles');
+    for (const edge of report.edges.slice(0, limit)) {
+      console.log(`${`${name(edge.caller)} -> ${name(edge.callee)}`.padEnd(36)}  ${edge.calls.toString().padStart(9)}  ` +
+        `${edge.cycles.toString().padStart(10)}`);
+    }
+
+    console.log(`\nActive: ${report.stack.map(name).join(' > ')}`);
+    if (report.droppedCalls > 0) {
+      console.log(`${report.droppedCalls} calls nested deeper than the shadow stack were charged to their caller`);
+    }
+  }
+
+  private handleTrace(args: string[]): void {
+    const usage = 'Usage: trace [on [file]|off|filter <start> <end>|filter clear|show [count]]';
+    const trace = this.emulator.getExecutionTrace();
+
+    if (args.length === 0) {
+      const filters = this.traceFilters.map(f =>
+        `${f.first.toString(16).toUpperCase().padStart(4, '0')}-${f.last.toString(16).toUpperCase().padStart(4, '0')}`);
+      console.log(`Execution trace: ${trace ? `on, ${trace.getWritten()} records` : 'off'}` +
+        (filters.length > 0 ? ` (filters ${filters.join(', ')})` : ''));
+      return;
+    }
+
+    if ((args[0] === 'on' && args.length <= 2) || (args[0] === 'off' && args.length === 1)) {
+      try {
+        this.emulator.enableExecutionTrace(args[0] === 'on', { filters: this.traceFilters, file: args[1] });
+        console.log(`Execution trace ${args[0] === 'on' ? 'enabled' : 'disabled'}${args[1] ? `, writing ${args[1]}` : ''}`);
+      } catch (error) {
+        console.error(`Trace error: ${error}`);
+      }
+      return;
+    }
+
+    if (args[0] === 'filter' && args.length === 2 && args[1] === 'clear') {
+      this.traceFilters = [];
+      console.log('Trace filters cleared');
+      return;
+    }
+
+    if (args[0] === 'filter' && args.length === 3) {
+      const first = parseInt(args[1], 16);
+      const last = parseInt(args[2], 16);
+      if (isNaN(first) || isNaN(last) || first < 0 || last > 0xFFFF || first > last) {
+        console.log('Invalid address range');
+        return;
+      }
+      this.traceFilters.push({ first, last });
+      console.log(`Tracing ${args[1].toUpperCase()}-${args[2].toUpperCase()} from the next "trace on"`);
+      return;
+    }
+
+    const limit = args.length === 2 ? parseInt(args[1]) : 20;
+    if (args[0] !== 'show' || args.length > 2 || isNaN(limit) || limit <= 0) {
+      console.log(usage);
+      return;
+    }
+    if (!trace) {
+      console.log('Execution trace: off');
+      return;
+    }
+    for (const record of trace.getRecords(limit)) {
+      console.log(formatTraceRecord(record));
+    }
+  }
+
+  private handleCoverage(args: string[]): void {
+    const usage = 'Usage: coverage [on|off|lcov <dbg-file> <file>|html <dbg-file> <dir>]';
+    if (args.length === 1 && (args[0] === 'on' || args[0] === 'off')) {
+      try {
+        this.emulator.enableCoverage(args[0] === 'on');
+        console.log(`Code coverage ${args[0] === 'on' ? 'enabled' : 'disabled'}`);
+      } catch (error) {
+        console.error(`Coverage error: ${error}`);
+      }
+      return;
+    }
+
+    const coverage = this.emulator.getCoverage();
+    if (args.length === 0) {
+      if (!coverage) {
+        console.log('Code coverage: off');
+        return;
+      }
+      let executed = 0;
+      let branches = 0;
+      let bothWays = 0;
+      for (const flags of coverage) {
+        executed += flags & COVERAGE_EXECUTED;
+        if (flags & (COVERAGE_TAKEN | COVERAGE_NOT_TAKEN)) {
+          branches++;
+          bothWays += (flags & COVERAGE_TAKEN) && (flags & COVERAGE_NOT_TAKEN) ? 1 : 0;
+        }
+      }
+      console.log(`Code coverage: on, ${executed} instruction addresses executed, ` +
+        `${branches} branches executed (${bothWays} both ways)`);
+      return;
+    }
+
+    if (args.length !== 3 || (args[0] !== 'lcov' && args[0] !== 'html')) {
+      console.log(usage);
+      return;
+    }
+
+    try {
+      const debugInfo = new CC65DebugInfoParser();
+      debugInfo.parseDebugFile(fs.readFileSync(args[1], 'utf8'));
+      const report = this.emulator.getCoverageReport(debugInfo.getLineRanges());
+      if (args[0] === 'lcov') {
+        fs.writeFileSync(args[2], formatLcov(report));
+      } else {
+        writeCoverageHtml(report, args[2], { sourceRoot: path.dirname(args[1]) });
+      }
+      console.log(`Saved coverage of ${report.files.length} files to ${args[2]}: ` +
+        `${report.linesHit}/${report.lines} lines, ${report.branchesHit}/${report.branches} branch outcomes`);
+    } catch (error) {
+      console.error(`Coverage error: ${error}`);
+    }
+  }
+
+  private handleHooks(args: string[]): void {
+    if (args.length === 1 && args[0] === 'off') {
+      this.emulator.disableRuntimeHooks();
+      console.log('Runtime hooks disabled');
+      return;
+    }
+
+    if (args.length >= 2 && args[0] === 'on') {
+      try {
+        const debugInfo = new CC65DebugInfoParser();
+        debugInfo.parseDebugFile(fs.readFileSync(args[1], 'utf8'));
+        const symbols = new CC65SymbolParser();
+        symbols.loadDebugInfo(debugInfo);
+        const validate = args[2] === 'validate';
+        const routines = args.slice(validate ? 3 : 2);
+        const hooked = this.emulator.enableRuntimeHooks({ validate, routines: routines.length > 0 ? routines : undefined }, symbols);
+        console.log(`Runtime hooks ${validate ? 'validating' : 'enabled'}: ` +
+          (hooked.length > 0 ? hooked.map(stats => stats.routine).join(', ') : 'no runtime routines found'));
+      } catch (error) {
+        console.error(`Hooks error: ${error}`);
+      }
+      return;
+    }
+
+    if (args.length > 0) {
+      console.log('Usage: hooks [on <dbg-file> [validate] [routine...]|off]');
+      return;
+    }
+    const hooks = this.emulator.getRuntimeHooks();
+    if (!hooks) {
+      console.log('Runtime hooks: off');
+      return;
+    }
+    console.log('Routine     Address      Calls      Cycles  Validated  Mismatches  Real cycles');
+    for (const stats of getRuntimeHookStats(hooks)) {
+      console.log(`${stats.routine.padEnd(10)}  $${stats.address.toString(16).toUpperCase().padStart(4, '0')}  ` +
+        `${stats.calls.toString().padStart(9)}  ${stats.cycles.toString().padStart(10)}  ${stats.validated.toString().padStart(9)}  ` +
+        `${stats.mismatches.toString().padStart(10)}  ${stats.realCycles.toString().padStart(11)}`);
+    }
+    const mismatch = getRuntimeHookMismatch(hooks);
+    if (mismatch) {
+      const location = typeof mismatch.location === 'number'
+        ? `$${mismatch.location.toString(16).toUpperCase().padStart(4, '0')}` : mismatch.location;
+      console.log(`Last mismatch: ${mismatch.routine} at ${location}, hook wrote $${mismatch.expected.toString(16).toUpperCase()}, ` +
+        `routine wrote $${mismatch.actual.toString(16).toUpperCase()}`);
+    }
+  }
+
+  private handleTurbo(args: string[]): void {
+    if (args.length === 0) {
+      if (this.emulator.isTurboMode()) {
+        console.log(`Turbo: on (${this.emulator.getLatencyBudget()} ms latency budget, ${this.emulator.getEffectiveMHz().toFixed(2)} MHz effective)`);
+      } else {
+        console.log('Turbo: off');
+      }
+      return;
+    }
+
+    if (args.length > 2 || (args[0] !== 'on' && args[0] !== 'off')) {
+      console.log('Usage: turbo [on|off] [latency-ms]');
+      return;
+    }
+
+    const budget = args.length === 2 ? parseFloat(args[1]) : undefined;
+    try {
+      this.emulator.setTurboMode(args[0] === 'on', budget);
+      console.log(`Turbo ${args[0] === 'on' ? 'enabled' : 'disabled'}`);
+    } catch (error) {
+      console.error(`Turbo error: ${error}`);
+    }
+  }
+
   private handleHelp(args: string[]): void {
     if (args.length === 0) {
       console.log('Available commands:');
@@ -937,8 +1506,14 @@ export class EmulatorCLI {
 
 /**
  * Main entry point for CLI
+ * `run` selects the non-interactive runner; anything else starts the prompt.
  */
 export async function main(): Promise<void> {
+  if (process.argv[2] === 'run') {
+    process.exitCode = await runHeadlessCommand(process.argv.slice(3));
+    return;
+  }
+
   const cli = new EmulatorCLI();
   await cli.start();
 }
@@ -27,6 +27,7 @@ export interface PeripheralConfig {
   via?: VIAConfig;
   timers?: TimerConfig[];
   gpio?: GPIOConfig;
+  hostCall?: HostCallConfig;
 }
 
 export interface ACIAConfig {
@@ -54,6 +55,12 @@ export interface TimerConfig {
   frequency: number;
 }
 
+export interface HostCallConfig {
+  baseAddress: number;
+  brkSignature?: number;  // BRK followed by this byte also makes a host call
+  directory?: string;     // Host directory the file services may use; none when omitted
+}
+
 export interface GPIOConfig {
   baseAddress: number;
   pins: number;
@@ -263,7 +270,8 @@ export class SystemConfigLoader {
           { ...defaultConfig.peripherals.via, ...userConfig.peripherals.via } : 
           defaultConfig.peripherals.via,
         timers: userConfig.peripherals?.timers || defaultConfig.peripherals.timers,
-        gpio: userConfig.peripherals?.gpio || defaultConfig.peripherals.gpio
+        gpio: userConfig.peripherals?.gpio || defaultConfig.peripherals.gpio,
+        hostCall: userConfig.peripherals?.hostCall
       },
       cpu: { ...defaultConfig.cpu, ...userConfig.cpu },
       debugging: { ...defaultConfig.debugging, ...userConfig.debugging }
@@ -319,6 +327,14 @@ export class SystemConfigLoader {
       this.validateAddress(config.peripherals.via.baseAddress, 'peripherals.via.baseAddress');
     }
 
+    if (config.peripherals.hostCall) {
+      this.validateAddress(config.peripherals.hostCall.baseAddress, 'peripherals.hostCall.baseAddress');
+      const signature = config.peripherals.hostCall.brkSignature;
+      if (signature !== undefined && (!Number.isInteger(signature) || signature < 0 || signature > 255)) {
+        throw new ConfigurationError('Host call BRK signature must be a byte', 'peripherals.hostCall.brkSignature');
+      }
+    }
+
     // Check for address conflicts
     this.checkAddressConflicts(config);
   }
@@ -374,6 +390,14 @@ export class SystemConfigLoader {
       });
     }
 
+    if (config.peripherals.hostCall) {
+      addressRanges.push({
+        start: config.peripherals.hostCall.baseAddress,
+        end: config.peripherals.hostCall.baseAddress + 5,
+        name: 'HostCall'
+      });
+    }
+
     // Check for overlaps
     for (let i = 0; i < addressRanges.length; i++) {
       for (let j = i + 1; j < addressRanges.length; j++) {
@@ -0,0 +1,230 @@
+/**
+ * Lockstep batch execution of many 6502 instances
+ * Wraps the native batch engine (native/fake6502_batch.c). Registers are
+ * held in structure-of-arrays form, one typed array per register indexed by
+ * lane, and every lane has its own 64K memory image. Lanes have no
+ * peripherals or interrupts; programs report results through memory or an
+ * output port, and a lane halts at the stop address or when it jumps to
+ * itself.
+ */
+
+import { CPUState } from './cpu';
+
+export interface BatchOptions {
+  lanes: number;
+  stopAddress?: number;     // Lanes halt when PC reaches this address
+  outputAddress?: number;   // Writes here are collected per lane instead of stored
+  outputCapacity?: number;  // Bytes kept per lane (default 4096)
+}
+
+export type BatchLaneStatus = 'running' | 'stopped' | 'spin';
+
+const LANE_MEMORY_SIZE = 0x10000;
+const LANE_STATUS: BatchLaneStatus[] = ['running', 'stopped', 'spin'];
+
+// The batch engine keeps no global state, so unlike the single-instance
+// core it may be used from any thread
+let nativeAddon: any = null;
+try {
+  nativeAddon = require('../../build/Release/fake6502_addon.node');
+} catch (error) {
+  nativeAddon = null;
+}
+
+// Layout shared with the native engine; every array is indexed by lane
+interface BatchState {
+  lanes: number;
+  stopAddress: number;
+  outputAddress: number;
+  outputCapacity: number;
+  pc: Uint16Array;
+  a: Uint8Array;
+  x: Uint8Array;
+  y: Uint8Array;
+  sp: Uint8Array;
+  status: Uint8Array;
+  cycles: Float64Array;
+  laneStatus: Uint8Array;
+  memory: Uint8Array;
+  writable: Uint8Array;     // Per page, shared by all lanes
+  output: Uint8Array;
+  outputLength: Uint32Array;
+}
+
+export class BatchEmulator {
+  readonly lanes: number;
+  private state: BatchState;
+
+  /**
+   * Whether the native batch engine is available
+   */
+  static isAvailable(): boolean {
+    return nativeAddon !== null && typeof nativeAddon.batchRun === 'function';
+  }
+
+  constructor(options: BatchOptions) {
+    if (!BatchEmulator.isAvailable()) {
+      throw new Error('Batch execution requires the native addon');
+    }
+    if (!Number.isInteger(options.lanes) || options.lanes < 1) {
+      throw new Error(`Invalid lane count: ${options.lanes}`);
+    }
+
+    const lanes = options.lanes;
+    const outputCapacity = options.outputCapacity ?? 4096;
+    this.lanes = lanes;
+    this.state = {
+      lanes,
+      stopAddress: options.stopAddress !== undefined ? options.stopAddress & 0xFFFF : -1,
+      outputAddress: options.outputAddress !== undefined ? options.outputAddress & 0xFFFF : -1,
+      outputCapacity,
+      pc: new Uint16Array(lanes),
+      a: new Uint8Array(lanes),
+      x: new Uint8Array(lanes),
+      y: new Uint8Array(lanes),
+      sp: new Uint8Array(lanes),
+      status: new Uint8Array(lanes),
+      cycles: new Float64Array(lanes),
+      laneStatus: new Uint8Array(lanes),
+      memory: new Uint8Array(lanes * LANE_MEMORY_SIZE),
+      writable: new Uint8Array(256).fill(1),
+      output: new Uint8Array(lanes * outputCapacity),
+      outputLength: new Uint32Array(lanes)
+    };
+  }
+
+  /**
+   * Copy data into memory
+   * @param lane Lane to load; all lanes when omitted
+   */
+  loadImage(data: Uint8Array, address: number, lane?: number): void {
+    if (address < 0 || address + data.length > LANE_MEMORY_SIZE) {
+      throw new Error(`Image at 0x${address.toString(16)} does not fit in memory`);
+    }
+    for (const index of this.laneRange(lane)) {
+      this.state.memory.set(data, index * LANE_MEMORY_SIZE + address);
+    }
+  }
+
+  /**
+   * Make the pages covering start..end read-only in every lane
+   */
+  protect(start: number, end: number): void {
+    this.state.writable.fill(0, (start & 0xFFFF) >> 8, ((end & 0xFFFF) >> 8) + 1);
+  }
+
+  /**
+   * Reset lanes: registers cleared, PC from the reset vector and the output
+   * buffer emptied. Memory is left alone.
+   * @param lane Lane to reset; all lanes when omitted
+   */
+  reset(lane?: number): void {
+    const s = this.state;
+    for (const index of this.laneRange(lane)) {
+      const base = index * LANE_MEMORY_SIZE;
+      s.pc[index] = s.memory[base + 0xFFFC] | (s.memory[base + 0xFFFD] << 8);
+      s.a[index] = 0;
+      s.x[index] = 0;
+      s.y[index] = 0;
+      s.sp[index] = 0xFD;
+      s.status[index] = 0x24;
+      s.cycles[index] = 0;
+      s.laneStatus[index] = 0;
+      s.outputLength[index] = 0;
+    }
+  }
+
+  /**
+   * Run every running lane for up to maxCycles more cycles
+   * @returns Number of lanes still running
+   */
+  run(maxCycles: number): number {
+    return nativeAddon.batchRun(this.state, maxCycles);
+  }
+
+  getRegisters(lane: number): CPUState {
+    const s = this.state;
+    this.checkLane(lane);
+    return {
+      A: s.a[lane],
+      X: s.x[lane],
+      Y: s.y[lane],
+      PC: s.pc[lane],
+      SP: s.sp[lane],
+      P: s.status[lane],
+      cycles: s.cycles[lane]
+    };
+  }
+
+  /**
+   * Set registers; a lane given a new PC is running again
+   * @param lane Lane to update; all lanes when omitted
+   */
+  setRegisters(state: Partial<CPUState>, lane?: number): void {
+    const s = this.state;
+    for (const index of this.laneRange(lane)) {
+      if (state.A !== undefined) s.a[index] = state.A;
+      if (state.X !== undefined) s.x[index] = state.X;
+      if (state.Y !== undefined) s.y[index] = state.Y;
+      if (state.SP !== undefined) s.sp[index] = state.SP;
+      if (state.P !== undefined) s.status[index] = state.P;
+      if (state.cycles !== undefined) s.cycles[index] = state.cycles;
+      if (state.PC !== undefined) {
+        s.pc[index] = state.PC;
+        s.laneStatus[index] = 0;
+      }
+    }
+  }
+
+  getLaneStatus(lane: number): BatchLaneStatus {
+    this.checkLane(lane);
+    return LANE_STATUS[this.state.laneStatus[lane]];
+  }
+
+  read(lane: number, address: number): number {
+    this.checkLane(lane);
+    return this.state.memory[lane * LANE_MEMORY_SIZE + (address & 0xFFFF)];
+  }
+
+  write(lane: number, address: number, value: number): void {
+    this.checkLane(lane);
+    this.state.memory[lane * LANE_MEMORY_SIZE + (address & 0xFFFF)] = value & 0xFF;
+  }
+
+  /**
+   * Live view of a lane's memory; it changes as the batch runs
+   */
+  readRange(lane: number, startAddress: number, length: number): Uint8Array {
+    this.checkLane(lane);
+    const start = lane * LANE_MEMORY_SIZE + (startAddress & 0xFFFF);
+    return this.state.memory.subarray(start, start + Math.min(length, LANE_MEMORY_SIZE - (startAddress & 0xFFFF)));
+  }
+
+  /**
+   * Bytes the lane wrote to the output port since its last reset
+   */
+  getOutput(lane: number): Uint8Array {
+    this.checkLane(lane);
+    const s = this.state;
+    const length = s.outputLength[lane];
+    if (length > s.outputCapacity) {
+      console.warn(`Batch lane ${lane} wrote ${length} output bytes; only the first ${s.outputCapacity} were kept`);
+    }
+    const start = lane * s.outputCapacity;
+    return s.output.slice(start, start + Math.min(length, s.outputCapacity));
+  }
+
+  private laneRange(lane?: number): number[] {
+    if (lane === undefined) {
+      return Array.from({ length: this.lanes }, (_, index) => index);
+    }
+    this.checkLane(lane);
+    return [lane];
+  }
+
+  private checkLane(lane: number): void {
+    if (!Number.isInteger(lane) || lane < 0 || lane >= this.lanes) {
+      throw new Error(`Invalid lane: ${lane}`);
+    }
+  }
+}
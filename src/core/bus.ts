@@ -2,11 +2,41 @@
  * System bus that coordinates CPU, memory, and peripherals
  */
 
-import { CPU6502, CPU6502Emulator } from './cpu';
-import { MemoryManager } from './memory';
+import { CPU6502, CPU6502Emulator, NativeThreadOptions, NativeThreadRequest, NativeThreadState } from './cpu';
+import { MemoryManager, DirectPage, RAM_PAGE_SIZE } from './memory';
 import { PeripheralHub } from '../peripherals/base';
 import { InterruptController } from './interrupt-controller';
 
+/**
+ * Components connected by a system bus
+ */
+export interface SystemBusComponents {
+  cpu: CPU6502;
+  memory: MemoryManager;
+  peripheralHub: PeripheralHub;
+  interruptController: InterruptController;
+}
+
+/**
+ * Notifications from a bus running on the native worker thread
+ */
+export interface NativeThreadListener {
+  // Cycles and instructions executed since the previous notification
+  onProgress?(cycles: number, instructions: number): void;
+  // Worker parked on a breakpoint or after an asynchronous pause
+  onStop?(reason: 'pause' | 'breakpoint', pc: number): void;
+}
+
+/**
+ * Called for every CPU access to a peripheral register
+ */
+export type PeripheralTraceCallback = (address: number, value: number, write: boolean) => void;
+
+/**
+ * Called for every write to a watched address
+ */
+export type WriteWatchCallback = (address: number, value: number) => void;
+
 /**
  * System bus coordinates all major components
  */
@@ -15,16 +45,50 @@ export class SystemBus {
   private memory: MemoryManager;
   private peripheralHub: PeripheralHub;
   private interruptController: InterruptController;
+  private cycleCount = 0; // Cycles executed since the last reset
+  private peripheralTrace?: PeripheralTraceCallback;
+  private writeWatch?: { addresses: Set<number>; callback: WriteWatchCallback };
 
-  constructor() {
-    this.cpu = new CPU6502Emulator();
-    this.memory = new MemoryManager();
-    this.peripheralHub = new PeripheralHub();
-    this.interruptController = new InterruptController();
+  /**
+   * @param components Existing components to connect (used by fork); new
+   *   ones are created when omitted
+   */
+  constructor(components?: SystemBusComponents) {
+    this.cpu = components ? components.cpu : new CPU6502Emulator();
+    this.memory = components ? components.memory : new MemoryManager();
+    this.peripheralHub = components ? components.peripheralHub : new PeripheralHub();
+    this.interruptController = components ? components.interruptController : new InterruptController();
 
     this.setupConnections();
   }
 
+  /**
+   * Create an independent machine in the same state
+   * RAM pages are shared copy-on-write; CPU, peripheral and interrupt state
+   * are copied.
+   * @returns New system bus
+   */
+  fork(): SystemBus {
+    if (!this.cpu.fork) {
+      throw new Error('CPU implementation does not support forking');
+    }
+    if (this.getNativeThreadState() !== 'idle') {
+      throw new Error('Cannot fork while the native worker thread is active');
+    }
+
+    const interruptController = new InterruptController();
+    interruptController.restoreState(this.interruptController.saveState());
+
+    const child = new SystemBus({
+      cpu: this.cpu.fork(),
+      memory: this.memory.fork(),
+      peripheralHub: this.peripheralHub.fork(),
+      interruptController
+    });
+    child.cycleCount = this.cycleCount;
+    return child;
+  }
+
   /**
    * Set up connections between components
    */
@@ -37,6 +101,12 @@ export class SystemBus {
       (address: number) => this.handleMemoryRead(address),
       (address: number, value: number) => this.handleMemoryWrite(address, value)
     );
+
+    // Peripherals that transfer memory go through the same routing
+    this.peripheralHub.connectMemory({
+      read: (address: number) => this.handleMemoryRead(address),
+      write: (address: number, value: number) => this.handleMemoryWrite(address, value)
+    });
   }
 
   /**
@@ -45,7 +115,11 @@ export class SystemBus {
    */
   private handleMemoryRead(address: number): number {
     if (this.peripheralHub.isPeripheralAddress(address)) {
-      return this.peripheralHub.read(address);
+      const value = this.peripheralHub.read(address);
+      if (this.peripheralTrace) {
+        this.peripheralTrace(address, value, false);
+      }
+      return value;
     }
     return this.memory.read(address);
   }
@@ -55,20 +129,53 @@ export class SystemBus {
    * Routes to memory manager or peripheral hub based on address
    */
   private handleMemoryWrite(address: number, value: number): void {
+    if (this.writeWatch && this.writeWatch.addresses.has(address)) {
+      this.writeWatch.callback(address, value);
+    }
     if (this.peripheralHub.isPeripheralAddress(address)) {
       this.peripheralHub.write(address, value);
+      if (this.peripheralTrace) {
+        this.peripheralTrace(address, value, true);
+      }
     } else {
       this.memory.write(address, value);
     }
   }
 
+  /**
+   * Report CPU accesses to peripheral registers, for profiling
+   * @param callback Trace callback, or undefined to stop
+   */
+  setPeripheralTraceCallback(callback?: PeripheralTraceCallback): void {
+    this.peripheralTrace = callback;
+  }
+
+  /**
+   * Report writes to the given addresses, whatever they map to
+   * Only writes made through the bus are seen, not those of the native
+   * worker thread to RAM pages.
+   * @param addresses Addresses to watch, or null to stop
+   */
+  setWriteWatch(addresses: number[] | null, callback?: WriteWatchCallback): void {
+    this.writeWatch = addresses && addresses.length > 0 && callback ?
+      { addresses: new Set(addresses.map(address => address & 0xFFFF)), callback } : undefined;
+  }
+
   /**
    * Execute one CPU instruction and update system state
    * @returns Number of cycles consumed
    */
   step(): number {
     const cycles = this.cpu.step();
-    
+    this.advance(cycles);
+    return cycles;
+  }
+
+  /**
+   * Account for cycles executed by the CPU
+   * Ticks peripherals, updates interrupt lines and the cycle count.
+   */
+  private advance(cycles: number): void {
     // Update peripherals
     this.peripheralHub.tick(cycles);
     
@@ -76,7 +183,78 @@ export class SystemBus {
     const interruptSources = this.peripheralHub.getInterruptSources();
     this.interruptController.updateFromPeripherals(interruptSources);
     
-    return cycles;
+    this.cycleCount += cycles;
+  }
+
+  /**
+   * Run the CPU on the native worker thread
+   * RAM and ROM pages are accessed directly by the worker. Pages holding
+   * peripherals are serviced here on the main thread; peripherals catch up
+   * on the cycles the worker has run before each such access and at every
+   * sync, so interrupts are raised at that granularity.
+   */
+  startNativeThread(options: NativeThreadOptions = {}, listener: NativeThreadListener = {}): void {
+    const cpu = this.getNativeCPU();
+    const peripherals = this.peripheralHub.getPeripherals();
+
+    const pages: Array<DirectPage | null> = [];
+    for (let page = 0; page < 256; page++) {
+      const start = page * RAM_PAGE_SIZE;
+      const end = start + RAM_PAGE_SIZE - 1;
+      const hasPeripheral = peripherals.some(p => p.startAddress <= end && p.endAddress >= start);
+      pages.push(hasPeripheral ? null : this.memory.getDirectPage(page));
+    }
+
+    cpu.startNativeThread(pages, options, (request, address, value, cycles, instructions) => {
+      if (cycles > 0) {
+        this.advance(cycles);
+        if (listener.onProgress) {
+          listener.onProgress(cycles, instructions);
+        }
+      }
+
+      switch (request) {
+        case NativeThreadRequest.READ:
+          return this.handleMemoryRead(address);
+        case NativeThreadRequest.WRITE:
+          this.handleMemoryWrite(address, value);
+          return 0;
+        case NativeThreadRequest.STOPPED:
+          if (listener.onStop) {
+            listener.onStop(value === 1 ? 'breakpoint' : 'pause', address);
+          }
+          return 0;
+        default:
+          return 0;
+      }
+    });
+  }
+
+  /**
+   * Park the worker thread; peripherals are synced before this returns
+   * @returns false if the worker parks only after the current callback
+   */
+  pauseNativeThread(): boolean {
+    return this.getNativeCPU().pauseNativeThread();
+  }
+
+  resumeNativeThread(): void {
+    this.getNativeCPU().resumeNativeThread();
+  }
+
+  stopNativeThread(): void {
+    this.getNativeCPU().stopNativeThread();
+  }
+
+  getNativeThreadState(): NativeThreadState {
+    return this.cpu instanceof CPU6502Emulator ? this.cpu.getNativeThreadState() : 'idle';
+  }
+
+  private getNativeCPU(): CPU6502Emulator {
+    if (!(this.cpu instanceof CPU6502Emulator)) {
+      throw new Error('CPU implementation does not support the native worker thread');
+    }
+    return this.cpu;
   }
 
   /**
@@ -87,6 +265,19 @@ export class SystemBus {
     this.memory.resetRAM();
     this.peripheralHub.reset();
     this.interruptController.reset();
+    this.cycleCount = 0;
+  }
+
+  /**
+   * Total cycles executed through the bus since the last reset
+   * Used as the timestamp for recorded external inputs.
+   */
+  getCycleCount(): number {
+    return this.cycleCount;
+  }
+
+  setCycleCount(cycles: number): void {
+    this.cycleCount = cycles;
   }
 
   /**
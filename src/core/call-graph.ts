@@ -0,0 +1,151 @@
+/**
+ * Shadow call stack kept by the CPU core
+ * The layout matches cpu_callgraph_t in native/fake6502.h: the native core
+ * updates these arrays in place, and the functions below do the same for
+ * the TypeScript fallback core. A frame is pushed on JSR, BRK and interrupt
+ * entry, and popped once an RTS, RTI or TXS leaves SP above the value the
+ * frame was entered with. Deciding on SP rather than on the return address
+ * keeps the stack in step through RTS dispatch, inline parameters read
+ * through the return address and routines that drop their return address.
+ * Cycle counts are doubles, exact up to 2^53, so long runs do not wrap them.
+ */
+
+export const CALL_STACK_DEPTH = 256;
+export const CALL_EDGE_SLOTS = 4096;
+export const CALL_HEADER = 2;  // stack[]: depth, dropped calls
+export const CALL_FRAME = 2;   // Then per frame: address, SP
+
+// The root frame is never popped
+const ROOT_SP = 0x100;
+
+export interface CPUCallGraph {
+  calls: Uint32Array;        // Per routine address: times entered
+  inclusive: Float64Array;   // Cycles in returned calls, callees included
+  exclusive: Float64Array;   // Cycles spent in the routine itself
+  edges: Uint32Array;        // CALL_EDGE_SLOTS x {caller << 16 | callee, calls}
+  edgeCycles: Float64Array;  // Per edge slot: cycles in the callee
+  stack: Uint32Array;
+  clock: Float64Array;       // Cycle clock, then the clock at entry per frame
+}
+
+/**
+ * Empty call graph whose root frame is the code at pc
+ */
+export function createCallGraph(pc: number): CPUCallGraph {
+  const stack = new Uint32Array(CALL_HEADER + CALL_STACK_DEPTH * CALL_FRAME);
+  stack[0] = 1;
+  stack[CALL_HEADER] = pc;
+  stack[CALL_HEADER + 1] = ROOT_SP;
+  return {
+    calls: new Uint32Array(0x10000),
+    inclusive: new Float64Array(0x10000),
+    exclusive: new Float64Array(0x10000),
+    edges: new Uint32Array(CALL_EDGE_SLOTS * 2),
+    edgeCycles: new Float64Array(CALL_EDGE_SLOTS),
+    stack,
+    clock: new Float64Array(1 + CALL_STACK_DEPTH)
+  };
+}
+
+/**
+ * Edge slot for caller -> callee, or -1 when the table is full
+ */
+export function findCallEdge(graph: CPUCallGraph, caller: number, callee: number): number {
+  const key = ((caller << 16) | callee) >>> 0;
+  let slot = Math.imul(key, 2654435761) >>> 20;
+  for (let probe = 0; probe < CALL_EDGE_SLOTS; probe++) {
+    if (graph.edges[slot * 2 + 1] === 0 || graph.edges[slot * 2] === key) {
+      graph.edges[slot * 2] = key;
+      return slot;
+    }
+    slot = (slot + 1) & (CALL_EDGE_SLOTS - 1);
+  }
+  return -1;
+}
+
+/**
+ * Account for an instruction the fallback core has executed
+ * @param opcode Opcode executed
+ * @param pc PC after the instruction
+ * @param sp SP after the instruction
+ */
+export function traceInstruction(graph: CPUCallGraph, opcode: number, pc: number, sp: number, cycles: number): void {
+  charge(graph, cycles);
+  switch (opcode) {
+    case 0x00: // BRK
+    case 0x20: // JSR
+      enter(graph, pc, sp);
+      break;
+    case 0x40: // RTI
+    case 0x60: // RTS
+    case 0x9A: // TXS
+      leave(graph, sp);
+      break;
+  }
+}
+
+/**
+ * Account for interrupt entry, charged to the handler
+ * @param taken False for a masked IRQ
+ */
+export function traceInterrupt(graph: CPUCallGraph, taken: boolean, pc: number, sp: number): void {
+  if (taken) {
+    enter(graph, pc, sp);
+  }
+  charge(graph, 7);
+}
+
+function charge(graph: CPUCallGraph, cycles: number): void {
+  const stack = graph.stack;
+  graph.exclusive[stack[CALL_HEADER + (stack[0] - 1) * CALL_FRAME]] += cycles;
+  graph.clock[0] += cycles;
+}
+
+function enter(graph: CPUCallGraph, address: number, sp: number): void {
+  const stack = graph.stack;
+  const depth = stack[0];
+  const edge = findCallEdge(graph, stack[CALL_HEADER + (depth - 1) * CALL_FRAME], address);
+
+  graph.calls[address]++;
+  if (edge >= 0) {
+    graph.edges[edge * 2 + 1]++;
+  }
+  if (depth === CALL_STACK_DEPTH) {
+    stack[1]++;  // Too deep; the caller keeps the cycles
+    return;
+  }
+  const frame = CALL_HEADER + depth * CALL_FRAME;
+  stack[frame] = address;
+  stack[frame + 1] = sp;
+  graph.clock[1 + depth] = graph.clock[0];
+  stack[0] = depth + 1;
+}
+
+function leave(graph: CPUCallGraph, sp: number): void {
+  const stack = graph.stack;
+  let depth = stack[0];
+  while (depth > 1) {
+    const frame = CALL_HEADER + (depth - 1) * CALL_FRAME;
+    if (sp <= stack[frame + 1]) {
+      break;
+    }
+    const address = stack[frame];
+    const elapsed = graph.clock[0] - graph.clock[depth];
+    const caller = stack[frame - CALL_FRAME];
+    depth--;
+
+    // Recursive calls are counted once, by the outermost frame
+    let outer = 0;
+    while (outer < depth && stack[CALL_HEADER + outer * CALL_FRAME] !== address) {
+      outer++;
+    }
+    if (outer === depth) {
+      graph.inclusive[address] += elapsed;
+    }
+    const edge = findCallEdge(graph, caller, address);
+    if (edge >= 0) {
+      graph.edgeCycles[edge] += elapsed;
+    }
+  }
+  stack[0] = depth;
+}
@@ -3,7 +3,15 @@
  * Wraps the fake6502 emulator with a TypeScript interface
  */
 
+import { isMainThread } from 'worker_threads';
 import { InterruptController } from './interrupt-controller';
+import { DirectPage } from './memory';
+import { FallbackCore, REG_A, REG_X, REG_Y, REG_SP, REG_P } from './fallback-core';
+import { HostCallRegister } from '../peripherals/host-call';
+import { CPUCallGraph, createCallGraph, traceInstruction, traceInterrupt } from './call-graph';
+import { ExecutionTraceBuffer, TRACE_INSTRUCTION, TRACE_IRQ, TRACE_NMI } from '../debug/trace-buffer';
+import { BRANCH_OPCODES, COVERAGE_EXECUTED, COVERAGE_NOT_TAKEN, COVERAGE_TAKEN } from '../debug/coverage';
+import { CPURuntimeHooks, runtimeHookStep } from '../cc65/runtime-hooks';
 
 // CPU state interface
 export interface CPUState {
@@ -16,6 +24,12 @@ export interface CPUState {
   cycles: number; // Total cycles executed
 }
 
+// Full CPU snapshot including latched interrupts, used for checkpointing
+export interface CPUSnapshot extends CPUState {
+  irqPending: boolean;
+  nmiPending: boolean;
+}
+
 // CPU type enumeration
 export type CPUType = '6502' | '65C02';
 
@@ -55,16 +69,100 @@ export interface CPU6502 {
   
   // Memory access callbacks
   setMemoryCallbacks(read: MemoryReadCallback, write: MemoryWriteCallback): void;
+  
+  // Checkpointing (optional): registers plus latched interrupt lines
+  saveState?(): CPUSnapshot;
+  restoreState?(snapshot: CPUSnapshot): void;
+  
+  // Forking (optional): independent copy of the CPU state and breakpoints
+  fork?(): CPU6502;
+  
+  // Per-PC profiling (optional)
+  setProfiling?(enabled: boolean): void;
+  getProfile?(): CPUProfile | null;
+  
+  // Call graph profiling (optional)
+  setCallGraph?(enabled: boolean): void;
+  getCallGraph?(): CPUCallGraph | null;
+  
+  // Execution trace (optional)
+  setTrace?(trace: ExecutionTraceBuffer | null): void;
+  getTrace?(): ExecutionTraceBuffer | null;
+  
+  // Code coverage (optional)
+  setCoverage?(enabled: boolean): void;
+  getCoverage?(): Uint8Array | null;
+  
+  // cc65 runtime hooks (optional)
+  setRuntimeHooks?(hooks: CPURuntimeHooks | null): void;
+  getRuntimeHooks?(): CPURuntimeHooks | null;
+  
+  // BRK host calls (optional)
+  setBrkTrap?(trap: BrkTrap | null): void;
 }
 
+/**
+ * BRK followed by signature calls the host-call device at address; see
+ * src/peripherals/host-call.ts for the registers
+ */
+export interface BrkTrap {
+  signature: number;
+  address: number;
+}
+
+/**
+ * Executions and cycles per instruction address, indexed by the PC each
+ * instruction starts at; interrupt entry is not counted and the counters
+ * wrap at 2^32
+ */
+export interface CPUProfile {
+  counts: Uint32Array;
+  cycles: Uint32Array;
+}
+
+// Requests sent by the native worker thread to the main thread; every
+// request carries the cycles and instructions run since the previous one
+export enum NativeThreadRequest {
+  READ = 0,    // Read from a page without a direct mapping; returns the value
+  WRITE = 1,   // Write to a page without a direct mapping
+  SYNC = 2,    // Periodic sync so peripherals can catch up
+  STOPPED = 3  // Worker parked by itself; value is 1 for a breakpoint
+}
+
+export type NativeThreadHandler = (
+  request: NativeThreadRequest,
+  address: number,
+  value: number,
+  cycles: number,
+  instructions: number
+) => number;
+
+export interface NativeThreadOptions {
+  sliceCycles?: number; // Cycles between sync requests
+  clockHz?: number;     // Target clock speed; 0 runs unthrottled
+}
+
+export type NativeThreadState = 'idle' | 'running' | 'paused';
+
 // Import the native addon
-let nativeAddon: any;
-try {
-  nativeAddon = require('../../build/Release/fake6502_addon.node');
-  console.log('Native addon loaded successfully');
-} catch (error) {
-  console.warn('Native addon not available, using fallback implementation:', error instanceof Error ? error.message : String(error));
-  nativeAddon = null;
+// The native core is a single process-wide machine, so only the main thread
+// drives it; worker threads (see EmulatorPool) use the fallback core.
+let nativeAddon: any = null;
+if (isMainThread) {
+  try {
+    nativeAddon = require('../../build/Release/fake6502_addon.node');
+    console.log('Native addon loaded successfully');
+  } catch (error) {
+    console.warn('Native addon not available, using fallback implementation:', error instanceof Error ? error.message : String(error));
+    nativeAddon = null;
+  }
+}
+
+/**
+ * Whether the native fake6502 addon could be loaded
+ */
+export function isNativeAvailable(): boolean {
+  return nativeAddon !== null;
 }
 
 /**
@@ -79,33 +177,49 @@ export class CPU6502Emulator implements CPU6502 {
   private useNativeAddon: boolean;
   private interruptController?: InterruptController;
   
-  // Fallback state for when native addon is not available
-  private fallbackState: CPUState = {
-    A: 0,
-    X: 0,
-    Y: 0,
-    PC: 0,
-    SP: 0xFF,
-    P: 0x20, // Interrupt disable flag set by default
-    cycles: 0
-  };
-  
-  constructor() {
+  // The native core is one global machine; instances take turns on it and
+  // park their state here while another instance is active
+  private static active: CPU6502Emulator | null = null;
+  private static callbacksInstalled = false;
+  private static threadOwner: CPU6502Emulator | null = null; // Instance running on the worker thread
+  private parkedState: any = null;
+  
+  // TypeScript core for when native addon is not available
+  private core = new FallbackCore();
+  
+  private profile: CPUProfile | null = null;
+  private callGraph: CPUCallGraph | null = null;
+  private trace: ExecutionTraceBuffer | null = null;
+  private coverage: Uint8Array | null = null;
+  private hooks: CPURuntimeHooks | null = null;
+  private brkTrap: BrkTrap | null = null;
+  
+  /**
+   * @param snapshot Initial state; the CPU is reset when omitted
+   */
+  constructor(snapshot?: CPUSnapshot) {
     this.useNativeAddon = nativeAddon !== null;
     
     // Default memory callbacks that do nothing
     this.memoryRead = () => 0xFF;
     this.memoryWrite = () => {};
+    this.core.read = this.memoryRead;
+    this.core.write = this.memoryWrite;
     
-    if (this.useNativeAddon) {
-      // Set up memory callbacks for native addon
+    if (this.useNativeAddon && !CPU6502Emulator.callbacksInstalled) {
+      // Native memory accesses go to whichever instance is active
       nativeAddon.setMemoryCallbacks(
-        (address: number) => this.memoryRead(address),
-        (address: number, value: number) => this.memoryWrite(address, value)
+        (address: number) => CPU6502Emulator.active!.memoryRead(address),
+        (address: number, value: number) => CPU6502Emulator.active!.memoryWrite(address, value)
       );
+      CPU6502Emulator.callbacksInstalled = true;
     }
     
-    this.reset();
+    if (snapshot) {
+      this.restoreState(snapshot);
+    } else {
+      this.reset();
+    }
   }
   
   reset(): void {
@@ -121,6 +235,7 @@ export class CPU6502Emulator implements CPU6502 {
     }
     
     if (this.useNativeAddon) {
+      this.activate();
       // Reset native addon and then set PC to reset vector
       nativeAddon.reset();
       // Set the PC to the reset vector we read from memory
@@ -130,21 +245,13 @@ export class CPU6502Emulator implements CPU6502 {
         pc: resetPC
       });
     } else {
-      // Fallback implementation
-      this.fallbackState = {
-        A: 0,
-        X: 0,
-        Y: 0,
-        PC: resetPC,
-        SP: 0xFF,
-        P: 0x20, // Interrupt disable flag set
-        cycles: 0
-      };
+      this.core.reset(resetPC);
     }
   }
   
   step(): number {
     if (this.useNativeAddon) {
+      this.activate();
       // Check for breakpoints
       const currentState = this.getRegisters();
       if (this.breakpoints.has(currentState.PC)) {
@@ -154,23 +261,106 @@ export class CPU6502Emulator implements CPU6502 {
       // Execute one instruction using native addon
       return nativeAddon.step();
     } else {
-      // Fallback implementation
       // Check for breakpoints
-      if (this.breakpoints.has(this.fallbackState.PC)) {
+      const pc = this.core.pc[0];
+      if (this.breakpoints.has(pc)) {
         return 0; // Execution halted at breakpoint
       }
       
-      // Fetch and execute instruction
-      const opcode = this.memoryRead(this.fallbackState.PC);
-      const cycles = this.executeInstruction(opcode);
-      
-      this.fallbackState.cycles += cycles;
+      if (this.hooks) {
+        const hooked = runtimeHookStep(this.hooks, this.core, this.memoryRead, this.memoryWrite);
+        if (hooked) {
+          this.accountHostStep(pc, hooked);
+          return hooked;
+        }
+      }
+      if (!this.profile && !this.callGraph && !this.trace && !this.coverage && !this.brkTrap) {
+        return this.core.step();
+      }
+      const sp = this.core.registers[REG_SP];
+      const status = this.core.registers[REG_P];
+      const nmi = this.core.nmiPending;
+      if (this.trace) {
+        this.trace.begin(pc, this.core.registers);
+      }
+      const cycles = this.core.step();
+      const opcode = this.core.opcode;  // -1 after interrupt entry, which is not profiled per PC
+      if (opcode === 0x00 && this.brkTrap && this.memoryRead((pc + 1) & 0xFFFF) === this.brkTrap.signature) {
+        // Undo the interrupt entry, as cpu_step in fake6502.c does
+        this.core.pc[0] = pc + 2;
+        this.core.registers[REG_SP] = sp;
+        this.core.registers[REG_P] = status;
+        this.brkHostCall(this.brkTrap.address);
+        this.accountHostStep(pc, cycles);
+        return cycles;
+      }
+      if (this.profile && opcode >= 0) {
+        this.profile.counts[pc]++;
+        this.profile.cycles[pc] += cycles;
+      }
+      if (this.coverage && opcode >= 0) {
+        let flags = COVERAGE_EXECUTED;
+        if (BRANCH_OPCODES[opcode]) {
+          flags |= this.core.pc[0] === ((pc + 2) & 0xFFFF) ? COVERAGE_NOT_TAKEN : COVERAGE_TAKEN;
+        }
+        this.coverage[pc] |= flags;
+      }
+      if (this.callGraph) {
+        const newSp = this.core.registers[REG_SP];
+        if (opcode >= 0) {
+          traceInstruction(this.callGraph, opcode, this.core.pc[0], newSp, cycles);
+        } else {
+          traceInterrupt(this.callGraph, newSp !== sp, this.core.pc[0], newSp);
+        }
+      }
+      if (this.trace) {
+        if (opcode >= 0) {
+          this.trace.end(TRACE_INSTRUCTION, opcode, cycles, this.memoryRead);
+        } else if (this.core.registers[REG_SP] !== sp) {
+          this.trace.end(nmi ? TRACE_NMI : TRACE_IRQ, 0, cycles, this.memoryRead);
+        } else {
+          this.trace.skip(cycles);  // Masked IRQ
+        }
+      }
       return cycles;
     }
   }
   
+  // Work done on the host for the instruction at pc is charged to it; a
+  // hooked routine returns as its RTS would
+  private accountHostStep(pc: number, cycles: number): void {
+    if (this.coverage) {
+      this.coverage[pc] |= COVERAGE_EXECUTED;
+    }
+    if (this.profile) {
+      this.profile.counts[pc]++;
+      this.profile.cycles[pc] += cycles;
+    }
+    if (this.callGraph) {
+      traceInstruction(this.callGraph, 0x60, this.core.pc[0], this.core.registers[REG_SP], cycles);
+    }
+    if (this.trace) {
+      this.trace.skip(cycles);
+    }
+  }
+  
+  private brkHostCall(address: number): void {
+    const registers = this.core.registers;
+    this.memoryWrite((address + HostCallRegister.ARG_LO) & 0xFFFF, registers[REG_A]);
+    this.memoryWrite((address + HostCallRegister.ARG_HI) & 0xFFFF, registers[REG_X]);
+    this.memoryWrite((address + HostCallRegister.SERVICE) & 0xFFFF, registers[REG_Y]);
+    registers[REG_A] = this.memoryRead((address + HostCallRegister.RESULT_LO) & 0xFFFF);
+    registers[REG_X] = this.memoryRead((address + HostCallRegister.RESULT_HI) & 0xFFFF);
+    if (this.memoryRead((address + HostCallRegister.STATUS) & 0xFFFF)) {
+      registers[REG_P] |= 0x01;
+    } else {
+      registers[REG_P] &= ~0x01;
+    }
+  }
+  
   getRegisters(): CPUState {
     if (this.useNativeAddon) {
+      this.activate();
       const nativeState = nativeAddon.getState();
       return {
         A: nativeState.a,
@@ -182,12 +372,22 @@ export class CPU6502Emulator implements CPU6502 {
         cycles: nativeState.cycles
       };
     } else {
-      return { ...this.fallbackState };
+      const registers = this.core.registers;
+      return {
+        A: registers[REG_A],
+        X: registers[REG_X],
+        Y: registers[REG_Y],
+        PC: this.core.pc[0],
+        SP: registers[REG_SP],
+        P: registers[REG_P],
+        cycles: this.core.cycles
+      };
     }
   }
   
   setRegisters(newState: Partial<CPUState>): void {
     if (this.useNativeAddon) {
+      this.activate();
       const currentState = nativeAddon.getState();
       const updatedState = {
         pc: newState.PC !== undefined ? newState.PC : currentState.pc,
@@ -200,20 +400,70 @@ export class CPU6502Emulator implements CPU6502 {
       };
       nativeAddon.setState(updatedState);
     } else {
-      this.fallbackState = { ...this.fallbackState, ...newState };
+      const registers = this.core.registers;
+      if (newState.A !== undefined) registers[REG_A] = newState.A;
+      if (newState.X !== undefined) registers[REG_X] = newState.X;
+      if (newState.Y !== undefined) registers[REG_Y] = newState.Y;
+      if (newState.SP !== undefined) registers[REG_SP] = newState.SP;
+      if (newState.P !== undefined) registers[REG_P] = newState.P;
+      if (newState.PC !== undefined) this.core.pc[0] = newState.PC;
+      if (newState.cycles !== undefined) this.core.cycles = newState.cycles;
+    }
+  }
+  
+  saveState(): CPUSnapshot {
+    if (this.useNativeAddon) {
+      this.activate();
+      const nativeState = nativeAddon.getState();
+      return {
+        ...this.getRegisters(),
+        irqPending: nativeState.irqPending === true,
+        nmiPending: nativeState.nmiPending === true
+      };
+    }
+    return { ...this.getRegisters(), irqPending: this.core.irqPending, nmiPending: this.core.nmiPending };
+  }
+  
+  restoreState(snapshot: CPUSnapshot): void {
+    if (this.useNativeAddon) {
+      this.activate();
+      nativeAddon.setState({
+        pc: snapshot.PC,
+        sp: snapshot.SP,
+        a: snapshot.A,
+        x: snapshot.X,
+        y: snapshot.Y,
+        status: snapshot.P,
+        cycles: snapshot.cycles,
+        irqPending: snapshot.irqPending,
+        nmiPending: snapshot.nmiPending
+      });
+    } else {
+      this.setRegisters(snapshot);
+      this.core.irqPending = snapshot.irqPending;
+      this.core.nmiPending = snapshot.nmiPending;
     }
   }
   
   setBreakpoint(address: number): void {
     this.breakpoints.add(address & 0xFFFF);
+    if (CPU6502Emulator.threadOwner === this) {
+      nativeAddon.setBreakpoint(address & 0xFFFF, true);
+    }
   }
   
   removeBreakpoint(address: number): void {
     this.breakpoints.delete(address & 0xFFFF);
+    if (CPU6502Emulator.threadOwner === this) {
+      nativeAddon.setBreakpoint(address & 0xFFFF, false);
+    }
   }
   
   clearBreakpoints(): void {
     this.breakpoints.clear();
+    if (CPU6502Emulator.threadOwner === this) {
+      nativeAddon.clearBreakpoints();
+    }
   }
   
   hasBreakpoint(address: number): boolean {
@@ -230,49 +480,282 @@ export class CPU6502Emulator implements CPU6502 {
   
   triggerIRQ(): void {
     if (this.useNativeAddon) {
+      this.activate();
       nativeAddon.triggerIRQ();
+    } else {
+      this.core.irqPending = true;
     }
-    // Fallback implementation would need interrupt handling
   }
   
   triggerNMI(): void {
     if (this.useNativeAddon) {
+      this.activate();
       nativeAddon.triggerNMI();
+    } else {
+      this.core.nmiPending = true;
     }
-    // Fallback implementation would need interrupt handling
   }
   
   clearIRQ(): void {
     if (this.useNativeAddon) {
+      this.activate();
       nativeAddon.clearIRQ();
+    } else {
+      this.core.irqPending = false;
     }
-    // Fallback implementation would need interrupt handling
   }
   
   isIRQPending(): boolean {
     if (this.useNativeAddon) {
+      this.activate();
       return nativeAddon.isIRQPending();
     }
-    return false; // Fallback
+    return this.core.irqPending;
   }
   
   isNMIPending(): boolean {
     if (this.useNativeAddon) {
+      this.activate();
       return nativeAddon.isNMIPending();
     }
-    return false; // Fallback
+    return this.core.nmiPending;
   }
   
   setMemoryCallbacks(read: MemoryReadCallback, write: MemoryWriteCallback): void {
+    // The native bridge dispatches to the active instance's callbacks
     this.memoryRead = read;
     this.memoryWrite = write;
+    this.core.read = read;
+    this.core.write = write;
+  }
+  
+  /**
+   * Create an independent CPU with this one's registers, latched interrupts,
+   * type, breakpoints and BRK trap. Memory callbacks and the interrupt
+   * controller are left for the owner to connect.
+   */
+  fork(): CPU6502Emulator {
+    const child = new CPU6502Emulator(this.saveState());
+    child.cpuType = this.cpuType;
+    child.breakpoints = new Set(this.breakpoints);
+    child.brkTrap = this.brkTrap;
+    return child;
+  }
+  
+  /**
+   * Count executions and cycles per instruction address
+   * The core updates the counters in place, in native code when the addon
+   * is loaded, including on the worker thread; when off the cost is one
+   * branch per instruction. Enabling starts from zero.
+   */
+  setProfiling(enabled: boolean): void {
+    const profile = enabled ? { counts: new Uint32Array(0x10000), cycles: new Uint32Array(0x10000) } : null;
+    if (this.useNativeAddon && CPU6502Emulator.active === this) {
+      // Throws while the worker thread runs; keep the old profile if so
+      nativeAddon.setProfile(profile ? profile.counts : null, profile ? profile.cycles : null);
+    }
+    this.profile = profile;
+  }
+  
+  /**
+   * Live profile counters, or null when profiling is off
+   */
+  getProfile(): CPUProfile | null {
+    return this.profile;
+  }
+  
+  /**
+   * Attribute cycles to subroutines through a shadow call stack
+   * The code running now becomes the root of the graph; see call-graph.ts
+   * for how calls and returns are matched.
+   */
+  setCallGraph(enabled: boolean): void {
+    const graph = enabled ? createCallGraph(this.getRegisters().PC) : null;
+    if (this.useNativeAddon && CPU6502Emulator.active === this) {
+      // Throws while the worker thread runs; keep the old graph if so
+      nativeAddon.setCallGraph(graph);
+    }
+    this.callGraph = graph;
+  }
+  
+  /**
+   * Live call graph arrays, or null when call graph profiling is off
+   */
+  getCallGraph(): CPUCallGraph | null {
+    return this.callGraph;
+  }
+  
+  /**
+   * Record every step into a ring of fixed-size records
+   * The native core writes the records itself, including on the worker
+   * thread; see trace-buffer.ts for the layout.
+   */
+  setTrace(trace: ExecutionTraceBuffer | null): void {
+    if (this.useNativeAddon && CPU6502Emulator.active === this) {
+      // Throws while the worker thread runs; keep the old trace if so
+      nativeAddon.setTrace(trace);
+    }
+    this.trace = trace;
+  }
+  
+  getTrace(): ExecutionTraceBuffer | null {
+    return this.trace;
+  }
+  
+  /**
+   * Mark executed instruction addresses and branch outcomes in a 64K map
+   * The core ORs the flags in place, in native code when the addon is
+   * loaded, including on the worker thread; see coverage.ts for the flags.
+   * Enabling starts from an empty map.
+   */
+  setCoverage(enabled: boolean): void {
+    const coverage = enabled ? new Uint8Array(0x10000) : null;
+    if (this.useNativeAddon && CPU6502Emulator.active === this) {
+      // Throws while the worker thread runs; keep the old map if so
+      nativeAddon.setCoverage(coverage);
+    }
+    this.coverage = coverage;
+  }
+  
+  /**
+   * Live coverage map, or null when coverage is off
+   */
+  getCoverage(): Uint8Array | null {
+    return this.coverage;
+  }
+  
+  /**
+   * Perform cc65 runtime routines on the host, see runtime-hooks.ts
+   * The core runs the hooks itself, in native code when the addon is
+   * loaded, including on the worker thread; null turns them off.
+   */
+  setRuntimeHooks(hooks: CPURuntimeHooks | null): void {
+    if (this.useNativeAddon && CPU6502Emulator.active === this) {
+      // Throws while the worker thread runs; keep the old hooks if so
+      nativeAddon.setHooks(hooks);
+    }
+    if (hooks) {
+      hooks.check = undefined;
+    }
+    this.hooks = hooks;
+  }
+  
+  getRuntimeHooks(): CPURuntimeHooks | null {
+    return this.hooks;
+  }
+  
+  /**
+   * Turn BRK with a signature byte into a host call instead of an
+   * interrupt, in native code when the addon is loaded; null turns it off
+   */
+  setBrkTrap(trap: BrkTrap | null): void {
+    if (this.useNativeAddon && CPU6502Emulator.active === this) {
+      if (trap) {
+        nativeAddon.setBrkTrap(trap.signature, trap.address);
+      } else {
+        nativeAddon.setBrkTrap(null);
+      }
+    }
+    this.brkTrap = trap;
+  }
+  
+  /**
+   * Run this CPU on the native worker thread
+   * Pages with a direct mapping are accessed by the worker without leaving
+   * native code; all other accesses and periodic syncs go to the handler,
+   * which runs on the main thread while the worker waits for its result.
+   * @param pages Direct mapping for each of the 256 pages (null: use the handler)
+   */
+  startNativeThread(pages: Array<DirectPage | null>, options: NativeThreadOptions, handler: NativeThreadHandler): void {
+    if (!this.useNativeAddon) {
+      throw new Error('Native worker thread requires the native addon');
+    }
+    if (CPU6502Emulator.threadOwner) {
+      throw new Error('Native worker thread is already in use');
+    }
+    this.activate();
     
-    if (this.useNativeAddon) {
-      // Update native addon callbacks
-      nativeAddon.setMemoryCallbacks(
-        (address: number) => this.memoryRead(address),
-        (address: number, value: number) => this.memoryWrite(address, value)
-      );
+    nativeAddon.clearPageMap();
+    pages.forEach((direct, page) => {
+      if (direct) {
+        nativeAddon.mapPage(page, direct.kind === 'RAM' ? 1 : 2, direct.data, direct.dirty, direct.versions, direct.index);
+      }
+    });
+    
+    nativeAddon.clearBreakpoints();
+    for (const address of this.breakpoints) {
+      nativeAddon.setBreakpoint(address, true);
+    }
+    
+    nativeAddon.threadStart(handler, options);
+    CPU6502Emulator.threadOwner = this;
+  }
+  
+  /**
+   * Park the worker thread
+   * @returns false if called from the handler; the worker then parks once
+   *   the handler returns and reports STOPPED
+   */
+  pauseNativeThread(): boolean {
+    return CPU6502Emulator.threadOwner === this ? nativeAddon.threadPause() : true;
+  }
+  
+  resumeNativeThread(): void {
+    if (CPU6502Emulator.threadOwner === this) {
+      nativeAddon.threadResume();
+    }
+  }
+  
+  /**
+   * Stop and join the worker thread; the CPU stays in its final state
+   */
+  stopNativeThread(): void {
+    if (CPU6502Emulator.threadOwner !== this) {
+      return;
+    }
+    nativeAddon.threadStop();
+    nativeAddon.clearPageMap();
+    nativeAddon.clearBreakpoints();
+    CPU6502Emulator.threadOwner = null;
+  }
+  
+  getNativeThreadState(): NativeThreadState {
+    return CPU6502Emulator.threadOwner === this ? nativeAddon.threadStatus() : 'idle';
+  }
+  
+  /**
+   * Make this instance the one loaded into the native core
+   */
+  private activate(): void {
+    const active = CPU6502Emulator.active;
+    if (active === this) {
+      return;
+    }
+    if (CPU6502Emulator.threadOwner) {
+      throw new Error('Native core is in use by the worker thread');
+    }
+    
+    if (active) {
+      active.parkedState = nativeAddon.getState();
+    }
+    if (this.parkedState) {
+      nativeAddon.setState(this.parkedState);
+      this.parkedState = null;
+    }
+    CPU6502Emulator.active = this;
+    this.installProfile();
+  }
+  
+  private installProfile(): void {
+    nativeAddon.setProfile(this.profile ? this.profile.counts : null, this.profile ? this.profile.cycles : null);
+    nativeAddon.setCallGraph(this.callGraph);
+    nativeAddon.setTrace(this.trace);
+    nativeAddon.setCoverage(this.coverage);
+    nativeAddon.setHooks(this.hooks);
+    if (this.brkTrap) {
+      nativeAddon.setBrkTrap(this.brkTrap.signature, this.brkTrap.address);
+    } else {
+      nativeAddon.setBrkTrap(null);
     }
   }
   
@@ -293,138 +776,4 @@ export class CPU6502Emulator implements CPU6502 {
     const result = low | (high << 8);
     return result;
   }
-  
-  private pushByte(value: number): void {
-    this.memoryWrite(0x0100 | this.fallbackState.SP, value);
-    this.fallbackState.SP = (this.fallbackState.SP - 1) & 0xFF;
-  }
-  
-  private pullByte(): number {
-    this.fallbackState.SP = (this.fallbackState.SP + 1) & 0xFF;
-    return this.memoryRead(0x0100 | this.fallbackState.SP);
-  }
-  
-  private handleNMI(): void {
-    // Fallback NMI handling
-    // Push PC and status register
-    this.pushByte((this.fallbackState.PC >> 8) & 0xFF);
-    this.pushByte(this.fallbackState.PC & 0xFF);
-    this.pushByte(this.fallbackState.P);
-    
-    // Set interrupt disable flag
-    this.fallbackState.P |= 0x04;
-    
-    // Jump to NMI vector
-    this.fallbackState.PC = this.readWord(0xFFFA);
-  }
-  
-  private handleIRQ(): void {
-    // Fallback IRQ handling
-    // Push PC and status register
-    this.pushByte((this.fallbackState.PC >> 8) & 0xFF);
-    this.pushByte(this.fallbackState.PC & 0xFF);
-    this.pushByte(this.fallbackState.P);
-    
-    // Set interrupt disable flag
-    this.fallbackState.P |= 0x04;
-    
-    // Jump to IRQ vector
-    this.fallbackState.PC = this.readWord(0xFFFE);
-  }
-  
-  private executeInstruction(opcode: number): number {
-    // Fallback instruction execution for when native addon is not available
-    const startPC = this.fallbackState.PC;
-    
-    switch (opcode) {
-      case 0x00: // BRK
-        this.fallbackState.PC = (this.fallbackState.PC + 2) & 0xFFFF;
-        this.handleIRQ();
-        return 7;
-        
-      case 0x4C: // JMP absolute
-        this.fallbackState.PC = this.readWord(this.fallbackState.PC + 1);
-        return 3;
-        
-      case 0x6C: // JMP indirect
-        {
-          const addr = this.readWord(this.fallbackState.PC + 1);
-          // Handle page boundary bug in original 6502
-          if ((addr & 0xFF) === 0xFF) {
-            const low = this.memoryRead(addr);
-            const high = this.memoryRead(addr & 0xFF00);
-            this.fallbackState.PC = low | (high << 8);
-          } else {
-            this.fallbackState.PC = this.readWord(addr);
-          }
-          return 5;
-        }
-        
-      case 0xA9: // LDA immediate
-        this.fallbackState.A = this.memoryRead(this.fallbackState.PC + 1);
-        this.fallbackState.PC = (this.fallbackState.PC + 2) & 0xFFFF;
-        this.setZeroNegativeFlags(this.fallbackState.A);
-        return 2;
-        
-      case 0xA5: // LDA zero page
-        {
-          const addr = this.memoryRead(this.fallbackState.PC + 1);
-          this.fallbackState.A = this.memoryRead(addr);
-          this.fallbackState.PC = (this.fallbackState.PC + 2) & 0xFFFF;
-          this.setZeroNegativeFlags(this.fallbackState.A);
-          return 3;
-        }
-        
-      case 0xAD: // LDA absolute
-        {
-          const addr = this.readWord(this.fallbackState.PC + 1);
-          this.fallbackState.A = this.memoryRead(addr);
-          this.fallbackState.PC = (this.fallbackState.PC + 3) & 0xFFFF;
-          this.setZeroNegativeFlags(this.fallbackState.A);
-          return 4;
-        }
-        
-      case 0x85: // STA zero page
-        {
-          const addr = this.memoryRead(this.fallbackState.PC + 1);
-          this.memoryWrite(addr, this.fallbackState.A);
-          this.fallbackState.PC = (this.fallbackState.PC + 2) & 0xFFFF;
-          return 3;
-        }
-        
-      case 0x8D: // STA absolute
-        {
-          const addr = this.readWord(this.fallbackState.PC + 1);
-          this.memoryWrite(addr, this.fallbackState.A);
-          this.fallbackState.PC = (this.fallbackState.PC + 3) & 0xFFFF;
-          return 4;
-        }
-        
-      case 0xEA: // NOP
-        this.fallbackState.PC = (this.fallbackState.PC + 1) & 0xFFFF;
-        return 2;
-        
-      case 0x40: // RTI
-        this.fallbackState.P = this.pullByte();
-        this.fallbackState.PC = this.pullByte();
-        this.fallbackState.PC |= (this.pullByte() << 8);
-        return 6;
-        
-      default:
-        // Unknown opcode - advance PC and return minimum cycles
-        console.warn(`Unknown opcode: 0x${opcode.toString(16).padStart(2, '0')} at PC: 0x${startPC.toString(16).padStart(4, '0')}`);
-        this.fallbackState.PC = (this.fallbackState.PC + 1) & 0xFFFF;
-        return 2;
-    }
-  }
-  
-  private setZeroNegativeFlags(value: number): void {
-    this.fallbackState.P &= ~(0x02 | 0x80); // Clear zero and negative flags
-    if (value === 0) {
-      this.fallbackState.P |= 0x02; // Set zero flag
-    }
-    if (value & 0x80) {
-      this.fallbackState.P |= 0x80; // Set negative flag
-    }
-  }
 }
\ No newline at end of file
@@ -0,0 +1,2215 @@
+/**
+ * Pure TypeScript 6502 core
+ * GENERATED by scripts/generate-fallback-core.js from the tables in
+ * native/fake6502_improved.h; do not edit by hand.
+ *
+ * Used by CPU6502Emulator when the native addon is unavailable. It follows
+ * the native core instruction for instruction (no decimal mode, undocumented
+ * opcodes, the same cycle counts and page-crossing penalties, the same
+ * interrupt handling). Registers live in typed arrays and step() allocates
+ * nothing.
+ */
+
+export type CoreReadCallback = (address: number) => number;
+export type CoreWriteCallback = (address: number, value: number) => void;
+
+// Indices into FallbackCore.registers
+export const REG_A = 0;
+export const REG_X = 1;
+export const REG_Y = 2;
+export const REG_SP = 3;
+export const REG_P = 4;
+
+// Bytes per instruction, opcode and operands, by opcode
+export const INSTRUCTION_LENGTH = Uint8Array.from([
+  1, 2, 1, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,
+  2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3,
+  3, 2, 1, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,
+  2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3,
+  1, 2, 1, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,
+  2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3,
+  1, 2, 1, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,
+  2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3,
+  2, 2, 2, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,
+  2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3,
+  2, 2, 2, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,
+  2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3,
+  2, 2, 2, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,
+  2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3,
+  2, 2, 2, 2, 2, 2, 2, 2, 1, 2, 1, 2, 3, 3, 3, 3,
+  2, 2, 1, 2, 2, 2, 2, 2, 1, 3, 1, 3, 3, 3, 3, 3
+]);
+
+// Addressing mode and operation by opcode, as named in the native tables
+export const ADDRESSING_MODE: readonly string[] = [
+  'imp', 'indx', 'imp', 'indx', 'zp', 'zp', 'zp', 'zp', 'imp', 'imm', 'acc', 'imm', 'abso', 'abso', 'abso', 'abso',
+  'rel', 'indy', 'imp', 'indy', 'zpx', 'zpx', 'zpx', 'zpx', 'imp', 'absy', 'imp', 'absy', 'absx', 'absx', 'absx', 'absx',
+  'abso', 'indx', 'imp', 'indx', 'zp', 'zp', 'zp', 'zp', 'imp', 'imm', 'acc', 'imm', 'abso', 'abso', 'abso', 'abso',
+  'rel', 'indy', 'imp', 'indy', 'zpx', 'zpx', 'zpx', 'zpx', 'imp', 'absy', 'imp', 'absy', 'absx', 'absx', 'absx', 'absx',
+  'imp', 'indx', 'imp', 'indx', 'zp', 'zp', 'zp', 'zp', 'imp', 'imm', 'acc', 'imm', 'abso', 'abso', 'abso', 'abso',
+  'rel', 'indy', 'imp', 'indy', 'zpx', 'zpx', 'zpx', 'zpx', 'imp', 'absy', 'imp', 'absy', 'absx', 'absx', 'absx', 'absx',
+  'imp', 'indx', 'imp', 'indx', 'zp', 'zp', 'zp', 'zp', 'imp', 'imm', 'acc', 'imm', 'ind', 'abso', 'abso', 'abso',
+  'rel', 'indy', 'imp', 'indy', 'zpx', 'zpx', 'zpx', 'zpx', 'imp', 'absy', 'imp', 'absy', 'absx', 'absx', 'absx', 'absx',
+  'imm', 'indx', 'imm', 'indx', 'zp', 'zp', 'zp', 'zp', 'imp', 'imm', 'imp', 'imm', 'abso', 'abso', 'abso', 'abso',
+  'rel', 'indy', 'imp', 'indy', 'zpx', 'zpx', 'zpy', 'zpy', 'imp', 'absy', 'imp', 'absy', 'absx', 'absx', 'absy', 'absy',
+  'imm', 'indx', 'imm', 'indx', 'zp', 'zp', 'zp', 'zp', 'imp', 'imm', 'imp', 'imm', 'abso', 'abso', 'abso', 'abso',
+  'rel', 'indy', 'imp', 'indy', 'zpx', 'zpx', 'zpy', 'zpy', 'imp', 'absy', 'imp', 'absy', 'absx', 'absx', 'absy', 'absy',
+  'imm', 'indx', 'imm', 'indx', 'zp', 'zp', 'zp', 'zp', 'imp', 'imm', 'imp', 'imm', 'abso', 'abso', 'abso', 'abso',
+  'rel', 'indy', 'imp', 'indy', 'zpx', 'zpx', 'zpx', 'zpx', 'imp', 'absy', 'imp', 'absy', 'absx', 'absx', 'absx', 'absx',
+  'imm', 'indx', 'imm', 'indx', 'zp', 'zp', 'zp', 'zp', 'imp', 'imm', 'imp', 'imm', 'abso', 'abso', 'abso', 'abso',
+  'rel', 'indy', 'imp', 'indy', 'zpx', 'zpx', 'zpx', 'zpx', 'imp', 'absy', 'imp', 'absy', 'absx', 'absx', 'absx', 'absx'
+];
+
+export const OPERATION: readonly string[] = [
+  'brk', 'ora', 'nop', 'slo', 'nop', 'ora', 'asl', 'slo', 'php', 'ora', 'asl', 'nop', 'nop', 'ora', 'asl', 'slo',
+  'bpl', 'ora', 'nop', 'slo', 'nop', 'ora', 'asl', 'slo', 'clc', 'ora', 'nop', 'slo', 'nop', 'ora', 'asl', 'slo',
+  'jsr', 'and', 'nop', 'rla', 'bit', 'and', 'rol', 'rla', 'plp', 'and', 'rol', 'nop', 'bit', 'and', 'rol', 'rla',
+  'bmi', 'and', 'nop', 'rla', 'nop', 'and', 'rol', 'rla', 'sec', 'and', 'nop', 'rla', 'nop', 'and', 'rol', 'rla',
+  'rti', 'eor', 'nop', 'sre', 'nop', 'eor', 'lsr', 'sre', 'pha', 'eor', 'lsr', 'nop', 'jmp', 'eor', 'lsr', 'sre',
+  'bvc', 'eor', 'nop', 'sre', 'nop', 'eor', 'lsr', 'sre', 'cli', 'eor', 'nop', 'sre', 'nop', 'eor', 'lsr', 'sre',
+  'rts', 'adc', 'nop', 'rra', 'nop', 'adc', 'ror', 'rra', 'pla', 'adc', 'ror', 'nop', 'jmp', 'adc', 'ror', 'rra',
+  'bvs', 'adc', 'nop', 'rra', 'nop', 'adc', 'ror', 'rra', 'sei', 'adc', 'nop', 'rra', 'nop', 'adc', 'ror', 'rra',
+  'nop', 'sta', 'nop', 'sax', 'sty', 'sta', 'stx', 'sax', 'dey', 'nop', 'txa', 'nop', 'sty', 'sta', 'stx', 'sax',
+  'bcc', 'sta', 'nop', 'nop', 'sty', 'sta', 'stx', 'sax', 'tya', 'sta', 'txs', 'nop', 'nop', 'sta', 'nop', 'nop',
+  'ldy', 'lda', 'ldx', 'lax', 'ldy', 'lda', 'ldx', 'lax', 'tay', 'lda', 'tax', 'nop', 'ldy', 'lda', 'ldx', 'lax',
+  'bcs', 'lda', 'nop', 'lax', 'ldy', 'lda', 'ldx', 'lax', 'clv', 'lda', 'tsx', 'lax', 'ldy', 'lda', 'ldx', 'lax',
+  'cpy', 'cmp', 'nop', 'dcp', 'cpy', 'cmp', 'dec', 'dcp', 'iny', 'cmp', 'dex', 'nop', 'cpy', 'cmp', 'dec', 'dcp',
+  'bne', 'cmp', 'nop', 'dcp', 'nop', 'cmp', 'dec', 'dcp', 'cld', 'cmp', 'nop', 'dcp', 'nop', 'cmp', 'dec', 'dcp',
+  'cpx', 'sbc', 'nop', 'isb', 'cpx', 'sbc', 'inc', 'isb', 'inx', 'sbc', 'nop', 'sbc', 'cpx', 'sbc', 'inc', 'isb',
+  'beq', 'sbc', 'nop', 'isb', 'nop', 'sbc', 'inc', 'isb', 'sed', 'sbc', 'nop', 'isb', 'nop', 'sbc', 'inc', 'isb'
+];
+
+export class FallbackCore {
+  readonly registers = new Uint8Array(5);
+  readonly pc = new Uint16Array(1);
+  cycles = 0;
+  opcode = -1;  // Last instruction executed; -1 after interrupt entry
+  irqPending = false;
+  nmiPending = false;
+  read: CoreReadCallback = () => 0xFF;
+  write: CoreWriteCallback = () => {};
+
+  /**
+   * Power-on state of the native core, starting at the given address
+   */
+  reset(pc: number): void {
+    this.registers.set([0, 0, 0, 0xFD, 0x24]);
+    this.pc[0] = pc;
+    this.cycles = 0;
+    this.opcode = -1;
+    this.irqPending = false;
+    this.nmiPending = false;
+  }
+
+  /**
+   * Service a latched interrupt or execute one instruction
+   * @returns Cycles consumed
+   */
+  step(): number {
+    const registers = this.registers;
+    const read = this.read;
+    const write = this.write;
+    let a = registers[REG_A];
+    let x = registers[REG_X];
+    let y = registers[REG_Y];
+    let sp = registers[REG_SP];
+    let p = registers[REG_P];
+    let pc = this.pc[0];
+    let ea = 0;
+    let value = 0;
+    let result = 0;
+    let crossed = 0;
+    let cycles = 7;
+    let opcode = -1;
+
+    if (this.nmiPending) {
+      this.nmiPending = false;
+      write(0x100 + sp, pc >> 8);
+      write(0x100 + ((sp - 1) & 0xFF), pc & 0xFF);
+      sp = (sp - 2) & 0xFF;
+      write(0x100 + sp, p & ~0x10);
+      sp = (sp - 1) & 0xFF;
+      p |= 0x04;
+      pc = read(0xFFFA) | (read(0xFFFB) << 8);
+    } else if (this.irqPending) {
+      // A masked IRQ is dropped, as in the native core
+      this.irqPending = false;
+      if ((p & 0x04) === 0) {
+        write(0x100 + sp, pc >> 8);
+        write(0x100 + ((sp - 1) & 0xFF), pc & 0xFF);
+        sp = (sp - 2) & 0xFF;
+        write(0x100 + sp, p & ~0x10);
+        sp = (sp - 1) & 0xFF;
+        p |= 0x04;
+        pc = read(0xFFFE) | (read(0xFFFF) << 8);
+      }
+    } else {
+      opcode = read(pc);
+      pc = (pc + 1) & 0xFFFF;
+      p |= 0x20;
+
+      switch (opcode) {
+        case 0x00: // BRK imp
+          cycles = 7;
+          pc = (pc + 1) & 0xFFFF;
+          write(0x100 + sp, pc >> 8);
+          write(0x100 + ((sp - 1) & 0xFF), pc & 0xFF);
+          sp = (sp - 2) & 0xFF;
+          write(0x100 + sp, p | 0x10);
+          sp = (sp - 1) & 0xFF;
+          p |= 0x04;
+          pc = read(0xFFFE) | (read(0xFFFF) << 8);
+          break;
+        case 0x01: // ORA indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 6;
+          a = a | read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x02: // NOP imp
+          cycles = 2;
+          break;
+        case 0x03: // SLO indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 8;
+          value = read(ea);
+          result = (value << 1) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a | read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x04: // NOP zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          break;
+        case 0x05: // ORA zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          a = a | read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x06: // ASL zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 5;
+          value = read(ea);
+          result = (value << 1) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x07: // SLO zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 5;
+          value = read(ea);
+          result = (value << 1) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a | read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x08: // PHP imp
+          cycles = 3;
+          write(0x100 + sp, p | 0x10);
+          sp = (sp - 1) & 0xFF;
+          break;
+        case 0x09: // ORA imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          a = a | read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x0A: // ASL acc
+          cycles = 2;
+          value = a;
+          result = (value << 1) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          a = result;
+          break;
+        case 0x0B: // NOP imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          break;
+        case 0x0C: // NOP abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          break;
+        case 0x0D: // ORA abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          a = a | read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x0E: // ASL abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = (value << 1) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x0F: // SLO abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = (value << 1) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a | read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x10: // BPL rel
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          if ((p & 0x80) === 0) {
+            result = (pc + ((ea ^ 0x80) - 0x80)) & 0xFFFF;
+            cycles += (pc ^ result) & 0xFF00 ? 2 : 1;
+            pc = result;
+          }
+          break;
+        case 0x11: // ORA indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          cycles = 5 + (crossed ? 1 : 0);
+          a = a | read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x12: // NOP imp
+          cycles = 2;
+          break;
+        case 0x13: // SLO indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          cycles = 8;
+          value = read(ea);
+          result = (value << 1) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a | read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x14: // NOP zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          break;
+        case 0x15: // ORA zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          a = a | read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x16: // ASL zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = (value << 1) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x17: // SLO zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = (value << 1) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a | read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x18: // CLC imp
+          cycles = 2;
+          p &= ~0x01;
+          break;
+        case 0x19: // ORA absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          a = a | read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x1A: // NOP imp
+          cycles = 2;
+          break;
+        case 0x1B: // SLO absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          value = read(ea);
+          result = (value << 1) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a | read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x1C: // NOP absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          break;
+        case 0x1D: // ORA absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          a = a | read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x1E: // ASL absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          value = read(ea);
+          result = (value << 1) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x1F: // SLO absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          value = read(ea);
+          result = (value << 1) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a | read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x20: // JSR abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 6;
+          write(0x100 + sp, ((pc - 1) & 0xFFFF) >> 8);
+          write(0x100 + ((sp - 1) & 0xFF), ((pc - 1) & 0xFFFF) & 0xFF);
+          sp = (sp - 2) & 0xFF;
+          pc = ea;
+          break;
+        case 0x21: // AND indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 6;
+          a = a & read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x22: // NOP imp
+          cycles = 2;
+          break;
+        case 0x23: // RLA indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 8;
+          value = read(ea);
+          result = ((value << 1) | (p & 0x01)) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a & read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x24: // BIT zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          value = read(ea);
+          p = (p & 0x3D) | ((a & value) === 0 ? 0x02 : 0) | (value & 0xC0);
+          break;
+        case 0x25: // AND zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          a = a & read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x26: // ROL zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 5;
+          value = read(ea);
+          result = ((value << 1) | (p & 0x01)) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x27: // RLA zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 5;
+          value = read(ea);
+          result = ((value << 1) | (p & 0x01)) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a & read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x28: // PLP imp
+          cycles = 4;
+          sp = (sp + 1) & 0xFF;
+          p = read(0x100 + sp);
+          p |= 0x20;
+          break;
+        case 0x29: // AND imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          a = a & read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x2A: // ROL acc
+          cycles = 2;
+          value = a;
+          result = ((value << 1) | (p & 0x01)) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          a = result;
+          break;
+        case 0x2B: // NOP imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          break;
+        case 0x2C: // BIT abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          value = read(ea);
+          p = (p & 0x3D) | ((a & value) === 0 ? 0x02 : 0) | (value & 0xC0);
+          break;
+        case 0x2D: // AND abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          a = a & read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x2E: // ROL abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = ((value << 1) | (p & 0x01)) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x2F: // RLA abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = ((value << 1) | (p & 0x01)) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a & read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x30: // BMI rel
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          if ((p & 0x80) !== 0) {
+            result = (pc + ((ea ^ 0x80) - 0x80)) & 0xFFFF;
+            cycles += (pc ^ result) & 0xFF00 ? 2 : 1;
+            pc = result;
+          }
+          break;
+        case 0x31: // AND indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          cycles = 5 + (crossed ? 1 : 0);
+          a = a & read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x32: // NOP imp
+          cycles = 2;
+          break;
+        case 0x33: // RLA indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          cycles = 8;
+          value = read(ea);
+          result = ((value << 1) | (p & 0x01)) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a & read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x34: // NOP zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          break;
+        case 0x35: // AND zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          a = a & read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x36: // ROL zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = ((value << 1) | (p & 0x01)) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x37: // RLA zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = ((value << 1) | (p & 0x01)) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a & read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x38: // SEC imp
+          cycles = 2;
+          p |= 0x01;
+          break;
+        case 0x39: // AND absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          a = a & read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x3A: // NOP imp
+          cycles = 2;
+          break;
+        case 0x3B: // RLA absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          value = read(ea);
+          result = ((value << 1) | (p & 0x01)) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a & read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x3C: // NOP absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          break;
+        case 0x3D: // AND absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          a = a & read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x3E: // ROL absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          value = read(ea);
+          result = ((value << 1) | (p & 0x01)) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x3F: // RLA absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          value = read(ea);
+          result = ((value << 1) | (p & 0x01)) & 0xFF;
+          p = (p & 0x7C) | (value >> 7) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a & read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x40: // RTI imp
+          cycles = 6;
+          sp = (sp + 1) & 0xFF;
+          p = read(0x100 + sp);
+          pc = read(0x100 + ((sp + 1) & 0xFF)) | (read(0x100 + ((sp + 2) & 0xFF)) << 8);
+          sp = (sp + 2) & 0xFF;
+          break;
+        case 0x41: // EOR indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 6;
+          a = a ^ read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x42: // NOP imp
+          cycles = 2;
+          break;
+        case 0x43: // SRE indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 8;
+          value = read(ea);
+          result = value >> 1;
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a ^ read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x44: // NOP zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          break;
+        case 0x45: // EOR zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          a = a ^ read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x46: // LSR zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 5;
+          value = read(ea);
+          result = value >> 1;
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x47: // SRE zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 5;
+          value = read(ea);
+          result = value >> 1;
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a ^ read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x48: // PHA imp
+          cycles = 3;
+          write(0x100 + sp, a);
+          sp = (sp - 1) & 0xFF;
+          break;
+        case 0x49: // EOR imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          a = a ^ read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x4A: // LSR acc
+          cycles = 2;
+          value = a;
+          result = value >> 1;
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          a = result;
+          break;
+        case 0x4B: // NOP imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          break;
+        case 0x4C: // JMP abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 3;
+          pc = ea;
+          break;
+        case 0x4D: // EOR abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          a = a ^ read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x4E: // LSR abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = value >> 1;
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x4F: // SRE abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = value >> 1;
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a ^ read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x50: // BVC rel
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          if ((p & 0x40) === 0) {
+            result = (pc + ((ea ^ 0x80) - 0x80)) & 0xFFFF;
+            cycles += (pc ^ result) & 0xFF00 ? 2 : 1;
+            pc = result;
+          }
+          break;
+        case 0x51: // EOR indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          cycles = 5 + (crossed ? 1 : 0);
+          a = a ^ read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x52: // NOP imp
+          cycles = 2;
+          break;
+        case 0x53: // SRE indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          cycles = 8;
+          value = read(ea);
+          result = value >> 1;
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a ^ read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x54: // NOP zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          break;
+        case 0x55: // EOR zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          a = a ^ read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x56: // LSR zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = value >> 1;
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x57: // SRE zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = value >> 1;
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a ^ read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x58: // CLI imp
+          cycles = 2;
+          p &= ~0x04;
+          break;
+        case 0x59: // EOR absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          a = a ^ read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x5A: // NOP imp
+          cycles = 2;
+          break;
+        case 0x5B: // SRE absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          value = read(ea);
+          result = value >> 1;
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a ^ read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x5C: // NOP absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          break;
+        case 0x5D: // EOR absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          a = a ^ read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x5E: // LSR absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          value = read(ea);
+          result = value >> 1;
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x5F: // SRE absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          value = read(ea);
+          result = value >> 1;
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          a = a ^ read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x60: // RTS imp
+          cycles = 6;
+          pc = read(0x100 + ((sp + 1) & 0xFF)) | (read(0x100 + ((sp + 2) & 0xFF)) << 8);
+          sp = (sp + 2) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          break;
+        case 0x61: // ADC indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 6;
+          value = read(ea);
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0x62: // NOP imp
+          cycles = 2;
+          break;
+        case 0x63: // RRA indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 8;
+          value = read(ea);
+          result = (value >> 1) | ((p & 0x01) << 7);
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea);
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0x64: // NOP zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          break;
+        case 0x65: // ADC zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          value = read(ea);
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0x66: // ROR zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 5;
+          value = read(ea);
+          result = (value >> 1) | ((p & 0x01) << 7);
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x67: // RRA zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 5;
+          value = read(ea);
+          result = (value >> 1) | ((p & 0x01) << 7);
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea);
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0x68: // PLA imp
+          cycles = 4;
+          sp = (sp + 1) & 0xFF;
+          a = read(0x100 + sp);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x69: // ADC imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          value = read(ea);
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0x6A: // ROR acc
+          cycles = 2;
+          value = a;
+          result = (value >> 1) | ((p & 0x01) << 7);
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          a = result;
+          break;
+        case 0x6B: // NOP imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          break;
+        case 0x6C: // JMP ind
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = read(value) | (read((value & 0xFF00) | ((value + 1) & 0xFF)) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 5;
+          pc = ea;
+          break;
+        case 0x6D: // ADC abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          value = read(ea);
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0x6E: // ROR abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = (value >> 1) | ((p & 0x01) << 7);
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x6F: // RRA abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = (value >> 1) | ((p & 0x01) << 7);
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea);
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0x70: // BVS rel
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          if ((p & 0x40) !== 0) {
+            result = (pc + ((ea ^ 0x80) - 0x80)) & 0xFFFF;
+            cycles += (pc ^ result) & 0xFF00 ? 2 : 1;
+            pc = result;
+          }
+          break;
+        case 0x71: // ADC indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          cycles = 5 + (crossed ? 1 : 0);
+          value = read(ea);
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0x72: // NOP imp
+          cycles = 2;
+          break;
+        case 0x73: // RRA indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          cycles = 8;
+          value = read(ea);
+          result = (value >> 1) | ((p & 0x01) << 7);
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea);
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0x74: // NOP zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          break;
+        case 0x75: // ADC zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          value = read(ea);
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0x76: // ROR zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = (value >> 1) | ((p & 0x01) << 7);
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x77: // RRA zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 6;
+          value = read(ea);
+          result = (value >> 1) | ((p & 0x01) << 7);
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea);
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0x78: // SEI imp
+          cycles = 2;
+          p |= 0x04;
+          break;
+        case 0x79: // ADC absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          value = read(ea);
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0x7A: // NOP imp
+          cycles = 2;
+          break;
+        case 0x7B: // RRA absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          value = read(ea);
+          result = (value >> 1) | ((p & 0x01) << 7);
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea);
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0x7C: // NOP absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          break;
+        case 0x7D: // ADC absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          value = read(ea);
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0x7E: // ROR absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          value = read(ea);
+          result = (value >> 1) | ((p & 0x01) << 7);
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0x7F: // RRA absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          value = read(ea);
+          result = (value >> 1) | ((p & 0x01) << 7);
+          p = (p & 0x7C) | (value & 0x01) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea);
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0x80: // NOP imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          break;
+        case 0x81: // STA indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 6;
+          write(ea, a);
+          break;
+        case 0x82: // NOP imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          break;
+        case 0x83: // SAX indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 6;
+          write(ea, a);
+          write(ea, x);
+          write(ea, a & x);
+          break;
+        case 0x84: // STY zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          write(ea, y);
+          break;
+        case 0x85: // STA zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          write(ea, a);
+          break;
+        case 0x86: // STX zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          write(ea, x);
+          break;
+        case 0x87: // SAX zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          write(ea, a);
+          write(ea, x);
+          write(ea, a & x);
+          break;
+        case 0x88: // DEY imp
+          cycles = 2;
+          y = (y - 1) & 0xFF;
+          p = (p & 0x7D) | (y === 0 ? 0x02 : 0) | (y & 0x80);
+          break;
+        case 0x89: // NOP imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          break;
+        case 0x8A: // TXA imp
+          cycles = 2;
+          a = x;
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x8B: // NOP imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          break;
+        case 0x8C: // STY abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          write(ea, y);
+          break;
+        case 0x8D: // STA abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          write(ea, a);
+          break;
+        case 0x8E: // STX abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          write(ea, x);
+          break;
+        case 0x8F: // SAX abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          write(ea, a);
+          write(ea, x);
+          write(ea, a & x);
+          break;
+        case 0x90: // BCC rel
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          if ((p & 0x01) === 0) {
+            result = (pc + ((ea ^ 0x80) - 0x80)) & 0xFFFF;
+            cycles += (pc ^ result) & 0xFF00 ? 2 : 1;
+            pc = result;
+          }
+          break;
+        case 0x91: // STA indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          cycles = 6;
+          write(ea, a);
+          break;
+        case 0x92: // NOP imp
+          cycles = 2;
+          break;
+        case 0x93: // NOP indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          cycles = 6;
+          break;
+        case 0x94: // STY zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          write(ea, y);
+          break;
+        case 0x95: // STA zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          write(ea, a);
+          break;
+        case 0x96: // STX zpy
+          ea = (read(pc) + y) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          write(ea, x);
+          break;
+        case 0x97: // SAX zpy
+          ea = (read(pc) + y) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          write(ea, a);
+          write(ea, x);
+          write(ea, a & x);
+          break;
+        case 0x98: // TYA imp
+          cycles = 2;
+          a = y;
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0x99: // STA absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 5;
+          write(ea, a);
+          break;
+        case 0x9A: // TXS imp
+          cycles = 2;
+          sp = x;
+          break;
+        case 0x9B: // NOP absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 5;
+          break;
+        case 0x9C: // NOP absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 5;
+          break;
+        case 0x9D: // STA absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 5;
+          write(ea, a);
+          break;
+        case 0x9E: // NOP absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 5;
+          break;
+        case 0x9F: // NOP absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 5;
+          break;
+        case 0xA0: // LDY imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          y = read(ea);
+          p = (p & 0x7D) | (y === 0 ? 0x02 : 0) | (y & 0x80);
+          break;
+        case 0xA1: // LDA indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 6;
+          a = read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0xA2: // LDX imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          x = read(ea);
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xA3: // LAX indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 6;
+          a = read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          x = read(ea);
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xA4: // LDY zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          y = read(ea);
+          p = (p & 0x7D) | (y === 0 ? 0x02 : 0) | (y & 0x80);
+          break;
+        case 0xA5: // LDA zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          a = read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0xA6: // LDX zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          x = read(ea);
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xA7: // LAX zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          a = read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          x = read(ea);
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xA8: // TAY imp
+          cycles = 2;
+          y = a;
+          p = (p & 0x7D) | (y === 0 ? 0x02 : 0) | (y & 0x80);
+          break;
+        case 0xA9: // LDA imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          a = read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0xAA: // TAX imp
+          cycles = 2;
+          x = a;
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xAB: // NOP imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          break;
+        case 0xAC: // LDY abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          y = read(ea);
+          p = (p & 0x7D) | (y === 0 ? 0x02 : 0) | (y & 0x80);
+          break;
+        case 0xAD: // LDA abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          a = read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0xAE: // LDX abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          x = read(ea);
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xAF: // LAX abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          a = read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          x = read(ea);
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xB0: // BCS rel
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          if ((p & 0x01) !== 0) {
+            result = (pc + ((ea ^ 0x80) - 0x80)) & 0xFFFF;
+            cycles += (pc ^ result) & 0xFF00 ? 2 : 1;
+            pc = result;
+          }
+          break;
+        case 0xB1: // LDA indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          cycles = 5 + (crossed ? 1 : 0);
+          a = read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0xB2: // NOP imp
+          cycles = 2;
+          break;
+        case 0xB3: // LAX indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          cycles = 5 + (crossed ? 1 : 0);
+          a = read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          x = read(ea);
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xB4: // LDY zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          y = read(ea);
+          p = (p & 0x7D) | (y === 0 ? 0x02 : 0) | (y & 0x80);
+          break;
+        case 0xB5: // LDA zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          a = read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0xB6: // LDX zpy
+          ea = (read(pc) + y) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          x = read(ea);
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xB7: // LAX zpy
+          ea = (read(pc) + y) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          a = read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          x = read(ea);
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xB8: // CLV imp
+          cycles = 2;
+          p &= ~0x40;
+          break;
+        case 0xB9: // LDA absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          a = read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0xBA: // TSX imp
+          cycles = 2;
+          x = sp;
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xBB: // LAX absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          a = read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          x = read(ea);
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xBC: // LDY absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          y = read(ea);
+          p = (p & 0x7D) | (y === 0 ? 0x02 : 0) | (y & 0x80);
+          break;
+        case 0xBD: // LDA absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          a = read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          break;
+        case 0xBE: // LDX absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          x = read(ea);
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xBF: // LAX absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          a = read(ea);
+          p = (p & 0x7D) | (a === 0 ? 0x02 : 0) | (a & 0x80);
+          x = read(ea);
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xC0: // CPY imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          value = read(ea);
+          p = (p & 0x7C) | (y >= value ? 0x01 : 0) | (y === value ? 0x02 : 0) | ((y - value) & 0x80);
+          break;
+        case 0xC1: // CMP indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 6;
+          value = read(ea);
+          p = (p & 0x7C) | (a >= value ? 0x01 : 0) | (a === value ? 0x02 : 0) | ((a - value) & 0x80);
+          break;
+        case 0xC2: // NOP imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          break;
+        case 0xC3: // DCP indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 8;
+          result = (read(ea) - 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea);
+          p = (p & 0x7C) | (a >= value ? 0x01 : 0) | (a === value ? 0x02 : 0) | ((a - value) & 0x80);
+          break;
+        case 0xC4: // CPY zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          value = read(ea);
+          p = (p & 0x7C) | (y >= value ? 0x01 : 0) | (y === value ? 0x02 : 0) | ((y - value) & 0x80);
+          break;
+        case 0xC5: // CMP zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          value = read(ea);
+          p = (p & 0x7C) | (a >= value ? 0x01 : 0) | (a === value ? 0x02 : 0) | ((a - value) & 0x80);
+          break;
+        case 0xC6: // DEC zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 5;
+          result = (read(ea) - 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0xC7: // DCP zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 5;
+          result = (read(ea) - 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea);
+          p = (p & 0x7C) | (a >= value ? 0x01 : 0) | (a === value ? 0x02 : 0) | ((a - value) & 0x80);
+          break;
+        case 0xC8: // INY imp
+          cycles = 2;
+          y = (y + 1) & 0xFF;
+          p = (p & 0x7D) | (y === 0 ? 0x02 : 0) | (y & 0x80);
+          break;
+        case 0xC9: // CMP imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          value = read(ea);
+          p = (p & 0x7C) | (a >= value ? 0x01 : 0) | (a === value ? 0x02 : 0) | ((a - value) & 0x80);
+          break;
+        case 0xCA: // DEX imp
+          cycles = 2;
+          x = (x - 1) & 0xFF;
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xCB: // NOP imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          break;
+        case 0xCC: // CPY abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          value = read(ea);
+          p = (p & 0x7C) | (y >= value ? 0x01 : 0) | (y === value ? 0x02 : 0) | ((y - value) & 0x80);
+          break;
+        case 0xCD: // CMP abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          value = read(ea);
+          p = (p & 0x7C) | (a >= value ? 0x01 : 0) | (a === value ? 0x02 : 0) | ((a - value) & 0x80);
+          break;
+        case 0xCE: // DEC abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 6;
+          result = (read(ea) - 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0xCF: // DCP abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 6;
+          result = (read(ea) - 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea);
+          p = (p & 0x7C) | (a >= value ? 0x01 : 0) | (a === value ? 0x02 : 0) | ((a - value) & 0x80);
+          break;
+        case 0xD0: // BNE rel
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          if ((p & 0x02) === 0) {
+            result = (pc + ((ea ^ 0x80) - 0x80)) & 0xFFFF;
+            cycles += (pc ^ result) & 0xFF00 ? 2 : 1;
+            pc = result;
+          }
+          break;
+        case 0xD1: // CMP indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          cycles = 5 + (crossed ? 1 : 0);
+          value = read(ea);
+          p = (p & 0x7C) | (a >= value ? 0x01 : 0) | (a === value ? 0x02 : 0) | ((a - value) & 0x80);
+          break;
+        case 0xD2: // NOP imp
+          cycles = 2;
+          break;
+        case 0xD3: // DCP indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          cycles = 8;
+          result = (read(ea) - 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea);
+          p = (p & 0x7C) | (a >= value ? 0x01 : 0) | (a === value ? 0x02 : 0) | ((a - value) & 0x80);
+          break;
+        case 0xD4: // NOP zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          break;
+        case 0xD5: // CMP zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          value = read(ea);
+          p = (p & 0x7C) | (a >= value ? 0x01 : 0) | (a === value ? 0x02 : 0) | ((a - value) & 0x80);
+          break;
+        case 0xD6: // DEC zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 6;
+          result = (read(ea) - 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0xD7: // DCP zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 6;
+          result = (read(ea) - 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea);
+          p = (p & 0x7C) | (a >= value ? 0x01 : 0) | (a === value ? 0x02 : 0) | ((a - value) & 0x80);
+          break;
+        case 0xD8: // CLD imp
+          cycles = 2;
+          p &= ~0x08;
+          break;
+        case 0xD9: // CMP absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          value = read(ea);
+          p = (p & 0x7C) | (a >= value ? 0x01 : 0) | (a === value ? 0x02 : 0) | ((a - value) & 0x80);
+          break;
+        case 0xDA: // NOP imp
+          cycles = 2;
+          break;
+        case 0xDB: // DCP absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          result = (read(ea) - 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea);
+          p = (p & 0x7C) | (a >= value ? 0x01 : 0) | (a === value ? 0x02 : 0) | ((a - value) & 0x80);
+          break;
+        case 0xDC: // NOP absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          break;
+        case 0xDD: // CMP absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          value = read(ea);
+          p = (p & 0x7C) | (a >= value ? 0x01 : 0) | (a === value ? 0x02 : 0) | ((a - value) & 0x80);
+          break;
+        case 0xDE: // DEC absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          result = (read(ea) - 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0xDF: // DCP absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          result = (read(ea) - 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea);
+          p = (p & 0x7C) | (a >= value ? 0x01 : 0) | (a === value ? 0x02 : 0) | ((a - value) & 0x80);
+          break;
+        case 0xE0: // CPX imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          value = read(ea);
+          p = (p & 0x7C) | (x >= value ? 0x01 : 0) | (x === value ? 0x02 : 0) | ((x - value) & 0x80);
+          break;
+        case 0xE1: // SBC indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 6;
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0xE2: // NOP imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          break;
+        case 0xE3: // ISB indx
+          value = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          ea = read(value) | (read((value + 1) & 0xFF) << 8);
+          cycles = 8;
+          result = (read(ea) + 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0xE4: // CPX zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          value = read(ea);
+          p = (p & 0x7C) | (x >= value ? 0x01 : 0) | (x === value ? 0x02 : 0) | ((x - value) & 0x80);
+          break;
+        case 0xE5: // SBC zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 3;
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0xE6: // INC zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 5;
+          result = (read(ea) + 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0xE7: // ISB zp
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 5;
+          result = (read(ea) + 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0xE8: // INX imp
+          cycles = 2;
+          x = (x + 1) & 0xFF;
+          p = (p & 0x7D) | (x === 0 ? 0x02 : 0) | (x & 0x80);
+          break;
+        case 0xE9: // SBC imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0xEA: // NOP imp
+          cycles = 2;
+          break;
+        case 0xEB: // SBC imm
+          ea = pc;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0xEC: // CPX abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          value = read(ea);
+          p = (p & 0x7C) | (x >= value ? 0x01 : 0) | (x === value ? 0x02 : 0) | ((x - value) & 0x80);
+          break;
+        case 0xED: // SBC abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4;
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0xEE: // INC abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 6;
+          result = (read(ea) + 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0xEF: // ISB abso
+          ea = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 6;
+          result = (read(ea) + 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0xF0: // BEQ rel
+          ea = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 2;
+          if ((p & 0x02) !== 0) {
+            result = (pc + ((ea ^ 0x80) - 0x80)) & 0xFFFF;
+            cycles += (pc ^ result) & 0xFF00 ? 2 : 1;
+            pc = result;
+          }
+          break;
+        case 0xF1: // SBC indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          cycles = 5 + (crossed ? 1 : 0);
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0xF2: // NOP imp
+          cycles = 2;
+          break;
+        case 0xF3: // ISB indy
+          value = read(pc);
+          pc = (pc + 1) & 0xFFFF;
+          value = read(value) | (read((value + 1) & 0xFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          cycles = 8;
+          result = (read(ea) + 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0xF4: // NOP zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          break;
+        case 0xF5: // SBC zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 4;
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0xF6: // INC zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 6;
+          result = (read(ea) + 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0xF7: // ISB zpx
+          ea = (read(pc) + x) & 0xFF;
+          pc = (pc + 1) & 0xFFFF;
+          cycles = 6;
+          result = (read(ea) + 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0xF8: // SED imp
+          cycles = 2;
+          p |= 0x08;
+          break;
+        case 0xF9: // SBC absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0xFA: // NOP imp
+          cycles = 2;
+          break;
+        case 0xFB: // ISB absy
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + y) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          result = (read(ea) + 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0xFC: // NOP absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          break;
+        case 0xFD: // SBC absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          crossed = (value ^ ea) & 0xFF00;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 4 + (crossed ? 1 : 0);
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+        case 0xFE: // INC absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          result = (read(ea) + 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          break;
+        case 0xFF: // ISB absx
+          value = read(pc) | (read((pc + 1) & 0xFFFF) << 8);
+          ea = (value + x) & 0xFFFF;
+          pc = (pc + 2) & 0xFFFF;
+          cycles = 7;
+          result = (read(ea) + 1) & 0xFF;
+          p = (p & 0x7D) | (result === 0 ? 0x02 : 0) | (result & 0x80);
+          write(ea, result);
+          value = read(ea) ^ 0xFF;
+          result = a + value + (p & 0x01);
+          p = (p & 0x3C) | (result > 0xFF ? 0x01 : 0) | ((result & 0xFF) === 0 ? 0x02 : 0) |
+            ((result ^ a) & (result ^ value) & 0x80 ? 0x40 : 0) | (result & 0x80);
+          a = result & 0xFF;
+          break;
+      }
+    }
+
+    registers[REG_A] = a;
+    registers[REG_X] = x;
+    registers[REG_Y] = y;
+    registers[REG_SP] = sp;
+    registers[REG_P] = p;
+    this.pc[0] = pc;
+    this.cycles += cycles;
+    this.opcode = opcode;
+    return cycles;
+  }
+}
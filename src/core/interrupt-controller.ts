@@ -8,6 +8,21 @@ export interface InterruptStatus {
   nmiSource?: string;
 }
 
+/**
+ * Snapshot of the interrupt controller, used for checkpointing
+ */
+export interface InterruptControllerState {
+  irqPending: boolean;
+  nmiPending: boolean;
+  irqSources: string[];
+  nmiSources: string[];
+}
+
+/**
+ * Called when a source starts or stops asserting an interrupt line
+ */
+export type InterruptTraceCallback = (line: 'IRQ' | 'NMI', source: string, asserted: boolean) => void;
+
 /**
  * Interrupt controller manages IRQ and NMI signals from peripherals and debug interface
  */
@@ -18,6 +33,7 @@ export class InterruptController {
   private nmiSources: Set<string> = new Set();
   private irqCallback?: () => void;
   private nmiCallback?: () => void;
+  private traceCallback?: InterruptTraceCallback;
 
   /**
    * Set callback functions for interrupt handling
@@ -29,11 +45,22 @@ export class InterruptController {
     this.nmiCallback = nmiCallback;
   }
 
+  /**
+   * Report sources asserting and releasing the lines, for profiling
+   * @param callback Trace callback, or undefined to stop
+   */
+  setTraceCallback(callback?: InterruptTraceCallback): void {
+    this.traceCallback = callback;
+  }
+
   /**
    * Trigger an IRQ from a specific source
    * @param source Name of the interrupt source
    */
   triggerIRQ(source: string = 'unknown'): void {
+    if (this.traceCallback && !this.irqSources.has(source)) {
+      this.traceCallback('IRQ', source, true);
+    }
     this.irqSources.add(source);
     if (!this.irqPending) {
       this.irqPending = true;
@@ -48,6 +75,9 @@ export class InterruptController {
    * @param source Name of the interrupt source
    */
   triggerNMI(source: string = 'unknown'): void {
+    if (this.traceCallback && !this.nmiSources.has(source)) {
+      this.traceCallback('NMI', source, true);
+    }
     this.nmiSources.add(source);
     if (!this.nmiPending) {
       this.nmiPending = true;
@@ -62,7 +92,9 @@ export class InterruptController {
    * @param source Name of the interrupt source
    */
   clearIRQ(source: string = 'unknown'): void {
-    this.irqSources.delete(source);
+    if (this.irqSources.delete(source) && this.traceCallback) {
+      this.traceCallback('IRQ', source, false);
+    }
     if (this.irqSources.size === 0) {
       this.irqPending = false;
     }
@@ -73,7 +105,9 @@ export class InterruptController {
    * @param source Name of the interrupt source
    */
   clearNMI(source: string = 'unknown'): void {
-    this.nmiSources.delete(source);
+    if (this.nmiSources.delete(source) && this.traceCallback) {
+      this.traceCallback('NMI', source, false);
+    }
     if (this.nmiSources.size === 0) {
       this.nmiPending = false;
     }
@@ -83,6 +117,7 @@ export class InterruptController {
    * Clear all IRQ sources
    */
   clearAllIRQ(): void {
+    this.traceReleased('IRQ', this.irqSources);
     this.irqSources.clear();
     this.irqPending = false;
   }
@@ -91,6 +126,7 @@ export class InterruptController {
    * Clear all NMI sources
    */
   clearAllNMI(): void {
+    this.traceReleased('NMI', this.nmiSources);
     this.nmiSources.clear();
     this.nmiPending = false;
   }
@@ -146,10 +182,42 @@ export class InterruptController {
   reset(): void {
     this.irqPending = false;
     this.nmiPending = false;
+    this.traceReleased('IRQ', this.irqSources);
+    this.traceReleased('NMI', this.nmiSources);
     this.irqSources.clear();
     this.nmiSources.clear();
   }
 
+  private traceReleased(line: 'IRQ' | 'NMI', sources: Set<string>): void {
+    if (this.traceCallback) {
+      sources.forEach(source => this.traceCallback!(line, source, false));
+    }
+  }
+
+  /**
+   * Capture the controller state without triggering callbacks
+   * @returns State snapshot
+   */
+  saveState(): InterruptControllerState {
+    return {
+      irqPending: this.irqPending,
+      nmiPending: this.nmiPending,
+      irqSources: Array.from(this.irqSources),
+      nmiSources: Array.from(this.nmiSources)
+    };
+  }
+
+  /**
+   * Restore a snapshot taken by saveState without triggering callbacks
+   * @param state State snapshot
+   */
+  restoreState(state: InterruptControllerState): void {
+    this.irqPending = state.irqPending;
+    this.nmiPending = state.nmiPending;
+    this.irqSources = new Set(state.irqSources);
+    this.nmiSources = new Set(state.nmiSources);
+  }
+
   /**
    * Update interrupt controller state based on peripheral interrupt sources
    * @param peripheralSources Array of peripheral names with pending interrupts
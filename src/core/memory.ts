@@ -33,50 +33,238 @@ export interface ROMImage {
   format: 'binary' | 'ihex' | 'srec';
 }
 
+// Size of a RAM page used for dirty tracking and snapshots
+export const RAM_PAGE_SIZE = 256;
+
+// Host buffer backing one full page, for cores that access memory directly
+// instead of through the read/write callbacks
+export interface DirectPage {
+  kind: 'RAM' | 'ROM';
+  data: Uint8Array;       // The page's 256 bytes (a view, not a copy)
+  dirty?: Uint8Array;     // RAM only: dirty-page flags to set on write
+  versions?: Uint32Array; // RAM only: write counters to bump on write
+  index?: number;         // RAM only: index of this page in dirty and versions
+}
+
+// Memory region backed by a SharedArrayBuffer, for viewers on other threads
+export interface SharedMemoryRegion {
+  type: 'RAM' | 'ROM';
+  start: number;
+  end: number;
+  buffer: SharedArrayBuffer;
+  // RAM only: one write counter per page, plus a final slot set to 1 once
+  // the region stops being live (after a fork or reconfiguration)
+  versions?: SharedArrayBuffer;
+}
+
+export interface SharedMemoryDescriptor {
+  regions: SharedMemoryRegion[];
+}
+
 // RAM handler implementation
+// Storage is split into pages that forks share until one side writes to
+// them (copy-on-write). A fork copies a page into a private 256-byte array
+// on its first write; once something asks for direct or shared access,
+// owned pages move into a SharedArrayBuffer so other threads can view them
+// without copies.
 class RAMHandler implements MemoryHandler {
-  private data: Uint8Array;
+  private buffer: Uint8Array | null = null; // Shared backing store, once viewed
+  private versions: Uint32Array;            // Per-page write counters (shared once viewed)
+  private pages: Uint8Array[];
+  private owned: Uint8Array;      // 1 if the page is private to this handler
+  private size: number;
   private baseAddress: number;
+  private dirtyPages: Uint8Array;
 
-  constructor(size: number, baseAddress: number) {
-    this.data = new Uint8Array(size);
+  constructor(size: number, baseAddress: number, pages?: Uint8Array[]) {
+    const pageCount = Math.ceil(size / RAM_PAGE_SIZE);
+    this.size = size;
     this.baseAddress = baseAddress;
+    this.dirtyPages = new Uint8Array(pageCount);
+    this.versions = new Uint32Array(pageCount + 1);
+
+    if (pages) {
+      this.pages = pages;
+      this.owned = new Uint8Array(pageCount);
+    } else {
+      this.allocateShared(pageCount);
+      this.pages = [];
+      for (let page = 0; page < pageCount; page++) {
+        this.pages.push(this.slot(page));
+      }
+      this.owned = new Uint8Array(pageCount).fill(1);
+    }
   }
 
   read(address: number): number {
     const offset = address - this.baseAddress;
-    if (offset < 0 || offset >= this.data.length) {
+    if (offset < 0 || offset >= this.size) {
       console.warn(`RAM read out of bounds: $${address.toString(16).toUpperCase().padStart(4, '0')}`);
       return 0xFF;
     }
-    return this.data[offset];
+    return this.pages[offset >> 8][offset & 0xFF];
   }
 
   write(address: number, value: number): void {
     const offset = address - this.baseAddress;
-    if (offset < 0 || offset >= this.data.length) {
+    if (offset < 0 || offset >= this.size) {
       console.warn(`RAM write out of bounds: $${address.toString(16).toUpperCase().padStart(4, '0')}`);
       return;
     }
-    this.data[offset] = value & 0xFF;
+    const page = offset >> 8;
+    this.ownPage(page)[offset & 0xFF] = value & 0xFF;
+    this.dirtyPages[page] = 1;
+    this.versions[page]++;
   }
 
   clear(): void {
-    this.data.fill(0);
+    for (let page = 0; page < this.pages.length; page++) {
+      if (!this.owned[page]) {
+        this.pages[page] = this.buffer ? this.slot(page) : new Uint8Array(RAM_PAGE_SIZE);
+        this.owned[page] = 1;
+      }
+      this.pages[page].fill(0);
+      this.versions[page]++;
+    }
+    this.dirtyPages.fill(1);
   }
 
   getSize(): number {
-    return this.data.length;
+    return this.size;
+  }
+
+  getPageCount(): number {
+    return this.pages.length;
+  }
+
+  // Pages written since the last clearDirtyPages() call (region-relative indices)
+  getDirtyPages(): number[] {
+    const pages: number[] = [];
+    for (let page = 0; page < this.dirtyPages.length; page++) {
+      if (this.dirtyPages[page]) {
+        pages.push(page);
+      }
+    }
+    return pages;
+  }
+
+  clearDirtyPages(): void {
+    this.dirtyPages.fill(0);
+  }
+
+  readPage(page: number): Uint8Array {
+    const length = Math.min(RAM_PAGE_SIZE, this.size - page * RAM_PAGE_SIZE);
+    return this.pages[page].slice(0, length);
+  }
+
+  // Current contents of a page without copying or taking ownership
+  peekPage(page: number): Uint8Array {
+    return this.pages[page];
+  }
+
+  writePage(page: number, contents: Uint8Array): void {
+    this.ownPage(page).set(contents);
+    this.dirtyPages[page] = 1;
+    this.versions[page]++;
+  }
+
+  // Pages this handler has not copied yet (still shared with a fork)
+  getSharedPageCount(): number {
+    let shared = 0;
+    for (let page = 0; page < this.owned.length; page++) {
+      if (!this.owned[page]) {
+        shared++;
+      }
+    }
+    return shared;
+  }
+
+  // Create a handler sharing every page with this one; both sides copy a
+  // page on their first write to it. The current pages become the fork's
+  // common base, so this handler gives up its shared buffer (if any) and
+  // allocates a new one only when it is viewed again.
+  fork(): RAMHandler {
+    const child = new RAMHandler(this.size, this.baseAddress, this.pages.slice());
+    Atomics.store(this.versions, this.pages.length, 1);
+    this.buffer = null;
+    this.versions = new Uint32Array(this.pages.length + 1);
+    this.owned.fill(0);
+    return child;
+  }
+
+  // Page storage for direct access; the page is made private first so
+  // writes through it cannot leak into a fork
+  getDirectPage(page: number): DirectPage {
+    this.ensureShared();
+    return { kind: 'RAM', data: this.ownPage(page), dirty: this.dirtyPages, versions: this.versions, index: page };
+  }
+
+  // Shared buffer holding every page; pages still shared with a fork are
+  // copied into it first
+  getSharedRegion(): { buffer: SharedArrayBuffer; versions: SharedArrayBuffer } {
+    const buffer = this.ensureShared();
+    for (let page = 0; page < this.pages.length; page++) {
+      this.ownPage(page);
+    }
+    return {
+      buffer: buffer.buffer as SharedArrayBuffer,
+      versions: this.versions.buffer as SharedArrayBuffer
+    };
+  }
+
+  // Mark the shared buffer as no longer live (the handler is being replaced)
+  retire(): void {
+    Atomics.store(this.versions, this.pages.length, 1);
+  }
+
+  private allocateShared(pageCount: number): Uint8Array {
+    const versions = new Uint32Array(new SharedArrayBuffer((pageCount + 1) * 4));
+    versions.set(this.versions);
+    this.versions = versions;
+    this.buffer = new Uint8Array(new SharedArrayBuffer(pageCount * RAM_PAGE_SIZE));
+    return this.buffer;
+  }
+
+  // Move pages copied privately since the last fork into a new shared buffer
+  private ensureShared(): Uint8Array {
+    if (this.buffer) {
+      return this.buffer;
+    }
+    const buffer = this.allocateShared(this.pages.length);
+    for (let page = 0; page < this.pages.length; page++) {
+      if (this.owned[page]) {
+        const slot = this.slot(page);
+        slot.set(this.pages[page]);
+        this.pages[page] = slot;
+      }
+    }
+    return buffer;
+  }
+
+  private slot(page: number): Uint8Array {
+    return this.buffer!.subarray(page * RAM_PAGE_SIZE, (page + 1) * RAM_PAGE_SIZE);
+  }
+
+  private ownPage(page: number): Uint8Array {
+    if (!this.owned[page]) {
+      const copy = this.buffer ? this.slot(page) : new Uint8Array(RAM_PAGE_SIZE);
+      copy.set(this.pages[page]);
+      this.pages[page] = copy;
+      this.owned[page] = 1;
+    }
+    return this.pages[page];
   }
 }
 
 // ROM handler implementation
+// The image lives in a SharedArrayBuffer so other threads can view it
 class ROMHandler implements MemoryHandler {
   private data: Uint8Array;
   private baseAddress: number;
 
   constructor(data: Uint8Array, baseAddress: number) {
-    this.data = new Uint8Array(data);
+    this.data = new Uint8Array(new SharedArrayBuffer(data.length));
+    this.data.set(data);
     this.baseAddress = baseAddress;
   }
 
@@ -101,6 +289,15 @@ class ROMHandler implements MemoryHandler {
   getData(): Uint8Array {
     return new Uint8Array(this.data);
   }
+
+  // View of one page of the image, starting at offset
+  getPageView(offset: number): Uint8Array {
+    return this.data.subarray(offset, offset + RAM_PAGE_SIZE);
+  }
+
+  getSharedBuffer(): SharedArrayBuffer {
+    return this.data.buffer as SharedArrayBuffer;
+  }
 }
 
 // Peripheral handler wrapper
@@ -141,6 +338,9 @@ export class MemoryManager {
   configureRAM(startAddress: number, size: number): void {
     // Remove existing RAM region if present
     this.regions = this.regions.filter(region => region.type !== 'RAM');
+    if (this.ramHandler) {
+      this.ramHandler.retire();
+    }
     
     this.ramHandler = new RAMHandler(size, startAddress);
     this.regions.push({
@@ -252,6 +452,9 @@ export class MemoryManager {
 
   // Clear all memory regions
   clear(): void {
+    if (this.ramHandler) {
+      this.ramHandler.retire();
+    }
     this.regions = [];
     this.ramHandler = null;
   }
@@ -263,6 +466,130 @@ export class MemoryManager {
     }
   }
 
+  // Capture RAM contents page by page (region-relative page indices).
+  // With onlyDirty set, only pages written since the previous capture are
+  // returned. Dirty tracking is reset either way, so consecutive captures
+  // form a chain of deltas.
+  captureRAMPages(onlyDirty: boolean = false): Map<number, Uint8Array> {
+    const pages = new Map<number, Uint8Array>();
+    if (!this.ramHandler) {
+      return pages;
+    }
+
+    if (onlyDirty) {
+      for (const page of this.ramHandler.getDirtyPages()) {
+        pages.set(page, this.ramHandler.readPage(page));
+      }
+    } else {
+      for (let page = 0; page < this.ramHandler.getPageCount(); page++) {
+        pages.set(page, this.ramHandler.readPage(page));
+      }
+    }
+
+    this.ramHandler.clearDirtyPages();
+    return pages;
+  }
+
+  // Write back pages produced by captureRAMPages()
+  restoreRAMPages(pages: Map<number, Uint8Array>): void {
+    if (!this.ramHandler) {
+      return;
+    }
+
+    for (const [page, contents] of pages) {
+      this.ramHandler.writePage(page, contents);
+    }
+  }
+
+  // Forget which RAM pages have been written so far
+  clearDirtyPages(): void {
+    if (this.ramHandler) {
+      this.ramHandler.clearDirtyPages();
+    }
+  }
+
+  // Create an independent copy of this memory map. RAM pages are shared
+  // copy-on-write and ROM images are shared outright; peripherals mapped
+  // directly into memory cannot be copied.
+  fork(): MemoryManager {
+    const child = new MemoryManager();
+
+    for (const region of this.regions) {
+      if (region.handler === this.ramHandler) {
+        child.ramHandler = this.ramHandler.fork();
+        child.regions.push({ ...region, handler: child.ramHandler });
+      } else if (region.type === 'ROM') {
+        child.regions.push({ ...region });
+      } else {
+        throw new Error(`Cannot fork memory region $${region.start.toString(16).toUpperCase().padStart(4, '0')}-$${region.end.toString(16).toUpperCase().padStart(4, '0')}: mapped peripherals cannot be copied`);
+      }
+    }
+
+    return child;
+  }
+
+  // Number of RAM pages still shared with a fork or parent
+  getSharedRAMPageCount(): number {
+    return this.ramHandler ? this.ramHandler.getSharedPageCount() : 0;
+  }
+
+  // Backing buffer for a 256-byte page, or null when the page mixes regions,
+  // is partly unmapped or contains directly mapped peripherals
+  getDirectPage(page: number): DirectPage | null {
+    const backing = this.findPageBacking(page);
+    if (!backing) {
+      return null;
+    }
+    if (backing.region.type === 'ROM') {
+      return { kind: 'ROM', data: (backing.region.handler as ROMHandler).getPageView(backing.offset) };
+    }
+    return this.ramHandler!.getDirectPage(backing.offset / RAM_PAGE_SIZE);
+  }
+
+  // Read a block of memory. Whole pages of RAM or ROM are copied directly;
+  // anything else (peripherals, partial pages) goes through read().
+  readRange(startAddress: number, length: number): Uint8Array {
+    const data = new Uint8Array(length);
+    let offset = 0;
+
+    while (offset < length) {
+      const address = (startAddress + offset) & 0xFFFF;
+      const backing = this.findPageBacking(address >> 8);
+      if (!backing) {
+        data[offset++] = this.read(address);
+        continue;
+      }
+
+      const pageData = backing.region.type === 'ROM'
+        ? (backing.region.handler as ROMHandler).getPageView(backing.offset)
+        : this.ramHandler!.peekPage(backing.offset / RAM_PAGE_SIZE);
+      const pageOffset = address & 0xFF;
+      const count = Math.min(RAM_PAGE_SIZE - pageOffset, length - offset);
+      data.set(pageData.subarray(pageOffset, pageOffset + count), offset);
+      offset += count;
+    }
+
+    return data;
+  }
+
+  // RAM and ROM regions backed by SharedArrayBuffers, for viewing memory
+  // from other threads without copies. Peripherals are not included since
+  // reading them has side effects. The descriptor stops being live when RAM
+  // is forked or reconfigured; viewers can detect this and request a new one.
+  getSharedMemory(): SharedMemoryDescriptor {
+    const regions: SharedMemoryRegion[] = [];
+    for (const region of this.regions) {
+      if (region.handler === this.ramHandler) {
+        const shared = this.ramHandler.getSharedRegion();
+        regions.push({ type: 'RAM', start: region.start, end: region.end, buffer: shared.buffer, versions: shared.versions });
+      } else if (region.type === 'ROM') {
+        regions.push({ type: 'ROM', start: region.start, end: region.end,
+                       buffer: (region.handler as ROMHandler).getSharedBuffer() });
+      }
+    }
+    return { regions };
+  }
+
   // Get all peripherals
   getPeripherals(): Peripheral[] {
     return this.regions
@@ -293,6 +620,33 @@ export class MemoryManager {
     return matchingRegions[0];
   }
 
+  // Region fully backing a page with plain storage, and the page's offset
+  // into it; null for pages with peripherals, mixed regions or gaps
+  private findPageBacking(page: number): { region: MemoryRegion; offset: number } | null {
+    const start = page * RAM_PAGE_SIZE;
+    const end = start + RAM_PAGE_SIZE - 1;
+    const overlapping = this.regions.filter(region => region.start <= end && region.end >= start);
+
+    if (overlapping.some(region => region.type === 'IO')) {
+      return null;
+    }
+
+    const roms = overlapping.filter(region => region.type === 'ROM');
+    if (roms.length > 0) {
+      const rom = roms[0];
+      if (roms.length > 1 || rom.start > start || rom.end < end) {
+        return null;
+      }
+      return { region: rom, offset: start - rom.start };
+    }
+
+    const ram = overlapping.find(region => region.handler === this.ramHandler);
+    if (!ram || ram.start > start || ram.end < end || (start - ram.start) % RAM_PAGE_SIZE !== 0) {
+      return null;
+    }
+    return { region: ram, offset: start - ram.start };
+  }
+
   private sortRegions(): void {
     this.regions.sort((a, b) => a.start - b.start);
   }
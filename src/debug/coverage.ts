@@ -0,0 +1,201 @@
+/**
+ * Code coverage from the core's per-PC coverage map
+ * The core ORs flags into a 64K map for every instruction it executes;
+ * source lines come from the cc65 debug info and are exported as lcov
+ * tracefiles (genhtml, IDE gutters, CI) or a self-contained HTML report.
+ */
+
+import fs from 'fs';
+import path from 'path';
+import { ADDRESSING_MODE, INSTRUCTION_LENGTH } from '../core/fallback-core';
+import { CC65LineRange } from '../cc65/debug-info';
+
+// Flags per address, matching CPU_COVERAGE_* in fake6502.h
+export const COVERAGE_EXECUTED = 0x01;
+export const COVERAGE_TAKEN = 0x02;
+export const COVERAGE_NOT_TAKEN = 0x04;
+
+// 1 for the conditional branches
+export const BRANCH_OPCODES = Uint8Array.from(ADDRESSING_MODE, mode => (mode === 'rel' ? 1 : 0));
+
+export interface CoverageBranch {
+  address: number;
+  executed: boolean;
+  taken: boolean;
+  notTaken: boolean;
+}
+
+export interface CoverageLine {
+  line: number;
+  hit: boolean;
+  branches: CoverageBranch[];
+}
+
+export interface CoverageFile {
+  name: string;
+  lines: CoverageLine[];        // Sorted by line number
+  linesHit: number;
+  branches: number;             // Two outcomes per branch instruction
+  branchesHit: number;
+}
+
+export interface CoverageReport {
+  files: CoverageFile[];        // Sorted by name
+  lines: number;
+  linesHit: number;
+  branches: number;
+  branchesHit: number;
+}
+
+export interface CoverageHtmlOptions {
+  title?: string;
+  sourceRoot?: string;          // Directory the debug info file names are relative to
+}
+
+/**
+ * Map coverage flags to source lines
+ * A line is hit when any instruction in its bytes ran. Branches are found
+ * by decoding each line's bytes from its first address, so branches that
+ * never ran are reported too; addresses the core marked as executed
+ * resynchronize the decoding after inline data.
+ */
+export function buildCoverageReport(map: Uint8Array, ranges: CC65LineRange[], read: (address: number) => number): CoverageReport {
+  const files = new Map<string, Map<number, CoverageLine>>();
+  for (const range of ranges) {
+    let lines = files.get(range.file);
+    if (!lines) {
+      lines = new Map();
+      files.set(range.file, lines);
+    }
+    let line = lines.get(range.line);
+    if (!line) {
+      line = { line: range.line, hit: false, branches: [] };
+      lines.set(range.line, line);
+    }
+
+    let next = range.start;
+    for (let address = range.start; address < range.end && address <= 0xFFFF; address++) {
+      const flags = map[address];
+      if (flags & COVERAGE_EXECUTED) {
+        line.hit = true;
+      } else if (address !== next) {
+        continue;
+      }
+      const opcode = read(address);
+      next = address + INSTRUCTION_LENGTH[opcode];
+      if (BRANCH_OPCODES[opcode] && !line.branches.some(branch => branch.address === address)) {
+        line.branches.push({
+          address,
+          executed: (flags & COVERAGE_EXECUTED) !== 0,
+          taken: (flags & COVERAGE_TAKEN) !== 0,
+          notTaken: (flags & COVERAGE_NOT_TAKEN) !== 0
+        });
+      }
+    }
+  }
+
+  const report: CoverageReport = { files: [], lines: 0, linesHit: 0, branches: 0, branchesHit: 0 };
+  for (const name of Array.from(files.keys()).sort()) {
+    const lines = Array.from(files.get(name)!.values()).sort((a, b) => a.line - b.line);
+    const file: CoverageFile = { name, lines, linesHit: 0, branches: 0, branchesHit: 0 };
+    for (const line of lines) {
+      line.branches.sort((a, b) => a.address - b.address);
+      file.linesHit += line.hit ? 1 : 0;
+      file.branches += line.branches.length * 2;
+      for (const branch of line.branches) {
+        file.branchesHit += (branch.taken ? 1 : 0) + (branch.notTaken ? 1 : 0);
+      }
+    }
+    report.files.push(file);
+    report.lines += lines.length;
+    report.linesHit += file.linesHit;
+    report.branches += file.branches;
+    report.branchesHit += file.branchesHit;
+  }
+  return report;
+}
+
+/**
+ * lcov tracefile; line counts are 1 or 0 since the map records whether an
+ * address ran, not how often
+ */
+export function formatLcov(report: CoverageReport, testName: string = ''): string {
+  const output: string[] = [];
+  for (const file of report.files) {
+    output.push(`TN:${testName}`, `SF:${file.name}`);
+    for (const line of file.lines) {
+      line.branches.forEach((branch, block) => {
+        const outcome = (taken: boolean) => (branch.executed ? (taken ? '1' : '0') : '-');
+        output.push(`BRDA:${line.line},${block},0,${outcome(branch.taken)}`);
+        output.push(`BRDA:${line.line},${block},1,${outcome(branch.notTaken)}`);
+      });
+    }
+    output.push(`BRF:${file.branches}`, `BRH:${file.branchesHit}`);
+    for (const line of file.lines) {
+      output.push(`DA:${line.line},${line.hit ? 1 : 0}`);
+    }
+    output.push(`LF:${file.lines.length}`, `LH:${file.linesHit}`, 'end_of_record');
+  }
+  return output.join('\n') + '\n';
+}
+
+function escapeHtml(text: string): string {
+  return text.replace(/&/g, '&amp;').replace(/</g, '&lt;').replace(/>/g, '&gt;').replace(/"/g, '&quot;');
+}
+
+function percent(hit: number, total: number): string {
+  return total === 0 ? '-' : `${((hit / total) * 100).toFixed(1)}%`;
+}
+
+const HTML_STYLE = `body{font-family:sans-serif;margin:2em}table{border-collapse:collapse}
+td,th{padding:2px 10px;text-align:left}pre{margin:0}.hit{background:#cfc}.miss{background:#fcc}
+.partial{background:#ffc}.src td{font-family:monospace;white-space:pre;padding:0 8px}.num{color:#888;text-align:right}`;
+
+function htmlPage(title: string, body: string): string {
+  return `<!DOCTYPE html>\n<html><head><meta charset="utf-8"><title>${escapeHtml(title)}</title>` +
+    `<style>${HTML_STYLE}</style></head><body>\n${body}\n</body></html>\n`;
+}
+
+/**
+ * Write an HTML report: index.html with per-file totals and one page per
+ * file listing its source, when found, with hit and missed lines marked
+ */
+export function writeCoverageHtml(report: CoverageReport, directory: string, options: CoverageHtmlOptions = {}): void {
+  const title = options.title || 'Coverage';
+  fs.mkdirSync(directory, { recursive: true });
+
+  const rows = report.files.map((file, index) =>
+    `<tr><td><a href="file${index}.html">${escapeHtml(file.name)}</a></td>` +
+    `<td>${percent(file.linesHit, file.lines.length)}</td><td>${file.linesHit}/${file.lines.length}</td>` +
+    `<td>${percent(file.branchesHit, file.branches)}</td><td>${file.branchesHit}/${file.branches}</td></tr>`);
+  fs.writeFileSync(path.join(directory, 'index.html'), htmlPage(title,
+    `<h1>${escapeHtml(title)}</h1>\n<p>Lines ${percent(report.linesHit, report.lines)} (${report.linesHit}/${report.lines}), ` +
+    `branches ${percent(report.branchesHit, report.branches)} (${report.branchesHit}/${report.branches})</p>\n` +
+    `<table><tr><th>File</th><th>Lines</th><th></th><th>Branches</th><th></th></tr>\n${rows.join('\n')}\n</table>`));
+
+  report.files.forEach((file, index) => {
+    const source = path.resolve(options.sourceRoot || '.', file.name);
+    const text = fs.existsSync(source) ? fs.readFileSync(source, 'utf8').split(/\r?\n/) : [];
+    const lines = new Map(file.lines.map(line => [line.line, line]));
+    const count = Math.max(text.length, file.lines.length > 0 ? file.lines[file.lines.length - 1].line : 0);
+
+    const listing: string[] = [];
+    for (let number = 1; number <= count; number++) {
+      const line = lines.get(number);
+      let state = '';
+      let note = '';
+      if (line) {
+        const outcomes = line.branches.reduce((sum, b) => sum + (b.taken ? 1 : 0) + (b.notTaken ? 1 : 0), 0);
+        state = !line.hit ? 'miss' : outcomes < line.branches.length * 2 ? 'partial' : 'hit';
+        note = line.branches.map(b => (b.executed ? `${b.taken ? '+' : '-'}${b.notTaken ? '+' : '-'}` : '??')).join(' ');
+      }
+      listing.push(`<tr class="${state}"><td class="num">${number}</td><td>${escapeHtml(note)}</td>` +
+        `<td>${escapeHtml(text[number - 1] || '')}</td></tr>`);
+    }
+    fs.writeFileSync(path.join(directory, `file${index}.html`), htmlPage(`${title}: ${file.name}`,
+      `<p><a href="index.html">${escapeHtml(title)}</a></p>\n<h1>${escapeHtml(file.name)}</h1>\n` +
+      `<p>Lines ${percent(file.linesHit, file.lines.length)}, branches ${percent(file.branchesHit, file.branches)}; ` +
+      'branch outcomes are shown as taken/not taken, ?? for branches that never ran</p>\n' +
+      `<table class="src">\n${listing.join('\n')}\n</table>`));
+  });
+}
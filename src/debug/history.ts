@@ -0,0 +1,589 @@
+/**
+ * Execution history for reverse debugging
+ * Keeps periodic delta checkpoints of the machine plus a log of the
+ * nondeterministic inputs (serial bytes, host clock readings and file
+ * accesses, debugger interrupts), so any earlier
+ * instruction can be reached by restoring the nearest checkpoint and
+ * replaying forward.
+ */
+
+import { SystemBus } from '../core/bus';
+import { CPU6502, CPUSnapshot } from '../core/cpu';
+import { InterruptControllerState } from '../core/interrupt-controller';
+import { SerialPort } from '../peripherals/serial-port';
+import { HostCallBackend, HostCallStatus, HostFileRead } from '../peripherals/host-call';
+import { InputEventKind, InputEvent, InputLog, isPolledInput } from './input-log';
+
+export interface ExecutionHistoryOptions {
+  checkpointInterval: number; // Instructions between checkpoints
+  maxCheckpoints: number;     // Oldest checkpoints are folded away beyond this
+}
+
+interface Checkpoint {
+  instruction: number;
+  cycles: number;
+  cpu: CPUSnapshot;
+  ramPages: Map<number, Uint8Array>; // Full image for the oldest checkpoint, pages written since the previous one otherwise
+  peripherals: Map<string, unknown>;
+  interrupts: InterruptControllerState;
+}
+
+const DEFAULT_OPTIONS: ExecutionHistoryOptions = {
+  checkpointInterval: 10000,
+  maxCheckpoints: 64
+};
+
+export class ExecutionHistory {
+  private options: ExecutionHistoryOptions;
+  private enabled = false;
+  private checkpoints: Checkpoint[] = [];
+  private inputs = new InputLog();
+
+  // Position on the current timeline
+  private instruction = 0;
+  private horizon = 0; // Furthest instruction reached on this timeline
+
+  // While replaying, the next checkpoint to pass and the next logged input to deliver
+  private checkpointCursor = 0;
+  private inputCursor = 0;
+
+  constructor(private bus: SystemBus, options: Partial<ExecutionHistoryOptions> = {}) {
+    this.options = { ...DEFAULT_OPTIONS, ...options };
+  }
+
+  /**
+   * Start recording from the current machine state
+   */
+  enable(): void {
+    if (this.enabled) {
+      return;
+    }
+    this.enabled = true;
+    this.reset();
+  }
+
+  /**
+   * Stop recording and drop all history
+   */
+  disable(): void {
+    this.enabled = false;
+    this.clear();
+  }
+
+  isEnabled(): boolean {
+    return this.enabled;
+  }
+
+  setOptions(options: Partial<ExecutionHistoryOptions>): void {
+    this.options = { ...this.options, ...options };
+  }
+
+  getOptions(): ExecutionHistoryOptions {
+    return { ...this.options };
+  }
+
+  /**
+   * Drop all history and, when enabled, take a fresh base checkpoint
+   * Call after the machine has been reset or reloaded.
+   */
+  reset(): void {
+    this.clear();
+    if (this.enabled) {
+      this.takeCheckpoint(false);
+    }
+  }
+
+  /**
+   * Execute one instruction through the system bus, recording it
+   * Logged inputs are delivered first when replaying an earlier timeline.
+   * @returns Cycles consumed, 0 if a breakpoint halted execution
+   */
+  step(): number {
+    this.deliverLoggedInputs();
+    const cycles = this.bus.step();
+    if (cycles > 0) {
+      this.advance();
+    }
+    return cycles;
+  }
+
+  /**
+   * Record an external input delivered at the current instruction
+   * Recording while replaying an earlier timeline discards everything after
+   * the current position.
+   */
+  recordInput(kind: InputEventKind, source: string, value?: number, data?: Uint8Array): void {
+    if (!this.enabled) {
+      return;
+    }
+
+    if (this.isReplaying()) {
+      this.truncate();
+    }
+
+    this.inputs.append({ cycle: this.bus.getCycleCount(), kind, source, value, data });
+    this.inputCursor = this.inputs.length;
+  }
+
+  /**
+   * Wrap a host serial port so the bytes it delivers are logged and replayed
+   * @param port Host-side serial port
+   * @param source Name of the peripheral the port is connected to
+   */
+  wrapSerialPort(port: SerialPort, source: string): SerialPort {
+    return new HistorySerialPort(this, port, source);
+  }
+
+  /**
+   * True while re-executing instructions that are already part of the history
+   */
+  isReplaying(): boolean {
+    return this.enabled && (this.instruction < this.horizon || this.inputCursor < this.inputs.length);
+  }
+
+  /**
+   * Move to an earlier (or already recorded later) instruction
+   * @param target Instruction index to reach
+   * @returns true if the target was reached exactly
+   */
+  seek(target: number): boolean {
+    if (!this.enabled || this.checkpoints.length === 0) {
+      return false;
+    }
+
+    const clamped = Math.max(this.getEarliestInstruction(), Math.min(target, this.horizon));
+    this.restoreCheckpoint(this.findCheckpointIndex(clamped));
+
+    while (this.instruction < clamped) {
+      if (this.replayStep() === 0) {
+        break;
+      }
+    }
+
+    return this.instruction === target;
+  }
+
+  /**
+   * Undo the last instructions
+   * @param count Number of instructions to go back
+   * @returns true if the position moved
+   */
+  reverseStep(count: number = 1): boolean {
+    if (!this.enabled || this.instruction <= this.getEarliestInstruction()) {
+      return false;
+    }
+
+    this.seek(Math.max(this.getEarliestInstruction(), this.instruction - Math.max(1, count)));
+    return true;
+  }
+
+  /**
+   * Run backwards to the most recent instruction whose address satisfies
+   * isBreakpoint. Stops at the start of the history if none is found.
+   * @returns true if a breakpoint was found
+   */
+  reverseContinue(isBreakpoint: (address: number) => boolean): boolean {
+    if (!this.enabled || this.checkpoints.length === 0) {
+      return false;
+    }
+
+    const origin = this.instruction;
+    const cpu = this.bus.getCPU();
+
+    // Scan segment by segment, newest first, for the last breakpoint before origin
+    for (let k = this.findCheckpointIndex(origin - 1); k >= 0; k--) {
+      if (this.checkpoints[k].instruction >= origin) {
+        continue;
+      }
+
+      const segmentEnd = k + 1 < this.checkpoints.length
+        ? Math.min(this.checkpoints[k + 1].instruction, origin)
+        : origin;
+
+      this.restoreCheckpoint(k);
+      let found = -1;
+      while (this.instruction < segmentEnd) {
+        if (isBreakpoint(cpu.getRegisters().PC)) {
+          found = this.instruction;
+        }
+        if (this.replayStep() === 0) {
+          break;
+        }
+      }
+
+      if (found >= 0) {
+        this.seek(found);
+        return true;
+      }
+    }
+
+    this.seek(this.getEarliestInstruction());
+    return false;
+  }
+
+  // Position and statistics
+  getInstructionIndex(): number {
+    return this.instruction;
+  }
+
+  getCycleCount(): number {
+    return this.bus.getCycleCount();
+  }
+
+  getHorizon(): number {
+    return this.horizon;
+  }
+
+  getEarliestInstruction(): number {
+    return this.checkpoints.length > 0 ? this.checkpoints[0].instruction : this.instruction;
+  }
+
+  getCheckpointCount(): number {
+    return this.checkpoints.length;
+  }
+
+  getInputLog(): InputEvent[] {
+    return this.inputs.getEvents();
+  }
+
+  // Serial port support
+  peekSerialInput(source: string): boolean {
+    return this.peekInput('serial', source);
+  }
+
+  takeSerialInput(source: string): number | null {
+    const event = this.takeInput('serial', source);
+    return event ? event.value ?? null : null;
+  }
+
+  /**
+   * Wrap a host-call backend so what the host returns is logged and
+   * replayed, and its side effects are not repeated
+   * @param backend Host-side backend
+   * @param source Name of the peripheral using it
+   */
+  wrapHostCallBackend(backend: HostCallBackend, source: string): HostCallBackend {
+    return new HistoryHostCallBackend(this, backend, source);
+  }
+
+  /**
+   * Next logged input of a kind from a source if due at the current cycle
+   */
+  takeInput(kind: InputEventKind, source: string): InputEvent | null {
+    if (!this.peekInput(kind, source)) {
+      return null;
+    }
+    return this.inputs.get(this.inputCursor++)!;
+  }
+
+  private peekInput(kind: InputEventKind, source: string): boolean {
+    const event = this.inputs.get(this.inputCursor);
+    return event !== undefined &&
+      event.kind === kind &&
+      event.source === source &&
+      event.cycle === this.bus.getCycleCount();
+  }
+
+  /**
+   * Execute one instruction as part of an internal replay
+   * The recorded run got past this instruction, so breakpoints are bypassed.
+   */
+  private replayStep(): number {
+    const cpu = this.bus.getCPU();
+    const pc = cpu.getRegisters().PC;
+    if (!cpu.hasBreakpoint(pc)) {
+      return this.step();
+    }
+
+    cpu.removeBreakpoint(pc);
+    try {
+      return this.step();
+    } finally {
+      cpu.setBreakpoint(pc);
+    }
+  }
+
+  private advance(): void {
+    this.instruction++;
+    if (this.instruction > this.horizon) {
+      this.horizon = this.instruction;
+    }
+
+    // Pass checkpoints recorded earlier on this timeline; memory matches them
+    // exactly, so dirty tracking restarts from there
+    while (this.checkpointCursor < this.checkpoints.length &&
+           this.checkpoints[this.checkpointCursor].instruction <= this.instruction) {
+      if (this.checkpoints[this.checkpointCursor].instruction === this.instruction) {
+        this.bus.getMemory().clearDirtyPages();
+      }
+      this.checkpointCursor++;
+    }
+
+    if (this.checkpointCursor === this.checkpoints.length) {
+      const last = this.checkpoints[this.checkpoints.length - 1];
+      if (!last || this.instruction - last.instruction >= this.options.checkpointInterval) {
+        this.takeCheckpoint(last !== undefined);
+      }
+    }
+  }
+
+  private deliverLoggedInputs(): void {
+    const interruptController = this.bus.getInterruptController();
+    const cycle = this.bus.getCycleCount();
+
+    // Skip anything the machine did not consume on the recorded run
+    while (this.inputCursor < this.inputs.length &&
+           this.inputs.get(this.inputCursor)!.cycle < cycle) {
+      this.inputCursor++;
+    }
+
+    while (this.inputCursor < this.inputs.length) {
+      const event = this.inputs.get(this.inputCursor)!;
+      if (event.cycle !== cycle || isPolledInput(event.kind)) {
+        break;
+      }
+
+      switch (event.kind) {
+        case 'irq':
+          interruptController.triggerIRQ(event.source);
+          break;
+        case 'nmi':
+          interruptController.triggerNMI(event.source);
+          break;
+        case 'clear-irq':
+          interruptController.clearIRQ(event.source);
+          break;
+      }
+      this.inputCursor++;
+    }
+  }
+
+  private takeCheckpoint(delta: boolean): void {
+    this.checkpoints.push({
+      instruction: this.instruction,
+      cycles: this.bus.getCycleCount(),
+      cpu: captureCPU(this.bus.getCPU()),
+      ramPages: this.bus.getMemory().captureRAMPages(delta),
+      peripherals: this.bus.getPeripheralHub().saveState(),
+      interrupts: this.bus.getInterruptController().saveState()
+    });
+    this.checkpointCursor = this.checkpoints.length;
+
+    if (this.checkpoints.length > this.options.maxCheckpoints) {
+      this.foldOldestCheckpoint();
+    }
+  }
+
+  /**
+   * Drop the oldest checkpoint, merging its full RAM image into the next one
+   */
+  private foldOldestCheckpoint(): void {
+    const oldest = this.checkpoints.shift()!;
+    const next = this.checkpoints[0];
+    const merged = new Map(oldest.ramPages);
+    for (const [page, contents] of next.ramPages) {
+      merged.set(page, contents);
+    }
+    next.ramPages = merged;
+    this.checkpointCursor--;
+
+    const dropped = this.inputs.dropBefore(next.cycles);
+    this.inputCursor = Math.max(0, this.inputCursor - dropped);
+  }
+
+  private restoreCheckpoint(index: number): void {
+    const checkpoint = this.checkpoints[index];
+    const memory = this.bus.getMemory();
+
+    // The oldest checkpoint holds every page; later ones hold deltas
+    for (let i = 0; i <= index; i++) {
+      memory.restoreRAMPages(this.checkpoints[i].ramPages);
+    }
+    memory.clearDirtyPages();
+
+    restoreCPU(this.bus.getCPU(), checkpoint.cpu);
+    this.bus.getPeripheralHub().restoreState(checkpoint.peripherals);
+    this.bus.getInterruptController().restoreState(checkpoint.interrupts);
+
+    this.instruction = checkpoint.instruction;
+    this.bus.setCycleCount(checkpoint.cycles);
+    this.checkpointCursor = index + 1;
+    this.inputCursor = this.inputs.findIndex(checkpoint.cycles);
+  }
+
+  /**
+   * Index of the newest checkpoint at or before the given instruction
+   */
+  private findCheckpointIndex(instruction: number): number {
+    let low = 0;
+    let high = this.checkpoints.length - 1;
+    let result = 0;
+
+    while (low <= high) {
+      const mid = (low + high) >> 1;
+      if (this.checkpoints[mid].instruction <= instruction) {
+        result = mid;
+        low = mid + 1;
+      } else {
+        high = mid - 1;
+      }
+    }
+
+    return result;
+  }
+
+  /**
+   * Forget the future of the current timeline
+   */
+  private truncate(): void {
+    this.inputs.setLength(this.inputCursor);
+    this.checkpoints.length = this.checkpointCursor;
+    this.horizon = this.instruction;
+  }
+
+  private clear(): void {
+    this.checkpoints = [];
+    this.inputs.clear();
+    this.instruction = 0;
+    this.horizon = 0;
+    this.checkpointCursor = 0;
+    this.inputCursor = 0;
+  }
+}
+
+/**
+ * Serial port decorator that logs received bytes and replays them
+ */
+export class HistorySerialPort implements SerialPort {
+  constructor(
+    private history: ExecutionHistory,
+    private port: SerialPort,
+    private source: string
+  ) {}
+
+  write(data: number): void {
+    // Output is deterministic, so replayed transmissions are not repeated
+    if (!this.history.isReplaying()) {
+      this.port.write(data);
+    }
+  }
+
+  read(): number | null {
+    if (this.history.isReplaying()) {
+      return this.history.takeSerialInput(this.source);
+    }
+
+    const data = this.port.read();
+    if (data !== null) {
+      this.history.recordInput('serial', this.source, data);
+    }
+    return data;
+  }
+
+  hasData(): boolean {
+    if (this.history.isReplaying()) {
+      return this.history.peekSerialInput(this.source);
+    }
+    return this.port.hasData();
+  }
+
+  isReady(): boolean {
+    return this.port.isReady();
+  }
+
+  setBaudRate(rate: number): void {
+    this.port.setBaudRate(rate);
+  }
+
+  close(): void {
+    this.port.close();
+  }
+
+  getPort(): SerialPort {
+    return this.port;
+  }
+}
+
+/**
+ * Host-call backend decorator that logs what the host returns and replays
+ * it; output and file writes already happened, so replay does not repeat
+ * them
+ */
+export class HistoryHostCallBackend implements HostCallBackend {
+  constructor(
+    private history: ExecutionHistory,
+    private backend: HostCallBackend,
+    private source: string
+  ) {}
+
+  output(text: string): void {
+    if (!this.history.isReplaying()) {
+      this.backend.output(text);
+    }
+  }
+
+  readFile(name: string, length: number): HostFileRead {
+    if (this.history.isReplaying()) {
+      const event = this.history.takeInput('file', this.source);
+      if (event) {
+        return { status: event.value ?? HostCallStatus.IO_ERROR, data: event.data || new Uint8Array(0) };
+      }
+    }
+    const read = this.backend.readFile(name, length);
+    this.history.recordInput('file', this.source, read.status, read.data);
+    return read;
+  }
+
+  writeFile(name: string, data: Uint8Array, append: boolean): HostCallStatus {
+    if (this.history.isReplaying()) {
+      const event = this.history.takeInput('file', this.source);
+      if (event) {
+        return event.value ?? HostCallStatus.IO_ERROR;
+      }
+    }
+    const status = this.backend.writeFile(name, data, append);
+    this.history.recordInput('file', this.source, status);
+    return status;
+  }
+
+  wallClock(): number {
+    if (this.history.isReplaying()) {
+      const event = this.history.takeInput('clock', this.source);
+      if (event) {
+        return event.value ?? 0;
+      }
+    }
+    const seconds = this.backend.wallClock();
+    this.history.recordInput('clock', this.source, seconds);
+    return seconds;
+  }
+}
+
+function captureCPU(cpu: CPU6502): CPUSnapshot {
+  if (cpu.saveState) {
+    return cpu.saveState();
+  }
+  return {
+    ...cpu.getRegisters(),
+    irqPending: cpu.isIRQPending(),
+    nmiPending: cpu.isNMIPending()
+  };
+}
+
+function restoreCPU(cpu: CPU6502, snapshot: CPUSnapshot): void {
+  if (cpu.restoreState) {
+    cpu.restoreState(snapshot);
+    return;
+  }
+
+  const { irqPending, nmiPending, ...registers } = snapshot;
+  cpu.setRegisters(registers);
+  if (irqPending) {
+    cpu.triggerIRQ();
+  } else {
+    cpu.clearIRQ();
+  }
+  if (nmiPending) {
+    cpu.triggerNMI();
+  }
+}
@@ -0,0 +1,284 @@
+/**
+ * Log of external inputs timestamped by emulated cycle
+ * Shared by the input recorder and the execution history; serializes to a
+ * compact binary form so recorded runs can be replayed elsewhere.
+ */
+
+import * as fs from 'fs';
+
+export type InputEventKind = 'serial' | 'irq' | 'nmi' | 'clear-irq' | 'clock' | 'file';
+
+export interface InputEvent {
+  cycle: number;   // Bus cycle count at the instruction boundary the input was delivered at
+  kind: InputEventKind;
+  source: string;  // Peripheral name for serial input and host readings, interrupt source otherwise
+  value?: number;  // Received byte for serial input, Unix seconds for clock readings, status for file access
+  data?: Uint8Array;  // Bytes read by file access
+}
+
+/**
+ * Inputs a peripheral takes while an instruction executes (a received byte,
+ * a host clock reading, a file access), rather than ones delivered between
+ * instructions
+ */
+export function isPolledInput(kind: InputEventKind): boolean {
+  return kind === 'serial' || kind === 'clock' || kind === 'file';
+}
+
+const MAGIC = 0x4C353649; // 'I65L' little-endian
+const VERSION = 3;
+const KINDS: InputEventKind[] = ['serial', 'irq', 'nmi', 'clear-irq', 'clock', 'file'];
+const MAX_SOURCES = 32;
+
+/**
+ * Error raised for malformed input log data
+ */
+export class InputLogError extends Error {
+  constructor(message: string) {
+    super(message);
+    this.name = 'InputLogError';
+  }
+}
+
+export class InputLog {
+  private events: InputEvent[] = [];
+
+  constructor(events: InputEvent[] = []) {
+    for (const event of events) {
+      this.append(event);
+    }
+  }
+
+  /**
+   * Append an event; events must be in cycle order
+   */
+  append(event: InputEvent): void {
+    const last = this.events[this.events.length - 1];
+    if (last && event.cycle < last.cycle) {
+      throw new InputLogError(`Input at cycle ${event.cycle} recorded after cycle ${last.cycle}`);
+    }
+    this.events.push({ ...event });
+  }
+
+  /**
+   * Drop every event recorded after the given cycle
+   */
+  truncateAfter(cycle: number): void {
+    let length = this.events.length;
+    while (length > 0 && this.events[length - 1].cycle > cycle) {
+      length--;
+    }
+    this.events.length = length;
+  }
+
+  /**
+   * Drop every event recorded before the given cycle
+   * @returns Number of events removed
+   */
+  dropBefore(cycle: number): number {
+    let count = 0;
+    while (count < this.events.length && this.events[count].cycle < cycle) {
+      count++;
+    }
+    this.events.splice(0, count);
+    return count;
+  }
+
+  /**
+   * Index of the first event at or after the given cycle
+   */
+  findIndex(cycle: number): number {
+    let low = 0;
+    let high = this.events.length;
+    while (low < high) {
+      const mid = (low + high) >> 1;
+      if (this.events[mid].cycle < cycle) {
+        low = mid + 1;
+      } else {
+        high = mid;
+      }
+    }
+    return low;
+  }
+
+  get(index: number): InputEvent | undefined {
+    return this.events[index];
+  }
+
+  get length(): number {
+    return this.events.length;
+  }
+
+  setLength(length: number): void {
+    this.events.length = Math.min(length, this.events.length);
+  }
+
+  getEvents(): InputEvent[] {
+    return this.events.map(event => ({ ...event }));
+  }
+
+  clear(): void {
+    this.events = [];
+  }
+
+  /**
+   * Encode as: magic, version, source name table, event count, then per event
+   * a LEB128 cycle delta, a byte packing kind (low 3 bits) and source index,
+   * the received byte for serial input, 4 bytes of seconds for a clock
+   * reading, and for a file access its status byte and a LEB128 data length
+   * plus one (0 for no data) followed by the data. Version 1 logs, with a
+   * 2-bit kind, and version 2 logs, without file access, are still read.
+   */
+  serialize(): Buffer {
+    const sources: string[] = [];
+    const sourceIndex = new Map<string, number>();
+    for (const event of this.events) {
+      if (!sourceIndex.has(event.source)) {
+        if (sources.length >= MAX_SOURCES) {
+          throw new InputLogError(`Too many input sources (max ${MAX_SOURCES})`);
+        }
+        sourceIndex.set(event.source, sources.length);
+        sources.push(event.source);
+      }
+    }
+
+    const bytes: number[] = [];
+    const pushU32 = (value: number) => {
+      bytes.push(value & 0xFF, (value >>> 8) & 0xFF, (value >>> 16) & 0xFF, (value >>> 24) & 0xFF);
+    };
+    const pushLEB = (value: number) => {
+      do {
+        const low = value % 128;
+        value = Math.floor(value / 128);
+        bytes.push(value > 0 ? low | 0x80 : low);
+      } while (value > 0);
+    };
+
+    pushU32(MAGIC);
+    bytes.push(VERSION, sources.length);
+    for (const source of sources) {
+      const name = Buffer.from(source, 'utf8');
+      if (name.length > 255) {
+        throw new InputLogError(`Input source name too long: ${source}`);
+      }
+      bytes.push(name.length, ...name);
+    }
+    pushU32(this.events.length);
+
+    let previousCycle = 0;
+    for (const event of this.events) {
+      pushLEB(event.cycle - previousCycle);
+      previousCycle = event.cycle;
+
+      bytes.push(KINDS.indexOf(event.kind) | (sourceIndex.get(event.source)! << 3));
+      if (event.kind === 'serial') {
+        bytes.push((event.value ?? 0) & 0xFF);
+      } else if (event.kind === 'clock') {
+        pushU32(event.value ?? 0);
+      } else if (event.kind === 'file') {
+        bytes.push((event.value ?? 0) & 0xFF);
+        pushLEB(event.data ? event.data.length + 1 : 0);
+        for (const byte of event.data || []) {
+          bytes.push(byte);
+        }
+      }
+    }
+
+    return Buffer.from(bytes);
+  }
+
+  static deserialize(data: Uint8Array): InputLog {
+    let offset = 0;
+    const need = (count: number) => {
+      if (offset + count > data.length) {
+        throw new InputLogError('Truncated input log');
+      }
+    };
+    const readU8 = () => {
+      need(1);
+      return data[offset++];
+    };
+    const readU32 = () => {
+      need(4);
+      const value = (data[offset] | (data[offset + 1] << 8) | (data[offset + 2] << 16) | (data[offset + 3] << 24)) >>> 0;
+      offset += 4;
+      return value;
+    };
+
+    if (readU32() !== MAGIC) {
+      throw new InputLogError('Not an input log');
+    }
+    const version = readU8();
+    if (version < 1 || version > VERSION) {
+      throw new InputLogError(`Unsupported input log version: ${version}`);
+    }
+
+    const sources: string[] = [];
+    const sourceCount = readU8();
+    for (let i = 0; i < sourceCount; i++) {
+      const length = readU8();
+      need(length);
+      sources.push(Buffer.from(data.subarray(offset, offset + length)).toString('utf8'));
+      offset += length;
+    }
+
+    const readLEB = () => {
+      let value = 0;
+      let scale = 1;
+      let byte: number;
+      do {
+        byte = readU8();
+        value += (byte & 0x7F) * scale;
+        scale *= 128;
+      } while (byte & 0x80);
+      return value;
+    };
+
+    const log = new InputLog();
+    const eventCount = readU32();
+    let cycle = 0;
+    for (let i = 0; i < eventCount; i++) {
+      cycle += readLEB();
+
+      const packed = readU8();
+      const kindBits = version === 1 ? 2 : 3;
+      const kind = KINDS[packed & ((1 << kindBits) - 1)];
+      const source = sources[packed >> kindBits];
+      if (kind === undefined) {
+        throw new InputLogError(`Invalid input kind in event ${i}`);
+      }
+      if (source === undefined) {
+        throw new InputLogError(`Invalid source index in event ${i}`);
+      }
+
+      const event: InputEvent = { cycle, kind, source };
+      if (kind === 'serial') {
+        event.value = readU8();
+      } else if (kind === 'clock') {
+        event.value = readU32();
+      } else if (kind === 'file') {
+        event.value = readU8();
+        const length = readLEB();
+        if (length > 0) {
+          need(length - 1);
+          event.data = Uint8Array.from(data.subarray(offset, offset + length - 1));
+          offset += length - 1;
+        }
+      }
+      log.events.push(event);
+    }
+
+    return log;
+  }
+
+  saveToFile(filePath: string): void {
+    fs.writeFileSync(filePath, this.serialize());
+  }
+
+  static loadFromFile(filePath: string): InputLog {
+    if (!fs.existsSync(filePath)) {
+      throw new InputLogError(`Input log not found: ${filePath}`);
+    }
+    return InputLog.deserialize(fs.readFileSync(filePath));
+  }
+}
@@ -0,0 +1,290 @@
+/**
+ * Deterministic record/replay of external inputs
+ * Recording timestamps every input reaching the machine with the bus cycle
+ * count; replaying injects the same inputs at the same cycles and ignores the
+ * host, so a run started from the same reset state reproduces exactly.
+ */
+
+import { SystemBus } from '../core/bus';
+import { SerialPort } from '../peripherals/serial-port';
+import { HostCallBackend, HostCallStatus, HostFileRead } from '../peripherals/host-call';
+import { InputEvent, InputEventKind, InputLog, isPolledInput } from './input-log';
+
+export type InputRecorderMode = 'off' | 'recording' | 'replaying';
+
+export class InputRecorder {
+  private mode: InputRecorderMode = 'off';
+  private log = new InputLog();
+  private cursor = 0; // Next event to inject while replaying
+
+  constructor(private bus: SystemBus) {}
+
+  /**
+   * Start a new recording; inputs are stamped with the bus cycle count
+   */
+  startRecording(): void {
+    this.log = new InputLog();
+    this.cursor = 0;
+    this.mode = 'recording';
+  }
+
+  /**
+   * Start injecting a recorded log
+   * The machine must be in the state the recording started from.
+   */
+  startReplay(log: InputLog): void {
+    this.log = log;
+    this.cursor = log.findIndex(this.bus.getCycleCount());
+    this.mode = this.cursor < log.length ? 'replaying' : 'off';
+  }
+
+  /**
+   * Stop recording or replaying
+   * @returns The recorded (or replayed) log
+   */
+  stop(): InputLog {
+    this.mode = 'off';
+    return this.log;
+  }
+
+  getMode(): InputRecorderMode {
+    return this.mode;
+  }
+
+  isRecording(): boolean {
+    return this.mode === 'recording';
+  }
+
+  isReplaying(): boolean {
+    return this.mode === 'replaying';
+  }
+
+  getLog(): InputLog {
+    return this.log;
+  }
+
+  /**
+   * Cycle of the last input in the log being replayed, or -1 if none
+   */
+  getLastInputCycle(): number {
+    const last = this.log.get(this.log.length - 1);
+    return last ? last.cycle : -1;
+  }
+
+  /**
+   * Record an input delivered at the current bus cycle
+   */
+  recordInput(kind: InputEventKind, source: string, value?: number, data?: Uint8Array): void {
+    if (this.mode !== 'recording') {
+      return;
+    }
+
+    // Inputs after a rewind replace whatever followed on the old timeline
+    const cycle = this.bus.getCycleCount();
+    this.log.truncateAfter(cycle);
+    this.log.append({ cycle, kind, source, value, data });
+  }
+
+  /**
+   * Inject the interrupt inputs due at the current bus cycle
+   * Call at each instruction boundary, before stepping the bus. Serial
+   * input is injected through the wrapped port when the peripheral polls.
+   */
+  deliverInputs(): void {
+    if (this.mode !== 'replaying') {
+      return;
+    }
+
+    const cycle = this.bus.getCycleCount();
+    const interruptController = this.bus.getInterruptController();
+
+    while (this.cursor < this.log.length) {
+      const event = this.log.get(this.cursor)!;
+      if (event.cycle > cycle) {
+        break;
+      }
+      if (event.cycle === cycle && isPolledInput(event.kind)) {
+        break;
+      }
+
+      // Events behind the current cycle were missed; they cannot be
+      // delivered on time, so drop them rather than diverge later
+      if (event.cycle === cycle) {
+        switch (event.kind) {
+          case 'irq':
+            interruptController.triggerIRQ(event.source);
+            break;
+          case 'nmi':
+            interruptController.triggerNMI(event.source);
+            break;
+          case 'clear-irq':
+            interruptController.clearIRQ(event.source);
+            break;
+        }
+      }
+      this.cursor++;
+    }
+
+    this.finishIfExhausted();
+  }
+
+  /**
+   * Wrap a host serial port so received bytes are recorded and replayed
+   * @param port Host-side serial port
+   * @param source Name of the peripheral the port is connected to
+   */
+  wrapSerialPort(port: SerialPort, source: string): SerialPort {
+    return new RecordingSerialPort(this, port, source);
+  }
+
+  /**
+   * Wrap a host-call backend so what the host returns is recorded and
+   * replayed
+   * @param backend Host-side backend
+   * @param source Name of the peripheral using it
+   */
+  wrapHostCallBackend(backend: HostCallBackend, source: string): HostCallBackend {
+    return new RecordingHostCallBackend(this, backend, source);
+  }
+
+  peekSerialInput(source: string): boolean {
+    return this.peekInput('serial', source);
+  }
+
+  takeSerialInput(source: string): number | null {
+    const event = this.takeInput('serial', source);
+    return event ? event.value ?? null : null;
+  }
+
+  /**
+   * Next logged input of a kind from a source if due at the current cycle
+   */
+  takeInput(kind: InputEventKind, source: string): InputEvent | null {
+    if (!this.peekInput(kind, source)) {
+      return null;
+    }
+    const event = this.log.get(this.cursor++)!;
+    this.finishIfExhausted();
+    return event;
+  }
+
+  private peekInput(kind: InputEventKind, source: string): boolean {
+    if (this.mode !== 'replaying') {
+      return false;
+    }
+    const event = this.log.get(this.cursor);
+    return event !== undefined &&
+      event.kind === kind &&
+      event.source === source &&
+      event.cycle === this.bus.getCycleCount();
+  }
+
+  private finishIfExhausted(): void {
+    if (this.mode === 'replaying' && this.cursor >= this.log.length) {
+      this.mode = 'off';
+    }
+  }
+}
+
+/**
+ * Serial port decorator that records received bytes, or replays them in
+ * place of the host port
+ */
+export class RecordingSerialPort implements SerialPort {
+  constructor(
+    private recorder: InputRecorder,
+    private port: SerialPort,
+    private source: string
+  ) {}
+
+  write(data: number): void {
+    this.port.write(data);
+  }
+
+  read(): number | null {
+    if (this.recorder.isReplaying()) {
+      return this.recorder.takeSerialInput(this.source);
+    }
+
+    const data = this.port.read();
+    if (data !== null) {
+      this.recorder.recordInput('serial', this.source, data);
+    }
+    return data;
+  }
+
+  hasData(): boolean {
+    if (this.recorder.isReplaying()) {
+      return this.recorder.peekSerialInput(this.source);
+    }
+    return this.port.hasData();
+  }
+
+  isReady(): boolean {
+    return this.port.isReady();
+  }
+
+  setBaudRate(rate: number): void {
+    this.port.setBaudRate(rate);
+  }
+
+  close(): void {
+    this.port.close();
+  }
+
+  getPort(): SerialPort {
+    return this.port;
+  }
+}
+
+/**
+ * Host-call backend decorator that records the clock readings, file reads
+ * and file write outcomes the host returns, or replays them in place of
+ * the host. Output and file writes still happen while replaying, as serial
+ * output does.
+ */
+export class RecordingHostCallBackend implements HostCallBackend {
+  constructor(
+    private recorder: InputRecorder,
+    private backend: HostCallBackend,
+    private source: string
+  ) {}
+
+  output(text: string): void {
+    this.backend.output(text);
+  }
+
+  readFile(name: string, length: number): HostFileRead {
+    if (this.recorder.isReplaying()) {
+      const event = this.recorder.takeInput('file', this.source);
+      if (event) {
+        return { status: event.value ?? HostCallStatus.IO_ERROR, data: event.data || new Uint8Array(0) };
+      }
+    }
+    const read = this.backend.readFile(name, length);
+    this.recorder.recordInput('file', this.source, read.status, read.data);
+    return read;
+  }
+
+  writeFile(name: string, data: Uint8Array, append: boolean): HostCallStatus {
+    const status = this.backend.writeFile(name, data, append);
+    if (this.recorder.isReplaying()) {
+      const event = this.recorder.takeInput('file', this.source);
+      return event ? event.value ?? status : status;
+    }
+    this.recorder.recordInput('file', this.source, status);
+    return status;
+  }
+
+  wallClock(): number {
+    if (this.recorder.isReplaying()) {
+      const event = this.recorder.takeInput('clock', this.source);
+      if (event) {
+        return event.value ?? 0;
+      }
+    }
+    const seconds = this.backend.wallClock();
+    this.recorder.recordInput('clock', this.source, seconds);
+    return seconds;
+  }
+}
@@ -1,6 +1,9 @@
 import { CPU6502, CPUState } from '../core/cpu';
 import { MemoryManager } from '../core/memory';
 import { InterruptController } from '../core/interrupt-controller';
+import { ExecutionHistory } from './history';
+import { InputRecorder } from './input-recorder';
+import { InputEventKind } from './input-log';
 
 export interface TraceEntry {
   address: number;
@@ -47,6 +50,10 @@ export interface DebugInspector {
   triggerNMI(): void;
   clearIRQ(): void;
   
+  // Reverse execution
+  reverseStep(count?: number): boolean; // Returns true if the position moved
+  reverseContinue(): boolean; // Returns true if a breakpoint was found
+  
   // State inspection
   getCPUState(): CPUState;
   isRunning(): boolean;
@@ -66,6 +73,8 @@ export class DebugInspectorImpl implements DebugInspector {
     averageCyclesPerSecond: 0
   };
   private startTime = 0;
+  private history: ExecutionHistory | null = null;
+  private inputRecorder: InputRecorder | null = null;
 
   constructor(
     private cpu: CPU6502,
@@ -94,6 +103,18 @@ export class DebugInspectorImpl implements DebugInspector {
     return Array.from(this.breakpoints);
   }
 
+  setExecutionHistory(history: ExecutionHistory | null): void {
+    this.history = history;
+  }
+
+  getExecutionHistory(): ExecutionHistory | null {
+    return this.history;
+  }
+
+  setInputRecorder(recorder: InputRecorder | null): void {
+    this.inputRecorder = recorder;
+  }
+
   step(): boolean {
     const state = this.cpu.getRegisters();
     const pc = state.PC;
@@ -104,8 +125,10 @@ export class DebugInspectorImpl implements DebugInspector {
       this.recordTraceEntry(pc, opcode, state);
     }
     
-    // Execute one instruction
-    const cycles = this.cpu.step();
+    // Execute one instruction, through the history when it is recording
+    const cycles = this.history && this.history.isEnabled()
+      ? this.history.step()
+      : this.cpu.step();
     
     // Update statistics
     this.stats.totalCycles += cycles;
@@ -191,17 +214,36 @@ export class DebugInspectorImpl implements DebugInspector {
   }
 
   triggerIRQ(): void {
+    this.recordInput('irq');
     this.interruptController.triggerIRQ('debug');
   }
 
   triggerNMI(): void {
+    this.recordInput('nmi');
     this.interruptController.triggerNMI('debug');
   }
 
   clearIRQ(): void {
+    this.recordInput('clear-irq');
     this.interruptController.clearIRQ('debug');
   }
 
+  reverseStep(count: number = 1): boolean {
+    if (!this.history || !this.history.isEnabled()) {
+      return false;
+    }
+    return this.history.reverseStep(count);
+  }
+
+  reverseContinue(): boolean {
+    if (!this.history || !this.history.isEnabled()) {
+      return false;
+    }
+    return this.history.reverseContinue(
+      address => this.breakpoints.has(address) || this.cpu.hasBreakpoint(address)
+    );
+  }
+
   getCPUState(): CPUState {
     return this.cpu.getRegisters();
   }
@@ -214,6 +256,11 @@ export class DebugInspectorImpl implements DebugInspector {
     return this.cpu.getRegisters().PC;
   }
 
+  private recordInput(kind: InputEventKind): void {
+    this.history?.recordInput(kind, 'debug');
+    this.inputRecorder?.recordInput(kind, 'debug');
+  }
+
   private recordTraceEntry(address: number, opcode: number, registers: CPUState): void {
     const instruction = this.disassembleInstruction(address, opcode);
     
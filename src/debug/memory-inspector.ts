@@ -1,4 +1,5 @@
 import { MemoryManager } from '../core/memory';
+import { MemoryView } from './memory-view';
 
 export interface MemoryInspector {
   readRange(startAddr: number, length: number): Uint8Array;
@@ -12,11 +13,15 @@ export class MemoryInspectorImpl implements MemoryInspector {
   constructor(private memoryManager: MemoryManager) {}
 
   readRange(startAddr: number, length: number): Uint8Array {
-    const data = new Uint8Array(length);
-    for (let i = 0; i < length; i++) {
-      data[i] = this.memoryManager.read(startAddr + i);
-    }
-    return data;
+    return this.memoryManager.readRange(startAddr, length);
+  }
+
+  /**
+   * Live, read-only view of RAM and ROM; its descriptor can be posted to
+   * other threads (see MemoryView)
+   */
+  createMemoryView(): MemoryView {
+    return new MemoryView(this.memoryManager.getSharedMemory());
   }
 
   writeRange(startAddr: number, data: Uint8Array): void {
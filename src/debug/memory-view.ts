@@ -0,0 +1,120 @@
+/**
+ * Read-only view of machine memory from any thread
+ * Built from MemoryManager.getSharedMemory(); the descriptor can be posted to
+ * a worker thread and the view reads the emulator's live RAM and ROM without
+ * copies or calls into the emulation thread. Peripheral registers are not
+ * visible. Writes through the returned arrays would reach the machine, so
+ * callers must treat them as read-only.
+ */
+
+import { SharedMemoryDescriptor, SharedMemoryRegion, RAM_PAGE_SIZE } from '../core/memory';
+
+interface ViewRegion {
+  type: 'RAM' | 'ROM';
+  start: number;
+  end: number;
+  data: Uint8Array;
+  versions: Uint32Array | null;
+  seen: Uint32Array | null;      // Versions at the previous getChangedPages()
+}
+
+export class MemoryView {
+  private regions: ViewRegion[];
+
+  constructor(descriptor: SharedMemoryDescriptor) {
+    // ROM takes priority over RAM, as in MemoryManager
+    this.regions = descriptor.regions
+      .map((region: SharedMemoryRegion) => {
+        const versions = region.versions ? new Uint32Array(region.versions) : null;
+        return {
+          type: region.type,
+          start: region.start,
+          end: region.end,
+          data: new Uint8Array(region.buffer, 0, region.end - region.start + 1),
+          versions,
+          seen: versions ? versions.slice(0, versions.length - 1) : null
+        };
+      })
+      .sort((a, b) => (a.type === b.type ? 0 : a.type === 'ROM' ? -1 : 1));
+  }
+
+  /**
+   * Read one byte; unmapped addresses read as 0xFF and peripheral registers
+   * are not visible
+   */
+  read(address: number): number {
+    const region = this.findRegion(address & 0xFFFF);
+    return region ? region.data[(address & 0xFFFF) - region.start] : 0xFF;
+  }
+
+  /**
+   * Read a block of memory
+   * Blocks inside a single region are returned as a live view of the
+   * machine's memory; other blocks are assembled into a copy.
+   */
+  readRange(startAddress: number, length: number): Uint8Array {
+    const first = this.findRegion(startAddress);
+    const lastAddress = startAddress + length - 1;
+    if (first && length > 0 && lastAddress <= first.end && this.findRegion(lastAddress) === first &&
+        !this.overlapsHigherPriority(first, startAddress, lastAddress)) {
+      return first.data.subarray(startAddress - first.start, startAddress - first.start + length);
+    }
+
+    const data = new Uint8Array(length);
+    for (let i = 0; i < length; i++) {
+      data[i] = this.read(startAddress + i);
+    }
+    return data;
+  }
+
+  /**
+   * Pages (absolute page numbers) written since the previous call, or
+   * since the view was created
+   */
+  getChangedPages(): number[] {
+    const changed: number[] = [];
+    for (const region of this.regions) {
+      if (!region.versions || !region.seen) {
+        continue;
+      }
+      for (let page = 0; page < region.seen.length; page++) {
+        const version = Atomics.load(region.versions, page);
+        if (version !== region.seen[page]) {
+          region.seen[page] = version;
+          changed.push((region.start + page * RAM_PAGE_SIZE) >> 8);
+        }
+      }
+    }
+    return changed.sort((a, b) => a - b);
+  }
+
+  /**
+   * True once the machine has replaced the memory this view was built on
+   * (its RAM was forked or reconfigured); request a new descriptor then
+   */
+  isStale(): boolean {
+    return this.regions.some(region =>
+      region.versions !== null && Atomics.load(region.versions, region.versions.length - 1) !== 0);
+  }
+
+  private findRegion(address: number): ViewRegion | null {
+    for (const region of this.regions) {
+      if (address >= region.start && address <= region.end) {
+        return region;
+      }
+    }
+    return null;
+  }
+
+  private overlapsHigherPriority(region: ViewRegion, start: number, end: number): boolean {
+    for (const other of this.regions) {
+      if (other === region) {
+        return false;
+      }
+      if (other.start <= end && other.end >= start) {
+        return true;
+      }
+    }
+    return false;
+  }
+}
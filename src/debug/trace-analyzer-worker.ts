@@ -0,0 +1,15 @@
+/**
+ * Worker thread entry point for analyzeTraceFile
+ * Analyzes one range of blocks and posts the stats back.
+ */
+
+import { parentPort, workerData } from 'worker_threads';
+import { analyzeTraceRange } from './trace-analyzer';
+
+if (parentPort) {
+  const { file, first, count } = workerData;
+  const stats = analyzeTraceRange(file, first, count);
+  const transfer = [stats.pcCounts, stats.pcCycles, stats.opcodes, stats.leaders, stats.reads, stats.writes]
+    .map(array => array.buffer as ArrayBuffer);
+  parentPort.postMessage(stats, transfer);
+}
@@ -0,0 +1,757 @@
+/**
+ * Offline analysis of binary execution trace files
+ * A trace is split into ranges of blocks that are analyzed independently,
+ * on worker threads for large files, and the partial results merged in
+ * file order. Each partial result keeps the records at its edges and its
+ * unfinished interrupt handlers, so loops, basic blocks and handlers that
+ * straddle a range boundary are counted as if the file had been read in
+ * one pass.
+ *
+ * Memory accesses come from the addressing mode, the operands and the
+ * registers before each instruction. Indirect modes need memory contents
+ * that the trace does not hold and are only counted as unresolved.
+ * Interrupt timing is measured from the records: the time from entry to
+ * the matching RTI, and the interval between entries.
+ */
+
+import * as os from 'os';
+import * as path from 'path';
+import { Worker } from 'worker_threads';
+import { ADDRESSING_MODE, INSTRUCTION_LENGTH, OPERATION } from '../core/fallback-core';
+import { TRACE_INSTRUCTION, TraceRecord } from './trace-buffer';
+import { TraceBlock, TraceBlockDecoder, TraceFileReader } from './trace-file';
+
+export const HISTOGRAM_BUCKETS = 32;  // Powers of two of cycles
+
+// Per-opcode classification from the core tables
+const CONTROL = new Uint8Array(256);  // Ends a basic block
+const BACKWARD = new Uint8Array(256); // Can close a loop: branches and JMP
+const ACCESS = new Uint8Array(256);   // 1 read, 2 write, 3 read-modify-write
+const RESOLVED = new Uint8Array(256); // Effective address computable from the record
+const INDIRECT = new Uint8Array(256);
+const RTI = 0x40;
+const BRK = 0x00;
+
+for (let opcode = 0; opcode < 256; opcode++) {
+  const mode = ADDRESSING_MODE[opcode];
+  const op = OPERATION[opcode];
+  if (mode === 'rel' || ['jmp', 'jsr', 'rts', 'rti', 'brk'].includes(op)) {
+    CONTROL[opcode] = 1;
+    BACKWARD[opcode] = mode === 'rel' || op === 'jmp' ? 1 : 0;
+    continue;
+  }
+  if (['zp', 'zpx', 'zpy', 'abso', 'absx', 'absy', 'indx', 'indy'].includes(mode)) {
+    ACCESS[opcode] = ['sta', 'stx', 'sty', 'sax'].includes(op) ? 2
+      : ['asl', 'lsr', 'rol', 'ror', 'inc', 'dec', 'slo', 'rla', 'sre', 'rra', 'dcp', 'isb'].includes(op) ? 3 : 1;
+    RESOLVED[opcode] = mode === 'indx' || mode === 'indy' ? 0 : 1;
+    INDIRECT[opcode] = RESOLVED[opcode] ? 0 : 1;
+  }
+}
+
+/**
+ * Cycle counts bucketed by powers of two: bucket n holds values below 2^n
+ */
+export interface CycleHistogram {
+  buckets: Float64Array;
+  count: number;
+  total: number;
+  min: number;
+  max: number;
+}
+
+interface EdgeRecord {
+  cycle: number;
+  pc: number;
+  opcode: number;
+  length: number;
+  cycles: number;
+  kind: number;
+}
+
+interface InterruptEntry {
+  cycle: number;
+  sp: number;         // SP before entry
+  software: boolean;  // BRK, not timed
+}
+
+interface InterruptReturn {
+  end: number;        // Cycle after the RTI
+  sp: number;         // SP before the RTI
+}
+
+/**
+ * Mergeable analysis of a range of trace records
+ */
+export interface TraceStats {
+  records: number;
+  instructions: number;
+  interrupts: number;
+  lost: number;                 // Records lost inside the range
+  firstCycle: number;
+  endCycle: number;             // Cycle after the last record
+  pcCounts: Float64Array;       // Executions per instruction address
+  pcCycles: Float64Array;
+  opcodes: Uint8Array;          // Last opcode seen per address
+  leaders: Uint8Array;          // 1 where a basic block starts
+  loops: Map<number, number>;   // from << 16 | to -> backward transfers taken
+  reads: Float64Array;          // Per address, from resolved operands
+  writes: Float64Array;
+  unresolved: number;           // Indirect accesses
+  service: CycleHistogram;      // Interrupt entry to the end of its RTI
+  intervals: CycleHistogram;    // Between interrupt entries
+
+  // Range edges, for merging
+  head: EdgeRecord | null;
+  headLinked: boolean;          // The record before head is known to precede it directly
+  tail: EdgeRecord | null;
+  broken: boolean;              // Records were lost after head
+  open: InterruptEntry[];       // Handlers still running at the end
+  returns: InterruptReturn[];   // RTIs for handlers entered before the range
+  firstEntry: number;           // Cycle of the first interrupt entry, -1 if none or after a loss
+  lastEntry: number;
+}
+
+export interface TraceHotLoop {
+  from: number;                 // Address of the backward branch or JMP
+  to: number;                   // Loop start
+  iterations: number;
+  cycles: number;               // Cycles at addresses inside the loop
+}
+
+export interface TraceBasicBlock {
+  address: number;
+  end: number;                  // Address of the last instruction
+  instructions: number;
+  executions: number;
+  cycles: number;
+}
+
+export interface TraceMemoryHotspot {
+  address: number;
+  reads: number;
+  writes: number;
+}
+
+export interface TraceReport {
+  records: number;
+  instructions: number;
+  interrupts: number;
+  lost: number;
+  cycles: number;
+  loops: TraceHotLoop[];
+  blocks: TraceBasicBlock[];
+  pages: Array<{ page: number; reads: number; writes: number }>;  // All 256 pages
+  hotAddresses: TraceMemoryHotspot[];
+  unresolvedAccesses: number;
+  service: CycleHistogram;
+  intervals: CycleHistogram;
+}
+
+export interface TraceAnalysisOptions {
+  workers?: number;             // Threads (default: available parallelism; 0 analyzes in-process)
+  chunks?: number;              // Ranges to split the file into (default: one per worker)
+}
+
+export interface TraceDivergence {
+  index: number;                // Record index, counting lost records
+  fields: string[];             // Fields that differ; ['end'] when one trace ends first
+  a: TraceRecord | null;
+  b: TraceRecord | null;
+  context: TraceRecord[];       // Records of the first trace before the divergence
+}
+
+function createHistogram(): CycleHistogram {
+  return { buckets: new Float64Array(HISTOGRAM_BUCKETS), count: 0, total: 0, min: Infinity, max: 0 };
+}
+
+function addSample(histogram: CycleHistogram, cycles: number): void {
+  const bucket = Math.min(HISTOGRAM_BUCKETS - 1, cycles <= 0 ? 0 : Math.floor(Math.log2(cycles)) + 1);
+  histogram.buckets[bucket]++;
+  histogram.count++;
+  histogram.total += cycles;
+  histogram.min = Math.min(histogram.min, cycles);
+  histogram.max = Math.max(histogram.max, cycles);
+}
+
+function mergeHistogram(into: CycleHistogram, from: CycleHistogram): void {
+  for (let i = 0; i < HISTOGRAM_BUCKETS; i++) {
+    into.buckets[i] += from.buckets[i];
+  }
+  into.count += from.count;
+  into.total += from.total;
+  into.min = Math.min(into.min, from.min);
+  into.max = Math.max(into.max, from.max);
+}
+
+/**
+ * Upper bound of the bucket holding the given fraction of samples
+ */
+export function histogramPercentile(histogram: CycleHistogram, fraction: number): number {
+  const target = histogram.count * fraction;
+  let seen = 0;
+  for (let i = 0; i < HISTOGRAM_BUCKETS; i++) {
+    seen += histogram.buckets[i];
+    if (seen >= target && seen > 0) {
+      return Math.min(histogram.max, i === 0 ? 0 : 2 ** i - 1);
+    }
+  }
+  return histogram.max;
+}
+
+export function createTraceStats(): TraceStats {
+  return {
+    records: 0,
+    instructions: 0,
+    interrupts: 0,
+    lost: 0,
+    firstCycle: 0,
+    endCycle: 0,
+    pcCounts: new Float64Array(0x10000),
+    pcCycles: new Float64Array(0x10000),
+    opcodes: new Uint8Array(0x10000),
+    leaders: new Uint8Array(0x10000),
+    loops: new Map(),
+    reads: new Float64Array(0x10000),
+    writes: new Float64Array(0x10000),
+    unresolved: 0,
+    service: createHistogram(),
+    intervals: createHistogram(),
+    head: null,
+    headLinked: true,
+    tail: null,
+    broken: false,
+    open: [],
+    returns: [],
+    firstEntry: -1,
+    lastEntry: -1
+  };
+}
+
+function createEdge(): EdgeRecord {
+  return { cycle: 0, pc: 0, opcode: 0, length: 0, cycles: 0, kind: 0 };
+}
+
+/**
+ * Whether a record is a block leader, given the record before it: the
+ * target of a jump, the instruction after a branch, or a handler entry
+ * point. The point an RTI resumes at is not, so interrupts do not split
+ * the blocks they land in.
+ */
+function isLeader(previous: EdgeRecord, pc: number, kind: number): boolean {
+  if (kind !== TRACE_INSTRUCTION) {
+    return false;
+  }
+  if (previous.kind !== TRACE_INSTRUCTION) {
+    return true;
+  }
+  if (previous.opcode === RTI) {
+    return false;
+  }
+  return CONTROL[previous.opcode] === 1 || pc !== ((previous.pc + previous.length) & 0xFFFF);
+}
+
+function countLoop(stats: TraceStats, previous: EdgeRecord, pc: number): void {
+  if (previous.kind === TRACE_INSTRUCTION && BACKWARD[previous.opcode] && pc <= previous.pc &&
+      pc !== ((previous.pc + previous.length) & 0xFFFF)) {
+    const key = previous.pc * 0x10000 + pc;
+    stats.loops.set(key, (stats.loops.get(key) || 0) + 1);
+  }
+}
+
+/**
+ * Match an RTI with the innermost open handler entered at SP + 3
+ * @returns False when no open handler matches
+ */
+function closeHandler(stats: TraceStats, sp: number, end: number): boolean {
+  for (let i = stats.open.length - 1; i >= 0; i--) {
+    const entry = stats.open[i];
+    if (((entry.sp - 3) & 0xFF) === sp) {
+      stats.open.length = i;
+      if (!entry.software) {
+        addSample(stats.service, end - entry.cycle);
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+/**
+ * Analyze the records of consecutive blocks into stats
+ */
+export function analyzeBlocks(stats: TraceStats, blocks: Iterable<TraceBlock>): TraceStats {
+  const decoder = new TraceBlockDecoder();
+  const { pcCounts, pcCycles, opcodes, leaders, reads, writes } = stats;
+  let previous: EdgeRecord | null = stats.tail ? { ...stats.tail } : null;
+  let spare = createEdge();  // Reused so records allocate nothing
+
+  for (const block of blocks) {
+    if (block.lost > 0) {
+      // Unknown records in between: start afresh
+      if (stats.head === null) {
+        stats.headLinked = false;
+      } else {
+        stats.broken = true;
+      }
+      stats.lost += block.lost;
+      previous = null;
+      stats.open = [];
+      stats.lastEntry = -1;
+    }
+
+    decoder.load(block);
+    while (decoder.next()) {
+      const pc = decoder.pc;
+      const kind = decoder.kind;
+      const opcode = decoder.opcode;
+      const cycle = decoder.cycle;
+      stats.records++;
+
+      if (previous !== null) {
+        if (isLeader(previous, pc, kind)) {
+          leaders[pc] = 1;
+        }
+        countLoop(stats, previous, pc);
+      } else if (stats.head !== null && kind === TRACE_INSTRUCTION) {
+        leaders[pc] = 1;  // After lost records
+      }
+
+      if (kind === TRACE_INSTRUCTION) {
+        stats.instructions++;
+        pcCounts[pc]++;
+        pcCycles[pc] += decoder.cycles;
+        opcodes[pc] = opcode;
+
+        const access = ACCESS[opcode];
+        if (access !== 0) {
+          if (RESOLVED[opcode]) {
+            const mode = ADDRESSING_MODE[opcode];
+            let address = decoder.length === 3 ? decoder.operand1 | (decoder.operand2 << 8) : decoder.operand1;
+            if (mode === 'zpx' || mode === 'absx') address += decoder.x;
+            if (mode === 'zpy' || mode === 'absy') address += decoder.y;
+            address &= decoder.length === 3 ? 0xFFFF : 0xFF;
+            if (access & 1) reads[address]++;
+            if (access & 2) writes[address]++;
+          } else if (INDIRECT[opcode]) {
+            stats.unresolved++;
+          }
+        }
+
+        if (opcode === BRK) {
+          stats.open.push({ cycle, sp: decoder.sp, software: true });
+        } else if (opcode === RTI) {
+          const end = cycle + decoder.cycles;
+          if (!closeHandler(stats, decoder.sp, end) && stats.open.length === 0 && !stats.broken) {
+            stats.returns.push({ end, sp: decoder.sp });
+          }
+        }
+      } else {
+        stats.interrupts++;
+        if (stats.lastEntry >= 0) {
+          addSample(stats.intervals, cycle - stats.lastEntry);
+        } else if (stats.firstEntry < 0 && !stats.broken) {
+          stats.firstEntry = cycle;
+        }
+        stats.lastEntry = cycle;
+        stats.open.push({ cycle, sp: decoder.sp, software: false });
+      }
+
+      const edge = spare;
+      spare = previous !== null ? previous : createEdge();
+      edge.cycle = cycle;
+      edge.pc = pc;
+      edge.opcode = opcode;
+      edge.length = decoder.length;
+      edge.cycles = decoder.cycles;
+      edge.kind = kind;
+      if (stats.head === null) {
+        stats.head = { ...edge };
+        stats.firstCycle = cycle;
+      }
+      previous = edge;
+      stats.endCycle = cycle + decoder.cycles;
+    }
+  }
+
+  stats.tail = previous ? { ...previous } : stats.tail;
+  return stats;
+}
+
+/**
+ * Append the stats of the range that follows into the first
+ */
+export function mergeTraceStats(left: TraceStats, right: TraceStats): TraceStats {
+  if (right.head === null) {
+    return left;
+  }
+  if (left.head === null) {
+    return right;
+  }
+
+  const arrays: Array<keyof TraceStats> = ['pcCounts', 'pcCycles', 'reads', 'writes'];
+  for (const name of arrays) {
+    const into = left[name] as Float64Array;
+    const from = right[name] as Float64Array;
+    for (let i = 0; i < 0x10000; i++) {
+      into[i] += from[i];
+    }
+  }
+  for (let i = 0; i < 0x10000; i++) {
+    if (right.pcCounts[i] > 0) {
+      left.opcodes[i] = right.opcodes[i];
+    }
+    left.leaders[i] |= right.leaders[i];
+  }
+  right.loops.forEach((count, key) => left.loops.set(key, (left.loops.get(key) || 0) + count));
+  mergeHistogram(left.service, right.service);
+  mergeHistogram(left.intervals, right.intervals);
+  left.records += right.records;
+  left.instructions += right.instructions;
+  left.interrupts += right.interrupts;
+  left.lost += right.lost;
+  left.unresolved += right.unresolved;
+  left.endCycle = right.endCycle;
+
+  const head = right.head;
+  if (!right.headLinked) {
+    // Records were lost between the ranges
+    if (head.kind === TRACE_INSTRUCTION) {
+      left.leaders[head.pc] = 1;
+    }
+    left.broken = true;
+    left.open = right.open;
+    left.lastEntry = right.lastEntry;
+    left.tail = right.tail;
+    return left;
+  }
+
+  // The transition across the boundary, counted by neither range
+  const tail = left.tail!;
+  if (isLeader(tail, head.pc, head.kind)) {
+    left.leaders[head.pc] = 1;
+  }
+  countLoop(left, tail, head.pc);
+  if (left.lastEntry >= 0 && right.firstEntry >= 0) {
+    addSample(left.intervals, right.firstEntry - left.lastEntry);
+  }
+
+  // Handlers entered on the left that return on the right
+  for (const rti of right.returns) {
+    if (!closeHandler(left, rti.sp, rti.end) && left.open.length === 0 && !left.broken) {
+      left.returns.push(rti);
+    }
+  }
+  if (left.firstEntry < 0 && !left.broken) {
+    left.firstEntry = right.firstEntry;
+  }
+
+  if (right.broken) {
+    left.broken = true;
+    left.open = right.open;
+  } else {
+    left.open = left.open.concat(right.open);
+  }
+  left.lastEntry = right.lastEntry >= 0 ? right.lastEntry : (right.broken ? -1 : left.lastEntry);
+  left.tail = right.tail;
+  return left;
+}
+
+/**
+ * Analyze the blocks of a file from first, count blocks long
+ */
+export function analyzeTraceRange(file: string, first: Pick<TraceBlock, 'offset' | 'first'> | null, count: number): TraceStats {
+  const reader = new TraceFileReader(file);
+  try {
+    if (first) {
+      reader.seek(first);
+    }
+    const blocks = function* (): Generator<TraceBlock> {
+      for (let i = 0; i < count; i++) {
+        const block = reader.nextBlock();
+        if (!block) {
+          return;
+        }
+        yield block;
+      }
+    };
+    return analyzeBlocks(createTraceStats(), blocks());
+  } finally {
+    reader.close();
+  }
+}
+
+function runWorker(file: string, first: TraceBlock, count: number): Promise<TraceStats> {
+  const script = path.join(__dirname, `trace-analyzer-worker${path.extname(__filename)}`);
+  const workerData = { file, first: { offset: first.offset, first: first.first }, count };
+  const worker = script.endsWith('.ts')
+    // Running from source (ts-node, jest): compile the worker on the fly
+    ? new Worker(`require('ts-node').register({ transpileOnly: true }); require(${JSON.stringify(script)});`,
+        { eval: true, workerData })
+    : new Worker(script, { workerData });
+
+  return new Promise((resolve, reject) => {
+    worker.once('message', (stats: TraceStats) => resolve(stats));
+    worker.once('error', reject);
+    worker.once('exit', code => {
+      if (code !== 0) {
+        reject(new Error(`Trace analyzer worker exited with code ${code}`));
+      }
+    });
+  });
+}
+
+/**
+ * Analyze a whole trace file
+ * The blocks are split into ranges of roughly equal size in bytes, one per
+ * chunk, which run on worker threads when workers > 0.
+ */
+export async function analyzeTraceFile(file: string, options: TraceAnalysisOptions = {}): Promise<TraceStats> {
+  const reader = new TraceFileReader(file);
+  let blocks: TraceBlock[];
+  try {
+    blocks = reader.scan();
+  } finally {
+    reader.close();
+  }
+
+  const workers = options.workers !== undefined ? options.workers : os.availableParallelism();
+  const chunks = Math.max(1, Math.min(blocks.length, options.chunks || Math.max(1, workers)));
+  const bytes = blocks.length > 0 ? reader.size - blocks[0].offset : 0;
+  const ranges: Array<{ start: number; count: number }> = [];
+  let start = 0;
+  for (let chunk = 0; chunk < chunks && start < blocks.length; chunk++) {
+    // Split at the first block past an equal share of the bytes
+    let end = start + 1;
+    const limit = blocks[0].offset + (bytes * (chunk + 1)) / chunks;
+    while (end < blocks.length && (blocks[end].offset < limit || chunk === chunks - 1)) {
+      end++;
+    }
+    ranges.push({ start, count: end - start });
+    start = end;
+  }
+
+  const results = workers > 0 && ranges.length > 1
+    ? await Promise.all(ranges.map(range => runWorker(file, blocks[range.start], range.count)))
+    : ranges.map(range => analyzeTraceRange(file, blocks[range.start], range.count));
+
+  const merged = results.reduce((into, stats) => mergeTraceStats(into, stats), createTraceStats());
+  if (merged.head !== null && merged.head.kind === TRACE_INSTRUCTION) {
+    merged.leaders[merged.head.pc] = 1;
+  }
+  return merged;
+}
+
+/**
+ * Rank the analysis for display
+ * @param limit Entries per list
+ */
+export function getTraceReport(stats: TraceStats, limit: number = 20): TraceReport {
+  const cyclesIn = (first: number, last: number): number => {
+    let total = 0;
+    for (let address = first; address <= last; address++) {
+      total += stats.pcCycles[address];
+    }
+    return total;
+  };
+
+  const loops: TraceHotLoop[] = [];
+  stats.loops.forEach((iterations, key) => {
+    const from = Math.floor(key / 0x10000);
+    const to = key % 0x10000;
+    loops.push({ from, to, iterations, cycles: cyclesIn(to, from) });
+  });
+  loops.sort((a, b) => b.cycles - a.cycles || b.iterations - a.iterations || a.to - b.to);
+
+  // A block runs from its leader to the first control transfer or the next leader
+  const blocks: TraceBasicBlock[] = [];
+  for (let address = 0; address < 0x10000; address++) {
+    const executions = stats.pcCounts[address];
+    if (!stats.leaders[address] || executions === 0) {
+      continue;
+    }
+    let end = address;
+    let instructions = 1;
+    let cycles = stats.pcCycles[address];
+    while (CONTROL[stats.opcodes[end]] === 0) {
+      const next = end + INSTRUCTION_LENGTH[stats.opcodes[end]];
+      if (next > 0xFFFF || stats.pcCounts[next] === 0 || stats.leaders[next]) {
+        break;
+      }
+      end = next;
+      instructions++;
+      cycles += stats.pcCycles[end];
+    }
+    blocks.push({ address, end, instructions, executions, cycles });
+  }
+  blocks.sort((a, b) => b.cycles - a.cycles || b.executions - a.executions || a.address - b.address);
+
+  const pages: TraceReport['pages'] = [];
+  const addresses: TraceMemoryHotspot[] = [];
+  for (let page = 0; page < 256; page++) {
+    let pageReads = 0;
+    let pageWrites = 0;
+    for (let address = page * 256; address < page * 256 + 256; address++) {
+      pageReads += stats.reads[address];
+      pageWrites += stats.writes[address];
+      if (stats.reads[address] + stats.writes[address] > 0) {
+        addresses.push({ address, reads: stats.reads[address], writes: stats.writes[address] });
+      }
+    }
+    pages.push({ page, reads: pageReads, writes: pageWrites });
+  }
+  addresses.sort((a, b) => (b.reads + b.writes) - (a.reads + a.writes) || a.address - b.address);
+
+  return {
+    records: stats.records,
+    instructions: stats.instructions,
+    interrupts: stats.interrupts,
+    lost: stats.lost,
+    cycles: stats.endCycle - stats.firstCycle,
+    loops: loops.slice(0, limit),
+    blocks: blocks.slice(0, limit),
+    pages,
+    hotAddresses: addresses.slice(0, limit),
+    unresolvedAccesses: stats.unresolved,
+    service: stats.service,
+    intervals: stats.intervals
+  };
+}
+
+const RECORD_FIELDS: Array<keyof TraceBlockDecoder> = ['cycle', 'pc', 'kind', 'opcode', 'operand1', 'operand2', 'a', 'x', 'y', 'p', 'sp', 'cycles'];
+
+/**
+ * Records of a file in order, with the index of each counting lost records
+ */
+class TraceCursor {
+  readonly decoder = new TraceBlockDecoder();
+  index = -1;
+  private remaining = 0;
+  private pending: TraceBlock | null = null;
+
+  constructor(readonly reader: TraceFileReader) {}
+
+  /**
+   * Next block when the cursor sits at the end of one, without consuming it
+   */
+  peekBlock(): TraceBlock | null {
+    if (this.remaining > 0) {
+      return null;
+    }
+    if (!this.pending) {
+      this.pending = this.reader.nextBlock();
+    }
+    return this.pending;
+  }
+
+  skipBlock(): void {
+    const block = this.peekBlock()!;
+    this.pending = null;
+    this.index = block.first + block.count - 1;
+  }
+
+  next(): boolean {
+    if (this.remaining === 0) {
+      const block = this.peekBlock();
+      this.pending = null;
+      if (!block) {
+        return false;
+      }
+      this.remaining = block.count;
+      this.index = block.first - 1;
+      this.decoder.load(block);
+    }
+    this.decoder.next();
+    this.remaining--;
+    this.index++;
+    return true;
+  }
+}
+
+/**
+ * First record where two traces differ
+ * Blocks that line up and hold the same bytes are compared without
+ * decoding, so traces written with the same keyframe interval are
+ * compared at close to the speed of reading them.
+ * @param context Records of the first trace to include before the divergence
+ * @returns null when the traces are identical
+ */
+export function findTraceDivergence(fileA: string, fileB: string, context: number = 8): TraceDivergence | null {
+  const readerA = new TraceFileReader(fileA);
+  const readerB = new TraceFileReader(fileB);
+  try {
+    const a = new TraceCursor(readerA);
+    const b = new TraceCursor(readerB);
+    for (;;) {
+      const blockA = a.peekBlock();
+      const blockB = b.peekBlock();
+      if (blockA && blockB && blockA.first === blockB.first && blockA.count === blockB.count &&
+          blockA.payload.equals(blockB.payload)) {
+        a.skipBlock();
+        b.skipBlock();
+        continue;
+      }
+
+      const hasA = a.next();
+      const hasB = b.next();
+      if (!hasA && !hasB) {
+        return null;
+      }
+
+      let fields: string[];
+      if (!hasA || !hasB) {
+        fields = ['end'];
+      } else if (a.index !== b.index) {
+        fields = ['index'];
+      } else {
+        fields = RECORD_FIELDS.filter(field => a.decoder[field] !== b.decoder[field]);
+        if (fields.length === 0) {
+          continue;
+        }
+      }
+
+      const index = hasA ? a.index : b.index;
+      return {
+        index,
+        fields: fields.map(field => (field === 'operand1' || field === 'operand2' ? 'operands' : field))
+          .filter((field, i, all) => all.indexOf(field) === i),
+        a: hasA ? a.decoder.toRecord() : null,
+        b: hasB ? b.decoder.toRecord() : null,
+        context: readContext(fileA, index, context)
+      };
+    }
+  } finally {
+    readerA.close();
+    readerB.close();
+  }
+}
+
+function readContext(file: string, index: number, count: number): TraceRecord[] {
+  const reader = new TraceFileReader(file);
+  try {
+    const blocks = reader.scan();
+    const start = Math.max(0, index - count);
+    let first = 0;
+    while (first + 1 < blocks.length && blocks[first + 1].first <= start) {
+      first++;
+    }
+
+    const records: TraceRecord[] = [];
+    if (blocks.length === 0) {
+      return records;
+    }
+    reader.seek(blocks[first]);
+    const decoder = new TraceBlockDecoder();
+    let block: TraceBlock | null;
+    while ((block = reader.nextBlock()) !== null && block.first < index) {
+      decoder.load(block);
+      for (let i = block.first; decoder.next() && i < index; i++) {
+        if (i >= start) {
+          records.push(decoder.toRecord());
+        }
+      }
+    }
+    return records;
+  } finally {
+    reader.close();
+  }
+}
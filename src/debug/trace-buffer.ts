@@ -0,0 +1,210 @@
+/**
+ * Execution trace ring buffer
+ * Fixed-size records written by the CPU core on every step, in native code
+ * when the addon is loaded (see cpu_trace_t in native/fake6502.h for the
+ * layout) and by CPU6502Emulator otherwise. The oldest records are
+ * overwritten once the ring is full, so capture costs the same on a
+ * production-length run as on a short one.
+ */
+
+import { INSTRUCTION_LENGTH, REG_A, REG_X, REG_Y, REG_P, REG_SP } from '../core/fallback-core';
+
+export const TRACE_RECORD_SIZE = 24;
+export const TRACE_MAX_FILTERS = 8;
+
+export const TRACE_INSTRUCTION = 0;
+export const TRACE_IRQ = 1;
+export const TRACE_NMI = 2;
+
+export interface TraceRecord {
+  cycle: number;        // Cycle clock before the step
+  pc: number;
+  opcode: number;
+  operands: number[];
+  a: number;            // Registers before the step
+  x: number;
+  y: number;
+  p: number;
+  sp: number;
+  cycles: number;       // Cycles the step took
+  kind: 'instruction' | 'irq' | 'nmi';
+}
+
+export interface TraceFilter {
+  first: number;        // Inclusive PC range
+  last: number;
+}
+
+const KINDS: TraceRecord['kind'][] = ['instruction', 'irq', 'nmi'];
+
+export class ExecutionTraceBuffer {
+  readonly capacity: number;
+  readonly records: Uint8Array;
+  readonly counters = new BigUint64Array(2);  // Records written, cycle clock
+  readonly filters = new Uint16Array(TRACE_MAX_FILTERS * 2);
+  readonly filterCount: number;
+  private view: DataView;
+
+  // Registers captured before a step on the TypeScript core, in record order
+  private pending = new Uint8Array(5);
+  private pendingPc = 0;
+
+  /**
+   * @param capacity Records kept
+   * @param startCycle Cycle clock at the first step traced
+   * @param filters PC ranges to record; everything when empty
+   */
+  constructor(capacity: number = 65536, startCycle: number = 0, filters: TraceFilter[] = []) {
+    if (!Number.isInteger(capacity) || capacity <= 0) {
+      throw new Error(`Invalid trace capacity: ${capacity}`);
+    }
+    if (filters.length > TRACE_MAX_FILTERS) {
+      throw new Error(`At most ${TRACE_MAX_FILTERS} trace filters are supported`);
+    }
+    this.capacity = capacity;
+    this.records = new Uint8Array(capacity * TRACE_RECORD_SIZE);
+    this.view = new DataView(this.records.buffer);
+    this.counters[1] = BigInt(startCycle);
+    filters.forEach((filter, i) => {
+      this.filters[i * 2] = filter.first & 0xFFFF;
+      this.filters[i * 2 + 1] = filter.last & 0xFFFF;
+    });
+    this.filterCount = filters.length;
+  }
+
+  /**
+   * Records written since tracing started, including overwritten ones
+   */
+  getWritten(): number {
+    return Number(this.counters[0]);
+  }
+
+  getCycle(): number {
+    return Number(this.counters[1]);
+  }
+
+  /**
+   * Index of the oldest record still in the ring
+   */
+  getOldest(): number {
+    return Math.max(0, this.getWritten() - this.capacity);
+  }
+
+  /**
+   * Byte offset of a record by its index, which must still be in the ring
+   */
+  offsetOf(index: number): number {
+    return (index % this.capacity) * TRACE_RECORD_SIZE;
+  }
+
+  decode(index: number): TraceRecord {
+    return decodeTraceRecord(this.records, this.offsetOf(index));
+  }
+
+  /**
+   * The most recent records, oldest first
+   */
+  getRecords(limit: number = this.capacity): TraceRecord[] {
+    const written = this.getWritten();
+    const records: TraceRecord[] = [];
+    for (let index = Math.max(this.getOldest(), written - limit); index < written; index++) {
+      records.push(this.decode(index));
+    }
+    return records;
+  }
+
+  /**
+   * Capture the registers before a step of the TypeScript core
+   */
+  begin(pc: number, registers: Uint8Array): void {
+    this.pendingPc = pc;
+    this.pending[0] = registers[REG_A];
+    this.pending[1] = registers[REG_X];
+    this.pending[2] = registers[REG_Y];
+    this.pending[3] = registers[REG_P];
+    this.pending[4] = registers[REG_SP];
+  }
+
+  /**
+   * Record the step begun last, as the native core does
+   * @param kind TRACE_INSTRUCTION, or TRACE_IRQ/TRACE_NMI for interrupt entry
+   * @param read Memory read for the operands, done after execution
+   */
+  end(kind: number, opcode: number, cycles: number, read: (address: number) => number): void {
+    if (this.wanted(this.pendingPc)) {
+      const record = this.records;
+      const offset = this.offsetOf(this.getWritten());
+      const clock = this.counters[1];
+      this.counters[0]++;
+
+      record.fill(0, offset, offset + TRACE_RECORD_SIZE);
+      this.view.setBigUint64(offset, clock, true);
+      record[offset + 8] = this.pendingPc & 0xFF;
+      record[offset + 9] = this.pendingPc >> 8;
+      record.set(this.pending, offset + 13);
+      record[offset + 18] = cycles;
+      record[offset + 19] = kind;
+      if (kind === TRACE_INSTRUCTION) {
+        const length = INSTRUCTION_LENGTH[opcode];
+        record[offset + 10] = opcode;
+        for (let i = 1; i < length; i++) {
+          record[offset + 10 + i] = read((this.pendingPc + i) & 0xFFFF);
+        }
+        record[offset + 20] = length;
+      }
+    }
+    this.counters[1] += BigInt(cycles);
+  }
+
+  /**
+   * Account for a step that is not recorded, such as a masked IRQ
+   */
+  skip(cycles: number): void {
+    this.counters[1] += BigInt(cycles);
+  }
+
+  private wanted(pc: number): boolean {
+    if (this.filterCount === 0) {
+      return true;
+    }
+    for (let i = 0; i < this.filterCount; i++) {
+      if (pc >= this.filters[i * 2] && pc <= this.filters[i * 2 + 1]) {
+        return true;
+      }
+    }
+    return false;
+  }
+}
+
+/**
+ * Decode the record at offset in a buffer of native trace records
+ */
+export function decodeTraceRecord(bytes: Uint8Array, offset: number): TraceRecord {
+  const view = new DataView(bytes.buffer, bytes.byteOffset);
+  const length = bytes[offset + 20];
+  return {
+    cycle: Number(view.getBigUint64(offset, true)),
+    pc: view.getUint16(offset + 8, true),
+    opcode: bytes[offset + 10],
+    operands: Array.from(bytes.subarray(offset + 11, offset + 10 + Math.max(1, length))),
+    a: bytes[offset + 13],
+    x: bytes[offset + 14],
+    y: bytes[offset + 15],
+    p: bytes[offset + 16],
+    sp: bytes[offset + 17],
+    cycles: bytes[offset + 18],
+    kind: KINDS[bytes[offset + 19]] || 'instruction'
+  };
+}
+
+/**
+ * One line per record in the style of common 6502 trace logs
+ */
+export function formatTraceRecord(record: TraceRecord): string {
+  const hex = (value: number, digits: number = 2) => value.toString(16).toUpperCase().padStart(digits, '0');
+  const bytes = record.kind === 'instruction'
+    ? [record.opcode, ...record.operands].map(b => hex(b)).join(' ')
+    : record.kind.toUpperCase();
+  return `${hex(record.pc, 4)}  ${bytes.padEnd(8)}  A:${hex(record.a)} X:${hex(record.x)} Y:${hex(record.y)} ` +
+    `P:${hex(record.p)} SP:${hex(record.sp)} CYC:${record.cycle}`;
+}
@@ -0,0 +1,414 @@
+/**
+ * Binary execution trace files
+ * Trace records are delta-encoded against the record before them and cut
+ * into blocks that each start with a keyframe, a full record, so a reader
+ * can seek through a long trace block by block.
+ *
+ *   header  "6502TRC" 0, u32 version, u32 clock Hz
+ *   block   u32 payload bytes, u32 records, u32 records lost before the block,
+ *           keyframe (a ring record, see trace-buffer.ts), then deltas
+ *   delta   tag, [pc u16] [a] [x] [y] [p] [sp] [cycle gap varint] [kind],
+ *           opcode, cycles | length << 4, operands
+ *
+ * Tag bits say which optional fields follow: the PC when it is not the
+ * previous PC plus the previous length, registers that changed, cycles
+ * skipped since the previous record ended (filtered-out code) and the
+ * record kind when it is not an instruction. All values are little-endian.
+ */
+
+import fs from 'fs';
+import { ExecutionTraceBuffer, TraceRecord, TRACE_RECORD_SIZE } from './trace-buffer';
+
+export const TRACE_FILE_MAGIC = '6502TRC\0';
+export const TRACE_FILE_VERSION = 1;
+
+const HEADER_SIZE = 16;
+const BLOCK_HEADER_SIZE = 12;
+const MAX_DELTA_SIZE = 23;
+
+const TAG_PC = 0x01;
+const TAG_A = 0x02;
+const TAG_X = 0x04;
+const TAG_Y = 0x08;
+const TAG_P = 0x10;
+const TAG_SP = 0x20;
+const TAG_GAP = 0x40;
+const TAG_KIND = 0x80;
+
+const KINDS: TraceRecord['kind'][] = ['instruction', 'irq', 'nmi'];
+
+export interface TraceFileSummary {
+  clockHz: number;
+  records: number;
+  lost: number;         // Records overwritten in the ring before they were written out
+  blocks: number;
+}
+
+export class TraceFileWriter {
+  private fd: number;
+  private block: Buffer;
+  private length = BLOCK_HEADER_SIZE;
+  private count = 0;
+  private lost = 0;     // Lost before the current block
+  private previous = new Uint8Array(TRACE_RECORD_SIZE);
+  private previousView = new DataView(this.previous.buffer);
+
+  /**
+   * @param keyframeInterval Records per block
+   */
+  constructor(path: string, clockHz: number, private keyframeInterval: number = 4096) {
+    if (!Number.isInteger(keyframeInterval) || keyframeInterval <= 0) {
+      throw new Error(`Invalid keyframe interval: ${keyframeInterval}`);
+    }
+    this.block = Buffer.alloc(BLOCK_HEADER_SIZE + TRACE_RECORD_SIZE + keyframeInterval * MAX_DELTA_SIZE);
+    this.fd = fs.openSync(path, 'w');
+
+    const header = Buffer.alloc(HEADER_SIZE);
+    header.write(TRACE_FILE_MAGIC, 0, 'latin1');
+    header.writeUInt32LE(TRACE_FILE_VERSION, 8);
+    header.writeUInt32LE(clockHz >>> 0, 12);
+    fs.writeSync(this.fd, header);
+  }
+
+  /**
+   * Write the records added to a trace ring since index from
+   * @returns Index to continue from
+   */
+  drain(trace: ExecutionTraceBuffer, from: number): number {
+    const written = trace.getWritten();
+    const oldest = trace.getOldest();
+    if (from < oldest) {
+      this.markLost(oldest - from);
+      from = oldest;
+    }
+    for (let index = from; index < written; index++) {
+      this.writeRecord(trace.records, trace.offsetOf(index));
+    }
+    return written;
+  }
+
+  /**
+   * Note records that could not be written; the next record is a keyframe
+   */
+  markLost(count: number): void {
+    this.flush();
+    this.lost += count;
+  }
+
+  /**
+   * Append one record in the ring layout
+   */
+  writeRecord(bytes: Uint8Array, offset: number): void {
+    if (this.count === this.keyframeInterval) {
+      this.flush();
+    }
+
+    const block = this.block;
+    if (this.count === 0) {
+      block.set(bytes.subarray(offset, offset + TRACE_RECORD_SIZE), this.length);
+      this.length += TRACE_RECORD_SIZE;
+    } else {
+      this.writeDelta(bytes, offset);
+    }
+    this.previous.set(bytes.subarray(offset, offset + TRACE_RECORD_SIZE));
+    this.count++;
+  }
+
+  close(): void {
+    this.flush();
+    fs.closeSync(this.fd);
+  }
+
+  private writeDelta(bytes: Uint8Array, offset: number): void {
+    const previous = this.previous;
+    const view = new DataView(bytes.buffer, bytes.byteOffset);
+    const block = this.block;
+    const tagAt = this.length++;
+    let tag = 0;
+
+    const pc = bytes[offset + 8] | (bytes[offset + 9] << 8);
+    const expectedPc = ((previous[8] | (previous[9] << 8)) + previous[20]) & 0xFFFF;
+    if (pc !== expectedPc) {
+      tag |= TAG_PC;
+      block[this.length++] = bytes[offset + 8];
+      block[this.length++] = bytes[offset + 9];
+    }
+    const registerTags = [TAG_A, TAG_X, TAG_Y, TAG_P, TAG_SP];
+    for (let i = 0; i < 5; i++) {
+      if (bytes[offset + 13 + i] !== previous[13 + i]) {
+        tag |= registerTags[i];
+        block[this.length++] = bytes[offset + 13 + i];
+      }
+    }
+    const gap = Number(view.getBigUint64(offset, true) - this.previousView.getBigUint64(0, true)) - previous[18];
+    if (gap !== 0) {
+      tag |= TAG_GAP;
+      this.varint(gap);
+    }
+    if (bytes[offset + 19] !== 0) {
+      tag |= TAG_KIND;
+      block[this.length++] = bytes[offset + 19];
+    }
+
+    const length = bytes[offset + 20];
+    block[this.length++] = bytes[offset + 10];
+    block[this.length++] = bytes[offset + 18] | (length << 4);
+    for (let i = 1; i < length; i++) {
+      block[this.length++] = bytes[offset + 10 + i];
+    }
+    block[tagAt] = tag;
+  }
+
+  private varint(value: number): void {
+    while (value >= 0x80) {
+      this.block[this.length++] = (value % 0x80) | 0x80;
+      value = Math.floor(value / 0x80);
+    }
+    this.block[this.length++] = value;
+  }
+
+  private flush(): void {
+    if (this.count === 0) {
+      return;
+    }
+    this.block.writeUInt32LE(this.length - BLOCK_HEADER_SIZE, 0);
+    this.block.writeUInt32LE(this.count, 4);
+    this.block.writeUInt32LE(this.lost, 8);
+    fs.writeSync(this.fd, this.block, 0, this.length);
+    this.length = BLOCK_HEADER_SIZE;
+    this.count = 0;
+    this.lost = 0;
+  }
+}
+
+/**
+ * Block of a trace file as stored
+ */
+export interface TraceBlock {
+  offset: number;       // File position of the block header
+  first: number;        // Index of the keyframe, counting lost records
+  count: number;
+  lost: number;         // Records lost before the block
+  payload: Buffer;      // Empty when only the headers were scanned
+}
+
+/**
+ * Sequential or random access to the blocks of a trace file
+ * Blocks decode independently, so ranges of them can be handed to
+ * different readers.
+ */
+export class TraceFileReader {
+  readonly clockHz: number;
+  readonly size: number;
+  private fd: number;
+  private position = HEADER_SIZE;
+  private first = 0;
+  private header = Buffer.alloc(BLOCK_HEADER_SIZE);
+
+  constructor(private path: string) {
+    this.fd = fs.openSync(path, 'r');
+    try {
+      const header = Buffer.alloc(HEADER_SIZE);
+      if (fs.readSync(this.fd, header, 0, HEADER_SIZE, 0) !== HEADER_SIZE ||
+          header.toString('latin1', 0, 8) !== TRACE_FILE_MAGIC) {
+        throw new Error(`Not a trace file: ${path}`);
+      }
+      if (header.readUInt32LE(8) !== TRACE_FILE_VERSION) {
+        throw new Error(`Unsupported trace file version ${header.readUInt32LE(8)}`);
+      }
+      this.clockHz = header.readUInt32LE(12);
+      this.size = fs.fstatSync(this.fd).size;
+    } catch (error) {
+      fs.closeSync(this.fd);
+      throw error;
+    }
+  }
+
+  /**
+   * Every block header, without reading the payloads
+   */
+  scan(): TraceBlock[] {
+    const blocks: TraceBlock[] = [];
+    this.seek({ offset: HEADER_SIZE, first: 0 });
+    let block: TraceBlock | null;
+    while ((block = this.nextBlock(false)) !== null) {
+      blocks.push(block);
+    }
+    this.seek({ offset: HEADER_SIZE, first: 0 });
+    return blocks;
+  }
+
+  /**
+   * Continue reading at a block returned by scan()
+   */
+  seek(block: Pick<TraceBlock, 'offset' | 'first'>): void {
+    this.position = block.offset;
+    this.first = block.first;
+  }
+
+  /**
+   * @param payload False to skip over the payload
+   * @returns Next block, or null at the end of the file
+   */
+  nextBlock(payload: boolean = true): TraceBlock | null {
+    if (fs.readSync(this.fd, this.header, 0, BLOCK_HEADER_SIZE, this.position) !== BLOCK_HEADER_SIZE) {
+      return null;
+    }
+    const length = this.header.readUInt32LE(0);
+    const count = this.header.readUInt32LE(4);
+    const lost = this.header.readUInt32LE(8);
+    if (this.position + BLOCK_HEADER_SIZE + length > this.size) {
+      throw new Error(`Truncated trace file: ${this.path}`);
+    }
+
+    const block: TraceBlock = {
+      offset: this.position,
+      first: this.first + lost,
+      count,
+      lost,
+      payload: Buffer.alloc(payload ? length : 0)
+    };
+    if (payload) {
+      fs.readSync(this.fd, block.payload, 0, length, this.position + BLOCK_HEADER_SIZE);
+    }
+    this.position += BLOCK_HEADER_SIZE + length;
+    this.first = block.first + count;
+    return block;
+  }
+
+  close(): void {
+    fs.closeSync(this.fd);
+  }
+}
+
+/**
+ * Decodes the records of a block into its own fields, one at a time,
+ * without allocating
+ */
+export class TraceBlockDecoder {
+  cycle = 0;
+  pc = 0;
+  opcode = 0;
+  operand1 = 0;
+  operand2 = 0;
+  length = 0;           // Instruction bytes; 0 for interrupt entry
+  a = 0;
+  x = 0;
+  y = 0;
+  p = 0;
+  sp = 0;
+  cycles = 0;
+  kind = 0;             // TRACE_INSTRUCTION, TRACE_IRQ or TRACE_NMI
+  private payload: Buffer = Buffer.alloc(0);
+  private offset = 0;
+  private remaining = 0;
+
+  load(block: TraceBlock): void {
+    this.payload = block.payload;
+    this.offset = 0;
+    this.remaining = block.count;
+  }
+
+  /**
+   * Advance to the next record
+   * @returns False once the block is exhausted
+   */
+  next(): boolean {
+    if (this.remaining === 0) {
+      return false;
+    }
+    const payload = this.payload;
+    let offset = this.offset;
+
+    if (offset === 0) {
+      const view = new DataView(payload.buffer, payload.byteOffset);
+      this.cycle = Number(view.getBigUint64(0, true));
+      this.pc = payload[8] | (payload[9] << 8);
+      this.opcode = payload[10];
+      this.operand1 = payload[11];
+      this.operand2 = payload[12];
+      this.a = payload[13];
+      this.x = payload[14];
+      this.y = payload[15];
+      this.p = payload[16];
+      this.sp = payload[17];
+      this.cycles = payload[18];
+      this.kind = payload[19];
+      this.length = payload[20];
+      offset = TRACE_RECORD_SIZE;
+    } else {
+      const tag = payload[offset++];
+      this.cycle += this.cycles;
+      this.pc = (this.pc + this.length) & 0xFFFF;
+      if (tag & TAG_PC) {
+        this.pc = payload[offset] | (payload[offset + 1] << 8);
+        offset += 2;
+      }
+      if (tag & TAG_A) this.a = payload[offset++];
+      if (tag & TAG_X) this.x = payload[offset++];
+      if (tag & TAG_Y) this.y = payload[offset++];
+      if (tag & TAG_P) this.p = payload[offset++];
+      if (tag & TAG_SP) this.sp = payload[offset++];
+      if (tag & TAG_GAP) {
+        let scale = 1;
+        while (payload[offset] & 0x80) {
+          this.cycle += (payload[offset++] & 0x7F) * scale;
+          scale *= 128;
+        }
+        this.cycle += payload[offset++] * scale;
+      }
+      this.kind = tag & TAG_KIND ? payload[offset++] : 0;
+      this.opcode = payload[offset++];
+      const info = payload[offset++];
+      this.cycles = info & 0x0F;
+      this.length = info >> 4;
+      this.operand1 = this.length > 1 ? payload[offset++] : 0;
+      this.operand2 = this.length > 2 ? payload[offset++] : 0;
+    }
+
+    this.offset = offset;
+    this.remaining--;
+    return true;
+  }
+
+  toRecord(): TraceRecord {
+    return {
+      cycle: this.cycle,
+      pc: this.pc,
+      opcode: this.opcode,
+      operands: [this.operand1, this.operand2].slice(0, Math.max(0, this.length - 1)),
+      a: this.a,
+      x: this.x,
+      y: this.y,
+      p: this.p,
+      sp: this.sp,
+      cycles: this.cycles,
+      kind: KINDS[this.kind] || 'instruction'
+    };
+  }
+}
+
+/**
+ * Read a trace file block by block
+ * @param callback Called for every record in order
+ */
+export function readTraceFile(path: string, callback: (record: TraceRecord) => void): TraceFileSummary {
+  const reader = new TraceFileReader(path);
+  const decoder = new TraceBlockDecoder();
+  const summary: TraceFileSummary = { clockHz: reader.clockHz, records: 0, lost: 0, blocks: 0 };
+  try {
+    let block: TraceBlock | null;
+    while ((block = reader.nextBlock()) !== null) {
+      summary.lost += block.lost;
+      summary.records += block.count;
+      summary.blocks++;
+      decoder.load(block);
+      while (decoder.next()) {
+        callback(decoder.toRecord());
+      }
+    }
+    return summary;
+  } finally {
+    reader.close();
+  }
+}
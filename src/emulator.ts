@@ -4,15 +4,28 @@
  */
 
 import { SystemBus } from './core/bus';
+import { CPUProfile, isNativeAvailable } from './core/cpu';
 import { SystemConfig, SystemConfigLoader } from './config/system';
 import { MemoryInspectorImpl } from './debug/memory-inspector';
 import { DebugInspectorImpl } from './debug/inspector';
+import { ExecutionHistory, ExecutionHistoryOptions } from './debug/history';
+import { InputRecorder } from './debug/input-recorder';
+import { InputLog } from './debug/input-log';
+import { ExecutionTraceBuffer, TraceFilter } from './debug/trace-buffer';
+import { TraceFileWriter } from './debug/trace-file';
+import { CoverageReport, buildCoverageReport } from './debug/coverage';
 import { ACIA68B50 } from './peripherals/acia';
 import { VIA65C22Implementation } from './peripherals/via';
+import { HOST_CALL_REGISTERS, HostCallDevice } from './peripherals/host-call';
+import { SerialPort, MemorySerialPort } from './peripherals/serial-port';
 import { CC65SymbolParser } from './cc65/symbol-parser';
 import { CC65MemoryConfigurator } from './cc65/memory-layout';
-import { EmulatorProfiler } from './performance/profiler';
+import { CC65LineRange } from './cc65/debug-info';
+import { CPURuntimeHooks, RuntimeHookOptions, RuntimeHookStats, getRuntimeHookStats, resolveRuntimeHooks } from './cc65/runtime-hooks';
+import { CallGraphReport, EmulatorProfiler, getCallGraphReport } from './performance/profiler';
 import { EmulatorOptimizer, ExecutionSpeedController } from './performance/optimizer';
+import { Pacer, PacerOptions, PacingStats } from './performance/pacer';
+import { createTraceEvents, encodePprof, TraceEventFile } from './performance/profile-export';
 
 /**
  * Execution state of the emulator
@@ -25,6 +38,19 @@ export enum EmulatorState {
   ERROR = 'error'
 }
 
+/**
+ * Where continuous execution runs: chunks scheduled on the Node.js event
+ * loop, or the native core on its own worker thread
+ */
+export type ExecutionMode = 'event-loop' | 'native-thread';
+
+/**
+ * How emulated time relates to host time: paced to the wall clock, or
+ * virtual, where execution runs unpaced and statistics are kept in
+ * emulated time so they do not depend on host load
+ */
+export type ClockMode = 'real-time' | 'virtual';
+
 /**
  * Execution statistics
  */
@@ -36,15 +62,29 @@ export interface ExecutionStats {
   clockSpeed: number; // Actual clock speed in Hz
 }
 
+/**
+ * Execution trace capture, see enableExecutionTrace
+ */
+export interface ExecutionTraceOptions {
+  capacity?: number;          // Records kept in the ring (default 65536)
+  filters?: TraceFilter[];    // PC ranges to record; everything when empty
+  file?: string;              // Binary trace file the ring is drained into
+  keyframeInterval?: number;  // Records per file block (default 4096)
+}
+
 /**
  * Main emulator class that coordinates all components
  */
 export class Emulator {
+  private static readonly UNTHROTTLED_SLICE_MS = 20; // Wall time per chunk when not pacing
+
   private systemBus: SystemBus;
   private config: SystemConfig;
   private state: EmulatorState = EmulatorState.STOPPED;
   private memoryInspector: MemoryInspectorImpl;
   private debugInspector: DebugInspectorImpl;
+  private history: ExecutionHistory;
+  private inputRecorder: InputRecorder;
   private symbolParser?: CC65SymbolParser;
   private memoryLayout?: any; // Will be a layout object from CC65MemoryConfigurator
   
@@ -52,11 +92,20 @@ export class Emulator {
   private profiler: EmulatorProfiler;
   private optimizer: EmulatorOptimizer;
   private speedController: ExecutionSpeedController;
+  private pacer: Pacer;
+  private traceFile?: TraceFileWriter;
+  private traceDrained: number = 0; // Next trace record to write to the file
   
   // Execution control
-  private executionTimer?: NodeJS.Timeout;
+  private executionImmediate?: NodeJS.Immediate;
   private targetClockSpeed: number = 1000000; // 1MHz default
   private cyclesPerTick: number = 1000; // Execute 1000 cycles per timer tick
+  private unthrottled: boolean = false; // Run without pacing (replay at maximum speed)
+  private exitStatus: number | null = null; // From the host-call EXIT service
+  private turbo: boolean = false; // Run at host speed regardless of the target clock
+  private latencyBudgetMs: number = Emulator.UNTHROTTLED_SLICE_MS; // Longest event loop stall when unpaced
+  private executionMode: ExecutionMode = 'event-loop';
+  private clockMode: ClockMode = 'real-time';
   
   // Statistics
   private stats: ExecutionStats = {
@@ -70,7 +119,11 @@ export class Emulator {
   private startTime: number = 0;
   private lastStatsUpdate: number = 0;
 
-  constructor(config?: SystemConfig) {
+  /**
+   * @param config System configuration (defaults when omitted)
+   * @param systemBus Machine to drive instead of a new one (used by fork)
+   */
+  constructor(config?: SystemConfig, systemBus?: SystemBus) {
     this.config = config || SystemConfigLoader.getDefaultConfig();
     
     // Initialize performance components
@@ -78,16 +131,21 @@ export class Emulator {
     this.optimizer = new EmulatorOptimizer();
     this.speedController = this.optimizer.getSpeedController();
     
-    this.systemBus = new SystemBus();
+    this.systemBus = systemBus || new SystemBus();
     this.memoryInspector = new MemoryInspectorImpl(this.systemBus.getMemory());
     this.debugInspector = new DebugInspectorImpl(
       this.systemBus.getCPU(),
       this.systemBus.getMemory(),
       this.systemBus.getInterruptController()
     );
+    this.history = new ExecutionHistory(this.systemBus);
+    this.debugInspector.setExecutionHistory(this.history);
+    this.inputRecorder = new InputRecorder(this.systemBus);
+    this.debugInspector.setInputRecorder(this.inputRecorder);
     
     this.targetClockSpeed = this.config.cpu.clockSpeed;
     this.speedController.setTargetSpeed(this.targetClockSpeed);
+    this.pacer = new Pacer(this.targetClockSpeed);
     this.calculateCyclesPerTick();
   }
 
@@ -191,6 +249,58 @@ export class Emulator {
       
       console.log(`VIA registered at $${this.config.peripherals.via.baseAddress.toString(16).toUpperCase().padStart(4, '0')}-$${(this.config.peripherals.via.baseAddress + 15).toString(16).toUpperCase().padStart(4, '0')}`);
     }
+    
+    // Configure the host-call device if specified
+    const cpu = this.systemBus.getCPU();
+    if (cpu.setBrkTrap) {
+      cpu.setBrkTrap(null);
+    }
+    if (this.config.peripherals.hostCall) {
+      const hostCall = this.config.peripherals.hostCall;
+      const device = new HostCallDevice({ directory: hostCall.directory, clockSpeed: this.config.cpu.clockSpeed });
+      device.setExitHandler(status => this.handleGuestExit(status));
+      this.connectHostCallBackend(device);
+      
+      peripheralHub.registerPeripheral(
+        device,
+        hostCall.baseAddress,
+        hostCall.baseAddress + HOST_CALL_REGISTERS - 1,
+        'HostCall'
+      );
+      
+      if (hostCall.brkSignature !== undefined) {
+        if (!cpu.setBrkTrap) {
+          throw new Error('CPU does not support BRK host calls');
+        }
+        cpu.setBrkTrap({ signature: hostCall.brkSignature, address: hostCall.baseAddress });
+      }
+      
+      console.log(`HostCall registered at $${hostCall.baseAddress.toString(16).toUpperCase().padStart(4, '0')}` +
+        (hostCall.brkSignature !== undefined ? `, BRK signature $${hostCall.brkSignature.toString(16).toUpperCase().padStart(2, '0')}` : ''));
+    }
+  }
+
+  /**
+   * The guest requested EXIT through the host-call device
+   * Execution stops after the current instruction; on the worker thread
+   * the stop waits for the request being serviced to complete.
+   */
+  private handleGuestExit(status: number): void {
+    this.exitStatus = status;
+    console.log(`Guest exited with status ${status}`);
+    if (this.systemBus.getNativeThreadState() !== 'idle') {
+      setImmediate(() => this.stop());
+    } else if (this.state === EmulatorState.RUNNING) {
+      this.stop();
+    }
+  }
+
+  /**
+   * Status the guest passed to the host-call EXIT service since the last
+   * reset, or null
+   */
+  getExitStatus(): number | null {
+    return this.exitStatus;
   }
 
   /**
@@ -199,6 +309,10 @@ export class Emulator {
   reset(): void {
     this.stop();
     this.systemBus.reset();
+    this.history.reset();
+    this.inputRecorder.stop();
+    this.unthrottled = false;
+    this.exitStatus = null;
     this.resetStats();
     
     if (this.config.debugging.breakOnReset) {
@@ -222,7 +336,13 @@ export class Emulator {
     this.startTime = Date.now();
     this.lastStatsUpdate = this.startTime;
     
-    this.scheduleExecution();
+    if (this.shouldUseNativeThread()) {
+      this.startNativeThread();
+    } else {
+      this.pacer.start();
+      this.speedController.startLagMonitor();
+      this.scheduleExecution();
+    }
     console.log('Execution started');
   }
 
@@ -230,15 +350,24 @@ export class Emulator {
    * Stop execution
    */
   stop(): void {
-    if (this.executionTimer) {
-      clearTimeout(this.executionTimer);
-      this.executionTimer = undefined;
+    if (this.executionImmediate) {
+      clearImmediate(this.executionImmediate);
+      this.executionImmediate = undefined;
+    }
+    this.pacer.cancel();
+    this.speedController.stopLagMonitor();
+    if (this.systemBus.getNativeThreadState() !== 'idle') {
+      this.systemBus.stopNativeThread();
     }
     
     if (this.state === EmulatorState.RUNNING) {
       this.updateStats();
+      if (this.turbo) {
+        console.log(`Turbo: ${this.getEffectiveMHz().toFixed(2)} MHz effective`);
+      }
     }
     
+    this.drainExecutionTrace();
     this.state = EmulatorState.STOPPED;
     console.log('Execution stopped');
   }
@@ -247,7 +376,14 @@ export class Emulator {
    * Pause execution
    */
   pause(): void {
-    if (this.state === EmulatorState.RUNNING) {
+    if (this.state === EmulatorState.RUNNING && this.systemBus.getNativeThreadState() === 'running') {
+      // Keep the worker parked rather than stopped so resume is cheap
+      this.systemBus.pauseNativeThread();
+      this.drainExecutionTrace();
+      this.updateStats();
+      this.state = EmulatorState.PAUSED;
+      console.log('Execution paused');
+    } else if (this.state === EmulatorState.RUNNING) {
       this.stop();
       this.state = EmulatorState.PAUSED;
       console.log('Execution paused');
@@ -274,7 +410,7 @@ export class Emulator {
     this.state = EmulatorState.STEPPING;
     
     try {
-      const cycles = this.systemBus.step();
+      const cycles = this.executeInstruction();
       
       // Check if execution was halted due to breakpoint (0 cycles returned)
       if (cycles === 0) {
@@ -295,6 +431,97 @@ export class Emulator {
     }
   }
 
+  /**
+   * Execute one instruction, recording it when reverse execution is enabled
+   */
+  private executeInstruction(): number {
+    if (this.history.isEnabled()) {
+      // The history injects its own log while replaying an earlier timeline
+      if (!this.history.isReplaying()) {
+        this.inputRecorder.deliverInputs();
+      }
+      return this.history.step();
+    }
+
+    this.inputRecorder.deliverInputs();
+    return this.systemBus.step();
+  }
+
+  /**
+   * Select where continuous execution runs
+   * The native worker thread needs the native addon; without it the
+   * emulator stays on the event loop.
+   */
+  setExecutionMode(mode: ExecutionMode): void {
+    if (this.state === EmulatorState.RUNNING) {
+      throw new Error('Cannot change execution mode while running');
+    }
+    if (mode === 'native-thread' && !isNativeAvailable()) {
+      console.warn('Native addon not available, staying on the event loop');
+      return;
+    }
+    if (mode === 'event-loop' && this.systemBus.getNativeThreadState() !== 'idle') {
+      this.systemBus.stopNativeThread();
+    }
+    this.executionMode = mode;
+  }
+
+  getExecutionMode(): ExecutionMode {
+    return this.executionMode;
+  }
+
+  /**
+   * Whether start() should hand execution to the native worker thread
+   * Reverse execution and input recording observe every instruction, so
+   * they keep execution on the event loop.
+   */
+  private shouldUseNativeThread(): boolean {
+    if (this.executionMode !== 'native-thread') {
+      return false;
+    }
+    if (this.history.isEnabled() || this.inputRecorder.getMode() !== 'off') {
+      console.warn('Reverse execution and input recording run on the event loop; not using the worker thread');
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Start or resume the native worker thread
+   */
+  private startNativeThread(): void {
+    if (this.systemBus.getNativeThreadState() === 'paused') {
+      this.systemBus.resumeNativeThread();
+      return;
+    }
+
+    this.systemBus.startNativeThread({
+      sliceCycles: this.cyclesPerTick,
+      clockHz: this.isUnpaced() ? 0 : this.targetClockSpeed
+    }, {
+      onProgress: (cycles, instructions) => {
+        this.stats.totalCycles += cycles;
+        this.stats.instructionsExecuted += instructions;
+        this.drainExecutionTrace();  // The worker waits while this runs
+
+        const now = Date.now();
+        if (now - this.lastStatsUpdate > 1000) {
+          this.updateStats();
+          this.lastStatsUpdate = now;
+        }
+      },
+      onStop: (reason, pc) => {
+        if (reason === 'breakpoint') {
+          console.log(`Breakpoint hit at ${pc.toString(16).toUpperCase().padStart(4, '0')}`);
+        }
+        if (this.state === EmulatorState.RUNNING) {
+          this.updateStats();
+          this.state = EmulatorState.PAUSED;
+        }
+      }
+    });
+  }
+
   /**
    * Schedule the next execution cycle
    */
@@ -303,12 +530,17 @@ export class Emulator {
       return;
     }
     
-    // Calculate timing for accurate clock speed simulation
-    const targetInterval = (this.cyclesPerTick / this.targetClockSpeed) * 1000;
-    
-    this.executionTimer = setTimeout(() => {
-      this.executeChunk();
-    }, Math.max(1, targetInterval));
+    if (this.isUnpaced()) {
+      // One hop through the event loop, without the timer clamp
+      this.executionImmediate = setImmediate(() => {
+        this.executionImmediate = undefined;
+        this.executeChunk();
+      });
+      return;
+    }
+
+    // Wait until host time catches up with the cycles run so far
+    this.pacer.wait(() => this.executeChunk());
   }
 
   /**
@@ -322,11 +554,18 @@ export class Emulator {
     try {
       const chunkStartTime = performance.now();
       let cyclesExecuted = 0;
+      const unpaced = this.isUnpaced();
+      let instructionsExecuted = 0;
       
-      // Execute cycles in chunks for better performance
-      while (cyclesExecuted < this.cyclesPerTick && this.state === EmulatorState.RUNNING) {
+      // Execute cycles in chunks for better performance; unpaced runs use
+      // the whole slice instead of a cycle budget, reading the clock every
+      // 64 instructions since that costs more than an instruction
+      while ((unpaced
+                ? (++instructionsExecuted & 63) !== 0 || performance.now() - chunkStartTime < this.latencyBudgetMs
+                : cyclesExecuted < this.cyclesPerTick) &&
+             this.state === EmulatorState.RUNNING) {
         const stepStartTime = this.profiler.startTiming();
-        const cycles = this.systemBus.step();
+        const cycles = this.executeInstruction();
         this.profiler.endTiming(stepStartTime, 'cpu_step');
         
         // Check if execution was halted due to breakpoint (0 cycles returned)
@@ -345,9 +584,12 @@ export class Emulator {
       // Update speed controller
       const chunkTime = performance.now() - chunkStartTime;
       this.speedController.updateActualSpeed(cyclesExecuted, chunkTime);
-      
-      // Calculate delay for speed control
-      const delay = this.speedController.calculateDelay(cyclesExecuted, chunkTime);
+      this.pacer.advance(cyclesExecuted);
+
+      // Size the next chunk from what this one cost on the host
+      this.speedController.recordChunk(cyclesExecuted, chunkTime);
+      this.calculateCyclesPerTick();
+      this.drainExecutionTrace();
       
       // Update statistics periodically
       const now = Date.now();
@@ -362,8 +604,14 @@ export class Emulator {
         }
       }
       
-      // Schedule next execution with speed control delay
-      setTimeout(() => this.scheduleExecution(), delay);
+      // Pacing resumes once a maximum-speed replay has injected all its inputs
+      if (this.unthrottled && !this.inputRecorder.isReplaying()) {
+        this.unthrottled = false;
+        this.pacer.start();
+        console.log('Input replay complete');
+      }
+
+      this.scheduleExecution();
       
     } catch (error) {
       this.state = EmulatorState.ERROR;
@@ -371,6 +619,13 @@ export class Emulator {
     }
   }
 
+  /**
+   * Whether execution ignores the target clock speed
+   */
+  private isUnpaced(): boolean {
+    return this.unthrottled || this.turbo || this.clockMode === 'virtual';
+  }
+
   /**
    * Calculate cycles per tick based on target clock speed
    */
@@ -382,8 +637,12 @@ export class Emulator {
    * Update execution statistics
    */
   private updateStats(): void {
-    const now = Date.now();
-    this.stats.executionTimeMs = now - this.startTime;
+    if (this.clockMode === 'virtual') {
+      // Everything counted has taken its emulated time, whatever the host did
+      this.stats.executionTimeMs = (this.stats.totalCycles / this.targetClockSpeed) * 1000;
+    } else {
+      this.stats.executionTimeMs = Date.now() - this.startTime;
+    }
     
     if (this.stats.executionTimeMs > 0) {
       this.stats.averageIPS = (this.stats.instructionsExecuted * 1000) / this.stats.executionTimeMs;
@@ -458,6 +717,167 @@ export class Emulator {
     return this.debugInspector;
   }
 
+  getExecutionHistory(): ExecutionHistory {
+    return this.history;
+  }
+
+  /**
+   * Enable/disable reverse execution
+   * Recording starts from the current machine state.
+   */
+  enableReverseExecution(enabled: boolean, options?: Partial<ExecutionHistoryOptions>): void {
+    if (options) {
+      this.history.setOptions(options);
+    }
+    if (enabled) {
+      this.history.enable();
+    } else {
+      this.history.disable();
+    }
+  }
+
+  getInputRecorder(): InputRecorder {
+    return this.inputRecorder;
+  }
+
+  /**
+   * Reset the system and start recording external inputs
+   * The recording is reproducible from the same configuration and images.
+   */
+  startRecording(): void {
+    this.reset();
+    this.inputRecorder.startRecording();
+  }
+
+  /**
+   * Stop recording
+   * @returns The recorded inputs
+   */
+  stopRecording(): InputLog {
+    return this.inputRecorder.stop();
+  }
+
+  /**
+   * Reset the system and inject recorded inputs at their original cycles
+   * @param log Inputs recorded by startRecording()
+   * @param maxSpeed Run without pacing until the last input is injected
+   */
+  startReplay(log: InputLog, maxSpeed: boolean = true): void {
+    this.reset();
+
+    // Serial input is injected through the port, so the ACIA needs one
+    const acia = this.getACIA();
+    if (acia && !acia.getSerialPort()) {
+      this.connectSerialPort(new MemorySerialPort());
+    }
+
+    this.inputRecorder.startReplay(log);
+    this.unthrottled = maxSpeed && this.inputRecorder.isReplaying();
+  }
+
+  /**
+   * Stop injecting recorded inputs; execution continues from live inputs
+   */
+  stopReplay(): void {
+    this.inputRecorder.stop();
+    this.unthrottled = false;
+  }
+
+  /**
+   * Execute synchronously until the bus cycle count reaches the target
+   * @param until Checked after every instruction; execution stops when it
+   *   returns true
+   * @returns false if a breakpoint or the until check stopped execution first
+   */
+  runUntilCycle(targetCycle: number, until?: () => boolean): boolean {
+    while (this.systemBus.getCycleCount() < targetCycle) {
+      const cycles = this.executeInstruction();
+      if (cycles === 0) {
+        this.state = EmulatorState.PAUSED;
+        return false;
+      }
+      this.stats.totalCycles += cycles;
+      this.stats.instructionsExecuted++;
+      if (until && until()) {
+        this.state = EmulatorState.PAUSED;
+        return false;
+      }
+    }
+    return true;
+  }
+
+  /**
+   * Create an independent emulator in the current machine state
+   * Unchanged RAM pages are shared with this instance until either side
+   * writes to them. The fork starts paused, with no serial port connected,
+   * and records history if this instance does.
+   * @returns New emulator
+   */
+  fork(): Emulator {
+    const child = new Emulator(JSON.parse(JSON.stringify(this.config)), this.systemBus.fork());
+    child.symbolParser = this.symbolParser;
+    child.memoryLayout = this.memoryLayout;
+    child.targetClockSpeed = this.targetClockSpeed;
+    child.speedController.setTargetSpeed(this.targetClockSpeed);
+    child.pacer.setClockSpeed(this.targetClockSpeed);
+    child.calculateCyclesPerTick();
+    child.turbo = this.turbo;
+    child.clockMode = this.clockMode;
+    child.latencyBudgetMs = this.latencyBudgetMs;
+    child.stats = { ...this.stats };
+    child.state = EmulatorState.PAUSED;
+    child.exitStatus = this.exitStatus;
+    const hostCall = child.getHostCallDevice();
+    if (hostCall) {
+      hostCall.setExitHandler(status => child.handleGuestExit(status));
+      child.connectHostCallBackend(hostCall);
+    }
+
+    if (this.history.isEnabled()) {
+      child.enableReverseExecution(true, this.history.getOptions());
+    }
+
+    return child;
+  }
+
+  /**
+   * Connect a host serial port to the ACIA
+   * Received bytes are logged so reverse execution can replay them.
+   * @returns false if no ACIA is configured
+   */
+  connectSerialPort(port: SerialPort): boolean {
+    const acia = this.getACIA();
+    if (!acia) {
+      return false;
+    }
+    const recorded = this.inputRecorder.wrapSerialPort(port, 'ACIA');
+    acia.connectSerial(this.history.wrapSerialPort(recorded, 'ACIA'));
+    return true;
+  }
+
+  /**
+   * Route the host-call device's host access through the input recorder
+   * and history, so input replay and reverse execution see the same clock
+   * readings and files, and reverse execution does not repeat output
+   */
+  private connectHostCallBackend(device: HostCallDevice): void {
+    const recorded = this.inputRecorder.wrapHostCallBackend(device.getLocalBackend(), 'HostCall');
+    device.setBackend(this.history.wrapHostCallBackend(recorded, 'HostCall'));
+  }
+
+  private getACIA(): ACIA68B50 | undefined {
+    const registration = this.systemBus.getPeripheralHub().getPeripherals().find(p => p.name === 'ACIA');
+    return registration && registration.peripheral instanceof ACIA68B50 ? registration.peripheral : undefined;
+  }
+
+  /**
+   * Host-call device, when configured; its PUTS output can be redirected
+   */
+  getHostCallDevice(): HostCallDevice | undefined {
+    const registration = this.systemBus.getPeripheralHub().getPeripherals().find(p => p.name === 'HostCall');
+    return registration && registration.peripheral instanceof HostCallDevice ? registration.peripheral : undefined;
+  }
+
   getSymbolParser(): CC65SymbolParser | undefined {
     return this.symbolParser;
   }
@@ -472,18 +892,344 @@ export class Emulator {
   setClockSpeed(speed: number): void {
     this.targetClockSpeed = speed;
     this.speedController.setTargetSpeed(speed);
+    this.pacer.setClockSpeed(speed);
     this.calculateCyclesPerTick();
   }
 
+  /**
+   * Configure real-time pacing on the event loop
+   * Takes effect from the next start().
+   */
+  setPacingOptions(options: PacerOptions): void {
+    if (this.state === EmulatorState.RUNNING) {
+      throw new Error('Cannot change pacing options while running');
+    }
+    this.pacer = new Pacer(this.targetClockSpeed, options);
+  }
+
+  /**
+   * Wake-up error percentiles and measured clock of the current paced run
+   */
+  getPacingStats(): PacingStats {
+    return this.pacer.getStats();
+  }
+
+  /**
+   * Select real-time or virtual clock mode
+   * In virtual mode start() runs unpaced like turbo mode, and execution
+   * time, IPS and clock speed in getStats() are measured in emulated time.
+   */
+  setClockMode(mode: ClockMode): void {
+    if (this.state === EmulatorState.RUNNING) {
+      throw new Error('Cannot change clock mode while running');
+    }
+    this.clockMode = mode;
+  }
+
+  getClockMode(): ClockMode {
+    return this.clockMode;
+  }
+
+  /**
+   * Emulated time since reset in milliseconds, at the current clock speed
+   */
+  getEmulatedTime(): number {
+    return (this.systemBus.getCycleCount() / this.targetClockSpeed) * 1000;
+  }
+
+  /**
+   * Execute for a span of emulated time as fast as the host allows
+   * Runs on the event loop in either clock mode, yielding between slices
+   * of the latency budget so timers and I/O keep running.
+   * @returns false if a breakpoint or stop() ended the run first
+   */
+  async runFor(emulatedMs: number): Promise<boolean> {
+    if (this.state === EmulatorState.RUNNING) {
+      throw new Error('Cannot run for a fixed time while running');
+    }
+
+    const targetCycle = this.systemBus.getCycleCount() + Math.round((emulatedMs * this.targetClockSpeed) / 1000);
+    this.state = EmulatorState.RUNNING;
+    this.startTime = Date.now();
+
+    while (this.state === EmulatorState.RUNNING) {
+      const sliceStartTime = performance.now();
+      let instructionsExecuted = 0;
+      while (this.systemBus.getCycleCount() < targetCycle &&
+             ((++instructionsExecuted & 63) !== 0 || performance.now() - sliceStartTime < this.latencyBudgetMs)) {
+        const stepStartTime = this.profiler.startTiming();
+        const cycles = this.executeInstruction();
+        this.profiler.endTiming(stepStartTime, 'cpu_step');
+
+        if (cycles === 0) {
+          const pc = this.systemBus.getCPU().getRegisters().PC;
+          console.log(`Breakpoint hit at ${pc.toString(16).toUpperCase().padStart(4, '0')}`);
+          this.updateStats();
+          this.state = EmulatorState.PAUSED;
+          return false;
+        }
+
+        this.stats.totalCycles += cycles;
+        this.stats.instructionsExecuted++;
+      }
+
+      this.drainExecutionTrace();
+      if (this.systemBus.getCycleCount() >= targetCycle) {
+        this.updateStats();
+        this.state = EmulatorState.PAUSED;
+        return true;
+      }
+      await new Promise(resolve => setImmediate(resolve));
+    }
+    return false;
+  }
+
+  /**
+   * Run as fast as the host allows, ignoring the target clock speed
+   * On the event loop, chunks run back to back and yield once per latency
+   * budget; on the worker thread the core runs unpaced.
+   * @param latencyBudgetMs Longest the event loop is held by one chunk
+   */
+  setTurboMode(enabled: boolean, latencyBudgetMs?: number): void {
+    if (this.systemBus.getNativeThreadState() !== 'idle') {
+      throw new Error('Cannot change turbo mode while the worker thread is active');
+    }
+    if (latencyBudgetMs !== undefined) {
+      if (!(latencyBudgetMs > 0)) {
+        throw new Error(`Invalid latency budget: ${latencyBudgetMs}`);
+      }
+      this.latencyBudgetMs = latencyBudgetMs;
+    }
+    this.turbo = enabled;
+  }
+
+  isTurboMode(): boolean {
+    return this.turbo;
+  }
+
+  getLatencyBudget(): number {
+    return this.latencyBudgetMs;
+  }
+
+  /**
+   * Clock speed achieved since execution started, in MHz
+   */
+  getEffectiveMHz(): number {
+    if (this.state === EmulatorState.RUNNING) {
+      this.updateStats();
+    }
+    return this.stats.clockSpeed / 1000000;
+  }
+
   /**
    * Enable/disable performance profiling
    */
   enableProfiling(enabled: boolean): void {
+    const interruptController = this.systemBus.getInterruptController();
     if (enabled) {
       this.profiler.enable();
+
+      // Interrupt and peripheral activity for the timeline, in bus cycles
+      interruptController.setTraceCallback((line, source, asserted) => {
+        this.profiler.recordEvent({
+          cycle: this.systemBus.getCycleCount(), kind: 'interrupt', name: line, detail: source,
+          phase: asserted ? 'begin' : 'end'
+        });
+      });
+      this.systemBus.setPeripheralTraceCallback((address, value, write) => {
+        const registration = this.systemBus.getPeripheralHub().getPeripherals()
+          .find(p => address >= p.startAddress && address <= p.endAddress);
+        this.profiler.recordEvent({
+          cycle: this.systemBus.getCycleCount(), kind: 'peripheral', name: registration ? registration.name : 'unknown',
+          detail: write ? 'write' : 'read', phase: 'instant', address, value
+        });
+      });
     } else {
       this.profiler.disable();
+      interruptController.setTraceCallback(undefined);
+      this.systemBus.setPeripheralTraceCallback(undefined);
+    }
+  }
+
+  /**
+   * Count executions and cycles per instruction address in the CPU core
+   * Enabling starts from zero.
+   */
+  enableInstructionProfiling(enabled: boolean): void {
+    const cpu = this.systemBus.getCPU();
+    if (!cpu.setProfiling) {
+      throw new Error('CPU does not support instruction profiling');
+    }
+    cpu.setProfiling(enabled);
+  }
+
+  /**
+   * Live per-PC counters, or null when instruction profiling is off
+   */
+  getInstructionProfile(): CPUProfile | null {
+    const cpu = this.systemBus.getCPU();
+    return cpu.getProfile ? cpu.getProfile() : null;
+  }
+
+  /**
+   * Attribute cycles to subroutines through the core's shadow call stack
+   * Enabling starts from zero with the current code as the root.
+   */
+  enableCallGraphProfiling(enabled: boolean): void {
+    const cpu = this.systemBus.getCPU();
+    if (!cpu.setCallGraph) {
+      throw new Error('CPU does not support call graph profiling');
+    }
+    cpu.setCallGraph(enabled);
+  }
+
+  /**
+   * Cycles per subroutine, named from the loaded symbols, or null when
+   * call graph profiling is off
+   */
+  getCallGraphReport(): CallGraphReport | null {
+    const cpu = this.systemBus.getCPU();
+    const graph = cpu.getCallGraph ? cpu.getCallGraph() : null;
+    return graph ? getCallGraphReport(graph, this.symbolParser) : null;
+  }
+
+  /**
+   * Record every instruction and interrupt entry into a ring buffer in the
+   * CPU core, optionally streamed to a binary trace file
+   * The ring is drained into the file after every chunk and whenever the
+   * worker thread syncs; records overwritten before a drain are counted as
+   * lost in the file. Enabling starts a new trace.
+   */
+  enableExecutionTrace(enabled: boolean, options: ExecutionTraceOptions = {}): void {
+    const cpu = this.systemBus.getCPU();
+    if (!cpu.setTrace) {
+      throw new Error('CPU does not support execution tracing');
     }
+    const trace = enabled
+      ? new ExecutionTraceBuffer(options.capacity, this.systemBus.getCycleCount(), options.filters)
+      : null;
+    const file = enabled && options.file
+      ? new TraceFileWriter(options.file, this.targetClockSpeed, options.keyframeInterval)
+      : undefined;
+
+    try {
+      this.drainExecutionTrace();
+      cpu.setTrace(trace);
+    } catch (error) {
+      if (file) {
+        file.close();
+      }
+      throw error;
+    }
+    if (this.traceFile) {
+      this.traceFile.close();
+    }
+    this.traceFile = file;
+    this.traceDrained = 0;
+  }
+
+  /**
+   * Live trace ring, or null when tracing is off
+   */
+  getExecutionTrace(): ExecutionTraceBuffer | null {
+    const cpu = this.systemBus.getCPU();
+    return cpu.getTrace ? cpu.getTrace() : null;
+  }
+
+  /**
+   * Mark executed instruction addresses and branch outcomes in the CPU core
+   * Enabling starts from an empty map.
+   */
+  enableCoverage(enabled: boolean): void {
+    const cpu = this.systemBus.getCPU();
+    if (!cpu.setCoverage) {
+      throw new Error('CPU does not support code coverage');
+    }
+    cpu.setCoverage(enabled);
+  }
+
+  /**
+   * Live coverage map, or null when coverage is off
+   */
+  getCoverage(): Uint8Array | null {
+    const cpu = this.systemBus.getCPU();
+    return cpu.getCoverage ? cpu.getCoverage() : null;
+  }
+
+  /**
+   * Coverage per source line, for line ranges from cc65 debug info
+   * Branches are decoded from the code currently in memory.
+   */
+  getCoverageReport(ranges: CC65LineRange[]): CoverageReport {
+    const coverage = this.getCoverage();
+    if (!coverage) {
+      throw new Error('Code coverage is not enabled');
+    }
+    const memory = this.systemBus.getMemory();
+    return buildCoverageReport(coverage, ranges, address => memory.read(address));
+  }
+
+  /**
+   * Perform the cc65 runtime routines found in symbols on the host
+   * Symbols default to the loaded ones; returns the routines hooked.
+   */
+  enableRuntimeHooks(options: RuntimeHookOptions = {}, symbols: CC65SymbolParser | undefined = this.symbolParser): RuntimeHookStats[] {
+    const cpu = this.systemBus.getCPU();
+    if (!cpu.setRuntimeHooks) {
+      throw new Error('CPU does not support runtime hooks');
+    }
+    if (!symbols) {
+      throw new Error('Runtime hooks need cc65 symbols');
+    }
+    const hooks = resolveRuntimeHooks(symbols, options);
+    cpu.setRuntimeHooks(hooks);
+    return getRuntimeHookStats(hooks);
+  }
+
+  disableRuntimeHooks(): void {
+    const cpu = this.systemBus.getCPU();
+    if (cpu.setRuntimeHooks) {
+      cpu.setRuntimeHooks(null);
+    }
+  }
+
+  /**
+   * Live runtime hooks, or null when they are off
+   */
+  getRuntimeHooks(): CPURuntimeHooks | null {
+    const cpu = this.systemBus.getCPU();
+    return cpu.getRuntimeHooks ? cpu.getRuntimeHooks() : null;
+  }
+
+  private drainExecutionTrace(): void {
+    const trace = this.traceFile ? this.getExecutionTrace() : null;
+    if (trace) {
+      this.traceDrained = this.traceFile!.drain(trace, this.traceDrained);
+    }
+  }
+
+  /**
+   * Per-PC profile as gzipped pprof, with routines from the loaded symbols
+   * and the call graph when that is on
+   */
+  exportPprof(): Buffer {
+    const profile = this.getInstructionProfile();
+    if (!profile) {
+      throw new Error('Instruction profiling is not enabled');
+    }
+    const cpu = this.systemBus.getCPU();
+    return encodePprof(profile, {
+      clockHz: this.targetClockSpeed,
+      symbols: this.symbolParser,
+      callGraph: (cpu.getCallGraph && cpu.getCallGraph()) || undefined
+    });
+  }
+
+  /**
+   * Interrupt and peripheral timeline as Chrome trace_event JSON
+   */
+  exportTraceEvents(): TraceEventFile {
+    return createTraceEvents(this.profiler.getTimeline(), this.targetClockSpeed);
   }
 
   /**
@@ -0,0 +1,312 @@
+/**
+ * Non-interactive runner for CI
+ * Runs a program from reset at host speed until an exit condition is met
+ * and reports the guest's output, final registers and statistics as JSON.
+ * Used by `6502-emulator run`.
+ */
+
+import fs from 'fs';
+import { Emulator } from './emulator';
+import { ROMImage, SystemConfig, SystemConfigLoader } from './config/system';
+import { CPUState } from './core/cpu';
+import { MemorySerialPort } from './peripherals/serial-port';
+
+const USAGE = `Usage:
+  6502-emulator run [--config <file>] [--rom <file>[@address]]... [--stdin <file>]
+                    [--until-pc <address>]... [--until-write <address>]... [--until-brk]
+                    [--until-output <regex>] [--max-cycles <count>]
+                    [--result <file>] [--output <file>]
+Addresses are hex. ROM formats follow the extension (.hex ihex, .srec/.s19 srec,
+otherwise binary at the given address). The JSON result goes to stdout unless
+--result is given; emulator messages go to stderr.
+Exit code: the guest's host-call EXIT status, 0 when another condition is met,
+124 when the cycle limit is reached first, 2 for usage errors and files that
+cannot be loaded.`;
+
+export const DEFAULT_MAX_CYCLES = 100000000;  // 100 seconds at 1 MHz
+export const TIMEOUT_EXIT_CODE = 124;
+
+export interface HeadlessOptions {
+  config?: SystemConfig;      // Default system configuration when omitted
+  roms?: ROMImage[];          // Loaded after config.memory.romImages
+  serialInput?: Uint8Array;   // Queued on the ACIA before the program starts
+  untilPC?: number[];         // Stop before executing one of these
+  untilWrite?: number[];      // Stop after the instruction that writes one of these
+  untilBrk?: boolean;         // Stop before executing a BRK that is not a host call
+  untilOutput?: RegExp;       // Stop once the output matches
+  maxCycles?: number;         // Bus cycle limit (DEFAULT_MAX_CYCLES)
+}
+
+/**
+ * Why the run ended: the guest's host-call EXIT, one of the until
+ * conditions, or the cycle limit
+ */
+export type HeadlessStopReason = 'exit' | 'pc' | 'write' | 'brk' | 'output' | 'cycles';
+
+export interface HeadlessResult {
+  reason: HeadlessStopReason;
+  address?: number;           // PC, written address or BRK location that stopped the run
+  exitStatus: number | null;  // Host-call EXIT status
+  exitCode: number;
+  output: string;             // ACIA transmissions and host-call PUTS, as Latin-1
+  registers: CPUState;
+  stats: {
+    cycles: number;
+    instructions: number;
+    elapsedMs: number;
+    effectiveMHz: number;
+  };
+}
+
+/**
+ * Serial port that keeps the transmissions as text for pattern matching
+ */
+class HeadlessSerialPort extends MemorySerialPort {
+  constructor(private output: (text: string) => void) {
+    super();
+  }
+
+  write(data: number): void {
+    super.write(data);
+    this.output(String.fromCharCode(data & 0xFF));
+  }
+}
+
+/**
+ * Process exit code for a result
+ */
+export function headlessExitCode(reason: HeadlessStopReason, exitStatus: number | null): number {
+  if (reason === 'exit') {
+    return exitStatus! & 0xFF;
+  }
+  return reason === 'cycles' ? TIMEOUT_EXIT_CODE : 0;
+}
+
+/**
+ * Run a program from reset on a fresh emulator until an exit condition is
+ * met. The guest's host-call EXIT always ends the run.
+ */
+export async function runHeadless(options: HeadlessOptions = {}): Promise<HeadlessResult> {
+  const maxCycles = options.maxCycles ?? DEFAULT_MAX_CYCLES;
+  if (!(maxCycles > 0)) {
+    throw new Error('Headless run needs a positive cycle limit');
+  }
+
+  const config = options.config ? JSON.parse(JSON.stringify(options.config)) : SystemConfigLoader.getDefaultConfig();
+  config.memory.romImages.push(...(options.roms || []));
+  const emulator = new Emulator(config);
+  await emulator.initialize();
+
+  let output = '';
+  let outputChanged = false;
+  const appendOutput = (text: string) => {
+    output += text;
+    outputChanged = true;
+  };
+
+  const port = new HeadlessSerialPort(appendOutput);
+  if (!emulator.connectSerialPort(port) && options.serialInput) {
+    throw new Error('Serial input needs an ACIA');
+  }
+  for (const byte of options.serialInput || []) {
+    port.addReceiveData(byte);
+  }
+  const hostCall = emulator.getHostCallDevice();
+  if (hostCall) {
+    hostCall.setOutput(appendOutput);
+  }
+
+  const bus = emulator.getSystemBus();
+  const cpu = bus.getCPU();
+  const memory = bus.getMemory();
+  let stop: { reason: HeadlessStopReason; address?: number } | null = null;
+
+  for (const address of options.untilPC || []) {
+    cpu.setBreakpoint(address);
+  }
+  bus.setWriteWatch(options.untilWrite || null, address => {
+    stop = stop || { reason: 'write', address };
+  });
+
+  // BRKs followed by the host-call signature are calls, not stops
+  const signature = config.peripherals.hostCall?.brkSignature;
+  const atBrk = (): boolean => {
+    const pc = cpu.getRegisters().PC;
+    if (memory.read(pc) === 0x00 && (signature === undefined || memory.read((pc + 1) & 0xFFFF) !== signature)) {
+      stop = { reason: 'brk', address: pc };
+      return true;
+    }
+    return false;
+  };
+
+  const until = (): boolean => {
+    if (emulator.getExitStatus() !== null) {
+      stop = { reason: 'exit' };
+    } else if (!stop && options.untilOutput && outputChanged) {
+      outputChanged = false;
+      if (options.untilOutput.test(output)) {
+        stop = { reason: 'output' };
+      }
+    }
+    return stop !== null || (options.untilBrk === true && atBrk());
+  };
+
+  const startTime = performance.now();
+  try {
+    if (!(options.untilBrk && atBrk()) && !emulator.runUntilCycle(maxCycles, until) && !stop) {
+      stop = { reason: 'pc', address: cpu.getRegisters().PC };
+    }
+  } finally {
+    bus.setWriteWatch(null);
+    cpu.clearBreakpoints();
+  }
+  const elapsedMs = performance.now() - startTime;
+
+  const { reason, address } = stop || { reason: 'cycles' as HeadlessStopReason, address: undefined };
+  const exitStatus = emulator.getExitStatus();
+  const cycles = bus.getCycleCount();
+  return {
+    reason,
+    address,
+    exitStatus,
+    exitCode: headlessExitCode(reason, exitStatus),
+    output,
+    registers: cpu.getRegisters(),
+    stats: {
+      cycles,
+      instructions: emulator.getStats().instructionsExecuted,
+      elapsedMs,
+      effectiveMHz: elapsedMs > 0 ? cycles / elapsedMs / 1000 : 0
+    }
+  };
+}
+
+interface Arguments {
+  options: HeadlessOptions;
+  configFile?: string;
+  stdinFile?: string;
+  resultFile?: string;
+  outputFile?: string;
+}
+
+function parseAddress(value: string, option: string): number {
+  const address = parseInt(value.replace(/^\$/, ''), 16);
+  if (isNaN(address) || address < 0 || address > 0xFFFF) {
+    throw new Error(`Invalid address for ${option}: ${value}`);
+  }
+  return address;
+}
+
+function parseROM(value: string): ROMImage {
+  const at = value.lastIndexOf('@');
+  const file = at > 0 ? value.slice(0, at) : value;
+  const extension = file.slice(file.lastIndexOf('.')).toLowerCase();
+  const format = extension === '.hex' || extension === '.ihex' ? 'ihex' :
+    extension === '.srec' || extension === '.s19' ? 'srec' : 'binary';
+  if (format === 'binary' && at <= 0) {
+    throw new Error(`Binary ROM needs a load address: ${value}`);
+  }
+  return { file, loadAddress: at > 0 ? parseAddress(value.slice(at + 1), '--rom') : 0, format };
+}
+
+function parseArguments(args: string[]): Arguments {
+  const parsed: Arguments = { options: { roms: [], untilPC: [], untilWrite: [] } };
+  const options = parsed.options;
+  for (let i = 0; i < args.length; i++) {
+    const arg = args[i];
+    if (arg === '--until-brk') {
+      options.untilBrk = true;
+      continue;
+    }
+    const value = args[++i];
+    if (value === undefined) {
+      throw new Error(arg.startsWith('--') ? `Missing value for ${arg}` : `Unexpected argument ${arg}`);
+    }
+    switch (arg) {
+      case '--config':
+        parsed.configFile = value;
+        break;
+      case '--rom':
+        options.roms!.push(parseROM(value));
+        break;
+      case '--stdin':
+        parsed.stdinFile = value;
+        break;
+      case '--until-pc':
+        options.untilPC!.push(parseAddress(value, arg));
+        break;
+      case '--until-write':
+        options.untilWrite!.push(parseAddress(value, arg));
+        break;
+      case '--until-output':
+        options.untilOutput = new RegExp(value);
+        break;
+      case '--max-cycles':
+        options.maxCycles = Number(value);
+        if (!Number.isInteger(options.maxCycles) || options.maxCycles <= 0) {
+          throw new Error(`Invalid value for ${arg}: ${value}`);
+        }
+        break;
+      case '--result':
+        parsed.resultFile = value;
+        break;
+      case '--output':
+        parsed.outputFile = value;
+        break;
+      default:
+        throw new Error(`Unknown option ${arg}`);
+    }
+  }
+  return parsed;
+}
+
+/**
+ * Entry point for `6502-emulator run`
+ * @returns Process exit code
+ */
+export async function main(args: string[]): Promise<number> {
+  if (args.includes('--help')) {
+    console.log(USAGE);
+    return 0;
+  }
+
+  let parsed: Arguments;
+  try {
+    parsed = parseArguments(args);
+  } catch (error) {
+    console.error(error instanceof Error ? error.message : error);
+    console.error(USAGE);
+    return 2;
+  }
+
+  // Keep stdout for the result
+  const log = console.log;
+  console.log = console.error;
+  let result: HeadlessResult;
+  try {
+    const options = parsed.options;
+    if (parsed.configFile) {
+      options.config = SystemConfigLoader.loadFromFile(parsed.configFile);
+    }
+    if (parsed.stdinFile) {
+      options.serialInput = fs.readFileSync(parsed.stdinFile);
+    }
+    result = await runHeadless(options);
+  } catch (error) {
+    console.error(error instanceof Error ? error.message : error);
+    return 2;
+  } finally {
+    console.log = log;
+  }
+
+  if (parsed.outputFile) {
+    fs.writeFileSync(parsed.outputFile, Buffer.from(result.output, 'latin1'));
+  }
+  const json = JSON.stringify(result, null, 2) + '\n';
+  if (parsed.resultFile) {
+    fs.writeFileSync(parsed.resultFile, json);
+  } else {
+    process.stdout.write(json);
+  }
+  return result.exitCode;
+}
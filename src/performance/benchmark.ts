@@ -5,6 +5,8 @@
 
 import { Emulator } from '../emulator';
 import { SystemConfig } from '../config/system';
+import { CPU6502Emulator, isNativeAvailable } from '../core/cpu';
+import { FallbackCore } from '../core/fallback-core';
 
 export interface BenchmarkResult {
   name: string;
@@ -32,6 +34,57 @@ export interface BenchmarkSummary {
   recommendations: string[];
 }
 
+export interface CoreBenchmarkResult {
+  core: 'typescript' | 'native';
+  cycles: number;
+  instructions: number;
+  duration: number;
+  cyclesPerSecond: number;
+}
+
+// LDX #$10 / loop: LDA $10,X / ADC #$01 / STA $10,X / DEX / BNE loop / JMP $0200
+const CORE_BENCHMARK_PROGRAM = [
+  0xA2, 0x10, 0xB5, 0x10, 0x69, 0x01, 0x95, 0x10, 0xCA, 0xD0, 0xF7, 0x4C, 0x00, 0x02
+];
+
+/**
+ * Compare the TypeScript fallback core with the native core on the same
+ * program over flat memory, without the system bus in the way
+ */
+export function benchmarkCPUCores(targetCycles: number = 2000000): CoreBenchmarkResult[] {
+  const results: CoreBenchmarkResult[] = [];
+  const run = (core: CoreBenchmarkResult['core'], step: () => number): void => {
+    let cycles = 0;
+    let instructions = 0;
+    const startTime = performance.now();
+    while (cycles < targetCycles) {
+      cycles += step();
+      instructions++;
+    }
+    const duration = performance.now() - startTime;
+    results.push({ core, cycles, instructions, duration, cyclesPerSecond: cycles / (duration / 1000) });
+  };
+
+  const memory = new Uint8Array(0x10000);
+  memory.set(CORE_BENCHMARK_PROGRAM, 0x0200);
+  const fallback = new FallbackCore();
+  fallback.read = address => memory[address];
+  fallback.write = (address, value) => { memory[address] = value; };
+  fallback.reset(0x0200);
+  run('typescript', () => fallback.step());
+
+  if (isNativeAvailable()) {
+    const nativeMemory = new Uint8Array(0x10000);
+    nativeMemory.set(CORE_BENCHMARK_PROGRAM, 0x0200);
+    const cpu = new CPU6502Emulator();
+    cpu.setMemoryCallbacks(address => nativeMemory[address], (address, value) => { nativeMemory[address] = value; });
+    cpu.setRegisters({ PC: 0x0200, A: 0, X: 0, Y: 0, SP: 0xFD, P: 0x24, cycles: 0 });
+    run('native', () => cpu.step());
+  }
+
+  return results;
+}
+
 /**
  * Performance benchmark runner
  */
@@ -83,10 +136,10 @@ export class EmulatorBenchmark {
     // Create test program with various instructions
     const testProgram = new Uint8Array([
       0xA9, 0x01,  // LDA #$01
-      0x8D, 0x00, 0x02,  // STA $0200
-      0xAD, 0x00, 0x02,  // LDA $0200
+      0x8D, 0x00, 0x05,  // STA $0500
+      0xAD, 0x00, 0x05,  // LDA $0500
       0x69, 0x01,  // ADC #$01
-      0x8D, 0x01, 0x02,  // STA $0201
+      0x8D, 0x01, 0x05,  // STA $0501
       0xA2, 0x10,  // LDX #$10
       0xCA,        // DEX
       0xD0, 0xFD,  // BNE -3 (loop)
@@ -99,9 +152,7 @@ export class EmulatorBenchmark {
     const startStats = this.emulator.getStats();
     
     // Run for 1 second
-    this.emulator.start();
-    await this.delay(1000);
-    this.emulator.stop();
+    await this.runWorkload(1000);
     
     const endTime = performance.now();
     const endStats = this.emulator.getStats();
@@ -150,9 +201,7 @@ export class EmulatorBenchmark {
     profiler.enable();
     profiler.reset();
     
-    this.emulator.start();
-    await this.delay(1000);
-    this.emulator.stop();
+    await this.runWorkload(1000);
     
     const endTime = performance.now();
     const metrics = profiler.getMetrics();
@@ -196,9 +245,7 @@ export class EmulatorBenchmark {
     profiler.enable();
     profiler.reset();
     
-    this.emulator.start();
-    await this.delay(1000);
-    this.emulator.stop();
+    await this.runWorkload(1000);
     
     const endTime = performance.now();
     const metrics = profiler.getMetrics();
@@ -227,12 +274,12 @@ export class EmulatorBenchmark {
     const testProgram = new Uint8Array([
       // Initialize
       0xA9, 0x00,  // LDA #$00
-      0x8D, 0x00, 0x02,  // STA $0200 (counter)
+      0x8D, 0x00, 0x05,  // STA $0500 (counter)
       
       // Main loop
-      0xAD, 0x00, 0x02,  // LDA $0200 (load counter)
+      0xAD, 0x00, 0x05,  // LDA $0500 (load counter)
       0x69, 0x01,  // ADC #$01 (increment)
-      0x8D, 0x00, 0x02,  // STA $0200 (store counter)
+      0x8D, 0x00, 0x05,  // STA $0500 (store counter)
       
       // Peripheral access
       0x8D, 0x01, 0x50,  // STA $5001 (ACIA data)
@@ -240,8 +287,8 @@ export class EmulatorBenchmark {
       
       // Memory operations
       0xA2, 0x08,  // LDX #$08
-      0xBD, 0x10, 0x02,  // LDA $0210,X
-      0x9D, 0x20, 0x02,  // STA $0220,X
+      0xBD, 0x10, 0x05,  // LDA $0510,X
+      0x9D, 0x20, 0x05,  // STA $0520,X
       0xCA,        // DEX
       0x10, 0xF8,  // BPL -8
       
@@ -255,9 +302,7 @@ export class EmulatorBenchmark {
     profiler.enable();
     profiler.reset();
     
-    this.emulator.start();
-    await this.delay(1000);
-    this.emulator.stop();
+    await this.runWorkload(1000);
     
     const endTime = performance.now();
     const metrics = profiler.getMetrics();
@@ -303,9 +348,7 @@ export class EmulatorBenchmark {
     profiler.enable();
     profiler.reset();
     
-    this.emulator.start();
-    await this.delay(1000);
-    this.emulator.stop();
+    await this.runWorkload(1000);
     
     const endTime = performance.now();
     const metrics = profiler.getMetrics();
@@ -380,6 +423,21 @@ export class EmulatorBenchmark {
     };
   }
 
+  /**
+   * Run the loaded program for the given time: emulated time in virtual
+   * clock mode, wall-clock time at the configured pace otherwise
+   */
+  private async runWorkload(ms: number): Promise<void> {
+    if (this.emulator.getClockMode() === 'virtual') {
+      await this.emulator.runFor(ms);
+      return;
+    }
+
+    this.emulator.start();
+    await this.delay(ms);
+    this.emulator.stop();
+  }
+
   /**
    * Utility delay function
    */
@@ -3,6 +3,7 @@
  * Implements various optimization strategies based on profiling data
  */
 
+import { monitorEventLoopDelay, IntervalHistogram } from 'perf_hooks';
 import { MemoryManager } from '../core/memory';
 import { PeripheralHub } from '../peripherals/base';
 
@@ -117,6 +118,12 @@ export class OptimizedMemoryManager extends MemoryManager {
   }
 }
 
+export interface EventLoopLag {
+  mean: number;
+  p99: number;
+  max: number;
+}
+
 /**
  * Execution speed controller
  */
@@ -132,6 +139,17 @@ export class ExecutionSpeedController {
   private cyclesPerChunk: number = 1000;
   private targetChunkTime: number = 16.67; // ~60 FPS
 
+  // Chunk sizing from measured host cost
+  private maxStallMs: number = 4; // Longest a chunk may hold the main thread
+  private costPerCycle: number = 0; // Host ms per emulated cycle, smoothed
+  private lagScale: number = 1; // Shrinks chunks while the event loop lags
+  private lagMonitor?: IntervalHistogram;
+  private lastLagCheck: number = 0;
+  private lastLag: EventLoopLag = { mean: 0, p99: 0, max: 0 };
+  private static readonly MIN_CHUNK_CYCLES = 100;
+  private static readonly LAG_CHECK_INTERVAL_MS = 250;
+  private static readonly LAG_RESOLUTION_MS = 1;
+
   constructor(targetSpeed: number = 1000000) {
     this.targetSpeed = targetSpeed;
     this.calculateChunkSize();
@@ -163,8 +181,102 @@ export class ExecutionSpeedController {
    * Calculate optimal chunk size for target speed
    */
   private calculateChunkSize(): void {
-    // Calculate cycles per chunk to maintain ~60 FPS
-    this.cyclesPerChunk = Math.max(1, Math.floor((this.targetSpeed * this.targetChunkTime) / 1000));
+    // At most ~60 chunks per second of emulated time; more is never needed
+    let cycles = Math.max(1, Math.floor((this.targetSpeed * this.targetChunkTime) / 1000));
+
+    // Once the host cost is known, stay within the stall budget
+    if (this.costPerCycle > 0) {
+      const withinStall = Math.floor((this.maxStallMs * this.lagScale) / this.costPerCycle);
+      cycles = Math.min(cycles, Math.max(ExecutionSpeedController.MIN_CHUNK_CYCLES, withinStall));
+    }
+    this.cyclesPerChunk = cycles;
+  }
+
+  /**
+   * Set the longest a chunk may hold the main thread
+   */
+  setMaxStall(ms: number): void {
+    if (!(ms > 0)) {
+      throw new Error(`Invalid stall budget: ${ms}`);
+    }
+    this.maxStallMs = ms;
+    this.calculateChunkSize();
+  }
+
+  getMaxStall(): number {
+    return this.maxStallMs;
+  }
+
+  /**
+   * Measure a finished chunk and resize the next one
+   */
+  recordChunk(cyclesExecuted: number, executionTime: number): void {
+    if (cyclesExecuted <= 0 || executionTime <= 0) {
+      return;
+    }
+
+    // Smooth out one-off stalls such as garbage collection, but follow a
+    // sustained change in cost (a different workload) within a few chunks
+    const cost = executionTime / cyclesExecuted;
+    this.costPerCycle = this.costPerCycle > 0 ? this.costPerCycle * 0.75 + cost * 0.25 : cost;
+
+    if (this.lagMonitor) {
+      const now = performance.now();
+      if (now - this.lastLagCheck >= ExecutionSpeedController.LAG_CHECK_INTERVAL_MS) {
+        this.lastLagCheck = now;
+        // Samples are the time between 1 ms timer ticks; the lag is the excess
+        const lag = (ns: number) => Math.max(0, ns / 1000000 - ExecutionSpeedController.LAG_RESOLUTION_MS);
+        this.lastLag = {
+          mean: lag(this.lagMonitor.mean),
+          p99: lag(this.lagMonitor.percentile(99)),
+          max: lag(this.lagMonitor.max)
+        };
+        this.lagMonitor.reset();
+
+        // Lag beyond the budget comes from more than the chunks themselves
+        // (timers, I/O callbacks, pacing), so leave them more room. Below a
+        // quarter of the budget the chunk is no longer what the loop waits on.
+        if (this.lastLag.p99 > this.maxStallMs) {
+          this.lagScale = Math.max(0.25, this.lagScale * 0.8);
+        } else {
+          this.lagScale = Math.min(1, this.lagScale * 1.05);
+        }
+      }
+    }
+
+    this.calculateChunkSize();
+  }
+
+  /**
+   * Sample event loop delay while execution runs on the event loop
+   */
+  startLagMonitor(): void {
+    if (!this.lagMonitor) {
+      this.lagMonitor = monitorEventLoopDelay({ resolution: ExecutionSpeedController.LAG_RESOLUTION_MS });
+    }
+    this.lagMonitor.reset();
+    this.lagMonitor.enable();
+    this.lastLagCheck = performance.now();
+  }
+
+  stopLagMonitor(): void {
+    if (this.lagMonitor) {
+      this.lagMonitor.disable();
+    }
+  }
+
+  /**
+   * Event loop delay over the last sampling interval, in ms
+   */
+  getEventLoopLag(): EventLoopLag {
+    return { ...this.lastLag };
+  }
+
+  /**
+   * Measured host cost in ms per emulated cycle (0 until a chunk has run)
+   */
+  getCostPerCycle(): number {
+    return this.costPerCycle;
   }
 
   /**
@@ -0,0 +1,185 @@
+/**
+ * Real-time pacing for the emulated clock
+ * Deadlines are absolute: emulated cycles since the anchor, converted to
+ * host time, so rounding in one wait is made up in the next instead of
+ * accumulating. Each wait sleeps on a timer until it is close to the
+ * deadline and spins for the rest.
+ */
+
+// Host time and timers; replaced in tests with a simulated clock
+export interface PacerClock {
+  now(): number;             // Monotonic host time in ms
+  setTimeout(callback: () => void, ms: number): unknown;
+  clearTimeout(handle: unknown): void;
+}
+
+export const HOST_CLOCK: PacerClock = {
+  now: () => Number(process.hrtime.bigint()) / 1000000,
+  setTimeout: (callback, ms) => setTimeout(callback, ms),
+  clearTimeout: handle => clearTimeout(handle as NodeJS.Timeout)
+};
+
+export interface PacerOptions {
+  spinThresholdMs?: number;  // Spin instead of sleeping this close to a deadline
+  maxLagMs?: number;         // Re-anchor rather than catch up when this far behind
+  sampleCount?: number;      // Wake-up errors kept for the percentiles
+  clock?: PacerClock;        // Defaults to HOST_CLOCK
+}
+
+export interface PacingStats {
+  samples: number;
+  p50: number;               // Wake-up error percentiles in ms, late positive
+  p90: number;
+  p99: number;
+  max: number;
+  effectiveHz: number;       // Emulated clock measured since the anchor
+  clockErrorPercent: number; // (effective - target) / target
+  resyncs: number;           // Times the pacer fell too far behind and re-anchored
+}
+
+export class Pacer {
+  private clockHz: number;
+  private spinThresholdMs: number;
+  private maxLagMs: number;
+  private clock: PacerClock;
+
+  private anchorTime: number = 0;
+  private cycles: number = 0;  // Emulated cycles since the anchor
+  private wokenCycles: number = 0;  // Cycles and host time at the last wake-up
+  private wokenTime: number = 0;
+  private timer?: unknown;
+  private resyncs: number = 0;
+
+  private errors: Float64Array;
+  private errorIndex: number = 0;
+  private errorCount: number = 0;
+
+  constructor(clockHz: number, options: PacerOptions = {}) {
+    this.clockHz = clockHz;
+    this.spinThresholdMs = options.spinThresholdMs ?? 1.5;
+    this.maxLagMs = options.maxLagMs ?? 100;
+    this.clock = options.clock ?? HOST_CLOCK;
+    this.errors = new Float64Array(options.sampleCount ?? 1024);
+    this.start();
+  }
+
+  /**
+   * Anchor emulated time to now and clear the statistics
+   */
+  start(): void {
+    this.cancel();
+    this.anchor();
+    this.resyncs = 0;
+    this.errorIndex = 0;
+    this.errorCount = 0;
+  }
+
+  /**
+   * Change the clock speed; pacing continues from the current position
+   */
+  setClockSpeed(clockHz: number): void {
+    this.anchor();
+    this.clockHz = clockHz;
+  }
+
+  getClockSpeed(): number {
+    return this.clockHz;
+  }
+
+  /**
+   * Account for cycles the emulator has executed
+   */
+  advance(cycles: number): void {
+    this.cycles += cycles;
+  }
+
+  /**
+   * Call back when host time catches up with the emulated cycles
+   * Only one wait is pending at a time; a new one replaces it.
+   */
+  wait(callback: () => void): void {
+    this.cancel();
+
+    const deadline = (this.cycles / this.clockHz) * 1000;
+    const remaining = deadline - this.elapsed();
+    if (remaining < -this.maxLagMs) {
+      // Too far behind to catch up without a burst, e.g. after a debugger
+      // pause or a host stall
+      this.resyncs++;
+      this.anchor();
+      callback();
+      return;
+    }
+
+    // Timers fire up to a millisecond or so late; sleep short and spin
+    this.timer = this.clock.setTimeout(() => {
+      this.timer = undefined;
+      this.finish(deadline, callback);
+    }, Math.max(0, remaining - this.spinThresholdMs));
+  }
+
+  /**
+   * Drop the pending wait
+   */
+  cancel(): void {
+    if (this.timer !== undefined) {
+      this.clock.clearTimeout(this.timer);
+      this.timer = undefined;
+    }
+  }
+
+  getStats(): PacingStats {
+    const sorted = Array.from(this.errors.subarray(0, this.errorCount)).sort((a, b) => a - b);
+    const percentile = (p: number) =>
+      sorted.length > 0 ? sorted[Math.min(sorted.length - 1, Math.floor(sorted.length * p))] : 0;
+
+    const effectiveHz = this.wokenTime > 0 ? this.wokenCycles / (this.wokenTime / 1000) : 0;
+    return {
+      samples: sorted.length,
+      p50: percentile(0.5),
+      p90: percentile(0.9),
+      p99: percentile(0.99),
+      max: sorted.length > 0 ? sorted[sorted.length - 1] : 0,
+      effectiveHz,
+      clockErrorPercent: effectiveHz > 0 ? ((effectiveHz - this.clockHz) / this.clockHz) * 100 : 0,
+      resyncs: this.resyncs
+    };
+  }
+
+  /**
+   * Spin out the last stretch before the deadline, then run the callback
+   */
+  private finish(deadline: number, callback: () => void): void {
+    let now = this.elapsed();
+    while (now < deadline) {
+      now = this.elapsed();
+    }
+    this.record(now - deadline);
+    this.wokenCycles = this.cycles;
+    this.wokenTime = now;
+    callback();
+  }
+
+  private record(error: number): void {
+    this.errors[this.errorIndex] = error;
+    this.errorIndex = (this.errorIndex + 1) % this.errors.length;
+    this.errorCount = Math.min(this.errorCount + 1, this.errors.length);
+  }
+
+  /**
+   * Move the anchor to now without losing the statistics
+   */
+  private anchor(): void {
+    this.anchorTime = this.clock.now();
+    this.cycles = 0;
+    this.wokenCycles = 0;
+    this.wokenTime = 0;
+  }
+
+  /**
+   * Host milliseconds since the anchor
+   */
+  private elapsed(): number {
+    return this.clock.now() - this.anchorTime;
+  }
+}
@@ -0,0 +1,252 @@
+/**
+ * Profile export in formats standard tools load
+ * pprof (gzipped protobuf) for the per-PC profile, with 6502 routines as
+ * functions and instruction addresses as locations, and Chrome trace_event
+ * JSON for the interrupt and peripheral timeline (Perfetto, chrome://tracing).
+ */
+
+import { gzipSync } from 'zlib';
+import { CPUProfile } from '../core/cpu';
+import { CPUCallGraph } from '../core/call-graph';
+import { CC65SymbolParser } from '../cc65/symbol-parser';
+import { TimelineEvent } from './profiler';
+
+export interface PprofOptions {
+  clockHz: number;
+  symbols?: CC65SymbolParser;
+  callGraph?: CPUCallGraph;  // Routine entry points for code without symbols
+  programName?: string;
+  startTime?: Date;
+}
+
+export interface TraceEvent {
+  name: string;
+  ph: 'X' | 'i' | 'M';
+  pid: number;
+  tid: number;
+  ts?: number;       // Microseconds of emulated time
+  dur?: number;
+  s?: 't';
+  cat?: string;
+  args?: { [key: string]: string | number };
+}
+
+export interface TraceEventFile {
+  traceEvents: TraceEvent[];
+  displayTimeUnit: 'ns';
+  otherData: { [key: string]: string | number };
+}
+
+/**
+ * Minimal protobuf encoder for the fields pprof uses
+ */
+class ProtoWriter {
+  private bytes: number[] = [];
+
+  uint(field: number, value: number): this {
+    this.tag(field, 0);
+    this.varint(value);
+    return this;
+  }
+
+  string(field: number, value: string): this {
+    return this.bytesField(field, Buffer.from(value, 'utf8'));
+  }
+
+  packed(field: number, values: number[]): this {
+    const inner = new ProtoWriter();
+    values.forEach(value => inner.varint(value));
+    return this.bytesField(field, inner.finish());
+  }
+
+  message(field: number, build: (writer: ProtoWriter) => void): this {
+    const inner = new ProtoWriter();
+    build(inner);
+    return this.bytesField(field, inner.finish());
+  }
+
+  finish(): Uint8Array {
+    return Uint8Array.from(this.bytes);
+  }
+
+  private bytesField(field: number, data: Uint8Array): this {
+    this.tag(field, 2);
+    this.varint(data.length);
+    data.forEach(byte => this.bytes.push(byte));
+    return this;
+  }
+
+  private tag(field: number, wireType: number): void {
+    this.varint(field * 8 + wireType);
+  }
+
+  // Non-negative values up to 2^53
+  private varint(value: number): void {
+    while (value >= 0x80) {
+      this.bytes.push((value % 0x80) | 0x80);
+      value = Math.floor(value / 0x80);
+    }
+    this.bytes.push(value);
+  }
+}
+
+function hex(address: number): string {
+  return `$${address.toString(16).toUpperCase().padStart(4, '0')}`;
+}
+
+/**
+ * Encode a per-PC profile as a gzipped pprof Profile message
+ * Each executed address is a location whose function is the routine
+ * containing it: the nearest label or call graph entry point at or below
+ * the address. Sample values are executions and cycles.
+ */
+export function encodePprof(profile: CPUProfile, options: PprofOptions): Buffer {
+  const strings: string[] = [''];
+  const stringIndex = new Map<string, number>([['', 0]]);
+  const str = (value: string): number => {
+    let index = stringIndex.get(value);
+    if (index === undefined) {
+      index = strings.length;
+      strings.push(value);
+      stringIndex.set(value, index);
+    }
+    return index;
+  };
+
+  // Routine entry points, named from the symbols where possible
+  const names = new Map<number, string>();
+  if (options.callGraph) {
+    options.callGraph.calls.forEach((calls, address) => {
+      if (calls > 0) {
+        names.set(address, hex(address));
+      }
+    });
+  }
+  if (options.symbols) {
+    for (const symbol of options.symbols.getAllSymbols()) {
+      if (symbol.type !== 'equate' && symbol.type !== 'import' && symbol.address >= 0 && symbol.address < 0x10000) {
+        names.set(symbol.address, symbol.name);
+      }
+    }
+  }
+  const entries = Array.from(names.keys()).sort((a, b) => a - b);
+
+  const functionIds = new Map<number, number>();  // Entry address -> function id
+  const functions: Array<{ id: number; name: string; file?: string }> = [];
+  const locations: Array<{ id: number; address: number; functionId: number }> = [];
+  const samples: Array<{ locationId: number; count: number; cycles: number }> = [];
+  let totalCycles = 0;
+  let entry = -1;  // Index into entries of the routine containing address
+
+  for (let address = 0; address < profile.counts.length; address++) {
+    while (entry + 1 < entries.length && entries[entry + 1] <= address) {
+      entry++;
+    }
+    if (profile.counts[address] === 0) {
+      continue;
+    }
+
+    const start = entry >= 0 ? entries[entry] : address;
+    let functionId = functionIds.get(start);
+    if (functionId === undefined) {
+      functionId = functions.length + 1;
+      functionIds.set(start, functionId);
+      const symbol = options.symbols ? options.symbols.getSymbolByAddress(start) : undefined;
+      functions.push({ id: functionId, name: names.get(start) || hex(start), file: symbol ? symbol.file : undefined });
+    }
+
+    const locationId = locations.length + 1;
+    locations.push({ id: locationId, address, functionId });
+    samples.push({ locationId, count: profile.counts[address], cycles: profile.cycles[address] });
+    totalCycles += profile.cycles[address];
+  }
+
+  const writer = new ProtoWriter();
+  writer.message(1, w => w.uint(1, str('instructions')).uint(2, str('count')));
+  writer.message(1, w => w.uint(1, str('cycles')).uint(2, str('count')));
+  for (const sample of samples) {
+    writer.message(2, w => w.packed(1, [sample.locationId]).packed(2, [sample.count, sample.cycles]));
+  }
+  writer.message(3, w => w.uint(1, 1).uint(3, 0x10000).uint(5, str(options.programName || '6502')).uint(7, 1));
+  for (const location of locations) {
+    writer.message(4, w => w.uint(1, location.id).uint(2, 1).uint(3, location.address)
+      .message(4, line => line.uint(1, location.functionId)));
+  }
+  for (const fn of functions) {
+    writer.message(5, w => {
+      w.uint(1, fn.id).uint(2, str(fn.name)).uint(3, str(fn.name));
+      if (fn.file) {
+        w.uint(4, str(fn.file));
+      }
+    });
+  }
+
+  const startTime = options.startTime || new Date();
+  writer.uint(9, startTime.getTime() * 1000000);
+  writer.uint(10, Math.round((totalCycles / options.clockHz) * 1e9));
+  writer.message(11, w => w.uint(1, str('cycles')).uint(2, str('count')));
+  writer.uint(12, 1);
+  writer.uint(14, str('cycles'));
+
+  // Written last, once every string has been interned
+  for (const value of strings) {
+    writer.string(6, value);
+  }
+
+  return gzipSync(writer.finish());
+}
+
+/**
+ * Build a Chrome trace_event file from the profiler timeline
+ * Interrupt sources become slices on one track each, from assertion to
+ * release; peripheral accesses are instant events on a track per
+ * peripheral. Timestamps are emulated time.
+ */
+export function createTraceEvents(timeline: TimelineEvent[], clockHz: number): TraceEventFile {
+  const toMicros = (cycle: number) => (cycle / clockHz) * 1e6;
+  const tracks = new Map<string, number>();
+  const traceEvents: TraceEvent[] = [{ name: 'process_name', ph: 'M', pid: 1, tid: 0, args: { name: '6502' } }];
+  const track = (name: string): number => {
+    let tid = tracks.get(name);
+    if (tid === undefined) {
+      tid = tracks.size + 1;
+      tracks.set(name, tid);
+      traceEvents.push({ name: 'thread_name', ph: 'M', pid: 1, tid, args: { name } });
+    }
+    return tid;
+  };
+
+  const open = new Map<string, TimelineEvent>();  // Track -> assertion still in force
+  const slice = (asserted: TimelineEvent, endCycle: number, tid: number): TraceEvent => ({
+    name: asserted.name, cat: 'interrupt', ph: 'X', pid: 1, tid,
+    ts: toMicros(asserted.cycle), dur: toMicros(endCycle - asserted.cycle), args: { source: asserted.detail }
+  });
+  const lastCycle = timeline.length > 0 ? timeline[timeline.length - 1].cycle : 0;
+  for (const event of timeline) {
+    if (event.kind === 'peripheral') {
+      const args: { [key: string]: string | number } = {};
+      if (event.address !== undefined) args.address = hex(event.address);
+      if (event.value !== undefined) args.value = event.value;
+      traceEvents.push({
+        name: `${event.detail} ${event.address !== undefined ? hex(event.address) : ''}`.trim(),
+        cat: 'peripheral', ph: 'i', s: 't', pid: 1, tid: track(event.name), ts: toMicros(event.cycle), args
+      });
+      continue;
+    }
+
+    const name = `${event.name} ${event.detail}`;
+    const asserted = open.get(name);
+    if (event.phase === 'begin') {
+      track(name);
+      open.set(name, event);
+    } else if (asserted) {
+      open.delete(name);
+      traceEvents.push(slice(asserted, event.cycle, track(name)));
+    }
+  }
+
+  // Lines still asserted run to the end of the timeline
+  open.forEach((asserted, name) => traceEvents.push(slice(asserted, lastCycle, track(name))));
+
+  return { traceEvents, displayTimeUnit: 'ns', otherData: { clockHz } };
+}
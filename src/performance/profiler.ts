@@ -3,6 +3,10 @@
  * Identifies bottlenecks and provides optimization insights
  */
 
+import { CPUProfile } from '../core/cpu';
+import { CPUCallGraph, CALL_EDGE_SLOTS, CALL_FRAME, CALL_HEADER } from '../core/call-graph';
+import { CC65SymbolParser } from '../cc65/symbol-parser';
+
 export interface PerformanceMetrics {
   totalExecutionTime: number;
   cpuTime: number;
@@ -17,6 +21,13 @@ export interface PerformanceMetrics {
   breakpointChecks: number;
 }
 
+export interface InstructionHotspot {
+  address: number;
+  count: number;        // Executions of the instruction at this address
+  cycles: number;
+  cyclePercent: number; // Share of all profiled cycles
+}
+
 export interface ProfilerSample {
   timestamp: number;
   operation: 'cpu_step' | 'memory_read' | 'memory_write' | 'peripheral_access' | 'breakpoint_check';
@@ -24,10 +35,60 @@ export interface ProfilerSample {
   duration: number;
 }
 
+/**
+ * Interrupt line or peripheral register activity, stamped in bus cycles
+ */
+export interface TimelineEvent {
+  cycle: number;
+  kind: 'interrupt' | 'peripheral';
+  name: string;    // IRQ/NMI, or the peripheral accessed
+  detail: string;  // Interrupt source, or read/write
+  phase: 'begin' | 'end' | 'instant';
+  address?: number;
+  value?: number;
+}
+
+/**
+ * Fixed-capacity buffer that overwrites its oldest entries
+ */
+class RingBuffer<T> {
+  private items: T[] = [];
+  private start = 0;  // Oldest item once full
+
+  constructor(private capacity: number) {}
+
+  push(item: T): void {
+    if (this.items.length < this.capacity) {
+      this.items.push(item);
+    } else {
+      this.items[this.start] = item;
+      this.start = (this.start + 1) % this.items.length;
+    }
+  }
+
+  /**
+   * Items in the order they were pushed
+   */
+  toArray(): T[] {
+    return this.items.slice(this.start).concat(this.items.slice(0, this.start));
+  }
+
+  clear(): void {
+    this.items = [];
+    this.start = 0;
+  }
+
+  setCapacity(capacity: number): void {
+    this.capacity = capacity;
+    this.items = this.toArray().slice(-capacity);
+    this.start = 0;
+  }
+}
+
 export class EmulatorProfiler {
-  private samples: ProfilerSample[] = [];
+  private samples = new RingBuffer<ProfilerSample>(10000);
+  private timeline = new RingBuffer<TimelineEvent>(100000);
   private isEnabled: boolean = false;
-  private maxSamples: number = 10000;
   private startTime: number = 0;
   
   // Performance counters
@@ -65,7 +126,8 @@ export class EmulatorProfiler {
    * Reset profiling data
    */
   reset(): void {
-    this.samples = [];
+    this.samples.clear();
+    this.timeline.clear();
     this.metrics = {
       totalExecutionTime: 0,
       cpuTime: 0,
@@ -116,11 +178,6 @@ export class EmulatorProfiler {
         this.metrics.breakpointChecks++;
         break;
     }
-
-    // Limit sample buffer size
-    if (this.samples.length > this.maxSamples) {
-      this.samples.shift();
-    }
   }
 
   /**
@@ -216,7 +273,7 @@ export class EmulatorProfiler {
   private getHotspots(): AddressHotspot[] {
     const addressCounts = new Map<number, number>();
     
-    this.samples.forEach(sample => {
+    this.samples.toArray().forEach(sample => {
       if (sample.address !== undefined && 
           (sample.operation === 'memory_read' || sample.operation === 'memory_write')) {
         const count = addressCounts.get(sample.address) || 0;
@@ -252,7 +309,7 @@ export class EmulatorProfiler {
   exportData(): ProfilerExport {
     return {
       metrics: this.getMetrics(),
-      samples: [...this.samples],
+      samples: this.samples.toArray(),
       analysis: this.getAnalysis(),
       timestamp: new Date().toISOString()
     };
@@ -262,10 +319,22 @@ export class EmulatorProfiler {
    * Set maximum number of samples to keep
    */
   setMaxSamples(max: number): void {
-    this.maxSamples = max;
-    if (this.samples.length > max) {
-      this.samples = this.samples.slice(-max);
-    }
+    this.samples.setCapacity(max);
+  }
+
+  /**
+   * Record interrupt or peripheral activity for the timeline
+   */
+  recordEvent(event: TimelineEvent): void {
+    if (!this.isEnabled) return;
+    this.timeline.push(event);
+  }
+
+  /**
+   * Timeline events, oldest first
+   */
+  getTimeline(): TimelineEvent[] {
+    return this.timeline.toArray();
   }
 }
 
@@ -276,6 +345,31 @@ export interface PerformanceAnalysis {
   efficiency: number;
 }
 
+export interface RoutineProfile {
+  address: number;
+  name?: string;
+  calls: number;
+  inclusive: number;    // Cycles in the routine and everything it calls
+  exclusive: number;    // Cycles in the routine itself
+  inclusivePercent: number;
+  exclusivePercent: number;
+}
+
+export interface CallEdge {
+  caller: number;
+  callee: number;
+  calls: number;
+  cycles: number;       // Inclusive cycles of the callee when called from caller
+}
+
+export interface CallGraphReport {
+  totalCycles: number;
+  routines: RoutineProfile[];  // Most inclusive cycles first
+  edges: CallEdge[];           // Most cycles first
+  stack: number[];             // Routines still active, outermost first
+  droppedCalls: number;        // Calls nested too deep to be tracked
+}
+
 export interface Bottleneck {
   type: 'memory' | 'peripheral' | 'cpu' | 'breakpoint';
   severity: 'low' | 'medium' | 'high';
@@ -293,4 +387,86 @@ export interface ProfilerExport {
   samples: ProfilerSample[];
   analysis: PerformanceAnalysis;
   timestamp: string;
+}
+
+/**
+ * Addresses that took the most cycles in a per-PC profile
+ */
+export function getInstructionHotspots(profile: CPUProfile, limit: number = 20): InstructionHotspot[] {
+  let totalCycles = 0;
+  const hotspots: InstructionHotspot[] = [];
+  for (let address = 0; address < profile.counts.length; address++) {
+    if (profile.counts[address] === 0) {
+      continue;
+    }
+    totalCycles += profile.cycles[address];
+    hotspots.push({ address, count: profile.counts[address], cycles: profile.cycles[address], cyclePercent: 0 });
+  }
+
+  hotspots.sort((a, b) => b.cycles - a.cycles);
+  const top = hotspots.slice(0, limit);
+  top.forEach(hotspot => {
+    hotspot.cyclePercent = totalCycles > 0 ? (hotspot.cycles / totalCycles) * 100 : 0;
+  });
+  return top;
+}
+
+/**
+ * Inclusive and exclusive cycles per subroutine and caller -> callee edges
+ * Routines still on the shadow stack are counted up to now.
+ * @param symbols Names routines by their entry address
+ */
+export function getCallGraphReport(graph: CPUCallGraph, symbols?: CC65SymbolParser): CallGraphReport {
+  const stack = graph.stack;
+  const depth = stack[0];
+  const clock = graph.clock[0];
+  const inclusive = new Map<number, number>();
+  const edges: CallEdge[] = [];
+  const openEdges = new Map<number, number>();
+  const active: number[] = [];
+
+  for (let i = 0; i < depth; i++) {
+    const frame = CALL_HEADER + i * CALL_FRAME;
+    const address = stack[frame];
+    const elapsed = clock - graph.clock[1 + i];
+    if (!active.includes(address)) {
+      inclusive.set(address, elapsed);
+    }
+    if (i > 0) {
+      const key = ((stack[frame - CALL_FRAME] << 16) | address) >>> 0;
+      openEdges.set(key, (openEdges.get(key) || 0) + elapsed);
+    }
+    active.push(address);
+  }
+
+  for (let slot = 0; slot < CALL_EDGE_SLOTS; slot++) {
+    const calls = graph.edges[slot * 2 + 1];
+    if (calls === 0) {
+      continue;
+    }
+    const key = graph.edges[slot * 2];
+    edges.push({ caller: key >>> 16, callee: key & 0xFFFF, calls, cycles: graph.edgeCycles[slot] + (openEdges.get(key) || 0) });
+  }
+  edges.sort((a, b) => b.cycles - a.cycles || a.caller - b.caller || a.callee - b.callee);
+
+  const routines: RoutineProfile[] = [];
+  for (let address = 0; address < 0x10000; address++) {
+    if (graph.calls[address] === 0 && graph.exclusive[address] === 0 && !inclusive.has(address)) {
+      continue;
+    }
+    const symbol = symbols ? symbols.getSymbolByAddress(address) : undefined;
+    const total = graph.inclusive[address] + (inclusive.get(address) || 0);
+    routines.push({
+      address,
+      name: symbol ? symbol.name : undefined,
+      calls: graph.calls[address],
+      inclusive: total,
+      exclusive: graph.exclusive[address],
+      inclusivePercent: clock > 0 ? (total / clock) * 100 : 0,
+      exclusivePercent: clock > 0 ? (graph.exclusive[address] / clock) * 100 : 0
+    });
+  }
+  routines.sort((a, b) => b.inclusive - a.inclusive || b.exclusive - a.exclusive);
+
+  return { totalCycles: clock, routines, edges, stack: active, droppedCalls: stack[1] };
 }
\ No newline at end of file
@@ -57,6 +57,24 @@ export enum ACIAStatusBits {
   IRQ = 0x80      // Interrupt Request
 }
 
+/**
+ * Snapshot of the ACIA's internal state, used for checkpointing
+ * The connected serial port is host-side and is not part of the snapshot.
+ */
+export interface ACIA68B50State {
+  controlRegister: number;
+  statusRegister: number;
+  receiveDataRegister: number;
+  transmitDataRegister: number;
+  receiveBuffer: number[];
+  transmitBuffer: number[];
+  baudRate: number;
+  cyclesPerBit: number;
+  transmitCyclesRemaining: number;
+  receiveCyclesRemaining: number;
+  interruptPending: boolean;
+}
+
 /**
  * Motorola 68B50 ACIA peripheral implementation
  */
@@ -135,6 +153,56 @@ export class ACIA68B50 implements Peripheral {
     this.updateBaudRateTiming();
   }
 
+  /**
+   * Capture the ACIA's internal state
+   * @returns State snapshot
+   */
+  saveState(): ACIA68B50State {
+    return {
+      controlRegister: this.controlRegister,
+      statusRegister: this.statusRegister,
+      receiveDataRegister: this.receiveDataRegister,
+      transmitDataRegister: this.transmitDataRegister,
+      receiveBuffer: [...this.receiveBuffer],
+      transmitBuffer: [...this.transmitBuffer],
+      baudRate: this.baudRate,
+      cyclesPerBit: this.cyclesPerBit,
+      transmitCyclesRemaining: this.transmitCyclesRemaining,
+      receiveCyclesRemaining: this.receiveCyclesRemaining,
+      interruptPending: this.interruptPending
+    };
+  }
+
+  /**
+   * Restore state captured by saveState
+   * @param state State snapshot
+   */
+  restoreState(state: unknown): void {
+    const saved = state as ACIA68B50State;
+    this.controlRegister = saved.controlRegister;
+    this.statusRegister = saved.statusRegister;
+    this.receiveDataRegister = saved.receiveDataRegister;
+    this.transmitDataRegister = saved.transmitDataRegister;
+    this.receiveBuffer = [...saved.receiveBuffer];
+    this.transmitBuffer = [...saved.transmitBuffer];
+    this.baudRate = saved.baudRate;
+    this.cyclesPerBit = saved.cyclesPerBit;
+    this.transmitCyclesRemaining = saved.transmitCyclesRemaining;
+    this.receiveCyclesRemaining = saved.receiveCyclesRemaining;
+    this.interruptPending = saved.interruptPending;
+  }
+
+  /**
+   * Create a copy of the ACIA in its current state
+   * The serial port connection is not copied.
+   * @returns New ACIA instance
+   */
+  clone(): ACIA68B50 {
+    const copy = new ACIA68B50();
+    copy.restoreState(this.saveState());
+    return copy;
+  }
+
   /**
    * Update ACIA state each CPU cycle
    * @param cycles Number of CPU cycles elapsed
@@ -156,10 +224,11 @@ export class ACIA68B50 implements Peripheral {
       }
     }
 
-    // Check for incoming data from serial port
-    if (this.serialPort && this.serialPort.hasData()) {
+    // Check for incoming data from serial port; bytes wait in the port
+    // while a reception is in progress
+    if (this.serialPort && this.receiveCyclesRemaining <= 0 && this.serialPort.hasData()) {
       const data = this.serialPort.read();
-      if (data !== null && this.receiveCyclesRemaining <= 0) {
+      if (data !== null) {
         this.startReception(data);
       }
     }
@@ -295,6 +364,14 @@ export class ACIA68B50 implements Peripheral {
     port.setBaudRate(this.baudRate);
   }
 
+  /**
+   * Get the connected serial port
+   * @returns Serial port or null if none is connected
+   */
+  getSerialPort(): SerialPort | null {
+    return this.serialPort;
+  }
+
   /**
    * Disconnect the serial port
    */
@@ -32,6 +32,43 @@ export interface Peripheral {
    * @returns true if an interrupt is pending
    */
   getInterruptStatus(): boolean;
+
+  /**
+   * Capture the peripheral's internal state (optional)
+   * Used by checkpointing; the returned value must not share mutable data
+   * with the live peripheral.
+   * @returns Opaque state object
+   */
+  saveState?(): unknown;
+
+  /**
+   * Restore state previously returned by saveState (optional)
+   * @param state State object from saveState
+   */
+  restoreState?(state: unknown): void;
+
+  /**
+   * Create an independent copy of the peripheral in its current state (optional)
+   * Used when forking a machine; host connections are not copied.
+   * @returns New peripheral instance
+   */
+  clone?(): Peripheral;
+
+  /**
+   * Give the peripheral access to guest memory (optional)
+   * Called by the hub on registration and when its bus connects, for
+   * peripherals that transfer blocks of memory themselves.
+   * @param memory Accessor for the CPU's address space
+   */
+  connectMemory?(memory: PeripheralMemoryAccess): void;
+}
+
+/**
+ * The CPU's address space, as seen by a peripheral accessing memory
+ */
+export interface PeripheralMemoryAccess {
+  read(address: number): number;
+  write(address: number, value: number): void;
 }
 
 /**
@@ -49,6 +86,7 @@ export interface PeripheralRegistration {
  */
 export class PeripheralHub {
   private peripherals: PeripheralRegistration[] = [];
+  private memory?: PeripheralMemoryAccess;
 
   /**
    * Register a peripheral with the hub
@@ -83,6 +121,9 @@ export class PeripheralHub {
       endAddress,
       name
     });
+    if (this.memory && peripheral.connectMemory) {
+      peripheral.connectMemory(this.memory);
+    }
 
     // Sort by start address for efficient lookup
     this.peripherals.sort((a, b) => a.startAddress - b.startAddress);
@@ -127,6 +168,19 @@ export class PeripheralHub {
     // Ignore writes to unmapped addresses
   }
 
+  /**
+   * Connect the address space peripherals access memory through
+   * @param memory Accessor for the CPU's address space
+   */
+  connectMemory(memory: PeripheralMemoryAccess): void {
+    this.memory = memory;
+    for (const registration of this.peripherals) {
+      if (registration.peripheral.connectMemory) {
+        registration.peripheral.connectMemory(memory);
+      }
+    }
+  }
+
   /**
    * Reset all registered peripherals
    */
@@ -146,6 +200,48 @@ export class PeripheralHub {
     }
   }
 
+  /**
+   * Capture the state of all peripherals that support checkpointing
+   * @returns Map of peripheral name to saved state
+   */
+  saveState(): Map<string, unknown> {
+    const states = new Map<string, unknown>();
+    for (const registration of this.peripherals) {
+      if (registration.peripheral.saveState) {
+        states.set(registration.name, registration.peripheral.saveState());
+      }
+    }
+    return states;
+  }
+
+  /**
+   * Create a hub with independent copies of all registered peripherals
+   * @returns New hub with the same address map
+   */
+  fork(): PeripheralHub {
+    const hub = new PeripheralHub();
+    for (const registration of this.peripherals) {
+      if (!registration.peripheral.clone) {
+        throw new Error(`Peripheral ${registration.name} cannot be forked`);
+      }
+      hub.peripherals.push({ ...registration, peripheral: registration.peripheral.clone() });
+    }
+    return hub;
+  }
+
+  /**
+   * Restore peripheral state captured by saveState
+   * @param states Map of peripheral name to saved state
+   */
+  restoreState(states: Map<string, unknown>): void {
+    for (const registration of this.peripherals) {
+      const state = states.get(registration.name);
+      if (state !== undefined && registration.peripheral.restoreState) {
+        registration.peripheral.restoreState(state);
+      }
+    }
+  }
+
   /**
    * Get interrupt status from all peripherals
    * @returns Array of peripheral names that have pending interrupts
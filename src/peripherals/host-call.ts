@@ -0,0 +1,388 @@
+/**
+ * Paravirtual host-call device
+ *
+ * Gives guest programs services that would be slow or impossible through
+ * emulated hardware: a whole string or file is transferred in one call,
+ * with no emulated cycles spent on it. Writing a service number to the
+ * SERVICE register performs it at once; ARG holds its argument, usually
+ * the address of a parameter block, and STATUS/RESULT the outcome.
+ *
+ * With a BRK signature configured, the core also turns `BRK sig` into a
+ * call: A/X go to ARG, Y is the service, and on return A/X hold RESULT and
+ * carry is set when STATUS is not OK. The BRK then takes two bytes and
+ * never enters the interrupt handler.
+ *
+ * Register Map:
+ * Offset 0: SERVICE (write: perform, read: last service)
+ * Offset 1: STATUS (read only)
+ * Offset 2-3: ARG, little-endian
+ * Offset 4-5: RESULT, little-endian (read only)
+ */
+
+import fs from 'fs';
+import path from 'path';
+import { Peripheral, PeripheralMemoryAccess } from './base';
+
+export const HOST_CALL_REGISTERS = 6;
+
+export enum HostCallRegister {
+  SERVICE = 0,
+  STATUS = 1,
+  ARG_LO = 2,
+  ARG_HI = 3,
+  RESULT_LO = 4,
+  RESULT_HI = 5
+}
+
+/**
+ * Services; parameter blocks are little-endian
+ */
+export enum HostCallService {
+  PUTS = 1,        // ARG: zero-terminated string. RESULT: length
+  EXIT = 2,        // ARG: exit status
+  READ_FILE = 3,   // ARG: {name, buffer, length}. RESULT: bytes read
+  WRITE_FILE = 4,  // ARG: {name, buffer, length, flags}; flags bit 0 appends. RESULT: bytes written
+  CLOCK = 5        // ARG: 8-byte buffer for emulated milliseconds since reset and host Unix seconds, 32 bits each
+}
+
+export enum HostCallStatus {
+  OK = 0,
+  UNKNOWN_SERVICE = 1,
+  IO_ERROR = 2,
+  ACCESS_DENIED = 3
+}
+
+export interface HostCallOptions {
+  directory?: string;   // Host directory the file services may use; none when omitted
+  clockSpeed?: number;  // CPU clock in Hz, for emulated time (default 1 MHz)
+}
+
+/**
+ * Outcome of reading a host file
+ */
+export interface HostFileRead {
+  status: HostCallStatus;
+  data: Uint8Array;     // Empty unless status is OK
+}
+
+/**
+ * Host side of the services: everything they read from or do to the host.
+ * Decorators log what the host returns and skip repeated side effects, so
+ * that replayed runs and reverse execution see the same results.
+ */
+export interface HostCallBackend {
+  output(text: string): void;
+  readFile(name: string, length: number): HostFileRead;  // At most length bytes
+  writeFile(name: string, data: Uint8Array, append: boolean): HostCallStatus;
+  wallClock(): number;  // Unix seconds
+}
+
+/**
+ * Backend on the host's stdout, clock and a directory of files
+ */
+export class LocalHostCallBackend implements HostCallBackend {
+  private outputHandler: (text: string) => void = text => { process.stdout.write(text); };
+  private clock: () => number = () => Math.floor(Date.now() / 1000);
+
+  constructor(private directory?: string) {}
+
+  setOutput(output: (text: string) => void): void {
+    this.outputHandler = output;
+  }
+
+  setWallClock(clock: () => number): void {
+    this.clock = clock;
+  }
+
+  output(text: string): void {
+    this.outputHandler(text);
+  }
+
+  readFile(name: string, length: number): HostFileRead {
+    const file = this.resolve(name);
+    if (!file) {
+      return { status: HostCallStatus.ACCESS_DENIED, data: new Uint8Array(0) };
+    }
+    try {
+      return { status: HostCallStatus.OK, data: Uint8Array.from(fs.readFileSync(file).subarray(0, length)) };
+    } catch (error) {
+      return { status: HostCallStatus.IO_ERROR, data: new Uint8Array(0) };
+    }
+  }
+
+  writeFile(name: string, data: Uint8Array, append: boolean): HostCallStatus {
+    const file = this.resolve(name);
+    if (!file) {
+      return HostCallStatus.ACCESS_DENIED;
+    }
+    try {
+      if (append) {
+        fs.appendFileSync(file, data);
+      } else {
+        fs.writeFileSync(file, data);
+      }
+      return HostCallStatus.OK;
+    } catch (error) {
+      return HostCallStatus.IO_ERROR;
+    }
+  }
+
+  wallClock(): number {
+    return this.clock();
+  }
+
+  /**
+   * Host path for a guest file name, or undefined when there is no
+   * directory or the name leaves it, symbolic links included
+   */
+  private resolve(name: string): string | undefined {
+    if (!this.directory) {
+      return undefined;
+    }
+    try {
+      const root = fs.realpathSync(path.resolve(this.directory));
+      const file = path.resolve(root, name);
+      if (!isInside(root, file)) {
+        return undefined;
+      }
+      // A file being created has no real path yet; its directory does
+      const real = fs.existsSync(file)
+        ? fs.realpathSync(file)
+        : path.join(fs.realpathSync(path.dirname(file)), path.basename(file));
+      return isInside(root, real) ? real : undefined;
+    } catch (error) {
+      return undefined;
+    }
+  }
+}
+
+function isInside(root: string, file: string): boolean {
+  const relative = path.relative(root, file);
+  return relative !== '' && !relative.startsWith('..') && !path.isAbsolute(relative);
+}
+
+interface HostCallState {
+  service: number;
+  status: number;
+  arg: number;
+  result: number;
+  cycles: number;
+}
+
+export class HostCallDevice implements Peripheral {
+  private service = 0;
+  private status = HostCallStatus.OK;
+  private arg = 0;
+  private result = 0;
+  private memory?: PeripheralMemoryAccess;
+  private exitHandler?: (status: number) => void;
+  private localBackend: LocalHostCallBackend;
+  private backend: HostCallBackend;
+  private cycles = 0;  // Since reset
+
+  constructor(private options: HostCallOptions = {}) {
+    this.localBackend = new LocalHostCallBackend(options.directory);
+    this.backend = this.localBackend;
+  }
+
+  connectMemory(memory: PeripheralMemoryAccess): void {
+    this.memory = memory;
+  }
+
+  /**
+   * Where PUTS output goes, the host's stdout by default
+   */
+  setOutput(output: (text: string) => void): void {
+    this.localBackend.setOutput(output);
+  }
+
+  /**
+   * Where CLOCK reads the host's time in Unix seconds, Date.now() by default
+   */
+  setWallClock(clock: () => number): void {
+    this.localBackend.setWallClock(clock);
+  }
+
+  /**
+   * Backend on the host itself, which decorators passed to setBackend wrap
+   */
+  getLocalBackend(): LocalHostCallBackend {
+    return this.localBackend;
+  }
+
+  /**
+   * Route the services through a decorated backend
+   */
+  setBackend(backend: HostCallBackend): void {
+    this.backend = backend;
+  }
+
+  /**
+   * Called when the guest requests EXIT
+   */
+  setExitHandler(handler: (status: number) => void): void {
+    this.exitHandler = handler;
+  }
+
+  read(offset: number): number {
+    switch (offset) {
+      case HostCallRegister.SERVICE:
+        return this.service;
+      case HostCallRegister.STATUS:
+        return this.status;
+      case HostCallRegister.ARG_LO:
+        return this.arg & 0xFF;
+      case HostCallRegister.ARG_HI:
+        return this.arg >> 8;
+      case HostCallRegister.RESULT_LO:
+        return this.result & 0xFF;
+      case HostCallRegister.RESULT_HI:
+        return this.result >> 8;
+      default:
+        return 0xFF;
+    }
+  }
+
+  write(offset: number, value: number): void {
+    switch (offset) {
+      case HostCallRegister.SERVICE:
+        this.service = value;
+        this.perform(value);
+        break;
+      case HostCallRegister.ARG_LO:
+        this.arg = (this.arg & 0xFF00) | value;
+        break;
+      case HostCallRegister.ARG_HI:
+        this.arg = (this.arg & 0x00FF) | (value << 8);
+        break;
+    }
+  }
+
+  reset(): void {
+    this.service = 0;
+    this.status = HostCallStatus.OK;
+    this.arg = 0;
+    this.result = 0;
+    this.cycles = 0;
+  }
+
+  tick(cycles: number): void {
+    // Services complete when requested; only emulated time is kept
+    this.cycles += cycles;
+  }
+
+  getInterruptStatus(): boolean {
+    return false;
+  }
+
+  saveState(): HostCallState {
+    return { service: this.service, status: this.status, arg: this.arg, result: this.result, cycles: this.cycles };
+  }
+
+  restoreState(state: unknown): void {
+    const saved = state as HostCallState;
+    this.service = saved.service;
+    this.status = saved.status;
+    this.arg = saved.arg;
+    this.result = saved.result;
+    this.cycles = saved.cycles ?? 0;
+  }
+
+  /**
+   * Copy with the same registers, emulated time and directory; output,
+   * exit handler, wall clock and backend are host connections and are not
+   * copied
+   */
+  clone(): HostCallDevice {
+    const copy = new HostCallDevice(this.options);
+    copy.restoreState(this.saveState());
+    return copy;
+  }
+
+  private perform(service: number): void {
+    this.status = HostCallStatus.OK;
+    this.result = 0;
+    if (!this.memory) {
+      this.status = HostCallStatus.IO_ERROR;
+      return;
+    }
+
+    try {
+      switch (service) {
+        case HostCallService.PUTS: {
+          const text = this.readString(this.arg);
+          this.backend.output(text);
+          this.result = text.length;
+          break;
+        }
+        case HostCallService.EXIT:
+          if (this.exitHandler) {
+            this.exitHandler(this.arg);
+          }
+          break;
+        case HostCallService.READ_FILE:
+          this.readFile();
+          break;
+        case HostCallService.WRITE_FILE:
+          this.writeFile();
+          break;
+        case HostCallService.CLOCK: {
+          const clockSpeed = this.options.clockSpeed ?? 1000000;
+          this.writeLong(this.arg, Math.floor((this.cycles * 1000) / clockSpeed));
+          this.writeLong(this.arg + 4, this.backend.wallClock());
+          break;
+        }
+        default:
+          this.status = HostCallStatus.UNKNOWN_SERVICE;
+      }
+    } catch (error) {
+      this.status = HostCallStatus.IO_ERROR;
+    }
+  }
+
+  private readFile(): void {
+    const name = this.readString(this.word(this.arg));
+    const buffer = this.word(this.arg + 2);
+    const read = this.backend.readFile(name, Math.min(this.word(this.arg + 4), 0x10000 - buffer));
+    this.status = read.status;
+    for (let i = 0; i < read.data.length; i++) {
+      this.memory!.write(buffer + i, read.data[i]);
+    }
+    this.result = read.data.length;
+  }
+
+  private writeFile(): void {
+    const name = this.readString(this.word(this.arg));
+    const buffer = this.word(this.arg + 2);
+    const length = Math.min(this.word(this.arg + 4), 0x10000 - buffer);
+    const data = new Uint8Array(length);
+    for (let i = 0; i < length; i++) {
+      data[i] = this.memory!.read(buffer + i);
+    }
+    const append = (this.memory!.read((this.arg + 6) & 0xFFFF) & 1) !== 0;
+    this.status = this.backend.writeFile(name, data, append);
+    this.result = this.status === HostCallStatus.OK ? length : 0;
+  }
+
+  private readString(address: number): string {
+    const bytes: number[] = [];
+    for (let i = 0; i < 0x10000; i++) {
+      const byte = this.memory!.read((address + i) & 0xFFFF);
+      if (byte === 0) {
+        break;
+      }
+      bytes.push(byte);
+    }
+    return Buffer.from(bytes).toString('latin1');
+  }
+
+  private word(address: number): number {
+    return this.memory!.read(address & 0xFFFF) | (this.memory!.read((address + 1) & 0xFFFF) << 8);
+  }
+
+  private writeLong(address: number, value: number): void {
+    for (let i = 0; i < 4; i++) {
+      this.memory!.write((address + i) & 0xFFFF, (value >>> (i * 8)) & 0xFF);
+    }
+  }
+}
@@ -37,6 +37,26 @@ export interface VIA65C22 extends Peripheral {
   getShiftRegister(): number;
 }
 
+/**
+ * Snapshot of the VIA's internal registers, used for checkpointing
+ */
+export interface VIA65C22State {
+  portAData: number;
+  portBData: number;
+  portADirection: number;
+  portBDirection: number;
+  timer1Counter: number;
+  timer1Latch: number;
+  timer2Counter: number;
+  shiftRegister: number;
+  auxiliaryControlRegister: number;
+  peripheralControlRegister: number;
+  interruptFlagRegister: number;
+  interruptEnableRegister: number;
+  timer1Running: boolean;
+  timer2Running: boolean;
+}
+
 export class VIA65C22Implementation implements VIA65C22 {
   // Register addresses (offsets from base)
   private static readonly REG_ORB_IRB = 0x00;    // Output/Input Register B
@@ -225,6 +245,49 @@ export class VIA65C22Implementation implements VIA65C22 {
     this.timer2Running = false;
   }
 
+  saveState(): VIA65C22State {
+    return {
+      portAData: this.portAData,
+      portBData: this.portBData,
+      portADirection: this.portADirection,
+      portBDirection: this.portBDirection,
+      timer1Counter: this.timer1Counter,
+      timer1Latch: this.timer1Latch,
+      timer2Counter: this.timer2Counter,
+      shiftRegister: this.shiftRegister,
+      auxiliaryControlRegister: this.auxiliaryControlRegister,
+      peripheralControlRegister: this.peripheralControlRegister,
+      interruptFlagRegister: this.interruptFlagRegister,
+      interruptEnableRegister: this.interruptEnableRegister,
+      timer1Running: this.timer1Running,
+      timer2Running: this.timer2Running
+    };
+  }
+
+  restoreState(state: unknown): void {
+    const saved = state as VIA65C22State;
+    this.portAData = saved.portAData;
+    this.portBData = saved.portBData;
+    this.portADirection = saved.portADirection;
+    this.portBDirection = saved.portBDirection;
+    this.timer1Counter = saved.timer1Counter;
+    this.timer1Latch = saved.timer1Latch;
+    this.timer2Counter = saved.timer2Counter;
+    this.shiftRegister = saved.shiftRegister;
+    this.auxiliaryControlRegister = saved.auxiliaryControlRegister;
+    this.peripheralControlRegister = saved.peripheralControlRegister;
+    this.interruptFlagRegister = saved.interruptFlagRegister;
+    this.interruptEnableRegister = saved.interruptEnableRegister;
+    this.timer1Running = saved.timer1Running;
+    this.timer2Running = saved.timer2Running;
+  }
+
+  clone(): VIA65C22Implementation {
+    const copy = new VIA65C22Implementation();
+    copy.restoreState(this.saveState());
+    return copy;
+  }
+
   tick(cycles: number): void {
     // Update Timer 1
     if (this.timer1Running) {
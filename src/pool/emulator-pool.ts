@@ -0,0 +1,24 @@
+/**
+ * Pool of emulators sharded across worker threads
+ * Each worker runs one job at a time on a fresh machine; queueing, work
+ * stealing and crash handling come from WorkerPool. Workers cannot load the
+ * native addon, so jobs there run on the generated TypeScript fallback core.
+ */
+
+import * as path from 'path';
+import { PoolJob, PoolJobResult } from './job';
+import { WorkerPool, WorkerPoolOptions, WorkerPoolStats } from './worker-pool';
+
+export type EmulatorPoolOptions = WorkerPoolOptions;
+export type EmulatorPoolStats = WorkerPoolStats;
+
+export class EmulatorPool extends WorkerPool<PoolJob, PoolJobResult> {
+  constructor(options: EmulatorPoolOptions = {}) {
+    super(path.join(__dirname, `worker${path.extname(__filename)}`), options);
+  }
+
+  protected finishJob(result: PoolJobResult, worker: number): PoolJobResult {
+    result.stats.worker = worker;
+    return result;
+  }
+}
@@ -0,0 +1,116 @@
+/**
+ * Self-contained emulator jobs
+ * A job carries everything needed to run a program from reset (configuration,
+ * ROM images, recorded inputs) and produces its serial output and final
+ * state. Jobs are plain data so they can be posted to worker threads.
+ */
+
+import { Emulator } from '../emulator';
+import { SystemConfig, SystemConfigLoader } from '../config/system';
+import { CPUState } from '../core/cpu';
+import { InputLog } from '../debug/input-log';
+import { MemorySerialPort } from '../peripherals/serial-port';
+
+/**
+ * ROM image passed by value
+ */
+export interface PoolROM {
+  data: Uint8Array;
+  address: number;
+}
+
+/**
+ * Memory range to copy out once the job finishes
+ */
+export interface PoolMemoryRange {
+  start: number;
+  length: number;
+}
+
+/**
+ * Program run from reset
+ */
+export interface PoolJob {
+  config?: SystemConfig;      // Default system configuration when omitted
+  roms?: PoolROM[];           // Loaded after config.memory.romImages
+  inputs?: Uint8Array;        // Serialized InputLog, replayed by cycle
+  serialInput?: string;       // Queued on the ACIA when no inputs are replayed
+  maxCycles: number;          // Bus cycle budget
+  breakpoints?: number[];     // Stop early when execution reaches one of these
+  readMemory?: PoolMemoryRange[];
+}
+
+export type PoolStopReason = 'cycles' | 'breakpoint';
+
+/**
+ * Outcome of a job
+ */
+export interface PoolJobResult {
+  serialOutput: Uint8Array;   // Bytes transmitted by the ACIA
+  registers: CPUState;
+  cycles: number;             // Bus cycles executed
+  stopReason: PoolStopReason;
+  memory: Uint8Array[];       // One entry per readMemory range
+  stats: {
+    instructions: number;
+    elapsedMs: number;
+    worker: number;           // Index of the pool worker that ran the job (-1 in-process)
+  };
+}
+
+/**
+ * Run a job to completion on a fresh emulator in the calling thread
+ */
+export async function runPoolJob(job: PoolJob): Promise<PoolJobResult> {
+  if (!(job.maxCycles > 0)) {
+    throw new Error('Job needs a positive maxCycles budget');
+  }
+
+  const emulator = new Emulator(job.config || SystemConfigLoader.getDefaultConfig());
+  await emulator.initialize();
+
+  const bus = emulator.getSystemBus();
+  const memory = bus.getMemory();
+  for (const rom of job.roms || []) {
+    memory.loadROM(rom.data, rom.address);
+  }
+
+  const port = new MemorySerialPort();
+  emulator.connectSerialPort(port);
+
+  if (job.inputs) {
+    emulator.startReplay(InputLog.deserialize(job.inputs));
+  } else {
+    emulator.reset();
+    if (job.serialInput) {
+      port.addReceiveString(job.serialInput);
+    }
+  }
+
+  for (const address of job.breakpoints || []) {
+    bus.getCPU().setBreakpoint(address);
+  }
+
+  const startTime = performance.now();
+  const completed = emulator.runUntilCycle(job.maxCycles);
+  const elapsedMs = performance.now() - startTime;
+
+  return {
+    serialOutput: Uint8Array.from(port.getTransmittedData()),
+    registers: bus.getCPU().getRegisters(),
+    cycles: bus.getCycleCount(),
+    stopReason: completed ? 'cycles' : 'breakpoint',
+    memory: (job.readMemory || []).map(range => {
+      const bytes = new Uint8Array(range.length);
+      for (let i = 0; i < range.length; i++) {
+        bytes[i] = memory.read((range.start + i) & 0xFFFF);
+      }
+      return bytes;
+    }),
+    stats: {
+      instructions: emulator.getStats().instructionsExecuted,
+      elapsedMs,
+      worker: -1
+    }
+  };
+}
@@ -0,0 +1,302 @@
+/**
+ * Pool of worker threads running queued jobs
+ * Each worker runs one job at a time. Submitted jobs are spread round-robin
+ * over per-worker queues; a worker that runs out of work steals from the
+ * tail of the longest queue, so a few long jobs do not hold up the short
+ * ones queued behind them. A worker that dies fails its current job and is
+ * replaced.
+ */
+
+import * as os from 'os';
+import { parentPort, Worker } from 'worker_threads';
+
+export interface WorkerPoolOptions {
+  size?: number;      // Worker count (default: available parallelism)
+  silent?: boolean;   // Discard console output from the workers
+}
+
+export interface WorkerPoolStats {
+  size: number;
+  queued: number;
+  running: number;
+  completed: number;
+  failed: number;
+  stolen: number;     // Jobs run by a worker other than the one they were queued on
+}
+
+export interface WorkerRequest<Job> {
+  id: number;
+  job: Job;
+}
+
+export interface WorkerResponse<Result> {
+  id: number;
+  result?: Result;
+  error?: string;
+}
+
+interface PendingJob<Job, Result> {
+  id: number;
+  job: Job;
+  resolve: (result: Result) => void;
+  reject: (error: Error) => void;
+}
+
+interface PoolWorker<Job, Result> {
+  index: number;
+  worker: Worker;
+  queue: PendingJob<Job, Result>[];
+  running: PendingJob<Job, Result> | null;
+}
+
+/**
+ * Start a worker thread
+ * @param script Entry point; a .ts script is compiled on the fly
+ * @param silent Discard the worker's console output
+ */
+export function spawnWorker(script: string, silent: boolean = false): Worker {
+  const worker = script.endsWith('.ts')
+    // Running from source (ts-node, jest): compile the worker on the fly
+    ? new Worker(`require('ts-node').register({ transpileOnly: true }); require(${JSON.stringify(script)});`,
+        { eval: true, stdout: silent, stderr: silent })
+    : new Worker(script, { stdout: silent, stderr: silent });
+
+  if (silent) {
+    worker.stdout.resume();
+    worker.stderr.resume();
+  }
+  return worker;
+}
+
+/**
+ * Answer WorkerPool requests in a worker thread
+ * @param run Runs one job; a thrown error fails that job only
+ */
+export function serveWorkerJobs<Job, Result>(run: (job: Job) => Promise<Result>): void {
+  if (!parentPort) {
+    return;
+  }
+
+  const port = parentPort;
+  port.on('message', async (request: WorkerRequest<Job>) => {
+    let response: WorkerResponse<Result>;
+    try {
+      response = { id: request.id, result: await run(request.job) };
+    } catch (error) {
+      response = { id: request.id, error: error instanceof Error ? error.message : String(error) };
+    }
+    port.postMessage(response);
+  });
+}
+
+export class WorkerPool<Job, Result> {
+  private workers: PoolWorker<Job, Result>[] = [];
+  private script: string;
+  private options: WorkerPoolOptions;
+  private nextId = 1;
+  private nextWorker = 0;
+  private closed = false;
+  private drainWaiters: Array<() => void> = [];
+  private completed = 0;
+  private failed = 0;
+  private stolen = 0;
+
+  /**
+   * @param script Worker entry point, which calls serveWorkerJobs()
+   */
+  constructor(script: string, options: WorkerPoolOptions = {}) {
+    this.script = script;
+    this.options = options;
+    const size = Math.max(1, options.size || os.availableParallelism());
+    for (let index = 0; index < size; index++) {
+      this.workers.push({ index, worker: this.startWorker(index), queue: [], running: null });
+    }
+  }
+
+  /**
+   * Queue a job
+   * @returns Result once a worker has run the job
+   */
+  submit(job: Job): Promise<Result> {
+    if (this.closed) {
+      return Promise.reject(new Error('Worker pool is closed'));
+    }
+
+    return new Promise((resolve, reject) => {
+      const owner = this.workers[this.nextWorker];
+      this.nextWorker = (this.nextWorker + 1) % this.workers.length;
+      owner.queue.push({ id: this.nextId++, job, resolve, reject });
+
+      // The owner takes it if idle; otherwise any idle worker may steal it
+      this.dispatch(owner);
+      for (const poolWorker of this.workers) {
+        this.dispatch(poolWorker);
+      }
+    });
+  }
+
+  getStats(): WorkerPoolStats {
+    return {
+      size: this.workers.length,
+      queued: this.workers.reduce((total, w) => total + w.queue.length, 0),
+      running: this.workers.filter(w => w.running !== null).length,
+      completed: this.completed,
+      failed: this.failed,
+      stolen: this.stolen
+    };
+  }
+
+  /**
+   * Stop accepting jobs, wait for queued and running ones, then shut the
+   * workers down
+   */
+  async close(): Promise<void> {
+    this.closed = true;
+    if (!this.isIdle()) {
+      await new Promise<void>(resolve => this.drainWaiters.push(resolve));
+    }
+    await this.terminateWorkers();
+  }
+
+  /**
+   * Shut the workers down immediately; queued and running jobs are rejected
+   */
+  async terminate(): Promise<void> {
+    this.closed = true;
+    const error = new Error('Worker pool terminated');
+    for (const poolWorker of this.workers) {
+      for (const pending of poolWorker.queue) {
+        pending.reject(error);
+      }
+      poolWorker.queue = [];
+      if (poolWorker.running) {
+        poolWorker.running.reject(error);
+        poolWorker.running = null;
+      }
+    }
+    await this.terminateWorkers();
+    this.notifyDrained();
+  }
+
+  /**
+   * Adjust a result before it is returned from submit()
+   * @param worker Index of the worker that ran the job
+   */
+  protected finishJob(result: Result, worker: number): Result {
+    return result;
+  }
+
+  private dispatch(poolWorker: PoolWorker<Job, Result>): void {
+    if (poolWorker.running) {
+      return;
+    }
+
+    const next = poolWorker.queue.shift() || this.steal(poolWorker);
+    if (!next) {
+      return;
+    }
+
+    poolWorker.running = next;
+    const request: WorkerRequest<Job> = { id: next.id, job: next.job };
+    poolWorker.worker.postMessage(request);
+  }
+
+  // Owners take from the head of their queue, thieves from the tail
+  private steal(thief: PoolWorker<Job, Result>): PendingJob<Job, Result> | undefined {
+    let victim: PoolWorker<Job, Result> | null = null;
+    for (const poolWorker of this.workers) {
+      if (poolWorker !== thief && poolWorker.queue.length > 0 &&
+          (!victim || poolWorker.queue.length > victim.queue.length)) {
+        victim = poolWorker;
+      }
+    }
+
+    if (!victim) {
+      return undefined;
+    }
+    this.stolen++;
+    return victim.queue.pop();
+  }
+
+  private handleResponse(poolWorker: PoolWorker<Job, Result>, response: WorkerResponse<Result>): void {
+    const pending = poolWorker.running;
+    if (!pending || pending.id !== response.id) {
+      return;
+    }
+    poolWorker.running = null;
+
+    if (response.result !== undefined) {
+      this.completed++;
+      pending.resolve(this.finishJob(response.result, poolWorker.index));
+    } else {
+      this.failed++;
+      pending.reject(new Error(response.error || 'Job failed'));
+    }
+
+    this.dispatch(poolWorker);
+    this.notifyDrained();
+  }
+
+  // A crashed worker fails its current job and is replaced; its queue is kept
+  private handleExit(poolWorker: PoolWorker<Job, Result>, error: Error): void {
+    if (poolWorker.running) {
+      this.failed++;
+      poolWorker.running.reject(error);
+      poolWorker.running = null;
+    }
+
+    console.warn(`Pool worker ${poolWorker.index} exited: ${error.message}`);
+    const replacement: PoolWorker<Job, Result> = {
+      index: poolWorker.index,
+      worker: this.startWorker(poolWorker.index),
+      queue: poolWorker.queue,
+      running: null
+    };
+    this.workers[poolWorker.index] = replacement;
+    this.dispatch(replacement);
+    this.notifyDrained();
+  }
+
+  private startWorker(index: number): Worker {
+    const worker = spawnWorker(this.script, this.options.silent === true);
+
+    let exited = false;
+    const onExit = (error: Error) => {
+      if (!exited) {
+        exited = true;
+        const poolWorker = this.workers[index];
+        if (poolWorker && poolWorker.worker === worker) {
+          this.handleExit(poolWorker, error);
+        }
+      }
+    };
+
+    worker.on('message', (response: WorkerResponse<Result>) => {
+      const poolWorker = this.workers[index];
+      if (poolWorker && poolWorker.worker === worker) {
+        this.handleResponse(poolWorker, response);
+      }
+    });
+    worker.on('error', error => onExit(error));
+    worker.on('exit', code => onExit(new Error(`Worker exited with code ${code}`)));
+    return worker;
+  }
+
+  private async terminateWorkers(): Promise<void> {
+    const workers = this.workers.map(poolWorker => poolWorker.worker);
+    this.workers.forEach(poolWorker => { poolWorker.worker.removeAllListeners(); });
+    await Promise.all(workers.map(worker => worker.terminate()));
+  }
+
+  private isIdle(): boolean {
+    return this.workers.every(poolWorker => poolWorker.queue.length === 0 && poolWorker.running === null);
+  }
+
+  private notifyDrained(): void {
+    if (this.isIdle()) {
+      const waiters = this.drainWaiters;
+      this.drainWaiters = [];
+      waiters.forEach(resolve => resolve());
+    }
+  }
+}
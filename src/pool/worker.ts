@@ -0,0 +1,9 @@
+/**
+ * Worker thread entry point for EmulatorPool
+ * Runs one job at a time and posts the result back to the pool.
+ */
+
+import { runPoolJob } from './job';
+import { serveWorkerJobs } from './worker-pool';
+
+serveWorkerJobs(runPoolJob);
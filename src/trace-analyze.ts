@@ -0,0 +1,208 @@
+#!/usr/bin/env node
+
+/**
+ * Command-line analyzer for binary execution trace files
+ * Reports hot loops, basic blocks, memory access heatmaps and interrupt
+ * timing for one trace, or the first record where two traces differ.
+ */
+
+import fs from 'fs';
+import { CC65SymbolParser } from './cc65/symbol-parser';
+import { CC65DebugInfoParser } from './cc65/debug-info';
+import { formatTraceRecord } from './debug/trace-buffer';
+import { TraceFileReader } from './debug/trace-file';
+import {
+  CycleHistogram, TraceReport, analyzeTraceFile, findTraceDivergence, getTraceReport, histogramPercentile
+} from './debug/trace-analyzer';
+
+const USAGE = `Usage:
+  trace-analyze <trace> [--top <count>] [--workers <count>] [--symbols <file>]
+  trace-analyze diff <good-trace> <bad-trace> [--context <count>] [--symbols <file>]
+Symbols are read from a label file or, for .dbg files, ld65 debug info.`;
+
+// Darker is busier, in ten steps
+const SHADES = ' .:-=+*#%@';
+
+interface Options {
+  files: string[];
+  top: number;
+  workers?: number;
+  context: number;
+  symbols?: CC65SymbolParser;
+}
+
+function parseArguments(args: string[]): Options {
+  const options: Options = { files: [], top: 20, context: 8 };
+  for (let i = 0; i < args.length; i++) {
+    const arg = args[i];
+    if (arg.startsWith('--')) {
+      const value = args[++i];
+      if (value === undefined) {
+        throw new Error(`Missing value for ${arg}`);
+      }
+      const number = parseInt(value);
+      switch (arg) {
+        case '--top':
+          options.top = number;
+          break;
+        case '--workers':
+          options.workers = number;
+          break;
+        case '--context':
+          options.context = number;
+          break;
+        case '--symbols':
+          options.symbols = new CC65SymbolParser();
+          if (value.endsWith('.dbg')) {
+            const debugInfo = new CC65DebugInfoParser();
+            debugInfo.parseDebugFile(fs.readFileSync(value, 'utf8'));
+            options.symbols.loadDebugInfo(debugInfo);
+          } else {
+            options.symbols.parseSymbolFile(fs.readFileSync(value, 'utf8'));
+          }
+          continue;
+        default:
+          throw new Error(`Unknown option ${arg}`);
+      }
+      if (isNaN(number) || number < 0) {
+        throw new Error(`Invalid value for ${arg}: ${value}`);
+      }
+    } else {
+      options.files.push(arg);
+    }
+  }
+  return options;
+}
+
+function hex(value: number, digits: number = 4): string {
+  return value.toString(16).toUpperCase().padStart(digits, '0');
+}
+
+// Symbol containing address as name+offset, or an empty string
+function symbolName(address: number, symbols?: CC65SymbolParser): string {
+  const found = symbols ? symbols.findSymbolForAddress(address) : undefined;
+  return found ? `${found.symbol.name}${found.offset ? `+${found.offset}` : ''}` : '';
+}
+
+function label(address: number, symbols?: CC65SymbolParser): string {
+  const name = symbolName(address, symbols);
+  return name ? `$${hex(address)} ${name}` : `$${hex(address)}`;
+}
+
+function printHistogram(title: string, histogram: CycleHistogram): void {
+  if (histogram.count === 0) {
+    console.log(`${title}: none`);
+    return;
+  }
+  console.log(`${title}: ${histogram.count} samples, min ${histogram.min}, ` +
+    `mean ${(histogram.total / histogram.count).toFixed(1)}, p50 <= ${histogramPercentile(histogram, 0.5)}, ` +
+    `p99 <= ${histogramPercentile(histogram, 0.99)}, max ${histogram.max} cycles`);
+  const peak = Math.max(...histogram.buckets);
+  histogram.buckets.forEach((count, bucket) => {
+    if (count > 0) {
+      const range = bucket === 0 ? '0' : `${2 ** (bucket - 1)}-${2 ** bucket - 1}`;
+      console.log(`  ${range.padStart(15)}  ${count.toString().padStart(10)}  ${'#'.repeat(Math.max(1, Math.round((count / peak) * 40)))}`);
+    }
+  });
+}
+
+function printReport(report: TraceReport, clockHz: number, elapsedMs: number, symbols?: CC65SymbolParser): void {
+  console.log(`${report.records} records (${report.instructions} instructions, ${report.interrupts} interrupts), ` +
+    `${report.cycles} cycles (${((report.cycles / clockHz) * 1000).toFixed(1)} ms emulated), analyzed in ${elapsedMs.toFixed(0)} ms`);
+  if (report.lost > 0) {
+    console.log(`${report.lost} records were lost before they reached the file; results span the gaps`);
+  }
+
+  console.log('\nHot loops');
+  console.log('  Start           Branch        Iterations      Cycles');
+  for (const loop of report.loops) {
+    console.log(`  ${label(loop.to, symbols).padEnd(14)}  $${hex(loop.from)}  ${loop.iterations.toString().padStart(16)}  ` +
+      `${loop.cycles.toString().padStart(10)}`);
+  }
+
+  console.log('\nBasic blocks');
+  console.log('  Block                 Instructions  Executions      Cycles');
+  for (const block of report.blocks) {
+    console.log(`  ${`${label(block.address, symbols)}-$${hex(block.end)}`.padEnd(20)}  ${block.instructions.toString().padStart(12)}  ` +
+      `${block.executions.toString().padStart(10)}  ${block.cycles.toString().padStart(10)}`);
+  }
+
+  console.log('\nMemory heatmap (accesses per page, rows of 16 pages)');
+  const peak = Math.max(1, ...report.pages.map(page => page.reads + page.writes));
+  for (let row = 0; row < 16; row++) {
+    const cells = report.pages.slice(row * 16, row * 16 + 16).map(page => {
+      const accesses = page.reads + page.writes;
+      return accesses === 0 ? ' ' : SHADES[Math.max(1, Math.ceil((accesses / peak) * (SHADES.length - 1)))];
+    });
+    console.log(`  $${hex(row * 16, 2)}00  |${cells.join('')}|`);
+  }
+  console.log('\n  Address              Reads      Writes');
+  for (const hotspot of report.hotAddresses) {
+    console.log(`  ${label(hotspot.address, symbols).padEnd(16)}  ${hotspot.reads.toString().padStart(10)}  ${hotspot.writes.toString().padStart(10)}`);
+  }
+  if (report.unresolvedAccesses > 0) {
+    console.log(`  ${report.unresolvedAccesses} indirect accesses not resolved`);
+  }
+
+  console.log('');
+  printHistogram('Interrupt service time', report.service);
+  printHistogram('Interval between interrupts', report.intervals);
+}
+
+/**
+ * Main entry point for the trace analyzer
+ */
+export async function main(args: string[]): Promise<number> {
+  let options: Options;
+  try {
+    options = parseArguments(args);
+  } catch (error) {
+    console.error(error instanceof Error ? error.message : error);
+    console.error(USAGE);
+    return 2;
+  }
+
+  if (options.files[0] === 'diff' && options.files.length === 3) {
+    const divergence = findTraceDivergence(options.files[1], options.files[2], options.context);
+    if (!divergence) {
+      console.log('Traces are identical');
+      return 0;
+    }
+    console.log(`Traces diverge at record ${divergence.index} (${divergence.fields.join(', ')})`);
+    for (const record of divergence.context) {
+      console.log(`  ${formatTraceRecord(record)}`);
+    }
+    const show = (name: string, record: typeof divergence.a) => {
+      const where = record && options.symbols ? symbolName(record.pc, options.symbols) : '';
+      const source = record && options.symbols ? options.symbols.getSourceLocation(record.pc) : undefined;
+      console.log(`${name} ${record ? formatTraceRecord(record) : '(end of trace)'}${where ? `  ${where}` : ''}` +
+        `${source ? `  ${source.file}:${source.line}` : ''}`);
+    };
+    show('-', divergence.a);
+    show('+', divergence.b);
+    return 1;
+  }
+
+  if (options.files.length !== 1) {
+    console.error(USAGE);
+    return 2;
+  }
+
+  const start = performance.now();
+  const reader = new TraceFileReader(options.files[0]);
+  const clockHz = reader.clockHz || 1000000;
+  reader.close();
+  const stats = await analyzeTraceFile(options.files[0], { workers: options.workers });
+  printReport(getTraceReport(stats, options.top), clockHz, performance.now() - start, options.symbols);
+  return 0;
+}
+
+// Run if this file is executed directly
+if (require.main === module) {
+  main(process.argv.slice(2)).then(code => {
+    process.exitCode = code;
+  }).catch(error => {
+    console.error('Trace analyzer error:', error instanceof Error ? error.message : error);
+    process.exit(1);
+  });
+}
@@ -361,5 +361,53 @@ describe('Emulator Integration Tests', () => {
       expect(stats.totalCycles).toBeGreaterThan(0);
       expect(stats.executionTimeMs).toBeGreaterThan(0);
     });
+
+    test('should run past the target clock speed in turbo mode', async () => {
+      // NOP / JMP $C000
+      const program = new Uint8Array([0xEA, 0x4C, 0x00, 0xC0]);
+      emulator.getSystemBus().getMemory().loadROM(program, 0xC000);
+      emulator.getSystemBus().getCPU().setRegisters({ PC: 0xC000 });
+
+      emulator.setClockSpeed(10000);
+      emulator.setTurboMode(true, 5);
+      expect(() => emulator.setTurboMode(true, 0)).toThrow('Invalid latency budget');
+
+      // The event loop still gets a turn at least once per latency budget
+      let ticks = 0;
+      const ticker = setInterval(() => ticks++, 1);
+      emulator.start();
+      await new Promise(resolve => setTimeout(resolve, 300));
+      clearInterval(ticker);
+      emulator.stop();
+
+      // A paced run would have executed about 3000 cycles
+      expect(emulator.getStats().totalCycles).toBeGreaterThan(30000);
+      expect(emulator.getEffectiveMHz()).toBeGreaterThan(0.1);
+      expect(ticks).toBeGreaterThan(5);
+    });
+
+    test('should run for emulated time in virtual clock mode', async () => {
+      // INX / NOP / JMP $C000: 7 cycles per iteration
+      const program = new Uint8Array([0xE8, 0xEA, 0x4C, 0x00, 0xC0]);
+      emulator.getSystemBus().getMemory().loadROM(program, 0xC000);
+      emulator.getSystemBus().getCPU().setRegisters({ PC: 0xC000 });
+      emulator.setClockMode('virtual');
+
+      // 100 ms of emulated time at 1 MHz
+      expect(await emulator.runFor(100)).toBe(true);
+
+      const stats = emulator.getStats();
+      expect(stats.totalCycles).toBeGreaterThanOrEqual(100000);
+      expect(stats.totalCycles).toBeLessThan(100007);
+      expect(stats.clockSpeed).toBeCloseTo(1000000);
+      expect(stats.executionTimeMs).toBeCloseTo(stats.totalCycles / 1000);
+      expect(emulator.getEmulatedTime()).toBeCloseTo(stats.totalCycles / 1000);
+      expect(emulator.getState()).toBe(EmulatorState.PAUSED);
+
+      // Breakpoints end the run early
+      emulator.getSystemBus().getCPU().setBreakpoint(0xC001);
+      expect(await emulator.runFor(10)).toBe(false);
+      expect(emulator.getSystemBus().getCPU().getRegisters().PC).toBe(0xC001);
+    });
   });
 });
\ No newline at end of file
@@ -4,7 +4,7 @@
 
 import { Emulator } from '../../src/emulator';
 import { SystemConfigLoader } from '../../src/config/system';
-import { EmulatorBenchmark } from '../../src/performance/benchmark';
+import { EmulatorBenchmark, benchmarkCPUCores } from '../../src/performance/benchmark';
 
 describe('Performance Benchmarks', () => {
   let emulator: Emulator;
@@ -14,6 +14,8 @@ describe('Performance Benchmarks', () => {
     const config = SystemConfigLoader.getDefaultConfig();
     emulator = new Emulator(config);
     await emulator.initialize();
+    // Workloads run for emulated time, so results do not depend on host load
+    emulator.setClockMode('virtual');
     benchmark = new EmulatorBenchmark(emulator);
   });
 
@@ -32,6 +34,17 @@ describe('Performance Benchmarks', () => {
     expect(result.efficiency).toBeGreaterThan(0);
   }, 10000);
 
+  test('CPU core comparison', () => {
+    const results = benchmarkCPUCores(200000);
+    const fallback = results.find(r => r.core === 'typescript')!;
+
+    expect(fallback.cycles).toBeGreaterThanOrEqual(200000);
+    expect(fallback.instructions).toBeGreaterThan(0);
+    expect(fallback.cyclesPerSecond).toBeGreaterThan(0);
+    // Both cores run the same program, so they agree on the work done
+    results.forEach(result => expect(result.instructions).toBe(fallback.instructions));
+  });
+
   test('Memory access benchmark', async () => {
     const result = await benchmark['runMemoryBenchmark']();
     
@@ -117,6 +130,25 @@ describe('Performance Benchmarks', () => {
     expect(breakpointManager.getCount()).toBe(2);
   });
 
+  test('Adaptive chunk sizing', () => {
+    const speedController = emulator.getOptimizer().getSpeedController();
+    speedController.setTargetSpeed(1000000);
+    const fullChunk = speedController.getCyclesPerChunk();
+
+    // 1 us per cycle: a 4 ms stall budget allows 4000 cycles
+    speedController.setMaxStall(4);
+    speedController.recordChunk(fullChunk, fullChunk / 1000);
+    expect(speedController.getCyclesPerChunk()).toBe(4000);
+
+    // A cheap host keeps the ~16 ms chunk
+    for (let i = 0; i < 20; i++) {
+      speedController.recordChunk(4000, 0.4);
+    }
+    expect(speedController.getCyclesPerChunk()).toBe(fullChunk);
+
+    expect(() => speedController.setMaxStall(0)).toThrow('Invalid stall budget');
+  });
+
   test('Benchmark result export', async () => {
     // Create a minimal benchmark suite
     const suite = {
@@ -2,7 +2,7 @@
  * Jest test wrapper for regression test suite
  */
 
-import { RegressionTestRunner } from './regression-test-suite';
+import { RegressionSuite, RegressionTestRunner } from './regression-test-suite';
 
 describe('Regression Test Suite', () => {
   let runner: RegressionTestRunner;
@@ -42,6 +42,30 @@ describe('Regression Test Suite', () => {
     console.log(`Regression suite completed: ${suite.summary.passed}/${suite.summary.totalTests} tests passed (${suite.summary.successRate.toFixed(1)}%)`);
   }, 60000); // 60 second timeout for full suite
 
+  test('Shard the suite on the fallback core with the same results', async () => {
+    // Sharded workers run the fallback core; the default run is in-process
+    const streamed: string[] = [];
+    const sharded = await runner.runRegressionSuite({ workers: 4, onResult: result => streamed.push(result.testName) });
+    const sequential = await new RegressionTestRunner().runRegressionSuite();
+
+    expect(sharded.results.map(r => r.testName)).toEqual(runner.getTestNames());
+    expect(streamed.sort()).toEqual([...runner.getTestNames()].sort());
+
+    // The performance baseline depends on host load, so only its presence
+    // is compared; every other test must agree exactly
+    const timed = ['Performance Baseline'];
+    const outcomes = (suite: RegressionSuite) => suite.results
+      .filter(r => !timed.includes(r.testName))
+      .map(r => [r.testName, r.passed, r.error]);
+    expect(outcomes(sharded)).toEqual(outcomes(sequential));
+    timed.forEach(testName => {
+      const result = sharded.results.find(r => r.testName === testName);
+      expect(result?.passed ? result.metrics : result?.error).toBeDefined();
+    });
+    expect(sharded.summary.totalTests).toBe(sequential.summary.totalTests);
+    expect(sharded.summary.passed + sharded.summary.failed).toBe(sharded.summary.totalTests);
+  }, 60000);
+
   test('Export regression results', async () => {
     const suite = await runner.runRegressionSuite();
     const exported = runner.exportResults(suite);
@@ -1,11 +1,14 @@
 /**
  * Automated regression test suite
- * Ensures that changes don't break existing functionality
+ * Ensures that changes don't break existing functionality. Tests run in
+ * turn on the native core by default, or sharded over worker threads on
+ * the fallback core, and are reported as they complete.
  */
 
 import { Emulator } from '../../src/emulator';
 import { SystemConfigLoader } from '../../src/config/system';
 import { EmulatorBenchmark } from '../../src/performance/benchmark';
+import { WorkerPool } from '../../src/pool/worker-pool';
 import * as fs from 'fs';
 import * as path from 'path';
 
@@ -29,48 +32,84 @@ export interface RegressionSuite {
   };
 }
 
+export interface RegressionRunOptions {
+  // Worker threads (default: 0, every test here in turn). Workers cannot
+  // load the native addon, so a sharded run tests the fallback core only.
+  workers?: number;
+  onResult?: (result: RegressionTestResult) => void;  // Called as each test completes
+}
+
 /**
  * Regression test runner
  */
 export class RegressionTestRunner {
   private emulator: Emulator;
+  private initialized = false;
   private testResults: RegressionTestResult[] = [];
 
+  // Suite order, which is also the order of the results
+  private readonly tests: Array<{ name: string; run: () => Promise<any> }> = [
+    // Core functionality tests
+    { name: 'CPU Basic Instructions', run: () => this.testCPUBasicInstructions() },
+    { name: 'Memory Management', run: () => this.testMemoryManagement() },
+    { name: 'Interrupt Handling', run: () => this.testInterruptHandling() },
+
+    // Peripheral tests
+    { name: 'ACIA Functionality', run: () => this.testACIAFunctionality() },
+    { name: 'VIA Functionality', run: () => this.testVIAFunctionality() },
+
+    // System integration tests
+    { name: 'ROM Loading', run: () => this.testROMLoading() },
+    { name: 'Configuration Loading', run: () => this.testConfigurationLoading() },
+
+    // Performance regression tests
+    { name: 'Performance Baseline', run: () => this.testPerformanceBaseline() },
+
+    // CC65 compatibility tests
+    { name: 'CC65 Compatibility', run: () => this.testCC65Compatibility() },
+
+    // Debug features tests
+    { name: 'Debug Features', run: () => this.testDebugFeatures() }
+  ];
+
   constructor() {
     const config = SystemConfigLoader.getDefaultConfig();
     this.emulator = new Emulator(config);
   }
 
+  /**
+   * Names of the tests in suite order
+   */
+  getTestNames(): string[] {
+    return this.tests.map(test => test.name);
+  }
+
   /**
    * Run complete regression test suite
    */
-  async runRegressionSuite(): Promise<RegressionSuite> {
+  async runRegressionSuite(options: RegressionRunOptions = {}): Promise<RegressionSuite> {
     console.log('Starting regression test suite...');
-    
-    await this.emulator.initialize();
-    this.testResults = [];
 
-    // Core functionality tests
-    await this.runTest('CPU Basic Instructions', () => this.testCPUBasicInstructions());
-    await this.runTest('Memory Management', () => this.testMemoryManagement());
-    await this.runTest('Interrupt Handling', () => this.testInterruptHandling());
-    
-    // Peripheral tests
-    await this.runTest('ACIA Functionality', () => this.testACIAFunctionality());
-    await this.runTest('VIA Functionality', () => this.testVIAFunctionality());
-    
-    // System integration tests
-    await this.runTest('ROM Loading', () => this.testROMLoading());
-    await this.runTest('Configuration Loading', () => this.testConfigurationLoading());
-    
-    // Performance regression tests
-    await this.runTest('Performance Baseline', () => this.testPerformanceBaseline());
-    
-    // CC65 compatibility tests
-    await this.runTest('CC65 Compatibility', () => this.testCC65Compatibility());
-    
-    // Debug features tests
-    await this.runTest('Debug Features', () => this.testDebugFeatures());
+    const names = this.getTestNames();
+    const workers = Math.min(options.workers ?? 0, names.length);
+    const report = (result: RegressionTestResult) => {
+      const duration = result.duration.toFixed(2);
+      console.log(result.passed ? `✓ ${result.testName} (${duration}ms)` : `✗ ${result.testName} (${duration}ms): ${result.error}`);
+      if (options.onResult) {
+        options.onResult(result);
+      }
+    };
+
+    if (workers > 0) {
+      this.testResults = await this.runSharded(names, workers, report);
+    } else {
+      this.testResults = [];
+      for (const name of names) {
+        const result = await this.runTest(name);
+        this.testResults.push(result);
+        report(result);
+      }
+    }
 
     const summary = this.calculateSummary();
     
@@ -83,39 +122,65 @@ export class RegressionTestRunner {
   }
 
   /**
-   * Run individual test with error handling
+   * Run individual test with error handling on this runner's emulator
    */
-  private async runTest(testName: string, testFunction: () => Promise<any>): Promise<void> {
+  async runTest(testName: string): Promise<RegressionTestResult> {
+    const test = this.tests.find(entry => entry.name === testName);
+    if (!test) {
+      throw new Error(`Unknown regression test: ${testName}`);
+    }
+    if (!this.initialized) {
+      await this.emulator.initialize();
+      this.initialized = true;
+    }
+
     const startTime = performance.now();
+    let result: RegressionTestResult;
     
     try {
       console.log(`Running: ${testName}`);
-      const metrics = await testFunction();
-      const duration = performance.now() - startTime;
-      
-      this.testResults.push({
+      const metrics = await test.run();
+      result = {
         testName,
         passed: true,
         metrics,
-        duration
-      });
-      
-      console.log(`✓ ${testName} (${duration.toFixed(2)}ms)`);
+        duration: performance.now() - startTime
+      };
     } catch (error) {
-      const duration = performance.now() - startTime;
-      
-      this.testResults.push({
+      result = {
         testName,
         passed: false,
         error: error instanceof Error ? error.message : String(error),
-        duration
-      });
-      
-      console.log(`✗ ${testName} (${duration.toFixed(2)}ms): ${error}`);
+        duration: performance.now() - startTime
+      };
     }
     
     // Reset emulator state between tests
     this.emulator.reset();
+    return result;
+  }
+
+  /**
+   * Run tests on worker threads, each with its own runner and emulator
+   * Idle workers take the next test, so one slow test does not hold up
+   * the others. A test whose worker dies fails with the worker's error.
+   * @returns Results in the order of names
+   */
+  private async runSharded(names: string[], workers: number,
+      report: (result: RegressionTestResult) => void): Promise<RegressionTestResult[]> {
+    const script = path.join(__dirname, `regression-worker${path.extname(__filename)}`);
+    const pool = new WorkerPool<string, RegressionTestResult>(script, { size: workers, silent: true });
+    try {
+      return await Promise.all(names.map(async name => {
+        const startTime = performance.now();
+        const result = await pool.submit(name).catch((error: Error): RegressionTestResult =>
+          ({ testName: name, passed: false, error: error.message, duration: performance.now() - startTime }));
+        report(result);
+        return result;
+      }));
+    } finally {
+      await pool.close();
+    }
   }
 
   /**
@@ -486,4 +551,4 @@ export class RegressionTestRunner {
     
     return lines.join('\n');
   }
-}
\ No newline at end of file
+}
@@ -0,0 +1,11 @@
+/**
+ * Worker thread entry point for sharded regression runs
+ * Runs each test name it is sent on its own runner and emulator and posts
+ * the result back.
+ */
+
+import { serveWorkerJobs } from '../../src/pool/worker-pool';
+import { RegressionTestRunner } from './regression-test-suite';
+
+const runner = new RegressionTestRunner();
+serveWorkerJobs((testName: string) => runner.runTest(testName));
@@ -0,0 +1,118 @@
+import { execFileSync } from 'child_process';
+import * as path from 'path';
+import { BatchEmulator } from '../../src/core/batch';
+import { CPU6502Emulator } from '../../src/core/cpu';
+
+// Small deterministic generator so failures can be reproduced
+function random(seed: number): () => number {
+  let state = seed >>> 0;
+  return () => {
+    state = (Math.imul(state, 1664525) + 1013904223) >>> 0;
+    return state >>> 24;
+  };
+}
+
+// Sum 1..n for n at $10 and write the low byte to $F000
+// LDX $10 / LDA #0 / loop: CPX #0 / BEQ done / STX $11 / CLC / ADC $11 /
+// DEX / BNE loop / done: STA $F000
+const SUM_PROGRAM = [
+  0xA6, 0x10, 0xA9, 0x00, 0xE0, 0x00, 0xF0, 0x08, 0x86, 0x11,
+  0x18, 0x65, 0x11, 0xCA, 0xD0, 0xF4, 0x8D, 0x00, 0xF0
+];
+const SUM_DONE = 0x0200 + SUM_PROGRAM.length;
+
+describe('Batch engine tables', () => {
+  it('should be generated from the current native tables', () => {
+    const script = path.join(__dirname, '../../scripts/generate-batch-tables.js');
+    expect(() => execFileSync(process.execPath, [script, '--check'], { stdio: 'pipe' })).not.toThrow();
+  });
+});
+
+// The batch engine lives in the native addon
+const describeNative = BatchEmulator.isAvailable() ? describe : describe.skip;
+
+describeNative('BatchEmulator', () => {
+  it('should run one program over many input vectors', () => {
+    const batch = new BatchEmulator({ lanes: 64, stopAddress: SUM_DONE, outputAddress: 0xF000 });
+    batch.loadImage(Uint8Array.from(SUM_PROGRAM), 0x0200);
+    batch.loadImage(Uint8Array.from([0x00, 0x02]), 0xFFFC);
+    for (let lane = 0; lane < batch.lanes; lane++) {
+      batch.write(lane, 0x10, lane);
+    }
+    batch.reset();
+
+    expect(batch.run(100000)).toBe(0);
+    for (let lane = 0; lane < batch.lanes; lane++) {
+      expect(batch.getLaneStatus(lane)).toBe('stopped');
+      expect(Array.from(batch.getOutput(lane))).toEqual([(lane * (lane + 1) / 2) & 0xFF]);
+    }
+    // Longer inputs take more iterations
+    expect(batch.getRegisters(63).cycles).toBeGreaterThan(batch.getRegisters(1).cycles);
+  });
+
+  it('should stop lanes at the cycle budget and continue them later', () => {
+    const batch = new BatchEmulator({ lanes: 2 });
+    // INC $20 / JMP $0200, and a ROM page the program cannot change
+    batch.loadImage(Uint8Array.from([0xE6, 0x20, 0xEE, 0x00, 0x30, 0x4C, 0x00, 0x02]), 0x0200);
+    batch.protect(0x3000, 0x30FF);
+    batch.setRegisters({ PC: 0x0200, SP: 0xFD, P: 0x24 });
+
+    expect(batch.run(110)).toBe(2);
+    expect(batch.getRegisters(0).cycles).toBeGreaterThanOrEqual(110);
+    expect(batch.read(0, 0x20)).toBe(8);
+    expect(batch.read(0, 0x3000)).toBe(0);
+
+    batch.run(110);
+    expect(batch.read(1, 0x20)).toBe(16);
+  });
+
+  it('should halt lanes that jump to themselves', () => {
+    const batch = new BatchEmulator({ lanes: 3 });
+    // LDA $10 / BEQ * / JMP *
+    batch.loadImage(Uint8Array.from([0xA5, 0x10, 0xF0, 0xFE, 0x4C, 0x04, 0x02]), 0x0200);
+    batch.write(1, 0x10, 1);
+    batch.setRegisters({ PC: 0x0200 });
+
+    expect(batch.run(1000)).toBe(0);
+    expect(batch.getRegisters(0).PC).toBe(0x0202);
+    expect(batch.getRegisters(1).PC).toBe(0x0204);
+    expect(batch.getLaneStatus(2)).toBe('spin');
+    expect(() => batch.getRegisters(3)).toThrow('Invalid lane');
+  });
+
+  it('should match the single-instance core on random code', () => {
+    const lanes = 24;
+    const budget = 4000;
+    const batch = new BatchEmulator({ lanes });
+    const images: Uint8Array[] = [];
+    for (let lane = 0; lane < lanes; lane++) {
+      const next = random(lane + 1);
+      const image = Uint8Array.from({ length: 0x10000 }, () => next());
+      images.push(image);
+      batch.loadImage(image, 0, lane);
+      batch.setRegisters({ PC: (next() << 8) | next(), A: next(), X: next(), Y: next(), SP: next(), P: next() | 0x20, cycles: 0 }, lane);
+    }
+    const initial = Array.from({ length: lanes }, (_, lane) => batch.getRegisters(lane));
+    batch.run(budget);
+
+    const cpu = new CPU6502Emulator();
+    for (let lane = 0; lane < lanes; lane++) {
+      const memory = images[lane].slice();
+      cpu.setMemoryCallbacks(address => memory[address], (address, value) => { memory[address] = value; });
+      cpu.setRegisters(initial[lane]);
+
+      let cycles = 0;
+      while (cycles < budget) {
+        const pc = cpu.getRegisters().PC;
+        cycles += cpu.step();
+        if (cpu.getRegisters().PC === pc) {
+          break;
+        }
+      }
+
+      const expected = cpu.getRegisters();
+      expect({ ...batch.getRegisters(lane), lane }).toEqual({ ...expected, cycles, lane });
+      expect(Buffer.compare(batch.readRange(lane, 0, 0x10000), memory)).toBe(0);
+    }
+  });
+});
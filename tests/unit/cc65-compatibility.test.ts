@@ -2,6 +2,9 @@
  * Unit tests for CC65 Compatibility Manager
  */
 
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
 import { CC65CompatibilityManager } from '../../src/cc65/compatibility';
 
 describe('CC65CompatibilityManager', () => {
@@ -163,6 +166,36 @@ describe('CC65CompatibilityManager', () => {
     });
   });
 
+  describe('debug info', () => {
+    it('should stream an ld65 debug file and map addresses to source', async () => {
+      const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'cc65-'));
+      const file = path.join(directory, 'program.dbg');
+      fs.writeFileSync(file, [
+        'version\tmajor=2,minor=0',
+        'file\tid=0,name="main.s",size=10,mtime=0,mod=0',
+        'line\tid=0,file=0,line=7,span=0',
+        'seg\tid=0,name="CODE",start=0x000800,size=0x0003,addrsize=absolute,type=ro',
+        'span\tid=0,seg=0,start=0,size=3',
+        'scope\tid=0,name="",mod=0,size=3,span=0',
+        'scope\tid=1,name="reset",mod=0,type=scope,size=3,parent=0,sym=0,span=0',
+        'sym\tid=0,name="reset",addrsize=absolute,scope=0,def=0,val=0x800,seg=0,type=lab'
+      ].join('\r\n'));
+      try {
+        await manager.initialize({ memoryLayout: 'homebrew', debugFile: file });
+        expect(manager.getSourceLocation(0x0802)).toEqual({ file: 'main.s', line: 7, scope: 'reset' });
+        expect(manager.getSourceLocation(0x0803)).toBeUndefined();
+        expect(manager.getSymbolAtAddress(0x0800)!.name).toBe('reset');
+        expect(manager.getLineRanges()).toEqual([{ file: 'main.s', line: 7, start: 0x0800, end: 0x0803 }]);
+      } finally {
+        fs.rmSync(directory, { recursive: true, force: true });
+      }
+    });
+
+    it('should report a missing debug file', async () => {
+      await expect(manager.loadDebugFile('/nonexistent/program.dbg')).rejects.toThrow('Failed to load debug info file');
+    });
+  });
+
   describe('configuration validation', () => {
     it('should validate correct configuration', async () => {
       await manager.initialize({ memoryLayout: 'homebrew' });
@@ -0,0 +1,178 @@
+/**
+ * Unit tests for the CC65 debug info parser
+ */
+
+import { Readable } from 'stream';
+import { CC65DebugInfoParser } from '../../src/cc65/debug-info';
+import { CC65SymbolParser } from '../../src/cc65/symbol-parser';
+
+// main.c compiled with cc65 -g, util.s from a library, as ld65 --dbgfile writes them
+const DEBUG_INFO = `version\tmajor=2,minor=0
+info\tcsym=1,file=2,lib=1,line=8,mod=2,scope=4,seg=2,span=9,sym=6,type=1
+file\tid=0,name="main.c",size=200,mtime=0x65000000,mod=0
+file\tid=1,name="util, v2.s",size=300,mtime=0x65000001,mod=1
+lib\tid=0,name="/usr/share/cc65/lib/none.lib"
+line\tid=0,file=0,line=5,type=1,span=0
+line\tid=1,file=0,line=6,type=1,span=1
+line\tid=2,file=1,line=10,span=2
+line\tid=3,file=1,line=11,span=3
+line\tid=4,file=1,line=12,span=4
+line\tid=5,file=1,line=3,type=2,count=1,span=4
+line\tid=6,file=1,line=20,span=6
+line\tid=7,file=1,line=2
+mod\tid=0,name="main.o",file=0
+mod\tid=1,name="util.o",file=1,lib=0
+seg\tid=0,name="CODE",start=0x000800,size=0x0018,addrsize=absolute,type=ro,oname="a.out",ooffs=2
+seg\tid=1,name="DATA",start=0x001000,size=0x0004,addrsize=absolute,type=rw,oname="a.out",ooffs=26
+span\tid=0,seg=0,start=0,size=8,type=0
+span\tid=1,seg=0,start=8,size=4
+span\tid=2,seg=0,start=16,size=2
+span\tid=3,seg=0,start=18,size=3
+span\tid=4,seg=0,start=21,size=3
+span\tid=5,seg=0,start=0,size=12
+span\tid=6,seg=1,start=0,size=4
+span\tid=7,seg=0,start=16,size=8
+span\tid=8,seg=0,start=18,size=3
+scope\tid=0,name="",mod=0,size=12,span=5
+scope\tid=1,name="",mod=1,size=8,span=7
+scope\tid=2,name="delay",mod=1,type=scope,size=8,parent=1,sym=3,span=7
+scope\tid=3,name="inner",mod=1,type=scope,size=3,parent=2,span=8
+sym\tid=0,name="_main",addrsize=absolute,size=12,scope=0,def=0,val=0x800,seg=0,type=lab
+sym\tid=1,name="_data",addrsize=absolute,scope=0,def=6,val=0x1000,seg=1,type=lab
+sym\tid=2,name="VIA",addrsize=absolute,scope=1,def=7,val=0x6000,type=equ
+sym\tid=3,name="delay",addrsize=absolute,size=8,scope=1,def=2,ref=1,val=0x810,seg=0,type=lab
+sym\tid=4,name="@loop",addrsize=absolute,scope=2,parent=3,def=3+4,val=0x812,seg=0,type=lab
+sym\tid=5,name="delay",addrsize=absolute,scope=0,ref=1,exp=3,type=imp
+csym\tid=0,name="main",scope=0,type=0,sc=ext,sym=0
+type\tid=0,val="800410"
+`;
+
+describe('CC65DebugInfoParser', () => {
+  let parser: CC65DebugInfoParser;
+
+  beforeEach(() => {
+    parser = new CC65DebugInfoParser();
+    parser.parseDebugFile(DEBUG_INFO);
+  });
+
+  it('should parse every record type', () => {
+    expect(parser.getFiles().map(file => file.name)).toEqual(['main.c', 'util, v2.s']);
+    expect(parser.getFile(1)).toEqual({ id: 1, name: 'util, v2.s', size: 300, mtime: 0x65000001, modules: [1] });
+    expect(parser.getModule(1)).toEqual({ id: 1, name: 'util.o', file: 1, library: 0 });
+    expect(parser.getModule(0)!.library).toBe(-1);
+    expect(parser.getLibrary(0)!.name).toBe('/usr/share/cc65/lib/none.lib');
+    expect(parser.getSegments()[1]).toEqual({
+      id: 1, name: 'DATA', start: 0x1000, size: 4, addressSize: 'absolute', type: 'rw', outputName: 'a.out', outputOffset: 26
+    });
+    expect(parser.getSpan(3)).toEqual({ id: 3, segment: 0, start: 0x0812, size: 3, type: -1 });
+    expect(parser.getScope(3)).toEqual({ id: 3, name: 'inner', module: 1, type: 'scope', size: 3, parent: 2, symbol: -1, spans: [8] });
+    expect(parser.getLine(5)).toEqual({ id: 5, file: 1, line: 3, type: 2, count: 1, spans: [4] });
+    expect(parser.getSymbol(4)).toEqual(expect.objectContaining({
+      name: '@loop', value: 0x812, scope: 2, parent: 3, segment: 0, definitions: [3, 4], references: []
+    }));
+    expect(parser.getSymbolsByName('delay').map(symbol => symbol.type)).toEqual(['lab', 'imp']);
+    expect(parser.getSymbol(5)!.value).toBeNaN();
+    expect(parser.getSymbol(5)!.exportId).toBe(3);
+    expect(parser.getCSymbols()).toEqual([{ id: 0, name: 'main', scope: 0, type: 0, storage: 'ext', offset: 0, symbol: 0 }]);
+    expect(parser.getType(0)!.value).toBe('800410');
+  });
+
+  it('should reject other major versions', () => {
+    expect(() => parser.parseDebugFile('version\tmajor=3,minor=0\n')).toThrow('Unsupported debug info version 3.0');
+  });
+
+  it('should find the innermost scope containing an address', () => {
+    expect(parser.getScopeAt(0x0805)!.id).toBe(0);
+    expect(parser.getScopeAt(0x0811)!.name).toBe('delay');  // Covers the same bytes as the module scope
+    const inner = parser.getScopeAt(0x0813)!;
+    expect(parser.getScopeName(inner)).toBe('delay::inner');
+    expect(parser.getScopeAt(0x0817)!.name).toBe('delay');
+    expect(parser.getScopeAt(0x080E)).toBeUndefined();
+    expect(parser.getScopeAt(0x0818)).toBeUndefined();
+  });
+
+  it('should map addresses to source lines, preferring C over assembler', () => {
+    expect(parser.getLineAt(0x0800)).toEqual({ file: 'main.c', line: 5, type: 1 });
+    expect(parser.getLineAt(0x080B)).toEqual({ file: 'main.c', line: 6, type: 1 });
+    expect(parser.getLineAt(0x0816)).toEqual({ file: 'util, v2.s', line: 12, type: 0 });  // Not the macro body
+    expect(parser.getLineAt(0x080C)).toBeUndefined();
+    expect(parser.getLineAt(0x1002)).toEqual({ file: 'util, v2.s', line: 20, type: 0 });
+  });
+
+  it('should find the nearest label at or below an address', () => {
+    expect(parser.getNearestLabel(0x0816)).toEqual({ symbol: parser.getSymbol(4), offset: 4 });
+    expect(parser.getNearestLabel(0x0800)!.symbol.name).toBe('_main');
+    expect(parser.getNearestLabel(0x07FF)).toBeUndefined();
+  });
+
+  it('should give the same result when streamed in arbitrary chunks', async () => {
+    const chunks: string[] = [];
+    for (let i = 0; i < DEBUG_INFO.length; i += 37) {
+      chunks.push(DEBUG_INFO.substring(i, i + 37));
+    }
+    const streamed = new CC65DebugInfoParser();
+    await streamed.parseDebugStream(Readable.from(chunks));
+
+    expect(streamed.getSymbols()).toEqual(parser.getSymbols());
+    expect(streamed.getScopes()).toEqual(parser.getScopes());
+    for (let address = 0x07F0; address < 0x1010; address++) {
+      expect(streamed.getLineAt(address)).toEqual(parser.getLineAt(address));
+      expect(streamed.getScopeAt(address)).toEqual(parser.getScopeAt(address));
+    }
+  });
+
+  it('should index overlapping spans to the innermost one', () => {
+    // Random nested and overlapping scopes checked against a linear search
+    let seed = 12345;
+    const random = (limit: number) => {
+      seed = (seed * 1103515245 + 12345) & 0x7FFFFFFF;
+      return seed % limit;
+    };
+    const records = ['version\tmajor=2,minor=0', 'seg\tid=0,name="CODE",start=0x8000,size=0x1000'];
+    const scopes: Array<{ id: number; start: number; end: number }> = [];
+    for (let id = 0; id < 300; id++) {
+      const start = 0x8000 + random(0x1000);
+      const size = 1 + random(id % 10 === 0 ? 0x400 : 0x20);
+      records.push(`span\tid=${id},seg=0,start=${start - 0x8000},size=${size}`);
+      records.push(`scope\tid=${id},name="s${id}",mod=0,size=${size},span=${id}`);
+      scopes.push({ id, start, end: start + size });
+    }
+    parser.parseDebugFile(records.join('\n'));
+
+    for (let address = 0x7FF0; address < 0x9420; address++) {
+      const covering = scopes.filter(scope => scope.start <= address && address < scope.end)
+        .sort((a, b) => (a.end - a.start) - (b.end - b.start) || b.id - a.id);
+      const found = parser.getScopeAt(address);
+      expect(found ? found.id : -1).toBe(covering.length > 0 ? covering[0].id : -1);
+    }
+  });
+});
+
+describe('CC65SymbolParser with debug info', () => {
+  let symbols: CC65SymbolParser;
+
+  beforeEach(() => {
+    const debugInfo = new CC65DebugInfoParser();
+    debugInfo.parseDebugFile(DEBUG_INFO);
+    symbols = new CC65SymbolParser();
+    symbols.loadDebugInfo(debugInfo);
+  });
+
+  it('should load labels and equates with qualified names and definitions', () => {
+    expect(symbols.getSymbolByName('_main')).toEqual({
+      name: '_main', address: 0x0800, type: 'label', scope: undefined, file: 'main.c', line: 5
+    });
+    expect(symbols.getSymbolByName('delay::@loop')).toEqual(expect.objectContaining({ address: 0x0812, scope: 'delay', line: 11 }));
+    expect(symbols.getSymbolByName('VIA')!.type).toBe('equate');
+    expect(symbols.getAllSymbols()).toHaveLength(5);  // Not the import
+  });
+
+  it('should attribute addresses inside a routine to the routine', () => {
+    expect(symbols.findSymbolForAddress(0x0812)!.symbol.name).toBe('delay::@loop');
+    expect(symbols.findSymbolForAddress(0x0813)).toEqual({ symbol: symbols.getSymbolByName('delay'), offset: 3 });
+    expect(symbols.findSymbolForAddress(0x0816)).toEqual({ symbol: symbols.getSymbolByName('delay'), offset: 6 });
+    // No .proc around main; the nearest label below
+    expect(symbols.findSymbolForAddress(0x0805)).toEqual({ symbol: symbols.getSymbolByName('_main'), offset: 5 });
+    expect(symbols.getSourceLocation(0x0813)).toEqual({ file: 'util, v2.s', line: 11, type: 0 });
+  });
+});
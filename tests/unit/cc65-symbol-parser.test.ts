@@ -178,6 +178,15 @@ describe('CC65SymbolParser', () => {
       expect(symbols[0].name).toBe('main');
     });
 
+    it('should resolve addresses inside code to the nearest label below', () => {
+      expect(parser.findSymbolForAddress(0x0800)).toEqual({ symbol: expect.objectContaining({ name: 'main' }), offset: 0 });
+      expect(parser.findSymbolForAddress(0x0834)).toEqual({ symbol: expect.objectContaining({ name: 'main' }), offset: 0x34 });
+      // Equates name data, not code
+      expect(parser.findSymbolForAddress(0x2001)!.symbol.name).toBe('main');
+      expect(parser.findSymbolForAddress(0x3001)).toEqual({ symbol: expect.objectContaining({ name: 'buffer' }), offset: 1 });
+      expect(parser.findSymbolForAddress(0x0700)).toBeUndefined();
+    });
+
     it('should return undefined for non-existent symbols', () => {
       expect(parser.getSymbolByName('nonexistent')).toBeUndefined();
       expect(parser.getSymbolByAddress(0x9999)).toBeUndefined();
@@ -0,0 +1,139 @@
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { CPU6502Emulator } from '../../src/core/cpu';
+import { CC65DebugInfoParser } from '../../src/cc65/debug-info';
+import {
+  COVERAGE_EXECUTED, COVERAGE_NOT_TAKEN, COVERAGE_TAKEN, buildCoverageReport, formatLcov, writeCoverageHtml
+} from '../../src/debug/coverage';
+
+// main.s, assembled at $0200:
+//  3  start:  LDX #$02
+//  4  loop:   DEX
+//  5          BNE loop
+//  6          BEQ done
+//  7          BRK
+//  8  done:   JMP done
+const PROGRAM = [0xA2, 0x02, 0xCA, 0xD0, 0xFD, 0xF0, 0x01, 0x00, 0x4C, 0x08, 0x02];
+
+// What ld65 --dbgfile writes for it, plus a data segment that is not code
+const DEBUG_INFO = `version\tmajor=2,minor=0
+info\tcsym=0,file=1,lib=0,line=7,mod=1,scope=1,seg=2,span=7,sym=0,type=0
+file\tid=0,name="main.s",size=120,mtime=0x6500A000,mod=0
+line\tid=0,file=0,line=3,span=0
+line\tid=1,file=0,line=4,span=1
+line\tid=2,file=0,line=5,span=2
+line\tid=3,file=0,line=6,span=3
+line\tid=4,file=0,line=7,span=4
+line\tid=5,file=0,line=8,span=5
+line\tid=6,file=0,line=11,span=6
+mod\tid=0,name="main.o",file=0
+seg\tid=0,name="CODE",start=0x000200,size=0x000B,addrsize=absolute,type=ro,oname="main.bin",ooffs=0
+seg\tid=1,name="RODATA",start=0x000300,size=0x0004,addrsize=absolute,type=ro,oname="main.bin",ooffs=11
+span\tid=0,seg=0,start=0,size=2
+span\tid=1,seg=0,start=2,size=1
+span\tid=2,seg=0,start=3,size=2
+span\tid=3,seg=0,start=5,size=2
+span\tid=4,seg=0,start=7,size=1
+span\tid=5,seg=0,start=8,size=3
+span\tid=6,seg=1,start=0,size=4
+`;
+
+function runProgram(steps: number): { memory: Uint8Array; coverage: Uint8Array } {
+  const memory = new Uint8Array(0x10000);
+  memory.set(PROGRAM, 0x0200);
+  const cpu = new CPU6502Emulator();
+  cpu.setMemoryCallbacks(address => memory[address], (address, value) => { memory[address] = value; });
+  cpu.setRegisters({ PC: 0x0200, SP: 0xFD, P: 0x24 });
+  cpu.setCoverage(true);
+  for (let i = 0; i < steps; i++) {
+    cpu.step();
+  }
+  return { memory, coverage: cpu.getCoverage()! };
+}
+
+describe('Code coverage', () => {
+  it('should mark executed instructions and branch outcomes', () => {
+    const { coverage } = runProgram(8);
+
+    expect(coverage[0x0200]).toBe(COVERAGE_EXECUTED);
+    expect(coverage[0x0201]).toBe(0);
+    expect(coverage[0x0203]).toBe(COVERAGE_EXECUTED | COVERAGE_TAKEN | COVERAGE_NOT_TAKEN);
+    expect(coverage[0x0205]).toBe(COVERAGE_EXECUTED | COVERAGE_TAKEN);
+    expect(coverage[0x0207]).toBe(0);  // BRK skipped
+    expect(coverage[0x0208]).toBe(COVERAGE_EXECUTED);
+  });
+
+  it('should not mark interrupt entry', () => {
+    const memory = new Uint8Array(0x10000);
+    memory.set(PROGRAM, 0x0200);
+    memory.set([0x00, 0x03], 0xFFFE);
+    const cpu = new CPU6502Emulator();
+    cpu.setMemoryCallbacks(address => memory[address], (address, value) => { memory[address] = value; });
+    cpu.setRegisters({ PC: 0x0200, SP: 0xFD, P: 0x20 });
+    cpu.setCoverage(true);
+    cpu.triggerIRQ();
+    cpu.step();
+    expect(cpu.getCoverage()!.some(flags => flags !== 0)).toBe(false);
+    cpu.setCoverage(false);
+    expect(cpu.getCoverage()).toBeNull();
+  });
+
+  it('should map cc65 debug info spans to source lines in code segments', () => {
+    const debugInfo = new CC65DebugInfoParser();
+    debugInfo.parseDebugFile(DEBUG_INFO);
+    const ranges = debugInfo.getLineRanges();
+
+    expect(ranges).toHaveLength(6);
+    expect(ranges[0]).toEqual({ file: 'main.s', line: 3, start: 0x0200, end: 0x0202 });
+    expect(ranges[5]).toEqual({ file: 'main.s', line: 8, start: 0x0208, end: 0x020B });
+    expect(debugInfo.getLineRanges(['RODATA'])).toEqual([{ file: 'main.s', line: 11, start: 0x0300, end: 0x0304 }]);
+  });
+
+  it('should report line and branch coverage as lcov', () => {
+    const { memory, coverage } = runProgram(8);
+    const debugInfo = new CC65DebugInfoParser();
+    debugInfo.parseDebugFile(DEBUG_INFO);
+    const report = buildCoverageReport(coverage, debugInfo.getLineRanges(), address => memory[address]);
+
+    expect(report).toEqual(expect.objectContaining({ lines: 6, linesHit: 5, branches: 4, branchesHit: 3 }));
+    expect(formatLcov(report, 'firmware')).toBe([
+      'TN:firmware', 'SF:main.s',
+      'BRDA:5,0,0,1', 'BRDA:5,0,1,1', 'BRDA:6,0,0,1', 'BRDA:6,0,1,0',
+      'BRF:4', 'BRH:3',
+      'DA:3,1', 'DA:4,1', 'DA:5,1', 'DA:6,1', 'DA:7,0', 'DA:8,1',
+      'LF:6', 'LH:5', 'end_of_record', ''
+    ].join('\n'));
+  });
+
+  it('should report branches that never ran as not executed', () => {
+    const { memory, coverage } = runProgram(1);
+    const debugInfo = new CC65DebugInfoParser();
+    debugInfo.parseDebugFile(DEBUG_INFO);
+    const lcov = formatLcov(buildCoverageReport(coverage, debugInfo.getLineRanges(), address => memory[address]));
+    expect(lcov).toContain('BRDA:5,0,0,-\nBRDA:5,0,1,-');
+    expect(lcov).toContain('DA:3,1\nDA:4,0');
+  });
+
+  it('should write an HTML report with the source listing', () => {
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'coverage-'));
+    try {
+      const { memory, coverage } = runProgram(8);
+      const debugInfo = new CC65DebugInfoParser();
+      debugInfo.parseDebugFile(DEBUG_INFO);
+      fs.writeFileSync(path.join(directory, 'main.s'), '; main\n\nstart:  LDX #$02\nloop:   DEX\n');
+      const report = buildCoverageReport(coverage, debugInfo.getLineRanges(), address => memory[address]);
+      writeCoverageHtml(report, path.join(directory, 'html'), { title: 'Firmware', sourceRoot: directory });
+
+      const index = fs.readFileSync(path.join(directory, 'html', 'index.html'), 'utf8');
+      expect(index).toContain('<a href="file0.html">main.s</a>');
+      expect(index).toContain('83.3%');
+      const listing = fs.readFileSync(path.join(directory, 'html', 'file0.html'), 'utf8');
+      expect(listing).toContain('<tr class="hit"><td class="num">3</td><td></td><td>start:  LDX #$02</td></tr>');
+      expect(listing).toContain('<tr class="partial"><td class="num">6</td><td>+-</td>');
+      expect(listing).toContain('<tr class="miss"><td class="num">7</td>');
+    } finally {
+      fs.rmSync(directory, { recursive: true, force: true });
+    }
+  });
+});
@@ -0,0 +1,155 @@
+import { EmulatorPool } from '../../src/pool/emulator-pool';
+import { PoolJob, runPoolJob } from '../../src/pool/job';
+import { InputLog } from '../../src/debug/input-log';
+import { SystemConfig } from '../../src/config/system';
+
+const CONFIG: SystemConfig = {
+  memory: { ramSize: 32768, ramStart: 0x0000, romImages: [] },
+  peripherals: { acia: { baseAddress: 0x8000, baudRate: 115200 } },
+  cpu: { type: '6502', clockSpeed: 1000000 },
+  debugging: { enableTracing: false, breakOnReset: false }
+};
+
+const NOPS = (count: number) => new Array(count).fill(0xEA);
+
+// Print text through the ACIA, leaving time for each byte to shift out, then
+// spin on JMP. Returns the image (loaded at $0000) and the spin address.
+function printProgram(text: string): { image: number[]; spin: number } {
+  const image: number[] = [];
+  for (const char of text) {
+    image.push(0xA9, char.charCodeAt(0), 0x8D, 0x01, 0x80, ...NOPS(45));
+  }
+  const spin = image.length;
+  image.push(0x4C, spin & 0xFF, spin >> 8);
+  return { image, spin };
+}
+
+// Wait for a byte, echo it, then spin
+function echoProgram(): number[] {
+  const image = [...NOPS(100), 0xAD, 0x01, 0x80, 0x8D, 0x01, 0x80, ...NOPS(50)];
+  const spin = image.length;
+  return [...image, 0x4C, spin & 0xFF, spin >> 8];
+}
+
+// Checksum the program's own bytes with a mix of addressing modes, a
+// subroutine and the stack, then store the result at $0200 and spin
+function checksumProgram(): { image: number[]; spin: number } {
+  const image = [
+    0xA2, 0x00,             // LDX #$00
+    0xA9, 0x5A,             // LDA #$5A
+    0x18,                   // CLC
+    0x7D, 0x00, 0x00,       // loop: ADC $0000,X
+    0x2A,                   // ROL A
+    0x5D, 0x00, 0x00,       // EOR $0000,X
+    0x20, 0x30, 0x00,       // JSR mix
+    0xE8,                   // INX
+    0xD0, 0xF3,             // BNE loop
+    0x8D, 0x00, 0x02,       // STA $0200
+    0x8E, 0x01, 0x02,       // STX $0201
+    0x08,                   // PHP
+    0x68,                   // PLA
+    0x8D, 0x02, 0x02,       // STA $0202
+    0x4C, 0x1D, 0x00,       // spin: JMP spin
+    ...NOPS(16),
+    0x48,                   // mix: PHA
+    0x38,                   // SEC
+    0xE9, 0x03,             // SBC #$03
+    0x6A,                   // ROR A
+    0x9D, 0x10, 0x02,       // STA $0210,X
+    0x68,                   // PLA
+    0x2C, 0x10, 0x02,       // BIT $0210
+    0x60                    // RTS
+  ];
+  return { image, spin: 0x1D };
+}
+
+// Programs are loaded as ROM at $0000, where the default reset vector points
+function job(image: number[], maxCycles: number, extra: Partial<PoolJob> = {}): PoolJob {
+  return {
+    config: CONFIG,
+    roms: [{ data: Uint8Array.from(image), address: 0x0000 }],
+    maxCycles,
+    ...extra
+  };
+}
+
+describe('runPoolJob', () => {
+  it('should run a program from reset and collect its serial output', async () => {
+    const { image, spin } = printProgram('Hi');
+    const result = await runPoolJob(job(image, 2000, { readMemory: [{ start: 0x0000, length: 2 }] }));
+
+    expect(Buffer.from(result.serialOutput).toString()).toBe('Hi');
+    expect(result.stopReason).toBe('cycles');
+    expect(result.cycles).toBeGreaterThanOrEqual(2000);
+    expect(result.registers.PC).toBe(spin);
+    expect(Array.from(result.memory[0])).toEqual([0xA9, 0x48]);
+    expect(result.stats.worker).toBe(-1);
+  });
+
+  it('should stop at breakpoints and reject jobs without a budget', async () => {
+    const { image, spin } = printProgram('A');
+    const result = await runPoolJob(job(image, 100000, { breakpoints: [spin] }));
+    expect(result.stopReason).toBe('breakpoint');
+    expect(result.registers.PC).toBe(spin);
+
+    await expect(runPoolJob(job(image, 0))).rejects.toThrow('maxCycles');
+  });
+});
+
+describe('EmulatorPool', () => {
+  let pool: EmulatorPool;
+
+  beforeAll(() => {
+    pool = new EmulatorPool({ size: 2, silent: true });
+  });
+
+  afterAll(async () => {
+    await pool.close();
+  });
+
+  it('should run jobs on worker threads and replay recorded inputs', async () => {
+    const inputs = new InputLog([{ cycle: 0, kind: 'serial', source: 'ACIA', value: 0x41 }]).serialize();
+    const [printed, echoed] = await Promise.all([
+      pool.submit(job(printProgram('pool').image, 5000)),
+      pool.submit(job(echoProgram(), 2000, { inputs }))
+    ]);
+
+    expect(Buffer.from(printed.serialOutput).toString()).toBe('pool');
+    expect(Buffer.from(echoed.serialOutput).toString()).toBe('A');
+    expect(printed.stats.worker).toBeGreaterThanOrEqual(0);
+  }, 60000);
+
+  it('should let an idle worker steal jobs queued behind a long one', async () => {
+    const { image } = printProgram('x');
+    const long = pool.submit(job(image, 2000000));
+    const short = Array.from({ length: 7 }, () => pool.submit(job(image, 2000)));
+
+    const results = await Promise.all([long, ...short]);
+    const longWorker = results[0].stats.worker;
+    results.slice(1).forEach(result => {
+      expect(result.stats.worker).not.toBe(longWorker);
+      expect(Buffer.from(result.serialOutput).toString()).toBe('x');
+    });
+    expect(pool.getStats().stolen).toBeGreaterThan(0);
+  }, 60000);
+
+  it('should report job errors without losing the worker', async () => {
+    await expect(pool.submit(job([0xEA], 0))).rejects.toThrow('maxCycles');
+    const result = await pool.submit(job(printProgram('ok').image, 3000));
+    expect(Buffer.from(result.serialOutput).toString()).toBe('ok');
+    expect(pool.getStats()).toMatchObject({ size: 2, queued: 0, running: 0, failed: 1 });
+  }, 60000);
+
+  it('should run every instruction on the worker core as it runs in-process', async () => {
+    // Workers cannot load the native addon and run the fallback core
+    const { image, spin } = checksumProgram();
+    const checksum = job(image, 100000, { breakpoints: [spin], readMemory: [{ start: 0x0200, length: 0x110 }] });
+    const [local, pooled] = await Promise.all([runPoolJob(checksum), pool.submit(checksum)]);
+
+    expect(pooled.stopReason).toBe('breakpoint');
+    const { cycles: _local, ...localRegisters } = local.registers;
+    expect(pooled.registers).toMatchObject(localRegisters);
+    expect(pooled.cycles).toBe(local.cycles);
+    expect(Array.from(pooled.memory[0])).toEqual(Array.from(local.memory[0]));
+  }, 60000);
+});
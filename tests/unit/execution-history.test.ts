@@ -0,0 +1,174 @@
+import { ExecutionHistory } from '../../src/debug/history';
+import { SystemBus } from '../../src/core/bus';
+import { CPUState } from '../../src/core/cpu';
+import { SerialPort } from '../../src/peripherals/serial-port';
+
+class QueueSerialPort implements SerialPort {
+  public reads = 0;
+  constructor(private queue: number[]) {}
+
+  write(_data: number): void {}
+
+  read(): number | null {
+    this.reads++;
+    return this.queue.length > 0 ? this.queue.shift()! : null;
+  }
+
+  hasData(): boolean {
+    return this.queue.length > 0;
+  }
+
+  isReady(): boolean {
+    return true;
+  }
+
+  setBaudRate(_rate: number): void {}
+
+  close(): void {}
+}
+
+// LDA #$01 / STA $10 / LDA #$02 / STA $11 / LDA #$03 / STA $10 / NOP / JMP $0200
+const PROGRAM = [
+  0xA9, 0x01, 0x85, 0x10,
+  0xA9, 0x02, 0x85, 0x11,
+  0xA9, 0x03, 0x85, 0x10,
+  0xEA,
+  0x4C, 0x00, 0x02
+];
+
+describe('ExecutionHistory', () => {
+  let bus: SystemBus;
+  let history: ExecutionHistory;
+
+  const snapshot = (): { regs: CPUState; zp10: number; zp11: number } => ({
+    regs: bus.getCPU().getRegisters(),
+    zp10: bus.getMemory().read(0x10),
+    zp11: bus.getMemory().read(0x11)
+  });
+
+  const withoutCycles = (regs: CPUState) => ({ ...regs, cycles: 0 });
+
+  beforeEach(() => {
+    bus = new SystemBus();
+    bus.getMemory().configureRAM(0x0000, 0x8000);
+    bus.getCPU().clearBreakpoints();
+    PROGRAM.forEach((byte, i) => bus.getMemory().write(0x0200 + i, byte));
+    bus.getCPU().setRegisters({ A: 0, X: 0, Y: 0, SP: 0xFF, P: 0x24, PC: 0x0200 });
+
+    history = new ExecutionHistory(bus, { checkpointInterval: 4, maxCheckpoints: 3 });
+    history.enable();
+  });
+
+  afterEach(() => {
+    bus.getCPU().clearBreakpoints();
+  });
+
+  it('should step backwards restoring registers and memory', () => {
+    history.step();
+    history.step();
+    const before = snapshot();
+
+    history.step();
+    history.step();
+    history.step();
+    history.step();
+    expect(bus.getMemory().read(0x10)).toBe(0x03);
+
+    expect(history.reverseStep(4)).toBe(true);
+    const after = snapshot();
+    expect(history.getInstructionIndex()).toBe(2);
+    expect(withoutCycles(after.regs)).toEqual(withoutCycles(before.regs));
+    expect(after.zp10).toBe(before.zp10);
+    expect(after.zp11).toBe(before.zp11);
+  });
+
+  it('should reproduce every recorded instruction after old checkpoints are folded', () => {
+    const states: Array<ReturnType<typeof snapshot>> = [snapshot()];
+    for (let i = 0; i < 40; i++) {
+      history.step();
+      states.push(snapshot());
+    }
+
+    expect(history.getCheckpointCount()).toBeLessThanOrEqual(3);
+    const earliest = history.getEarliestInstruction();
+    expect(earliest).toBeGreaterThan(0);
+
+    for (const target of [40, 37, earliest + 1, earliest, 33]) {
+      expect(history.seek(target)).toBe(true);
+      const state = snapshot();
+      expect(withoutCycles(state.regs)).toEqual(withoutCycles(states[target].regs));
+      expect(state.zp10).toBe(states[target].zp10);
+      expect(state.zp11).toBe(states[target].zp11);
+    }
+  });
+
+  it('should not move before the start of the history', () => {
+    expect(history.reverseStep()).toBe(false);
+    history.step();
+    expect(history.reverseStep(10)).toBe(true);
+    expect(history.getInstructionIndex()).toBe(0);
+    expect(bus.getCPU().getRegisters().PC).toBe(0x0200);
+  });
+
+  it('should reverse-continue to the last breakpoint hit', () => {
+    history.setOptions({ maxCheckpoints: 16 });
+    for (let i = 0; i < 20; i++) {
+      history.step();
+    }
+
+    // LDA #$03 executes at instructions 4, 12 and 20 (before it runs)
+    bus.getCPU().setBreakpoint(0x0208);
+    expect(history.reverseContinue(address => bus.getCPU().hasBreakpoint(address))).toBe(true);
+    expect(history.getInstructionIndex()).toBe(12);
+    expect(bus.getCPU().getRegisters().PC).toBe(0x0208);
+
+    expect(history.reverseContinue(address => bus.getCPU().hasBreakpoint(address))).toBe(true);
+    expect(history.getInstructionIndex()).toBe(4);
+
+    expect(history.reverseContinue(address => bus.getCPU().hasBreakpoint(address))).toBe(false);
+    expect(history.getInstructionIndex()).toBe(0);
+  });
+
+  it('should replay over breakpoints when seeking forward', () => {
+    for (let i = 0; i < 10; i++) {
+      history.step();
+    }
+    bus.getCPU().setBreakpoint(0x0208);
+
+    expect(history.reverseStep(10)).toBe(true);
+    expect(history.seek(10)).toBe(true);
+    expect(bus.getCPU().hasBreakpoint(0x0208)).toBe(true);
+  });
+
+  it('should replay serial input without reading the host port again', () => {
+    const port = new QueueSerialPort([0x41]);
+    const serial = history.wrapSerialPort(port, 'ACIA');
+
+    history.step();
+    const cycle = bus.getCycleCount();
+    expect(serial.read()).toBe(0x41);
+    history.step();
+    expect(history.getInputLog()).toEqual([
+      { cycle, kind: 'serial', source: 'ACIA', value: 0x41 }
+    ]);
+
+    history.reverseStep(2);
+    history.step();
+    expect(serial.hasData()).toBe(true);
+    expect(serial.read()).toBe(0x41);
+    expect(port.reads).toBe(1);
+  });
+
+  it('should discard the recorded future when a new input diverges', () => {
+    for (let i = 0; i < 10; i++) {
+      history.step();
+    }
+    history.reverseStep(5);
+    expect(history.isReplaying()).toBe(true);
+
+    history.recordInput('irq', 'debug');
+    expect(history.getHorizon()).toBe(5);
+    expect(history.isReplaying()).toBe(false);
+    expect(history.getInputLog()).toHaveLength(1);
+  });
+});
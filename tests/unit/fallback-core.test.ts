@@ -0,0 +1,167 @@
+import { execFileSync } from 'child_process';
+import * as path from 'path';
+import { FallbackCore, REG_A, REG_X, REG_SP, REG_P } from '../../src/core/fallback-core';
+import { CPU6502Emulator, isNativeAvailable } from '../../src/core/cpu';
+
+function createCore(program: number[], address: number = 0x0200): { core: FallbackCore; memory: Uint8Array } {
+  const memory = new Uint8Array(0x10000);
+  memory.set(program, address);
+  const core = new FallbackCore();
+  core.read = a => memory[a];
+  core.write = (a, v) => { memory[a] = v; };
+  core.reset(address);
+  return { core, memory };
+}
+
+// Small deterministic generator so failures can be reproduced
+function random(seed: number): () => number {
+  let state = seed >>> 0;
+  return () => {
+    state = (Math.imul(state, 1664525) + 1013904223) >>> 0;
+    return state >>> 24;
+  };
+}
+
+describe('FallbackCore', () => {
+  it('should be generated from the current native tables', () => {
+    const script = path.join(__dirname, '../../scripts/generate-fallback-core.js');
+    expect(() => execFileSync(process.execPath, [script, '--check'], { stdio: 'pipe' })).not.toThrow();
+  });
+
+  it('should compute ADC and SBC flags in binary mode', () => {
+    // LDA #$7F / ADC #$01 / SEC / SBC #$01 / SED / ADC #$09
+    const { core } = createCore([0xA9, 0x7F, 0x69, 0x01, 0x38, 0xE9, 0x01, 0xF8, 0x69, 0x09]);
+    core.step();
+    core.step();
+    expect(core.registers[REG_A]).toBe(0x80);
+    expect(core.registers[REG_P] & 0xC3).toBe(0xC0);  // N and V set, Z and C clear
+
+    core.step();
+    core.step();
+    expect(core.registers[REG_A]).toBe(0x7F);
+    expect(core.registers[REG_P] & 0xC3).toBe(0x41);  // V and C set
+
+    // No decimal mode, as in the native core
+    core.step();
+    core.step();
+    expect(core.registers[REG_A]).toBe(0x89);
+  });
+
+  it('should add page-crossing and branch cycles', () => {
+    // LDX #$01 / LDA $02FF,X / LDA $0200,X / STA $02FF,X / BNE $028C
+    // $028C: BNE $030D
+    const { core, memory } = createCore([0xA2, 0x01, 0xBD, 0xFF, 0x02, 0xBD, 0x00, 0x02, 0x9D, 0xFF, 0x02, 0xD0, 0x7F]);
+    memory.set([0xD0, 0x7F], 0x028C);
+    expect(core.step()).toBe(2);
+    expect(core.step()).toBe(5);
+    expect(core.step()).toBe(4);
+    expect(core.step()).toBe(5);
+    expect(core.step()).toBe(3);  // Taken within the page
+    expect(core.step()).toBe(4);  // Taken into the next page
+    expect(core.pc[0]).toBe(0x030D);
+    expect(core.cycles).toBe(23);
+  });
+
+  it('should call and return through the stack', () => {
+    // JSR $0300 / BRK ... $0300: PHA / PLA / RTS
+    const { core, memory } = createCore([0x20, 0x00, 0x03, 0x00]);
+    memory.set([0x48, 0x68, 0x60], 0x0300);
+    core.step();
+    expect(core.pc[0]).toBe(0x0300);
+    expect(core.registers[REG_SP]).toBe(0xFB);
+    expect(memory[0x01FD]).toBe(0x02);
+    expect(memory[0x01FC]).toBe(0x02);
+
+    core.step();
+    core.step();
+    expect(core.step()).toBe(6);
+    expect(core.pc[0]).toBe(0x0203);
+    expect(core.registers[REG_SP]).toBe(0xFD);
+  });
+
+  it('should take interrupts like the native core', () => {
+    // CLI / NOP, with the IRQ handler at $0400 and NMI handler at $0500
+    const { core, memory } = createCore([0x58, 0xEA]);
+    memory.set([0x00, 0x05, 0x00, 0x00, 0x00, 0x04], 0xFFFA);
+
+    // Masked IRQs are dropped
+    core.irqPending = true;
+    expect(core.step()).toBe(7);
+    expect(core.irqPending).toBe(false);
+    expect(core.pc[0]).toBe(0x0200);
+
+    core.step();
+    core.irqPending = true;
+    core.step();
+    expect(core.pc[0]).toBe(0x0400);
+    expect(memory[0x01FB] & 0x10).toBe(0);  // B clear on the pushed status
+    expect(core.registers[REG_P] & 0x04).toBe(0x04);
+
+    core.nmiPending = true;
+    core.step();
+    expect(core.pc[0]).toBe(0x0500);
+  });
+
+  it('should replicate the JMP indirect page wrap', () => {
+    const { core, memory } = createCore([0x6C, 0xFF, 0x03]);
+    memory[0x03FF] = 0x34;
+    memory[0x0300] = 0x12;
+    memory[0x0400] = 0x56;
+    core.step();
+    expect(core.pc[0]).toBe(0x1234);
+  });
+
+  it('should run undocumented opcodes', () => {
+    // LAX $10 / DCP $11
+    const { core, memory } = createCore([0xA7, 0x10, 0xC7, 0x11]);
+    memory[0x10] = 0x42;
+    memory[0x11] = 0x43;
+    core.step();
+    expect(core.registers[REG_A]).toBe(0x42);
+    expect(core.registers[REG_X]).toBe(0x42);
+    expect(core.step()).toBe(5);
+    expect(memory[0x11]).toBe(0x42);
+    expect(core.registers[REG_P] & 0x03).toBe(0x03);  // Equal: Z and C
+  });
+});
+
+// The reference is the native core; the fallback is what runs without it
+const describeNative = isNativeAvailable() ? describe : describe.skip;
+
+describeNative('FallbackCore against the native core', () => {
+  it('should match on random code, including every memory access', () => {
+    const cpu = new CPU6502Emulator();
+    for (let seed = 1; seed <= 16; seed++) {
+      const next = random(seed);
+      const image = Uint8Array.from({ length: 0x10000 }, () => next());
+      const start = { PC: (next() << 8) | next(), A: next(), X: next(), Y: next(), SP: next(), P: next() | 0x20, cycles: 0 };
+
+      const nativeMemory = image.slice();
+      const nativeAccesses: number[] = [];
+      cpu.setMemoryCallbacks(
+        a => { nativeAccesses.push(a); return nativeMemory[a]; },
+        (a, v) => { nativeAccesses.push(0x10000 | a, v); nativeMemory[a] = v; }
+      );
+      cpu.setRegisters(start);
+
+      const memory = image.slice();
+      const accesses: number[] = [];
+      const core = new FallbackCore();
+      core.read = a => { accesses.push(a); return memory[a]; };
+      core.write = (a, v) => { accesses.push(0x10000 | a, v); memory[a] = v; };
+      core.reset(start.PC);
+      core.registers.set([start.A, start.X, start.Y, start.SP, start.P]);
+
+      for (let i = 0; i < 300; i++) {
+        const cycles = cpu.step();
+        expect(core.step()).toBe(cycles);
+        const expected = cpu.getRegisters();
+        expect({ seed, i, registers: Array.from(core.registers), pc: core.pc[0] }).toEqual({
+          seed, i, registers: [expected.A, expected.X, expected.Y, expected.SP, expected.P], pc: expected.PC
+        });
+      }
+      expect(accesses).toEqual(nativeAccesses);
+      expect(Buffer.compare(memory, nativeMemory)).toBe(0);
+    }
+  });
+});
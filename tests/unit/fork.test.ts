@@ -0,0 +1,172 @@
+import { MemoryManager } from '../../src/core/memory';
+import { SystemBus } from '../../src/core/bus';
+import { Emulator } from '../../src/emulator';
+import { SystemConfig } from '../../src/config/system';
+import { ACIA68B50 } from '../../src/peripherals/acia';
+
+// LDA #$01 / STA $10 / LDA #$02 / STA $11 / NOP / JMP $0200
+const PROGRAM = [0xA9, 0x01, 0x85, 0x10, 0xA9, 0x02, 0x85, 0x11, 0xEA, 0x4C, 0x00, 0x02];
+
+function createBus(): SystemBus {
+  const bus = new SystemBus();
+  bus.getMemory().configureRAM(0x0000, 0x8000);
+  PROGRAM.forEach((byte, i) => bus.getMemory().write(0x0200 + i, byte));
+  bus.getPeripheralHub().registerPeripheral(new ACIA68B50(), 0x8000, 0x8001, 'ACIA');
+  bus.getCPU().clearBreakpoints();
+  bus.getCPU().setRegisters({ A: 0, X: 0, Y: 0, SP: 0xFF, P: 0x24, PC: 0x0200 });
+  return bus;
+}
+
+describe('MemoryManager fork', () => {
+  it('should share RAM pages until either side writes', () => {
+    const parent = new MemoryManager();
+    parent.configureRAM(0x0000, 0x8000);
+    parent.write(0x1234, 0xAA);
+
+    const child = parent.fork();
+    expect(child.read(0x1234)).toBe(0xAA);
+    expect(parent.getSharedRAMPageCount()).toBe(128);
+    expect(child.getSharedRAMPageCount()).toBe(128);
+
+    child.write(0x1234, 0xBB);
+    expect(child.read(0x1234)).toBe(0xBB);
+    expect(parent.read(0x1234)).toBe(0xAA);
+    expect(child.getSharedRAMPageCount()).toBe(127);
+
+    parent.write(0x0010, 0xCC);
+    expect(child.read(0x0010)).toBe(0x00);
+    expect(parent.getSharedRAMPageCount()).toBe(127);
+  });
+
+  it('should share ROM images and reject directly mapped peripherals', () => {
+    const memory = new MemoryManager();
+    memory.loadROM(new Uint8Array([0x12, 0x34]), 0xFFFC);
+    expect(memory.fork().read(0xFFFD)).toBe(0x34);
+
+    memory.mapPeripheral(0xA000, 0xA003, {
+      read: () => 0, write: () => {}, reset: () => {}, tick: () => {}, getInterruptStatus: () => false
+    });
+    expect(() => memory.fork()).toThrow();
+  });
+
+  it('should not allocate shared RAM for forks that are never viewed', () => {
+    const parent = new MemoryManager();
+    parent.configureRAM(0x0000, 0x8000);
+    parent.getSharedMemory();
+
+    const allocated: number[] = [];
+    const OriginalSharedArrayBuffer = SharedArrayBuffer;
+    (globalThis as any).SharedArrayBuffer = class extends OriginalSharedArrayBuffer {
+      constructor(length: number) {
+        super(length);
+        allocated.push(length);
+      }
+    };
+    try {
+      const forks = Array.from({ length: 100 }, (_, i) => {
+        const child = parent.fork();
+        child.write(0x1000, i);
+        parent.write(0x2000, i);
+        return child;
+      });
+      expect(allocated.filter(length => length >= 0x8000)).toEqual([]);
+      expect(forks[42].read(0x1000)).toBe(42);
+      expect(parent.read(0x2000)).toBe(99);
+
+      // Viewing a fork moves it into one shared buffer
+      const region = forks[42].getSharedMemory().regions.find(r => r.type === 'RAM')!;
+      expect(allocated.filter(length => length >= 0x8000)).toEqual([0x8000]);
+      expect(new Uint8Array(region.buffer)[0x1000]).toBe(42);
+    } finally {
+      (globalThis as any).SharedArrayBuffer = OriginalSharedArrayBuffer;
+    }
+  });
+});
+
+describe('SystemBus fork', () => {
+  it('should copy CPU, peripheral and cycle state', () => {
+    const parent = createBus();
+    parent.step();
+    parent.step();
+    parent.getCPU().setBreakpoint(0x0300);
+
+    const child = parent.fork();
+    expect(child.getCPU().getRegisters()).toEqual(parent.getCPU().getRegisters());
+    expect(child.getCycleCount()).toBe(parent.getCycleCount());
+    expect(child.getCPU().hasBreakpoint(0x0300)).toBe(true);
+    expect(child.getPeripheralHub().getPeripherals()[0].peripheral)
+      .not.toBe(parent.getPeripheralHub().getPeripherals()[0].peripheral);
+  });
+
+  it('should run parent and child independently when interleaved', () => {
+    const reference = createBus();
+    const parent = createBus();
+    for (let i = 0; i < 3; i++) {
+      reference.step();
+      parent.step();
+    }
+
+    const child = parent.fork();
+    // Patch the child's copy of the program: LDA #$01 becomes LDA #$07
+    child.getMemory().write(0x0201, 0x07);
+
+    for (let i = 0; i < 20; i++) {
+      parent.step();
+      child.step();
+      reference.step();
+    }
+
+    expect(parent.getCPU().getRegisters()).toEqual(reference.getCPU().getRegisters());
+    expect(parent.getMemory().read(0x10)).toBe(0x01);
+    expect(child.getMemory().read(0x10)).toBe(0x07);
+    expect(parent.getMemory().read(0x0201)).toBe(0x01);
+  });
+});
+
+describe('Emulator fork', () => {
+  let emulator: Emulator;
+
+  beforeEach(async () => {
+    const config: SystemConfig = {
+      memory: { ramSize: 32768, ramStart: 0x0000, romImages: [] },
+      peripherals: { acia: { baseAddress: 0x8000, baudRate: 9600 } },
+      cpu: { type: '6502', clockSpeed: 1000000 },
+      debugging: { enableTracing: false, breakOnReset: false }
+    };
+    emulator = new Emulator(config);
+    await emulator.initialize();
+    PROGRAM.forEach((byte, i) => emulator.getSystemBus().getMemory().write(0x0200 + i, byte));
+    emulator.getSystemBus().getCPU().setRegisters({ PC: 0x0200 });
+  });
+
+  afterEach(() => {
+    emulator.stop();
+  });
+
+  it('should fork into a paused, independent emulator', () => {
+    emulator.step();
+    emulator.step();
+
+    const child = emulator.fork();
+    expect(child.getState()).toBe('paused');
+    expect(child.getSystemBus()).not.toBe(emulator.getSystemBus());
+    expect(child.getSystemBus().getCPU().getRegisters().PC).toBe(0x0204);
+
+    child.step();
+    child.step();
+    expect(child.getSystemBus().getCPU().getRegisters().PC).toBe(0x0208);
+    expect(emulator.getSystemBus().getCPU().getRegisters().PC).toBe(0x0204);
+  });
+
+  it('should fan out many forks cheaply', () => {
+    emulator.step();
+    const forks = Array.from({ length: 200 }, () => emulator.fork());
+
+    forks.forEach((child, i) => child.getSystemBus().getMemory().write(0x4000, i & 0xFF));
+    forks.forEach((child, i) => {
+      expect(child.getSystemBus().getMemory().read(0x4000)).toBe(i & 0xFF);
+      expect(child.getSystemBus().getMemory().getSharedRAMPageCount()).toBe(127);
+    });
+    expect(emulator.getSystemBus().getMemory().read(0x4000)).toBe(0);
+  });
+});
@@ -0,0 +1,115 @@
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { SystemConfigLoader } from '../../src/config/system';
+import { main, runHeadless, TIMEOUT_EXIT_CODE } from '../../src/headless';
+
+// Echo serial input until a newline, store it to $0300, then BRK (the IRQ
+// handler at $F025 spins)
+const ECHO = [
+  0xA2, 0x00,               // F000 LDX #0
+  0xAD, 0x00, 0x80,         // F002 LDA ACIA status
+  0x29, 0x01,               //      AND #RDRF
+  0xF0, 0xF9,               //      BEQ F002
+  0xAD, 0x01, 0x80,         // F009 LDA ACIA data
+  0x9D, 0x00, 0x02,         //      STA $0200,X
+  0x48,                     //      PHA
+  0xAD, 0x00, 0x80,         // F010 LDA ACIA status
+  0x29, 0x02,               //      AND #TDRE
+  0xF0, 0xF9,               //      BEQ F010
+  0x68,                     //      PLA
+  0x8D, 0x01, 0x80,         //      STA ACIA data
+  0xE8,                     //      INX
+  0xC9, 0x0A,               //      CMP #$0A
+  0xD0, 0xE2,               //      BNE F002
+  0x8D, 0x00, 0x03,         // F020 STA $0300
+  0x00, 0x00,               // F023 BRK
+  0x4C, 0x25, 0xF0          // F025 JMP F025
+];
+
+// LDA #3, LDX #0, LDY #EXIT, BRK $42, JMP *
+const EXIT = [0xA9, 0x03, 0xA2, 0x00, 0xA0, 0x02, 0x00, 0x42, 0x4C, 0x08, 0xF0];
+
+describe('Headless runner', () => {
+  let directory: string;
+
+  function writeROM(name: string, code: number[]): string {
+    const rom = new Uint8Array(0x1000);
+    rom.set(code);
+    rom.set([0x00, 0xF0, 0x00, 0xF0, 0x25, 0xF0], 0x0FFA);
+    const file = path.join(directory, name);
+    fs.writeFileSync(file, rom);
+    return file;
+  }
+
+  async function run(options: Parameters<typeof runHeadless>[0]) {
+    return runHeadless({ roms: [{ file: writeROM('echo.bin', ECHO), loadAddress: 0xF000, format: 'binary' }], ...options });
+  }
+
+  beforeEach(() => {
+    directory = fs.mkdtempSync(path.join(os.tmpdir(), 'headless-'));
+    jest.spyOn(console, 'log').mockImplementation(() => {});
+    jest.spyOn(console, 'error').mockImplementation(() => {});
+  });
+
+  afterEach(() => {
+    jest.restoreAllMocks();
+    fs.rmSync(directory, { recursive: true, force: true });
+  });
+
+  it('should stop on each exit condition', async () => {
+    const input = Buffer.from('hi\n');
+
+    const output = await run({ serialInput: input, untilOutput: /hi\n/ });
+    expect(output.reason).toBe('output');
+    expect(output.output).toBe('hi\n');
+    expect(output.exitCode).toBe(0);
+
+    const write = await run({ serialInput: input, untilWrite: [0x0300] });
+    expect(write).toMatchObject({ reason: 'write', address: 0x0300 });
+    expect(write.registers).toMatchObject({ PC: 0xF023, A: 0x0A, X: 3 });
+
+    const brk = await run({ serialInput: input, untilBrk: true });
+    expect(brk).toMatchObject({ reason: 'brk', address: 0xF023 });
+    expect(brk.registers.PC).toBe(0xF023);
+
+    const pc = await run({ serialInput: input, untilPC: [0xF020] });
+    expect(pc).toMatchObject({ reason: 'pc', address: 0xF020 });
+    expect(pc.stats.instructions).toBeGreaterThan(0);
+
+    const timeout = await run({ maxCycles: 20000 });
+    expect(timeout.reason).toBe('cycles');
+    expect(timeout.exitCode).toBe(TIMEOUT_EXIT_CODE);
+    expect(timeout.stats.cycles).toBeGreaterThanOrEqual(20000);
+    expect(timeout.output).toBe('');
+  });
+
+  it('should exit with the guest status from the command line', async () => {
+    const config = SystemConfigLoader.getDefaultConfig();
+    config.peripherals.hostCall = { baseAddress: 0x9000, brkSignature: 0x42 };
+    const configFile = path.join(directory, 'config.json');
+    fs.writeFileSync(configFile, JSON.stringify(config));
+    const resultFile = path.join(directory, 'result.json');
+
+    // Host-call BRKs are not stops
+    const code = await main(['--config', configFile, '--rom', `${writeROM('exit.bin', EXIT)}@F000`,
+      '--until-brk', '--result', resultFile]);
+    const result = JSON.parse(fs.readFileSync(resultFile, 'utf8'));
+    expect(code).toBe(3);
+    expect(result).toMatchObject({ reason: 'exit', exitStatus: 3, exitCode: 3 });
+    expect(result.registers.PC).toBe(0xF008);
+
+    expect(await main(['--until-pc', 'nowhere'])).toBe(2);
+    expect(await main(['--rom', 'exit.bin'])).toBe(2);
+  });
+
+  it('should exit with the usage status when the ROM or configuration cannot be loaded', async () => {
+    const missing = path.join(directory, 'missing.bin');
+    expect(await main(['--rom', `${missing}@F000`])).toBe(2);
+    expect(console.error).toHaveBeenCalledWith(expect.stringContaining('missing.bin'));
+
+    const configFile = path.join(directory, 'config.json');
+    fs.writeFileSync(configFile, '{ not json');
+    expect(await main(['--config', configFile, '--rom', `${writeROM('exit.bin', EXIT)}@F000`])).toBe(2);
+  });
+});
@@ -0,0 +1,305 @@
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { SystemBus } from '../../src/core/bus';
+import { Emulator } from '../../src/emulator';
+import { SystemConfigLoader } from '../../src/config/system';
+import {
+  HOST_CALL_REGISTERS, HostCallDevice, HostCallRegister, HostCallService, HostCallStatus
+} from '../../src/peripherals/host-call';
+
+const BASE = 0x9000;
+
+function createBus(program: number[], output: string[]): { bus: SystemBus; device: HostCallDevice } {
+  const bus = new SystemBus();
+  bus.getMemory().configureRAM(0x0000, 0x8000);
+  program.forEach((byte, i) => bus.getMemory().write(0x0200 + i, byte));
+  Buffer.from('hello\n\0').forEach((byte, i) => bus.getMemory().write(0x0300 + i, byte));
+  const device = new HostCallDevice();
+  device.setOutput(text => output.push(text));
+  bus.getPeripheralHub().registerPeripheral(device, BASE, BASE + HOST_CALL_REGISTERS - 1, 'HostCall');
+  bus.getCPU().clearBreakpoints();
+  bus.getCPU().setRegisters({ A: 0, X: 0, Y: 0, SP: 0xFF, P: 0x24, PC: 0x0200 });
+  return { bus, device };
+}
+
+function runTo(bus: SystemBus, pc: number): void {
+  for (let i = 0; i < 100 && bus.getCPU().getRegisters().PC !== pc; i++) {
+    bus.step();
+  }
+}
+
+function deviceWithMemory(directory?: string): { device: HostCallDevice; memory: Uint8Array } {
+  const memory = new Uint8Array(0x10000);
+  const device = new HostCallDevice({ directory });
+  device.connectMemory({ read: address => memory[address], write: (address, value) => { memory[address] = value; } });
+  return { device, memory };
+}
+
+function call(device: HostCallDevice, service: HostCallService, arg: number): { status: number; result: number } {
+  device.write(HostCallRegister.ARG_LO, arg & 0xFF);
+  device.write(HostCallRegister.ARG_HI, arg >> 8);
+  device.write(HostCallRegister.SERVICE, service);
+  return {
+    status: device.read(HostCallRegister.STATUS),
+    result: device.read(HostCallRegister.RESULT_LO) | (device.read(HostCallRegister.RESULT_HI) << 8)
+  };
+}
+
+describe('Host-call device', () => {
+  it('should perform services written to its registers', () => {
+    // ARG = $0300, SERVICE = PUTS, LDA RESULT, JMP *
+    const output: string[] = [];
+    const { bus } = createBus([
+      0xA9, 0x00, 0x8D, 0x02, 0x90, 0xA9, 0x03, 0x8D, 0x03, 0x90, 0xA9, 0x01, 0x8D, 0x00, 0x90,
+      0xAD, 0x04, 0x90, 0x4C, 0x12, 0x02
+    ], output);
+    runTo(bus, 0x0212);
+
+    expect(output).toEqual(['hello\n']);
+    expect(bus.getCPU().getRegisters().A).toBe(6);
+  });
+
+  it('should turn BRK with the signature into a call', () => {
+    // LDA #<str, LDX #>str, LDY #PUTS, BRK $42, STA $10, LDY #9, BRK $42, JMP *
+    const output: string[] = [];
+    const { bus } = createBus([
+      0xA9, 0x00, 0xA2, 0x03, 0xA0, 0x01, 0x00, 0x42, 0x85, 0x10, 0xA0, 0x09, 0x00, 0x42, 0x4C, 0x0E, 0x02
+    ], output);
+    const cpu = bus.getCPU();
+    cpu.setBrkTrap!({ signature: 0x42, address: BASE });
+
+    runTo(bus, 0x0208);
+    let registers = cpu.getRegisters();
+    expect(output).toEqual(['hello\n']);
+    expect(registers.A).toBe(6);
+    expect(registers.SP).toBe(0xFF);
+    expect(registers.P & 0x05).toBe(0x04);  // Carry clear, I unchanged
+
+    runTo(bus, 0x020E);
+    registers = cpu.getRegisters();
+    expect(registers.PC).toBe(0x020E);
+    expect(registers.P & 0x01).toBe(0x01);  // Unknown service
+    expect(bus.getPeripheralHub().read(BASE + HostCallRegister.STATUS)).toBe(HostCallStatus.UNKNOWN_SERVICE);
+
+    // Other signatures are ordinary BRKs
+    cpu.setBrkTrap!(null);
+    cpu.setRegisters({ PC: 0x0206 });
+    bus.step();
+    expect(cpu.getRegisters().SP).toBe(0xFC);
+  });
+
+  it('should transfer files inside its directory only', () => {
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'host-call-'));
+    try {
+      const { device, memory } = deviceWithMemory(directory);
+      memory.set(Buffer.from('out.bin\0'), 0x0300);
+      memory.set(Buffer.from('../out.bin\0'), 0x0310);
+      memory.set([1, 2, 3, 4], 0x0400);
+
+      // {name, buffer, length, flags}
+      memory.set([0x00, 0x03, 0x00, 0x04, 0x04, 0x00, 0x00], 0x0320);
+      expect(call(device, HostCallService.WRITE_FILE, 0x0320)).toEqual({ status: HostCallStatus.OK, result: 4 });
+      memory[0x0326] = 1;
+      expect(call(device, HostCallService.WRITE_FILE, 0x0320).result).toBe(4);
+      expect(Array.from(fs.readFileSync(path.join(directory, 'out.bin')))).toEqual([1, 2, 3, 4, 1, 2, 3, 4]);
+
+      memory.set([0x00, 0x03, 0x00, 0x05, 0x10, 0x00], 0x0330);
+      expect(call(device, HostCallService.READ_FILE, 0x0330)).toEqual({ status: HostCallStatus.OK, result: 8 });
+      expect(Array.from(memory.subarray(0x0500, 0x0509))).toEqual([1, 2, 3, 4, 1, 2, 3, 4, 0]);
+
+      memory.set([0x10, 0x03, 0x00, 0x05, 0x10, 0x00], 0x0330);
+      expect(call(device, HostCallService.READ_FILE, 0x0330).status).toBe(HostCallStatus.ACCESS_DENIED);
+      memory.set([0x00, 0x03, 0x00, 0x05, 0x10, 0x00], 0x0330);
+      fs.unlinkSync(path.join(directory, 'out.bin'));
+      expect(call(device, HostCallService.READ_FILE, 0x0330).status).toBe(HostCallStatus.IO_ERROR);
+
+      expect(call(deviceWithMemory().device, HostCallService.READ_FILE, 0x0330).status).toBe(HostCallStatus.ACCESS_DENIED);
+    } finally {
+      fs.rmSync(directory, { recursive: true, force: true });
+    }
+  });
+
+  it('should follow symbolic links when checking the directory', () => {
+    const parent = fs.mkdtempSync(path.join(os.tmpdir(), 'host-call-'));
+    try {
+      const directory = path.join(parent, 'files');
+      fs.mkdirSync(directory);
+      fs.writeFileSync(path.join(parent, 'secret.bin'), Buffer.from([1, 2]));
+      fs.symlinkSync(path.join(parent, 'secret.bin'), path.join(directory, 'link.bin'));
+
+      // {name, buffer, length}
+      const { device, memory } = deviceWithMemory(directory);
+      memory.set(Buffer.from('link.bin\0'), 0x0300);
+      memory.set([0x00, 0x03, 0x00, 0x05, 0x10, 0x00], 0x0330);
+      expect(call(device, HostCallService.READ_FILE, 0x0330).status).toBe(HostCallStatus.ACCESS_DENIED);
+
+      // The file system root holds every path
+      const root = deviceWithMemory(path.parse(parent).root);
+      root.memory.set(Buffer.from(path.relative(path.parse(parent).root, path.join(parent, 'secret.bin')) + '\0'), 0x0300);
+      root.memory.set([0x00, 0x03, 0x00, 0x05, 0x10, 0x00], 0x0330);
+      expect(call(root.device, HostCallService.READ_FILE, 0x0330)).toEqual({ status: HostCallStatus.OK, result: 2 });
+    } finally {
+      fs.rmSync(parent, { recursive: true, force: true });
+    }
+  });
+
+  it('should report emulated time and the host clock', () => {
+    const { device, memory } = deviceWithMemory();
+    device.setWallClock(() => 1700000000);
+    device.tick(2500000);
+    expect(call(device, HostCallService.CLOCK, 0x0400).status).toBe(HostCallStatus.OK);
+    const view = new DataView(memory.buffer);
+    expect(view.getUint32(0x0400, true)).toBe(2500);  // At 1 MHz
+    expect(view.getUint32(0x0404, true)).toBe(1700000000);
+
+    device.reset();
+    call(device, HostCallService.CLOCK, 0x0400);
+    expect(view.getUint32(0x0400, true)).toBe(0);
+  });
+});
+
+describe('Host-call configuration', () => {
+  it('should register the device and stop on EXIT', async () => {
+    const config = SystemConfigLoader.getDefaultConfig();
+    config.peripherals.hostCall = { baseAddress: BASE, brkSignature: 0x42 };
+    const emulator = new Emulator(config);
+    await emulator.initialize();
+
+    // LDA #7, LDX #0, LDY #EXIT, BRK $42, JMP *
+    const memory = emulator.getSystemBus().getMemory();
+    [0xA9, 0x07, 0xA2, 0x00, 0xA0, 0x02, 0x00, 0x42, 0x4C, 0x08, 0x00].forEach((byte, i) => memory.write(i, byte));
+    expect(emulator.getExitStatus()).toBeNull();
+    for (let i = 0; i < 4; i++) {
+      emulator.step();
+    }
+    expect(emulator.getExitStatus()).toBe(7);
+    expect(emulator.getHostCallDevice()).toBeDefined();
+    expect(emulator.fork().getExitStatus()).toBe(7);
+
+    emulator.reset();
+    expect(emulator.getExitStatus()).toBeNull();
+  });
+
+  it('should replay recorded host clock readings', async () => {
+    const config = SystemConfigLoader.getDefaultConfig();
+    config.peripherals.hostCall = { baseAddress: BASE, brkSignature: 0x42 };
+    const emulator = new Emulator(config);
+    await emulator.initialize();
+
+    // Reset clears RAM, so the program is loaded after each one
+    // LDA #$00, LDX #$04, LDY #CLOCK, BRK $42, JMP *
+    const memory = emulator.getSystemBus().getMemory();
+    const load = (): void => {
+      [0xA9, 0x00, 0xA2, 0x04, 0xA0, 0x05, 0x00, 0x42, 0x4C, 0x08, 0x00].forEach((byte, i) => memory.write(i, byte));
+    };
+    const run = (): void => {
+      for (let i = 0; i < 5; i++) {
+        emulator.step();
+      }
+    };
+    const readClock = (): number[] => [0, 4].map(offset =>
+      memory.read(0x0400 + offset) | (memory.read(0x0401 + offset) << 8) |
+      (memory.read(0x0402 + offset) << 16) | (memory.read(0x0403 + offset) << 24));
+    const now = jest.spyOn(Date, 'now');
+    try {
+      now.mockReturnValue(1700000000000);
+      emulator.startRecording();
+      load();
+      run();
+      const log = emulator.stopRecording();
+      const recorded = readClock();
+      expect(recorded[1]).toBe(1700000000);
+
+      now.mockReturnValue(1800000000000);
+      emulator.startReplay(log);
+      load();
+      run();
+      expect(readClock()).toEqual(recorded);
+
+      // Reverse execution re-runs the call with the reading it saw first
+      emulator.stopReplay();
+      emulator.reset();
+      load();
+      emulator.enableReverseExecution(true);
+      run();
+      const seen = readClock();
+      expect(seen[1]).toBe(1800000000);
+      now.mockReturnValue(1900000000000);
+      const history = emulator.getExecutionHistory();
+      expect(history.reverseStep(3)).toBe(true);
+      for (let i = 0; i < 3; i++) {
+        emulator.step();
+      }
+      expect(readClock()).toEqual(seen);
+    } finally {
+      now.mockRestore();
+    }
+  });
+
+  it('should not repeat host side effects in reverse execution', async () => {
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'host-call-'));
+    try {
+      const config = SystemConfigLoader.getDefaultConfig();
+      config.peripherals.hostCall = { baseAddress: BASE, brkSignature: 0x42, directory };
+      const emulator = new Emulator(config);
+      await emulator.initialize();
+      const output: string[] = [];
+      emulator.getHostCallDevice()!.setOutput(text => output.push(text));
+
+      // PUTS "hi", WRITE_FILE appending 2 bytes, READ_FILE, JMP *
+      const memory = emulator.getSystemBus().getMemory();
+      [
+        0xA9, 0x10, 0xA2, 0x03, 0xA0, 0x01, 0x00, 0x42,
+        0xA9, 0x20, 0xA2, 0x03, 0xA0, 0x04, 0x00, 0x42,
+        0xA9, 0x30, 0xA2, 0x03, 0xA0, 0x03, 0x00, 0x42,
+        0x4C, 0x18, 0x00
+      ].forEach((byte, i) => memory.write(i, byte));
+      const blocks = [
+        [0x0300, [...Buffer.from('f.bin\0')]],
+        [0x0310, [...Buffer.from('hi\0')]],
+        [0x0320, [0x00, 0x03, 0x00, 0x04, 0x02, 0x00, 0x01]],
+        [0x0330, [0x00, 0x03, 0x00, 0x05, 0x10, 0x00]],
+        [0x0400, [7, 8]]
+      ] as const;
+      blocks.forEach(([address, bytes]) => bytes.forEach((byte, i) => memory.write(address + i, byte)));
+      const file = path.join(directory, 'f.bin');
+      const readBack = () => [memory.read(0x0500), memory.read(0x0501), memory.read(0x0502)];
+
+      emulator.enableReverseExecution(true);
+      for (let i = 0; i < 13; i++) {
+        emulator.step();
+      }
+      expect(output).toEqual(['hi']);
+      expect(Array.from(fs.readFileSync(file))).toEqual([7, 8]);
+      expect(readBack()).toEqual([7, 8, 0]);
+
+      // Re-run every call against a file that has changed since
+      fs.writeFileSync(file, Buffer.from([9, 9, 9]));
+      expect(emulator.getExecutionHistory().reverseStep(12)).toBe(true);
+      expect(readBack()).toEqual([0, 0, 0]);
+      for (let i = 0; i < 12; i++) {
+        emulator.step();
+      }
+      expect(output).toEqual(['hi']);
+      expect(Array.from(fs.readFileSync(file))).toEqual([9, 9, 9]);
+      expect(readBack()).toEqual([7, 8, 0]);
+      expect(emulator.getSystemBus().getCPU().getRegisters().A).toBe(2);
+    } finally {
+      fs.rmSync(directory, { recursive: true, force: true });
+    }
+  });
+
+  it('should validate the BRK signature', () => {
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'host-call-'));
+    try {
+      const file = path.join(directory, 'config.json');
+      fs.writeFileSync(file, JSON.stringify({ peripherals: { hostCall: { baseAddress: BASE, brkSignature: 300 } } }));
+      expect(() => SystemConfigLoader.loadFromFile(file)).toThrow('BRK signature');
+      fs.writeFileSync(file, JSON.stringify({ peripherals: { hostCall: { baseAddress: 0x8000 } } }));
+      expect(() => SystemConfigLoader.loadFromFile(file)).toThrow('Address conflict');
+    } finally {
+      fs.rmSync(directory, { recursive: true, force: true });
+    }
+  });
+});
@@ -0,0 +1,136 @@
+import { InputRecorder } from '../../src/debug/input-recorder';
+import { InputLog, InputLogError } from '../../src/debug/input-log';
+import { SystemBus } from '../../src/core/bus';
+import { ACIA68B50 } from '../../src/peripherals/acia';
+import { MemorySerialPort } from '../../src/peripherals/serial-port';
+
+// LDA $8000 / STA $10 / LDA $8001 / STA $11 / JMP $0200
+const PROGRAM = [
+  0xAD, 0x00, 0x80,
+  0x85, 0x10,
+  0xAD, 0x01, 0x80,
+  0x85, 0x11,
+  0x4C, 0x00, 0x02
+];
+
+function createMachine(): { bus: SystemBus; recorder: InputRecorder; port: MemorySerialPort } {
+  const bus = new SystemBus();
+  bus.getMemory().configureRAM(0x0000, 0x8000);
+  PROGRAM.forEach((byte, i) => bus.getMemory().write(0x0200 + i, byte));
+
+  const acia = new ACIA68B50();
+  bus.getPeripheralHub().registerPeripheral(acia, 0x8000, 0x8001, 'ACIA');
+
+  const recorder = new InputRecorder(bus);
+  const port = new MemorySerialPort();
+  acia.connectSerial(recorder.wrapSerialPort(port, 'ACIA'));
+
+  bus.getCPU().clearBreakpoints();
+  bus.getCPU().setRegisters({ A: 0, X: 0, Y: 0, SP: 0xFF, P: 0x24, PC: 0x0200 });
+  return { bus, recorder, port };
+}
+
+function traceStep(bus: SystemBus): string {
+  const regs = bus.getCPU().getRegisters();
+  const memory = bus.getMemory();
+  return `${bus.getCycleCount()}:${regs.PC}:${regs.A}:${memory.read(0x10)}:${memory.read(0x11)}`;
+}
+
+describe('InputLog', () => {
+  it('should round-trip through the binary format', () => {
+    const log = new InputLog([
+      { cycle: 0, kind: 'irq', source: 'debug' },
+      { cycle: 130, kind: 'serial', source: 'ACIA', value: 0x41 },
+      { cycle: 130, kind: 'clear-irq', source: 'debug' },
+      { cycle: 5000000000, kind: 'nmi', source: 'debug' }
+    ]);
+
+    const data = log.serialize();
+    expect(InputLog.deserialize(data).getEvents()).toEqual(log.getEvents());
+    expect(data.length).toBeLessThan(40);
+  });
+
+  it('should round-trip host clock readings and file accesses', () => {
+    const log = new InputLog([
+      { cycle: 12, kind: 'serial', source: 'ACIA', value: 0x41 },
+      { cycle: 900, kind: 'clock', source: 'HostCall', value: 1700000000 },
+      { cycle: 950, kind: 'file', source: 'HostCall', value: 0, data: Uint8Array.from({ length: 300 }, (_, i) => i & 0xFF) },
+      { cycle: 990, kind: 'file', source: 'HostCall', value: 2 }
+    ]);
+    expect(InputLog.deserialize(log.serialize()).getEvents()).toEqual(log.getEvents());
+  });
+
+  it('should reject out-of-order events and malformed data', () => {
+    const log = new InputLog([{ cycle: 10, kind: 'irq', source: 'debug' }]);
+    expect(() => log.append({ cycle: 5, kind: 'irq', source: 'debug' })).toThrow(InputLogError);
+    expect(() => InputLog.deserialize(Buffer.from([1, 2, 3, 4, 5]))).toThrow(InputLogError);
+    expect(() => InputLog.deserialize(log.serialize().subarray(0, 10))).toThrow(InputLogError);
+  });
+});
+
+describe('InputRecorder', () => {
+  it('should timestamp inputs with the bus cycle count', () => {
+    const { bus, recorder, port } = createMachine();
+    recorder.startRecording();
+
+    bus.step();
+    const cycle = bus.getCycleCount();
+    port.addReceiveData(0x41);
+    bus.step();
+    recorder.recordInput('irq', 'debug');
+
+    const events = recorder.stop().getEvents();
+    expect(events[0]).toEqual({ cycle, kind: 'serial', source: 'ACIA', value: 0x41 });
+    expect(events[1]).toEqual({ cycle: bus.getCycleCount(), kind: 'irq', source: 'debug', value: undefined });
+  });
+
+  it('should reproduce a recorded run exactly without the host port', () => {
+    const recording = createMachine();
+    recording.recorder.startRecording();
+
+    const recordedTrace: string[] = [];
+    for (let i = 0; i < 600; i++) {
+      if (i === 20) {
+        recording.port.addReceiveData(0x41);
+      }
+      if (i === 350) {
+        recording.port.addReceiveData(0x42);
+      }
+      if (i === 400) {
+        recording.recorder.recordInput('clear-irq', 'debug');
+        recording.bus.getInterruptController().clearIRQ('debug');
+      }
+      recording.bus.step();
+      recordedTrace.push(traceStep(recording.bus));
+    }
+
+    const data = recording.recorder.stop().serialize();
+    expect(recordedTrace.some(entry => entry.endsWith(':66'))).toBe(true);
+
+    const replay = createMachine();
+    replay.recorder.startReplay(InputLog.deserialize(data));
+    expect(replay.recorder.isReplaying()).toBe(true);
+
+    const replayedTrace: string[] = [];
+    for (let i = 0; i < 600; i++) {
+      replay.recorder.deliverInputs();
+      replay.bus.step();
+      replayedTrace.push(traceStep(replay.bus));
+    }
+
+    expect(replayedTrace).toEqual(recordedTrace);
+    expect(replay.recorder.isReplaying()).toBe(false);
+  });
+
+  it('should ignore host input while replaying', () => {
+    const { bus, recorder, port } = createMachine();
+    recorder.startReplay(new InputLog([{ cycle: 1000000, kind: 'irq', source: 'debug' }]));
+
+    port.addReceiveData(0x55);
+    for (let i = 0; i < 10; i++) {
+      recorder.deliverInputs();
+      bus.step();
+    }
+    expect(port.hasData()).toBe(true);
+  });
+});
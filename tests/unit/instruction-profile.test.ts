@@ -0,0 +1,209 @@
+import { CPU6502Emulator } from '../../src/core/cpu';
+import { EmulatorProfiler, getCallGraphReport, getInstructionHotspots } from '../../src/performance/profiler';
+import { CC65SymbolParser } from '../../src/cc65/symbol-parser';
+
+// LDX #$03 / loop: DEX / BNE loop / JMP $0200
+const PROGRAM = [0xA2, 0x03, 0xCA, 0xD0, 0xFD, 0x4C, 0x00, 0x02];
+
+function createCPU(): { cpu: CPU6502Emulator; memory: Uint8Array } {
+  const memory = new Uint8Array(0x10000);
+  memory.set(PROGRAM, 0x0200);
+  memory.set([0x00, 0x03], 0xFFFE);
+  memory[0x0300] = 0x40;  // RTI
+  const cpu = new CPU6502Emulator();
+  cpu.setMemoryCallbacks(address => memory[address], (address, value) => { memory[address] = value; });
+  cpu.setRegisters({ PC: 0x0200, SP: 0xFD, P: 0x24 });
+  return { cpu, memory };
+}
+
+describe('Instruction profile', () => {
+  it('should count executions and cycles per PC', () => {
+    const { cpu } = createCPU();
+    expect(cpu.getProfile()).toBeNull();
+    cpu.setProfiling(true);
+
+    // Two passes: LDX, 3 x DEX, 3 x BNE (two taken), JMP
+    for (let i = 0; i < 16; i++) {
+      cpu.step();
+    }
+
+    const profile = cpu.getProfile()!;
+    expect(profile.counts[0x0200]).toBe(2);
+    expect(profile.counts[0x0202]).toBe(6);
+    expect(profile.counts[0x0203]).toBe(6);
+    expect(profile.counts[0x0205]).toBe(2);
+    expect(profile.cycles[0x0203]).toBe(2 * (3 + 3 + 2));
+    expect(profile.cycles[0x0205]).toBe(2 * 3);
+    expect(profile.counts.reduce((sum, count) => sum + count, 0)).toBe(16);
+  });
+
+  it('should not count interrupt entry', () => {
+    const { cpu } = createCPU();
+    cpu.setRegisters({ P: 0x20 });
+    cpu.setProfiling(true);
+    cpu.triggerIRQ();
+    expect(cpu.step()).toBe(7);
+    expect(cpu.getRegisters().PC).toBe(0x0300);
+    expect(cpu.getProfile()!.counts.every(count => count === 0)).toBe(true);
+
+    cpu.step();
+    expect(cpu.getProfile()!.counts[0x0300]).toBe(1);
+  });
+
+  it('should keep separate profiles per CPU and stop when disabled', () => {
+    const { cpu } = createCPU();
+    const { cpu: other } = createCPU();
+    cpu.setProfiling(true);
+    other.step();
+    cpu.step();
+    expect(cpu.getProfile()!.counts[0x0200]).toBe(1);
+
+    const profile = cpu.getProfile()!;
+    cpu.setProfiling(false);
+    cpu.step();
+    expect(cpu.getProfile()).toBeNull();
+    expect(profile.counts[0x0202]).toBe(0);
+  });
+
+  it('should rank addresses by cycles', () => {
+    const { cpu } = createCPU();
+    cpu.setProfiling(true);
+    for (let i = 0; i < 16; i++) {
+      cpu.step();
+    }
+
+    const hotspots = getInstructionHotspots(cpu.getProfile()!, 2);
+    expect(hotspots.map(h => h.address)).toEqual([0x0203, 0x0202]);
+    // 16 + 12 of 4 + 12 + 16 + 6 cycles
+    expect(hotspots[0].cyclePercent).toBeCloseTo((16 / 38) * 100);
+  });
+});
+
+function createCallCPU(code: { [address: number]: number[] }): { cpu: CPU6502Emulator; memory: Uint8Array } {
+  const { cpu, memory } = createCPU();
+  for (const [address, bytes] of Object.entries(code)) {
+    memory.set(bytes, Number(address));
+  }
+  return { cpu, memory };
+}
+
+function run(cpu: CPU6502Emulator, steps: number): void {
+  for (let i = 0; i < steps; i++) {
+    cpu.step();
+  }
+}
+
+describe('Call graph', () => {
+  it('should attribute inclusive and exclusive cycles per subroutine', () => {
+    // JSR $0300 / JSR $0310 / JMP *, $0300: JSR $0310 / RTS, $0310: NOP / RTS
+    const { cpu } = createCallCPU({
+      0x0200: [0x20, 0x00, 0x03, 0x20, 0x10, 0x03, 0x4C, 0x06, 0x02],
+      0x0300: [0x20, 0x10, 0x03, 0x60],
+      0x0310: [0xEA, 0x60]
+    });
+    cpu.setCallGraph(true);
+    run(cpu, 9);
+
+    const graph = cpu.getCallGraph()!;
+    expect(graph.calls[0x0300]).toBe(1);
+    expect(graph.calls[0x0310]).toBe(2);
+    expect(graph.inclusive[0x0300]).toBe(6 + 8 + 6);
+    expect(graph.inclusive[0x0310]).toBe(16);
+    expect(graph.exclusive[0x0200]).toBe(6 + 6 + 3);
+    expect(graph.exclusive[0x0300]).toBe(12);
+    expect(graph.exclusive[0x0310]).toBe(16);
+
+    const symbols = new CC65SymbolParser();
+    symbols.parseSymbolFile('main=$0200 label\nouter=$0300 label\ninner=$0310 label');
+    const report = getCallGraphReport(graph, symbols);
+    expect(report.totalCycles).toBe(43);
+    expect(report.stack).toEqual([0x0200]);
+    expect(report.routines.map(r => [r.name, r.inclusive])).toEqual([['main', 43], ['outer', 20], ['inner', 16]]);
+    expect(report.edges.map(e => [e.caller, e.callee, e.calls, e.cycles])).toEqual([
+      [0x0200, 0x0300, 1, 20],
+      [0x0200, 0x0310, 1, 8],
+      [0x0300, 0x0310, 1, 8]
+    ]);
+  });
+
+  it('should keep counting past 32 bits of cycles', () => {
+    const { cpu } = createCallCPU({
+      0x0200: [0x20, 0x00, 0x03, 0x20, 0x10, 0x03, 0x4C, 0x06, 0x02],
+      0x0300: [0x20, 0x10, 0x03, 0x60],
+      0x0310: [0xEA, 0x60]
+    });
+    cpu.setCallGraph(true);
+    const graph = cpu.getCallGraph()!;
+    const start = 2 ** 32 - 10;  // Over an hour at a real 6502's 1 MHz
+    graph.clock[0] = start;
+    graph.exclusive[0x0200] = start;
+    run(cpu, 9);
+
+    const report = getCallGraphReport(graph);
+    expect(report.totalCycles).toBe(start + 43);
+    expect(report.routines.map(r => [r.address, r.inclusive])).toEqual([[0x0200, start + 43], [0x0300, 20], [0x0310, 16]]);
+    expect(report.routines[0].inclusivePercent).toBe(100);
+    expect(report.routines[0].exclusive).toBe(start + 15);
+    expect(report.edges[0].cycles).toBe(20);
+  });
+
+  it('should treat RTS dispatch as a jump and follow TXS', () => {
+    // $0300: LDA #$03 / PHA / LDA #$0F / PHA / RTS (to $0310) ... $0310: LDX #$FD / TXS / JMP *
+    const { cpu } = createCallCPU({
+      0x0200: [0x20, 0x00, 0x03],
+      0x0300: [0xA9, 0x03, 0x48, 0xA9, 0x0F, 0x48, 0x60],
+      0x0310: [0xA2, 0xFD, 0x9A, 0x4C, 0x13, 0x03]
+    });
+    cpu.setCallGraph(true);
+    run(cpu, 6);
+    expect(cpu.getRegisters().PC).toBe(0x0310);
+    expect(getCallGraphReport(cpu.getCallGraph()!).stack).toEqual([0x0200, 0x0300]);
+
+    // Resetting SP unwinds the frame that still held the return address
+    run(cpu, 3);
+    const report = getCallGraphReport(cpu.getCallGraph()!);
+    expect(report.stack).toEqual([0x0200]);
+    expect(report.routines.find(r => r.address === 0x0300)!.inclusive).toBe(2 + 3 + 2 + 3 + 6 + 2 + 2);
+  });
+
+  it('should count recursion once and charge interrupts to the handler', () => {
+    // $0300: DEX / BEQ done / JSR $0300 / done: RTS; IRQ handler at $0400: RTI
+    const { cpu } = createCallCPU({
+      0x0200: [0x20, 0x00, 0x03, 0x4C, 0x03, 0x02],
+      0x0300: [0xCA, 0xF0, 0x03, 0x20, 0x00, 0x03, 0x60],
+      0x0400: [0x40],
+      0xFFFE: [0x00, 0x04]
+    });
+    cpu.setRegisters({ X: 2, P: 0x20 });
+    cpu.setCallGraph(true);
+    run(cpu, 9);
+
+    const graph = cpu.getCallGraph()!;
+    expect(graph.calls[0x0300]).toBe(2);
+    expect(graph.inclusive[0x0300]).toBe(27);
+    expect(graph.exclusive[0x0300]).toBe(27);
+
+    cpu.triggerIRQ();
+    run(cpu, 2);
+    expect(graph.calls[0x0400]).toBe(1);
+    expect(graph.inclusive[0x0400]).toBe(7 + 6);
+    expect(graph.exclusive[0x0400]).toBe(7 + 6);
+    expect(graph.stack[0]).toBe(1);
+  });
+});
+
+describe('EmulatorProfiler samples', () => {
+  it('should keep the most recent samples in order', () => {
+    const profiler = new EmulatorProfiler();
+    profiler.enable();
+    profiler.setMaxSamples(3);
+    for (let address = 0; address < 5; address++) {
+      profiler.recordSample('memory_read', address, 1);
+    }
+    expect(profiler.exportData().samples.map(sample => sample.address)).toEqual([2, 3, 4]);
+    expect(profiler.getMetrics().memoryAccesses).toBe(5);
+
+    profiler.setMaxSamples(2);
+    expect(profiler.exportData().samples.map(sample => sample.address)).toEqual([3, 4]);
+  });
+});
@@ -0,0 +1,84 @@
+import { Worker } from 'worker_threads';
+import { MemoryManager } from '../../src/core/memory';
+import { MemoryView } from '../../src/debug/memory-view';
+
+function createMemory(): MemoryManager {
+  const memory = new MemoryManager();
+  memory.configureRAM(0x0000, 0x8000);
+  memory.loadROM(new Uint8Array([0xA9, 0x42, 0x4C, 0x00, 0xE0]), 0xE000);
+  return memory;
+}
+
+describe('MemoryManager shared memory', () => {
+  it('should expose live RAM and ROM without copies', () => {
+    const memory = createMemory();
+    const view = new MemoryView(memory.getSharedMemory());
+
+    memory.write(0x1234, 0x99);
+    expect(view.read(0x1234)).toBe(0x99);
+    expect(view.read(0xE001)).toBe(0x42);
+    expect(view.read(0x9000)).toBe(0xFF);
+
+    const live = view.readRange(0x1230, 8);
+    memory.write(0x1230, 0x11);
+    expect(live[0]).toBe(0x11);
+    expect(live[4]).toBe(0x99);
+  });
+
+  it('should report pages written since the previous check', () => {
+    const memory = createMemory();
+    const view = new MemoryView(memory.getSharedMemory());
+    expect(view.getChangedPages()).toEqual([]);
+
+    memory.write(0x0010, 1);
+    memory.write(0x0300, 2);
+    memory.write(0x0301, 3);
+    expect(view.getChangedPages()).toEqual([0x00, 0x03]);
+    expect(view.getChangedPages()).toEqual([]);
+  });
+
+  it('should mark views stale once RAM is forked', () => {
+    const memory = createMemory();
+    memory.write(0x2000, 0x55);
+    const view = new MemoryView(memory.getSharedMemory());
+
+    memory.fork();
+    expect(view.isStale()).toBe(true);
+
+    memory.write(0x2000, 0x66);
+    const fresh = new MemoryView(memory.getSharedMemory());
+    expect(fresh.isStale()).toBe(false);
+    expect(fresh.read(0x2000)).toBe(0x66);
+    expect(fresh.read(0x2001)).toBe(0x00);
+  });
+
+  it('should be readable from another thread', async () => {
+    const memory = createMemory();
+    const descriptor = memory.getSharedMemory();
+    memory.write(0x0400, 0x7E);
+
+    const worker = new Worker(`
+      const { parentPort, workerData } = require('worker_threads');
+      const ram = workerData.regions.find(region => region.type === 'RAM');
+      parentPort.postMessage(new Uint8Array(ram.buffer)[0x0400]);
+    `, { eval: true, workerData: descriptor });
+
+    const value = await new Promise(resolve => worker.once('message', resolve));
+    await worker.terminate();
+    expect(value).toBe(0x7E);
+  });
+
+  it('should copy whole pages in readRange and route other addresses through read()', () => {
+    const memory = createMemory();
+    const reads: number[] = [];
+    memory.mapPeripheral(0x7F00, 0x7F0F, {
+      read: (offset: number) => { reads.push(offset); return 0xA0 + offset; },
+      write: () => {}, reset: () => {}, tick: () => {}, getInterruptStatus: () => false
+    });
+    memory.write(0x7EFF, 0x33);
+
+    const data = memory.readRange(0x7EFE, 4);
+    expect(Array.from(data)).toEqual([0x00, 0x33, 0xA0, 0xA1]);
+    expect(reads).toEqual([0, 1]);
+  });
+});
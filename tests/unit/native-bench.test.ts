@@ -0,0 +1,56 @@
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { spawnSync } from 'child_process';
+
+const BENCH = path.join(__dirname, '../../build/Release/fake6502_bench');
+
+// Built with the addon by node-gyp
+const describeBench = fs.existsSync(BENCH) ? describe : describe.skip;
+
+describeBench('Native benchmark', () => {
+  it('should time and verify workloads on every engine', () => {
+    const run = spawnSync(BENCH, ['--runs', '2', '--warmup', '0', '--lanes', '2', '--workload', 'memcpy', '--workload', 'bcd', '--json'],
+      { encoding: 'utf8' });
+    expect(run.status).toBe(0);
+
+    const { benchmarks } = JSON.parse(run.stdout);
+    expect(benchmarks.map((b: { engine: string; workload: string }) => `${b.engine}/${b.workload}`)).toEqual([
+      'core/memcpy', 'callbacks/memcpy', 'batch/memcpy', 'core/bcd', 'callbacks/bcd', 'batch/bcd'
+    ]);
+    for (const benchmark of benchmarks) {
+      expect(benchmark.verified).toBe(true);
+      expect(benchmark.seconds).toHaveLength(2);
+      expect(benchmark.instructionsPerSecond).toBeGreaterThan(0);
+      expect(benchmark.nsPerInstruction).toBeCloseTo(1e9 / benchmark.instructionsPerSecond, 2);
+    }
+
+    // Every engine executes the same program; the batch runs it per lane
+    const [core, callbacks, batch] = benchmarks;
+    expect(callbacks.cycles).toBe(core.cycles);
+    expect(batch.instructions).toBe(core.instructions * 2);
+    expect(batch.cycles).toBe(core.cycles * 2);
+  });
+
+  it('should report a functional test that traps', () => {
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'native-bench-'));
+    try {
+      // JMP * at $0400, the start address
+      const image = path.join(directory, 'functional.bin');
+      fs.writeFileSync(image, Buffer.concat([Buffer.alloc(0x400), Buffer.from([0x4C, 0x00, 0x04])]));
+
+      const pass = spawnSync(BENCH, ['--engine', 'core', '--workload', 'functional', '--functional-test', image,
+        '--functional-success', '0400', '--runs', '1', '--json'], { encoding: 'utf8' });
+      expect(pass.status).toBe(0);
+
+      const fail = spawnSync(BENCH, ['--engine', 'core', '--workload', 'functional', '--functional-test', image,
+        '--runs', '1'], { encoding: 'utf8' });
+      expect(fail.status).toBe(1);
+      expect(fail.stdout).toContain('FAILED, trapped at $0400');
+
+      expect(spawnSync(BENCH, ['--engine', 'jit']).status).toBe(2);
+    } finally {
+      fs.rmSync(directory, { recursive: true, force: true });
+    }
+  });
+});
@@ -0,0 +1,92 @@
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { spawnSync } from 'child_process';
+
+const RUNNER = path.join(__dirname, '../../build/Release/fake6502_run');
+
+// Echo serial input until a newline, then spin: LDX #0; wait for RDRF;
+// read, echo once TDRE is set; loop until $0A; JMP *
+const ECHO = [
+  0xA2, 0x00, 0xAD, 0x00, 0x80, 0x29, 0x01, 0xF0, 0xF9, 0xAD, 0x01, 0x80, 0x48, 0xAD, 0x00, 0x80,
+  0x29, 0x02, 0xF0, 0xF9, 0x68, 0x8D, 0x01, 0x80, 0xC9, 0x0A, 0xD0, 0xE6, 0x4C, 0x1C, 0xF0
+];
+
+// Enable the receive interrupt and wait for a byte with IRQs still masked,
+// then CLI and idle; the handler echoes each byte and spins after $0A
+const ECHO_IRQ = [
+  0xA9, 0x80, 0x8D, 0x00, 0x80, 0xAD, 0x00, 0x80, 0x29, 0x01, 0xF0, 0xF9, 0x58, 0xEA, 0x4C, 0x0D,
+  0xF0, 0xAD, 0x01, 0x80, 0x8D, 0x01, 0x80, 0xC9, 0x0A, 0xF0, 0x01, 0x40, 0x4C, 0x1C, 0xF0
+];
+
+function intelHex(data: Uint8Array, address: number): string {
+  const lines: string[] = [];
+  for (let offset = 0; offset < data.length; offset += 16) {
+    const chunk = Array.from(data.subarray(offset, offset + 16));
+    const at = address + offset;
+    const record = [chunk.length, at >> 8, at & 0xFF, 0, ...chunk];
+    const checksum = -record.reduce((sum, byte) => sum + byte, 0) & 0xFF;
+    lines.push(':' + [...record, checksum].map(byte => byte.toString(16).toUpperCase().padStart(2, '0')).join(''));
+  }
+  return lines.join('\n') + '\n:00000001FF\n';
+}
+
+// Built with the addon by node-gyp
+const describeRunner = fs.existsSync(RUNNER) ? describe : describe.skip;
+
+describeRunner('Native headless runner', () => {
+  let directory: string;
+  let rom: Uint8Array;
+
+  beforeEach(() => {
+    directory = fs.mkdtempSync(path.join(os.tmpdir(), 'native-runner-'));
+    rom = new Uint8Array(0x1000);
+    rom.set(ECHO);
+    rom.set([0x00, 0xF0, 0x00, 0xF0, 0x00, 0xF0], 0x0FFA);
+  });
+
+  afterEach(() => {
+    fs.rmSync(directory, { recursive: true, force: true });
+  });
+
+  it('should run binary and Intel HEX ROMs with serial on stdio', () => {
+    const binary = path.join(directory, 'echo.bin');
+    const hex = path.join(directory, 'echo.hex');
+    fs.writeFileSync(binary, rom);
+    fs.writeFileSync(hex, intelHex(rom, 0xF000));
+
+    for (const args of [[`${binary}@F000`], [hex]]) {
+      const run = spawnSync(RUNNER, [...args, '--stats'], { input: 'hello\n', encoding: 'latin1' });
+      expect(run.status).toBe(0);
+      expect(run.stdout).toBe('hello\n');
+      expect(run.stderr).toContain('Stopped (spin) at $F01C');
+    }
+  });
+
+  it('should stop at addresses and the cycle limit', () => {
+    const binary = path.join(directory, 'echo.bin');
+    fs.writeFileSync(binary, rom);
+
+    const pc = spawnSync(RUNNER, [`${binary}@F000`, '--until-pc', 'F01C', '--stats'], { input: 'x\n', encoding: 'latin1' });
+    expect(pc.status).toBe(0);
+    expect(pc.stderr).toContain('Stopped (pc) at $F01C');
+
+    const timeout = spawnSync(RUNNER, [`${binary}@F000`, '--max-cycles', '10000'], { input: '', encoding: 'latin1' });
+    expect(timeout.status).toBe(124);
+
+    expect(spawnSync(RUNNER, [binary]).status).toBe(2);
+  });
+
+  it('should hold an IRQ raised while masked until the guest clears I', () => {
+    const binary = path.join(directory, 'echo-irq.bin');
+    rom.fill(0, 0, ECHO.length);
+    rom.set(ECHO_IRQ);
+    rom.set([0x11, 0xF0], 0x0FFE);
+    fs.writeFileSync(binary, rom);
+
+    const run = spawnSync(RUNNER, [`${binary}@F000`, '--stats'], { input: 'irq\n', encoding: 'latin1' });
+    expect(run.status).toBe(0);
+    expect(run.stdout).toBe('irq\n');
+    expect(run.stderr).toContain('Stopped (spin) at $F01C');
+  });
+});
@@ -0,0 +1,245 @@
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { SystemBus } from '../../src/core/bus';
+import { isNativeAvailable } from '../../src/core/cpu';
+import { Peripheral } from '../../src/peripherals/base';
+import { MemoryView } from '../../src/debug/memory-view';
+import { Emulator, EmulatorState } from '../../src/emulator';
+import { SystemConfig } from '../../src/config/system';
+import { readTraceFile } from '../../src/debug/trace-file';
+
+// INC $10 / LDA $10 / STA $8000 / JMP $0200
+const PROGRAM = [0xE6, 0x10, 0xA5, 0x10, 0x8D, 0x00, 0x80, 0x4C, 0x00, 0x02];
+
+// Register that remembers the last value written and counts ticked cycles
+class LatchPeripheral implements Peripheral {
+  value = 0;
+  writes = 0;
+  ticked = 0;
+
+  read(): number {
+    return this.value;
+  }
+
+  write(_offset: number, value: number): void {
+    this.value = value;
+    this.writes++;
+  }
+
+  reset(): void {}
+
+  tick(cycles: number): void {
+    this.ticked += cycles;
+  }
+
+  getInterruptStatus(): boolean {
+    return false;
+  }
+}
+
+// The worker thread lives in the native addon; the fallback CPU has none
+const describeNative = isNativeAvailable() ? describe : describe.skip;
+
+async function waitFor(condition: () => boolean, timeoutMs: number = 2000): Promise<void> {
+  const deadline = Date.now() + timeoutMs;
+  while (!condition()) {
+    if (Date.now() > deadline) {
+      throw new Error('Timed out waiting for the worker thread');
+    }
+    await new Promise(resolve => setTimeout(resolve, 5));
+  }
+}
+
+describeNative('SystemBus native worker thread', () => {
+  let bus: SystemBus;
+  let latch: LatchPeripheral;
+
+  beforeEach(() => {
+    bus = new SystemBus();
+    bus.getMemory().configureRAM(0x0000, 0x8000);
+    PROGRAM.forEach((byte, i) => bus.getMemory().write(0x0200 + i, byte));
+    latch = new LatchPeripheral();
+    bus.getPeripheralHub().registerPeripheral(latch, 0x8000, 0x8000, 'LATCH');
+    bus.getCPU().clearBreakpoints();
+    bus.getCPU().setRegisters({ A: 0, X: 0, Y: 0, SP: 0xFF, P: 0x24, PC: 0x0200 });
+  });
+
+  afterEach(() => {
+    bus.stopNativeThread();
+  });
+
+  it('should run RAM directly and route peripheral pages to the main thread', async () => {
+    const view = new MemoryView(bus.getMemory().getSharedMemory());
+    bus.startNativeThread({ sliceCycles: 1000 });
+    expect(bus.getNativeThreadState()).toBe('running');
+
+    await waitFor(() => latch.writes > 100);
+    expect(bus.pauseNativeThread()).toBe(true);
+    expect(bus.getNativeThreadState()).toBe('paused');
+
+    // The worker may have parked between INC and STA
+    const counter = bus.getMemory().read(0x10);
+    expect((counter - latch.value) & 0xFF).toBeLessThanOrEqual(1);
+    expect(latch.ticked).toBe(bus.getCycleCount());
+    expect(bus.getMemory().captureRAMPages(true).has(0)).toBe(true);
+    expect(view.getChangedPages()).toContain(0);
+    expect(view.read(0x10)).toBe(counter);
+  });
+
+  it('should park at breakpoints and allow stepping on the main thread', async () => {
+    bus.getCPU().setBreakpoint(0x0204);
+    const stops: Array<{ reason: string; pc: number }> = [];
+    bus.startNativeThread({}, { onStop: (reason, pc) => stops.push({ reason, pc }) });
+
+    await waitFor(() => stops.length > 0);
+    expect(stops[0]).toEqual({ reason: 'breakpoint', pc: 0x0204 });
+    expect(bus.getNativeThreadState()).toBe('paused');
+    expect(bus.getMemory().read(0x10)).toBe(1);
+
+    expect(bus.step()).toBe(0);
+    bus.getCPU().removeBreakpoint(0x0204);
+    bus.step();
+    expect(bus.getCPU().getRegisters().PC).toBe(0x0207);
+    expect(latch.value).toBe(1);
+  });
+
+  it('should count executions per PC on the worker thread', async () => {
+    const cpu = bus.getCPU();
+    cpu.setProfiling!(true);
+    bus.startNativeThread({ sliceCycles: 1000 });
+    expect(() => cpu.setProfiling!(false)).toThrow();
+
+    await waitFor(() => latch.writes > 100);
+    bus.pauseNativeThread();
+    const profile = cpu.getProfile!()!;
+    // Each loop iteration runs all four instructions once
+    expect(Math.abs(profile.counts[0x0200] - profile.counts[0x0207])).toBeLessThanOrEqual(1);
+    expect(profile.counts[0x0200]).toBeGreaterThan(100);
+    expect(profile.cycles[0x0200]).toBe(profile.counts[0x0200] * 5);
+    expect(profile.counts[0x0201]).toBe(0);
+    bus.stopNativeThread();
+    cpu.setProfiling!(false);
+  });
+
+  it('should record coverage on the worker thread', async () => {
+    const cpu = bus.getCPU();
+    cpu.setCoverage!(true);
+    bus.startNativeThread({ sliceCycles: 1000 });
+    await waitFor(() => latch.writes > 10);
+    bus.pauseNativeThread();
+    const coverage = cpu.getCoverage!()!;
+    expect([0x0200, 0x0202, 0x0204, 0x0207].map(address => coverage[address])).toEqual([1, 1, 1, 1]);
+    expect(coverage[0x0201]).toBe(0);
+    bus.stopNativeThread();
+    cpu.setCoverage!(false);
+  });
+
+  it('should reject direct CPU control while the worker runs', () => {
+    bus.startNativeThread({ clockHz: 1000000 });
+    expect(() => bus.step()).toThrow();
+    expect(() => bus.getCPU().setRegisters({ PC: 0x0300 })).toThrow();
+    expect(bus.getCPU().getRegisters().PC).toBeGreaterThanOrEqual(0x0200);
+    expect(() => bus.fork()).toThrow();
+  });
+});
+
+describeNative('Emulator native-thread mode', () => {
+  let emulator: Emulator;
+
+  beforeEach(async () => {
+    const config: SystemConfig = {
+      memory: { ramSize: 32768, ramStart: 0x0000, romImages: [] },
+      peripherals: { acia: { baseAddress: 0x8000, baudRate: 9600 } },
+      cpu: { type: '6502', clockSpeed: 1000000 },
+      debugging: { enableTracing: false, breakOnReset: false }
+    };
+    emulator = new Emulator(config);
+    await emulator.initialize();
+    // INC $10 / JMP $0200
+    [0xE6, 0x10, 0x4C, 0x00, 0x02].forEach((byte, i) => emulator.getSystemBus().getMemory().write(0x0200 + i, byte));
+    emulator.getSystemBus().getCPU().setRegisters({ PC: 0x0200 });
+  });
+
+  afterEach(() => {
+    emulator.stop();
+  });
+
+  it('should run, pause, step and resume on the worker thread', async () => {
+    emulator.setExecutionMode('native-thread');
+    expect(emulator.getExecutionMode()).toBe('native-thread');
+
+    emulator.start();
+    await waitFor(() => emulator.getStats().totalCycles > 10000);
+
+    emulator.pause();
+    expect(emulator.getState()).toBe(EmulatorState.PAUSED);
+    expect(emulator.getSystemBus().getNativeThreadState()).toBe('paused');
+
+    const cycles = emulator.getSystemBus().getCycleCount();
+    expect(emulator.step()).toBeGreaterThan(0);
+    expect(emulator.getSystemBus().getCycleCount()).toBeGreaterThan(cycles);
+
+    emulator.resume();
+    expect(emulator.getState()).toBe(EmulatorState.RUNNING);
+    expect(emulator.getSystemBus().getNativeThreadState()).toBe('running');
+
+    emulator.stop();
+    expect(emulator.getSystemBus().getNativeThreadState()).toBe('idle');
+  });
+
+  it('should stream the execution trace to a file from the worker thread', async () => {
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'trace-'));
+    const file = path.join(directory, 'worker.trace');
+    try {
+      emulator.setExecutionMode('native-thread');
+      emulator.enableExecutionTrace(true, { capacity: 1024, file });
+      emulator.start();
+      await waitFor(() => emulator.getStats().totalCycles > 20000);
+      emulator.stop();
+
+      const written = emulator.getExecutionTrace()!.getWritten();
+      emulator.enableExecutionTrace(false);
+      const pcs = new Set<number>();
+      const summary = readTraceFile(file, record => pcs.add(record.pc));
+      expect(summary.records + summary.lost).toBe(written);
+      expect(Array.from(pcs).sort()).toEqual([0x0200, 0x0202]);
+    } finally {
+      fs.rmSync(directory, { recursive: true, force: true });
+    }
+  });
+
+  it('should serve host calls and stop on EXIT from the worker thread', async () => {
+    const config: SystemConfig = {
+      memory: { ramSize: 32768, ramStart: 0x0000, romImages: [] },
+      peripherals: { hostCall: { baseAddress: 0x9000, brkSignature: 0x42 } },
+      cpu: { type: '6502', clockSpeed: 1000000 },
+      debugging: { enableTracing: false, breakOnReset: false }
+    };
+    const guest = new Emulator(config);
+    await guest.initialize();
+    const output: string[] = [];
+    guest.getHostCallDevice()!.setOutput(text => output.push(text));
+
+    // PUTS "worker", EXIT 3, JMP *
+    const memory = guest.getSystemBus().getMemory();
+    [0xA9, 0x00, 0xA2, 0x04, 0xA0, 0x01, 0x00, 0x42, 0xA9, 0x03, 0xA2, 0x00, 0xA0, 0x02, 0x00, 0x42, 0x4C, 0x10, 0x03]
+      .forEach((byte, i) => memory.write(0x0300 + i, byte));
+    Buffer.from('worker\0').forEach((byte, i) => memory.write(0x0400 + i, byte));
+    guest.getSystemBus().getCPU().setRegisters({ PC: 0x0300 });
+
+    guest.setExecutionMode('native-thread');
+    guest.start();
+    await waitFor(() => guest.getState() !== EmulatorState.RUNNING);
+    expect(output).toEqual(['worker']);
+    expect(guest.getExitStatus()).toBe(3);
+    expect(guest.getSystemBus().getNativeThreadState()).toBe('idle');
+  });
+
+  it('should stay on the event loop while recording inputs', () => {
+    emulator.setExecutionMode('native-thread');
+    emulator.startRecording();
+    emulator.start();
+    expect(emulator.getSystemBus().getNativeThreadState()).toBe('idle');
+  });
+});
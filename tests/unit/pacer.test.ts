@@ -0,0 +1,115 @@
+import { Pacer, PacerClock } from '../../src/performance/pacer';
+
+// Simulated host time: timers fire when runTimers() reaches them, and each
+// reading of the clock advances it slightly, as a spin loop would
+class FakeClock implements PacerClock {
+  time = 1000;
+  timerLateness = 0;
+  private timers = new Map<number, { at: number; callback: () => void }>();
+  private nextId = 1;
+
+  now(): number {
+    this.time += 0.001;
+    return this.time;
+  }
+
+  setTimeout(callback: () => void, ms: number): unknown {
+    const id = this.nextId++;
+    this.timers.set(id, { at: this.time + ms + this.timerLateness, callback });
+    return id;
+  }
+
+  clearTimeout(handle: unknown): void {
+    this.timers.delete(handle as number);
+  }
+
+  // The host is busy for a while
+  sleep(ms: number): void {
+    this.time += ms;
+  }
+
+  runTimers(): void {
+    while (this.timers.size > 0) {
+      const [id, timer] = [...this.timers].reduce((a, b) => (b[1].at < a[1].at ? b : a));
+      this.timers.delete(id);
+      this.time = Math.max(this.time, timer.at);
+      timer.callback();
+    }
+  }
+}
+
+function waitFor(pacer: Pacer, clock: FakeClock): number {
+  let woken = -1;
+  pacer.wait(() => { woken = clock.time; });
+  clock.runTimers();
+  return woken;
+}
+
+describe('Pacer', () => {
+  it('should hold the emulated clock to host time', () => {
+    const clock = new FakeClock();
+    clock.timerLateness = 1;  // Within the spin threshold
+    const pacer = new Pacer(100000, { clock });
+    const start = clock.time;
+    for (let i = 0; i < 20; i++) {
+      pacer.advance(1000);  // 10 ms of emulated time
+      clock.sleep(2);       // Emulating the chunk
+      waitFor(pacer, clock);
+    }
+
+    expect(clock.time - start).toBeGreaterThanOrEqual(200);
+    expect(clock.time - start).toBeLessThan(200.1);
+    const stats = pacer.getStats();
+    expect(stats.samples).toBe(20);
+    expect(stats.p50).toBeGreaterThanOrEqual(0);
+    expect(stats.max).toBeLessThan(0.01);
+    expect(Math.abs(stats.clockErrorPercent)).toBeLessThan(0.01);
+    expect(stats.resyncs).toBe(0);
+  });
+
+  it('should make up for late wake-ups on the next deadline', () => {
+    const clock = new FakeClock();
+    const pacer = new Pacer(1000000, { clock });
+    const start = clock.time;
+    pacer.advance(5000);
+    waitFor(pacer, clock);
+
+    // Run late, as if the chunk took longer than its emulated time
+    clock.sleep(10);
+    pacer.advance(10000);
+    const before = clock.time;
+    const woken = waitFor(pacer, clock);
+    // The deadline is 15 ms after the anchor, which has nearly passed; a
+    // pacer adding a delay per chunk would wait the full 10 ms here
+    expect(woken - start).toBeCloseTo(15, 1);
+    expect(woken - before).toBeLessThan(0.1);
+  });
+
+  it('should re-anchor when too far behind', () => {
+    const clock = new FakeClock();
+    const pacer = new Pacer(1000000, { maxLagMs: 5, clock });
+    clock.sleep(20);
+    pacer.advance(100);
+    const before = clock.time;
+    expect(waitFor(pacer, clock)).toBeCloseTo(before, 1);  // At once
+    expect(pacer.getStats().resyncs).toBe(1);
+
+    pacer.cancel();
+    pacer.start();
+    expect(pacer.getStats()).toMatchObject({ samples: 0, resyncs: 0 });
+  });
+
+  it('should pace against the host clock by default', async () => {
+    const pacer = new Pacer(100000);
+    const start = performance.now();
+    for (let i = 0; i < 10; i++) {
+      pacer.advance(1000);  // 10 ms of emulated time
+      await new Promise<void>(resolve => pacer.wait(resolve));
+    }
+
+    // Never early; late only by scheduling delays
+    expect(performance.now() - start).toBeGreaterThanOrEqual(99);
+    expect(pacer.getStats().samples).toBe(10);
+    expect(pacer.getStats().p50).toBeGreaterThanOrEqual(0);
+  });
+});
@@ -0,0 +1,136 @@
+import { gunzipSync } from 'zlib';
+import { createTraceEvents, encodePprof } from '../../src/performance/profile-export';
+import { TimelineEvent } from '../../src/performance/profiler';
+import { CC65SymbolParser } from '../../src/cc65/symbol-parser';
+import { InterruptController } from '../../src/core/interrupt-controller';
+import { createCallGraph } from '../../src/core/call-graph';
+
+type Message = Map<number, Array<number | Uint8Array>>;
+
+// Enough of the protobuf wire format to read back what the encoder writes
+function decode(bytes: Uint8Array): Message {
+  const fields: Message = new Map();
+  let offset = 0;
+  const varint = () => {
+    let value = 0;
+    let scale = 1;
+    while (bytes[offset] & 0x80) {
+      value += (bytes[offset++] & 0x7F) * scale;
+      scale *= 128;
+    }
+    return value + bytes[offset++] * scale;
+  };
+  while (offset < bytes.length) {
+    const tag = varint();
+    let value: number | Uint8Array;
+    if ((tag & 7) === 0) {
+      value = varint();
+    } else {
+      const length = varint();
+      value = bytes.subarray(offset, offset + length);
+      offset += length;
+    }
+    fields.set(tag >> 3, [...(fields.get(tag >> 3) || []), value]);
+  }
+  return fields;
+}
+
+function packed(bytes: Uint8Array): number[] {
+  const values: number[] = [];
+  let value = 0;
+  let scale = 1;
+  for (const byte of bytes) {
+    value += (byte & 0x7F) * scale;
+    scale *= 128;
+    if ((byte & 0x80) === 0) {
+      values.push(value);
+      value = 0;
+      scale = 1;
+    }
+  }
+  return values;
+}
+
+describe('pprof export', () => {
+  it('should encode addresses as locations inside named routines', () => {
+    const counts = new Uint32Array(0x10000);
+    const cycles = new Uint32Array(0x10000);
+    counts[0x0200] = 1; cycles[0x0200] = 2;
+    counts[0x0203] = 300; cycles[0x0203] = 900;
+    counts[0x0300] = 4; cycles[0x0300] = 24;
+    const symbols = new CC65SymbolParser();
+    symbols.parseSymbolFile('main=$0200 label\nACIA=$0250 equate');
+    const callGraph = createCallGraph(0x0200);
+    callGraph.calls[0x0300] = 4;
+
+    const profile = decode(gunzipSync(encodePprof({ counts, cycles }, { clockHz: 1000000, symbols, callGraph })));
+    const strings = (profile.get(6) as Uint8Array[]).map(bytes => Buffer.from(bytes).toString('utf8'));
+    expect(strings[0]).toBe('');
+
+    const sampleTypes = (profile.get(1) as Uint8Array[]).map(bytes => strings[decode(bytes).get(1)![0] as number]);
+    expect(sampleTypes).toEqual(['instructions', 'cycles']);
+    expect(strings[profile.get(14)![0] as number]).toBe('cycles');
+    expect(profile.get(10)![0]).toBe(926000);  // 926 cycles at 1 MHz
+
+    const functions = new Map((profile.get(5) as Uint8Array[]).map(bytes => {
+      const fn = decode(bytes);
+      return [fn.get(1)![0] as number, strings[fn.get(2)![0] as number]];
+    }));
+    const locations = new Map((profile.get(4) as Uint8Array[]).map(bytes => {
+      const location = decode(bytes);
+      const line = decode(location.get(4)![0] as Uint8Array);
+      return [location.get(1)![0] as number, { address: location.get(3)![0], name: functions.get(line.get(1)![0] as number) }];
+    }));
+    const samples = (profile.get(2) as Uint8Array[]).map(bytes => {
+      const sample = decode(bytes);
+      return { ...locations.get(packed(sample.get(1)![0] as Uint8Array)[0]), values: packed(sample.get(2)![0] as Uint8Array) };
+    });
+
+    // The equate is not a routine; $0300 is named from the call graph
+    expect(samples).toEqual([
+      { address: 0x0200, name: 'main', values: [1, 2] },
+      { address: 0x0203, name: 'main', values: [300, 900] },
+      { address: 0x0300, name: '$0300', values: [4, 24] }
+    ]);
+  });
+});
+
+describe('Chrome trace export', () => {
+  it('should turn interrupt assertions into slices and accesses into instants', () => {
+    const timeline: TimelineEvent[] = [
+      { cycle: 100, kind: 'interrupt', name: 'IRQ', detail: 'peripheral:VIA', phase: 'begin' },
+      { cycle: 200, kind: 'peripheral', name: 'VIA', detail: 'read', phase: 'instant', address: 0x600D, value: 0xC0 },
+      { cycle: 300, kind: 'interrupt', name: 'IRQ', detail: 'peripheral:VIA', phase: 'end' },
+      { cycle: 400, kind: 'interrupt', name: 'NMI', detail: 'debug', phase: 'begin' },
+      { cycle: 500, kind: 'peripheral', name: 'ACIA', detail: 'write', phase: 'instant', address: 0x5001, value: 0x41 }
+    ];
+    const trace = createTraceEvents(timeline, 2000000);
+    const tracks = new Map(trace.traceEvents.filter(e => e.name === 'thread_name').map(e => [e.tid, e.args!.name]));
+    const events = trace.traceEvents.filter(e => e.ph !== 'M').map(e => ({ ...e, track: tracks.get(e.tid) }));
+
+    expect(events).toEqual([
+      expect.objectContaining({ name: 'read $600D', ph: 'i', ts: 100, track: 'VIA', args: { address: '$600D', value: 0xC0 } }),
+      expect.objectContaining({ name: 'IRQ', ph: 'X', ts: 50, dur: 100, track: 'IRQ peripheral:VIA' }),
+      expect.objectContaining({ name: 'write $5001', ph: 'i', ts: 250, track: 'ACIA' }),
+      // Still asserted at the end of the timeline
+      expect.objectContaining({ name: 'NMI', ph: 'X', ts: 200, dur: 50, track: 'NMI debug' })
+    ]);
+    expect(JSON.parse(JSON.stringify(trace)).displayTimeUnit).toBe('ns');
+  });
+
+  it('should report each source asserting and releasing a line once', () => {
+    const controller = new InterruptController();
+    const changes: string[] = [];
+    controller.setTraceCallback((line, source, asserted) => changes.push(`${line} ${source} ${asserted}`));
+
+    controller.triggerIRQ('a');
+    controller.triggerIRQ('a');
+    controller.triggerIRQ('b');
+    controller.clearIRQ('a');
+    controller.clearIRQ('a');
+    controller.triggerNMI('c');
+    controller.reset();
+
+    expect(changes).toEqual(['IRQ a true', 'IRQ b true', 'IRQ a false', 'NMI c true', 'IRQ b false', 'NMI c false']);
+  });
+});
@@ -0,0 +1,169 @@
+import { CPU6502Emulator } from '../../src/core/cpu';
+import { CC65SymbolParser } from '../../src/cc65/symbol-parser';
+import {
+  getRuntimeHookMismatch, getRuntimeHookStats, resolveRuntimeHooks, RuntimeHookOptions, RuntimeHookStats
+} from '../../src/cc65/runtime-hooks';
+
+// cc65 runtime routines as ld65 would place them, with c_sp at $02,
+// sreg at $04, ptr1 at $06, ptr4 at $08, ptr2 at $0A and tmp1 at $0C
+const ROUTINES: Array<[number, number[]]> = [
+  // pushax
+  [0x1000, [0x48, 0xA5, 0x02, 0x38, 0xE9, 0x02, 0x85, 0x02, 0xB0, 0x02, 0xC6, 0x03, 0xA0, 0x01, 0x8A, 0x91,
+    0x02, 0x68, 0x88, 0x91, 0x02, 0x60]],
+  // popax, falling into incsp2
+  [0x1020, [0xA0, 0x01, 0xB1, 0x02, 0xAA, 0x88, 0xB1, 0x02, 0xE6, 0x02, 0xF0, 0x05, 0xE6, 0x02, 0xF0, 0x03,
+    0x60, 0xE6, 0x02, 0xE6, 0x03, 0x60]],
+  // _strlen
+  [0x1040, [0x85, 0x06, 0x86, 0x07, 0xA2, 0x00, 0xA0, 0x00, 0xB1, 0x06, 0xF0, 0x08, 0xC8, 0xD0, 0xF9, 0xE8,
+    0xE6, 0x07, 0xD0, 0xF4, 0x98, 0x60]],
+  // _memset: count to ptr2, fill byte to tmp1, pointer to ptr1
+  [0x1060, [0x85, 0x0A, 0x86, 0x0B, 0x20, 0x20, 0x10, 0x85, 0x0C, 0x20, 0x20, 0x10, 0x85, 0x06, 0x86, 0x07,
+    0x48, 0x8A, 0x48, 0xA0, 0x00, 0xA5, 0x0A, 0x05, 0x0B, 0xF0, 0x15, 0xA5, 0x0C, 0x91, 0x06, 0xE6, 0x06,
+    0xD0, 0x02, 0xE6, 0x07, 0xA5, 0x0A, 0xD0, 0x02, 0xC6, 0x0B, 0xC6, 0x0A, 0x4C, 0x75, 0x10, 0x68, 0xAA,
+    0x68, 0x60]],
+  // udiv16: ptr1 / ptr4 to ptr1, remainder to sreg
+  [0x10A0, [0xA9, 0x00, 0x85, 0x05, 0xA0, 0x10, 0x06, 0x06, 0x26, 0x07, 0x2A, 0x26, 0x05, 0xAA, 0xC5, 0x08,
+    0xA5, 0x05, 0xE5, 0x09, 0x90, 0x08, 0x85, 0x05, 0x8A, 0xE5, 0x08, 0xAA, 0xE6, 0x06, 0x8A, 0x88, 0xD0,
+    0xE4, 0x85, 0x04, 0x60]]
+];
+
+const SYMBOLS = `pushax=$1000 lab
+popax=$1020 lab
+_strlen=$1040 lab
+_memset=$1060 lab
+udiv16=$10A0 lab
+c_sp=$02 lab
+sreg=$04 lab
+ptr1=$06 lab
+ptr4=$08 lab
+`;
+
+// memset($0400, 'x', 300); strlen($0300) to $10; 1000 / 7 to $12 and
+// remainder to $14; then $1234 / 0, which the hook declines
+const MAIN = [
+  0xA9, 0x00, 0xA2, 0x04, 0x20, 0x00, 0x10,
+  0xA9, 0x78, 0xA2, 0x00, 0x20, 0x00, 0x10,
+  0xA9, 0x2C, 0xA2, 0x01, 0x20, 0x60, 0x10,
+  0xA9, 0x00, 0xA2, 0x03, 0x20, 0x40, 0x10, 0x85, 0x10, 0x86, 0x11,
+  0xA9, 0xE8, 0x85, 0x06, 0xA9, 0x03, 0x85, 0x07, 0xA9, 0x07, 0x85, 0x08, 0xA9, 0x00, 0x85, 0x09,
+  0x20, 0xA0, 0x10,
+  0xA5, 0x06, 0x85, 0x12, 0xA5, 0x07, 0x85, 0x13, 0xA5, 0x04, 0x85, 0x14, 0xA5, 0x05, 0x85, 0x15,
+  0xA9, 0x34, 0x85, 0x06, 0xA9, 0x12, 0x85, 0x07, 0xA9, 0x00, 0x85, 0x08, 0x85, 0x09, 0x20, 0xA0, 0x10
+];
+const DONE = 0x0200 + MAIN.length;
+
+function symbols(): CC65SymbolParser {
+  const parser = new CC65SymbolParser();
+  parser.parseSymbolFile(SYMBOLS);
+  return parser;
+}
+
+function run(options?: RuntimeHookOptions, patch?: (memory: Uint8Array) => void):
+    { memory: Uint8Array; cycles: number; steps: number; stats: RuntimeHookStats[]; cpu: CPU6502Emulator } {
+  const memory = new Uint8Array(0x10000);
+  for (const [address, code] of ROUTINES) {
+    memory.set(code, address);
+  }
+  memory.set(MAIN, 0x0200);
+  memory.set([0x4C, DONE & 0xFF, DONE >> 8], DONE);
+  memory.set(Buffer.from('hello, world\0'), 0x0300);
+  memory.set([0x00, 0x0F], 0x02);  // C stack at $0F00
+  if (patch) {
+    patch(memory);
+  }
+
+  const cpu = new CPU6502Emulator();
+  cpu.setMemoryCallbacks(address => memory[address], (address, value) => { memory[address] = value; });
+  cpu.setRegisters({ PC: 0x0200, SP: 0xFF, P: 0x24 });
+  const hooks = options ? resolveRuntimeHooks(symbols(), options) : null;
+  cpu.setRuntimeHooks(hooks);
+
+  let cycles = 0;
+  let steps = 0;
+  while (cpu.getRegisters().PC !== DONE && steps < 100000) {
+    cycles += cpu.step();
+    steps++;
+  }
+  cpu.setRuntimeHooks(null);
+  return { memory, cycles, steps, stats: hooks ? getRuntimeHookStats(hooks) : [], cpu };
+}
+
+function statsFor(stats: RuntimeHookStats[], routine: string): RuntimeHookStats {
+  return stats.find(entry => entry.routine === routine)!;
+}
+
+describe('cc65 runtime hooks', () => {
+  it('should produce the same results as the routines in fewer cycles', () => {
+    const emulated = run();
+    const hooked = run({});
+
+    expect(emulated.memory[0x10] | (emulated.memory[0x11] << 8)).toBe(12);
+    expect(emulated.memory[0x12] | (emulated.memory[0x13] << 8)).toBe(142);
+    expect(emulated.memory[0x14] | (emulated.memory[0x15] << 8)).toBe(6);
+    expect(emulated.memory.subarray(0x0400, 0x052C).every(byte => byte === 0x78)).toBe(true);
+    expect(emulated.memory[0x052C]).toBe(0);
+
+    // Everything but the routines' scratch zero page and stack bytes
+    expect(Buffer.compare(hooked.memory.subarray(0x0200), emulated.memory.subarray(0x0200))).toBe(0);
+    expect(Array.from(hooked.memory.subarray(0x02, 0x04))).toEqual([0x00, 0x0F]);
+    expect(Array.from(hooked.memory.subarray(0x10, 0x16))).toEqual(Array.from(emulated.memory.subarray(0x10, 0x16)));
+    expect(hooked.cpu.getRegisters().SP).toBe(0xFF);
+    expect(hooked.cycles).toBeLessThan(emulated.cycles / 2);
+    expect(hooked.steps).toBeLessThan(emulated.steps / 10);
+
+    expect(statsFor(hooked.stats, 'pushax').calls).toBe(2);
+    expect(statsFor(hooked.stats, 'popax').calls).toBe(0);  // memset's pops are part of the hook
+    expect(statsFor(hooked.stats, 'memset').calls).toBe(1);
+    expect(statsFor(hooked.stats, 'strlen').calls).toBe(1);
+    expect(statsFor(hooked.stats, 'udiv16').calls).toBe(1);  // Division by zero declined
+    expect(hooked.stats.map(entry => entry.routine)).not.toContain('memcpy');
+  });
+
+  it('should charge configured cycle costs', () => {
+    const { stats } = run({ routines: ['pushax', 'strlen'], costs: { pushax: 10 } });
+    expect(statsFor(stats, 'pushax').cycles).toBe(20);
+    expect(statsFor(stats, 'strlen').cycles).toBeGreaterThan(0);
+    expect(stats.map(entry => entry.routine)).toEqual(['pushax', 'strlen']);
+    expect(() => resolveRuntimeHooks(symbols(), { routines: ['printf'] })).toThrow('Unknown runtime routine');
+  });
+
+  it('should validate hooks against the routines', () => {
+    const emulated = run();
+    const validated = run({ validate: true });
+
+    expect(validated.cycles).toBe(emulated.cycles);
+    expect(Buffer.compare(validated.memory, emulated.memory)).toBe(0);
+    for (const routine of ['pushax', 'memset', 'strlen', 'udiv16']) {
+      const stats = statsFor(validated.stats, routine);
+      expect(stats.calls).toBe(0);
+      expect(stats.validated).toBeGreaterThan(0);
+      expect(stats.mismatches).toBe(0);
+      expect(stats.realCycles).toBeGreaterThan(0);
+    }
+    expect(getRuntimeHookMismatch(resolveRuntimeHooks(symbols()))).toBeNull();
+  });
+
+  it('should report where a routine differs from its hook', () => {
+    // pushax storing the C stack pointer's low byte instead of X
+    const hooks = resolveRuntimeHooks(symbols(), { routines: ['pushax'], validate: true });
+    const memory = new Uint8Array(0x10000);
+    for (const [address, code] of ROUTINES) {
+      memory.set(code, address);
+    }
+    memory[0x100E] = 0xEA;
+    memory.set([0xA9, 0x00, 0xA2, 0x04, 0x20, 0x00, 0x10, 0x4C, 0x07, 0x02], 0x0200);
+    memory.set([0x00, 0x0F], 0x02);
+
+    const cpu = new CPU6502Emulator();
+    cpu.setMemoryCallbacks(address => memory[address], (address, value) => { memory[address] = value; });
+    cpu.setRegisters({ PC: 0x0200, SP: 0xFF, P: 0x24 });
+    cpu.setRuntimeHooks(hooks);
+    for (let i = 0; i < 30; i++) {
+      cpu.step();
+    }
+    cpu.setRuntimeHooks(null);
+
+    expect(getRuntimeHookStats(hooks)[0].mismatches).toBe(1);
+    expect(getRuntimeHookMismatch(hooks)).toEqual({ routine: 'pushax', location: 0x0EFF, expected: 0x04, actual: 0xFE });
+  });
+});
@@ -0,0 +1,125 @@
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { CPU6502Emulator } from '../../src/core/cpu';
+import { ExecutionTraceBuffer } from '../../src/debug/trace-buffer';
+import { TraceFileWriter } from '../../src/debug/trace-file';
+import { analyzeTraceFile, findTraceDivergence, getTraceReport } from '../../src/debug/trace-analyzer';
+
+// LDX #$03 / loop: STA $10,X / DEX / BNE loop / LDA $3000 / JMP $0200
+const PROGRAM = [0xA2, 0x03, 0x95, 0x10, 0xCA, 0xD0, 0xFB, 0xAD, 0x00, 0x30, 0x4C, 0x00, 0x02];
+const PASS = 12;  // Instructions per pass through the program
+
+describe('Trace analyzer', () => {
+  let directory: string;
+
+  beforeEach(() => {
+    directory = fs.mkdtempSync(path.join(os.tmpdir(), 'trace-analyzer-'));
+  });
+
+  afterEach(() => {
+    fs.rmSync(directory, { recursive: true, force: true });
+  });
+
+  /**
+   * Run the program for a number of steps, raising an IRQ every irqEvery steps,
+   * and write the trace to a file
+   */
+  function writeTrace(name: string, steps: number, options: { irqEvery?: number; keyframes?: number; patch?: [number, number] } = {}): string {
+    const memory = new Uint8Array(0x10000);
+    memory.set(PROGRAM, 0x0200);
+    memory.set([0x00, 0x03], 0xFFFE);
+    memory[0x0300] = 0x40;  // RTI
+    if (options.patch) {
+      memory[options.patch[0]] = options.patch[1];
+    }
+    const cpu = new CPU6502Emulator();
+    cpu.setMemoryCallbacks(address => memory[address], (address, value) => { memory[address] = value; });
+    cpu.setRegisters({ PC: 0x0200, SP: 0xFD, P: 0x20 });
+    const trace = new ExecutionTraceBuffer(steps + 1);
+    cpu.setTrace(trace);
+    for (let i = 1; i <= steps; i++) {
+      if (options.irqEvery && i % options.irqEvery === 0) {
+        cpu.triggerIRQ();
+      }
+      cpu.step();
+    }
+
+    const file = path.join(directory, name);
+    const writer = new TraceFileWriter(file, 1000000, options.keyframes);
+    writer.drain(trace, 0);
+    writer.close();
+    return file;
+  }
+
+  it('should find hot loops, basic blocks and memory accesses', async () => {
+    const file = writeTrace('loop.trace', PASS * 10);
+    const report = getTraceReport(await analyzeTraceFile(file, { workers: 0 }), 10);
+
+    expect(report.instructions).toBe(PASS * 10);
+    expect(report.loops).toHaveLength(2);
+    const loops = new Map(report.loops.map(loop => [loop.from, loop]));
+    expect(loops.get(0x0205)!.iterations).toBe(20);
+    expect(loops.get(0x020A)!.iterations).toBe(9);  // The last JMP has no record after it
+
+    const blocks = new Map(report.blocks.map(block => [block.address, block]));
+    expect(blocks.get(0x0200)).toEqual(expect.objectContaining({ end: 0x0200, executions: 10 }));
+    expect(blocks.get(0x0202)).toEqual(expect.objectContaining({ end: 0x0205, instructions: 3, executions: 30 }));
+    expect(blocks.get(0x0207)).toEqual(expect.objectContaining({ end: 0x020A, instructions: 2, executions: 10 }));
+
+    const addresses = new Map(report.hotAddresses.map(hotspot => [hotspot.address, hotspot]));
+    for (const address of [0x11, 0x12, 0x13]) {
+      expect(addresses.get(address)).toEqual({ address, reads: 0, writes: 10 });
+    }
+    expect(addresses.get(0x3000)).toEqual({ address: 0x3000, reads: 10, writes: 0 });
+    expect(report.pages[0x30]).toEqual({ page: 0x30, reads: 10, writes: 0 });
+    expect(report.unresolvedAccesses).toBe(0);
+  });
+
+  it('should time interrupt service and the interval between interrupts', async () => {
+    const file = writeTrace('irq.trace', 200, { irqEvery: 25 });
+    const report = getTraceReport(await analyzeTraceFile(file, { workers: 0 }));
+
+    expect(report.interrupts).toBe(8);
+    // 7 cycles of entry plus a 6 cycle RTI; the last handler never returns
+    expect(report.service).toEqual(expect.objectContaining({ count: 7, min: 13, max: 13 }));
+    expect(report.intervals.count).toBe(7);
+    expect(report.intervals.min).toBeGreaterThan(0);
+  });
+
+  it('should merge chunked ranges to the same result as a single pass', async () => {
+    const file = writeTrace('chunked.trace', 5000, { irqEvery: 37, keyframes: 16 });
+    const single = getTraceReport(await analyzeTraceFile(file, { workers: 0 }));
+    for (const chunks of [2, 7, 50]) {
+      expect(getTraceReport(await analyzeTraceFile(file, { workers: 0, chunks }))).toEqual(single);
+    }
+  });
+
+  it('should analyze ranges on worker threads', async () => {
+    const file = writeTrace('threads.trace', 2000, { irqEvery: 41, keyframes: 32 });
+    const single = getTraceReport(await analyzeTraceFile(file, { workers: 0 }));
+    const threaded = getTraceReport(await analyzeTraceFile(file, { workers: 2 }));
+    // Typed arrays posted from workers belong to another realm, so compare their contents
+    expect(JSON.stringify(threaded)).toEqual(JSON.stringify(single));
+  }, 60000);
+
+  it('should report the first record where two traces differ', () => {
+    const good = writeTrace('good.trace', 100, { keyframes: 4 });
+    const bad = writeTrace('bad.trace', 100, { keyframes: 4, patch: [0x0208, 0x01] });  // LDA $3001
+
+    expect(findTraceDivergence(good, writeTrace('same.trace', 100, { keyframes: 4 }))).toBeNull();
+    const divergence = findTraceDivergence(good, bad, 3)!;
+    expect(divergence.index).toBe(10);
+    expect(divergence.fields).toEqual(['operands']);
+    expect(divergence.a).toEqual(expect.objectContaining({ pc: 0x0207, operands: [0x00, 0x30] }));
+    expect(divergence.b).toEqual(expect.objectContaining({ pc: 0x0207, operands: [0x01, 0x30] }));
+    expect(divergence.context.map(record => record.pc)).toEqual([0x0202, 0x0204, 0x0205]);
+  });
+
+  it('should report a trace that ends early', () => {
+    const divergence = findTraceDivergence(writeTrace('long.trace', 50), writeTrace('short.trace', 40))!;
+    expect(divergence.index).toBe(40);
+    expect(divergence.fields).toEqual(['end']);
+    expect(divergence.b).toBeNull();
+  });
+});
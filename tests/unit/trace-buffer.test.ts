@@ -0,0 +1,163 @@
+import fs from 'fs';
+import os from 'os';
+import path from 'path';
+import { CPU6502Emulator } from '../../src/core/cpu';
+import { ExecutionTraceBuffer, TraceRecord, formatTraceRecord } from '../../src/debug/trace-buffer';
+import { TraceFileWriter, readTraceFile } from '../../src/debug/trace-file';
+
+// LDX #$03 / loop: DEX / BNE loop / JMP $0200
+const PROGRAM = [0xA2, 0x03, 0xCA, 0xD0, 0xFD, 0x4C, 0x00, 0x02];
+
+function createCPU(): CPU6502Emulator {
+  const memory = new Uint8Array(0x10000);
+  memory.set(PROGRAM, 0x0200);
+  memory.set([0x00, 0x03], 0xFFFE);
+  memory[0x0300] = 0x40;  // RTI
+  const cpu = new CPU6502Emulator();
+  cpu.setMemoryCallbacks(address => memory[address], (address, value) => { memory[address] = value; });
+  cpu.setRegisters({ PC: 0x0200, SP: 0xFD, P: 0x24 });
+  return cpu;
+}
+
+function run(cpu: CPU6502Emulator, steps: number): void {
+  for (let i = 0; i < steps; i++) {
+    cpu.step();
+  }
+}
+
+describe('Execution trace buffer', () => {
+  it('should record each instruction with the registers before it', () => {
+    const cpu = createCPU();
+    const trace = new ExecutionTraceBuffer(16, 100);
+    cpu.setTrace(trace);
+    run(cpu, 3);
+
+    expect(trace.getWritten()).toBe(3);
+    expect(trace.getCycle()).toBe(100 + 2 + 2 + 3);
+    const [ldx, dex, bne] = trace.getRecords();
+    expect(ldx).toEqual({
+      cycle: 100, pc: 0x0200, opcode: 0xA2, operands: [0x03],
+      a: 0, x: 0, y: 0, p: 0x24, sp: 0xFD, cycles: 2, kind: 'instruction'
+    });
+    expect(dex).toEqual(expect.objectContaining({ cycle: 102, pc: 0x0202, operands: [], x: 3 }));
+    expect(bne).toEqual(expect.objectContaining({ cycle: 104, pc: 0x0203, operands: [0xFD], x: 2, cycles: 3 }));
+    expect(formatTraceRecord(bne)).toBe('0203  D0 FD     A:00 X:02 Y:00 P:24 SP:FD CYC:104');
+  });
+
+  it('should keep the most recent records once the ring wraps', () => {
+    const cpu = createCPU();
+    const trace = new ExecutionTraceBuffer(4);
+    cpu.setTrace(trace);
+    run(cpu, 10);
+
+    expect(trace.getWritten()).toBe(10);
+    expect(trace.getOldest()).toBe(6);
+    // Last BNE and JMP of the first pass, then LDX, DEX
+    expect(trace.getRecords().map(r => r.pc)).toEqual([0x0203, 0x0205, 0x0200, 0x0202]);
+    expect(trace.getRecords(2).map(r => r.pc)).toEqual([0x0200, 0x0202]);
+  });
+
+  it('should record only filtered PC ranges while keeping the clock', () => {
+    const cpu = createCPU();
+    const trace = new ExecutionTraceBuffer(16, 0, [{ first: 0x0203, last: 0x0204 }]);
+    cpu.setTrace(trace);
+    run(cpu, 8);
+
+    expect(trace.getRecords().map(r => r.cycle)).toEqual([4, 9, 14]);
+    expect(trace.getCycle()).toBe(2 + 3 * 2 + 3 + 3 + 2 + 3);
+  });
+
+  it('should record interrupt entry but not a masked IRQ', () => {
+    const cpu = createCPU();
+    const trace = new ExecutionTraceBuffer(16);
+    cpu.setTrace(trace);
+    cpu.triggerIRQ();
+    cpu.step();  // Masked by P=$24
+    expect(trace.getWritten()).toBe(0);
+    expect(trace.getCycle()).toBe(7);
+
+    cpu.setRegisters({ P: 0x20 });
+    cpu.triggerIRQ();
+    cpu.step();
+    cpu.step();
+    expect(trace.getRecords()).toEqual([
+      expect.objectContaining({ cycle: 7, pc: 0x0200, kind: 'irq', cycles: 7, sp: 0xFD, operands: [] }),
+      expect.objectContaining({ cycle: 14, pc: 0x0300, opcode: 0x40, kind: 'instruction', sp: 0xFA, p: 0x24 })
+    ]);
+  });
+
+  it('should stop recording when removed', () => {
+    const cpu = createCPU();
+    const trace = new ExecutionTraceBuffer(16);
+    cpu.setTrace(trace);
+    cpu.step();
+    cpu.setTrace(null);
+    cpu.step();
+    expect(cpu.getTrace()).toBeNull();
+    expect(trace.getWritten()).toBe(1);
+  });
+});
+
+describe('Trace files', () => {
+  let directory: string;
+
+  beforeEach(() => {
+    directory = fs.mkdtempSync(path.join(os.tmpdir(), 'trace-'));
+  });
+
+  afterEach(() => {
+    fs.rmSync(directory, { recursive: true, force: true });
+  });
+
+  function readAll(file: string): { records: TraceRecord[]; summary: ReturnType<typeof readTraceFile> } {
+    const records: TraceRecord[] = [];
+    const summary = readTraceFile(file, record => records.push(record));
+    return { records, summary };
+  }
+
+  it('should read back the records written, across keyframes and gaps', () => {
+    const cpu = createCPU();
+    const trace = new ExecutionTraceBuffer(64, 0, [{ first: 0x0200, last: 0x0202 }, { first: 0x0300, last: 0x0300 }]);
+    cpu.setTrace(trace);
+    run(cpu, 11);  // Interrupted before the DEX at $0202
+    cpu.setRegisters({ P: 0x20 });
+    cpu.triggerIRQ();
+    run(cpu, 2);
+
+    const file = path.join(directory, 'run.trace');
+    const writer = new TraceFileWriter(file, 1000000, 3);
+    expect(writer.drain(trace, 0)).toBe(trace.getWritten());
+    writer.close();
+
+    const { records, summary } = readAll(file);
+    expect(records).toEqual(trace.getRecords());
+    expect(records.some(r => r.kind === 'irq')).toBe(true);
+    expect(summary).toEqual({ clockHz: 1000000, records: records.length, lost: 0, blocks: Math.ceil(records.length / 3) });
+  });
+
+  it('should count records overwritten before they were drained', () => {
+    const cpu = createCPU();
+    const trace = new ExecutionTraceBuffer(4);
+    cpu.setTrace(trace);
+    const file = path.join(directory, 'lost.trace');
+    const writer = new TraceFileWriter(file, 1000000);
+
+    run(cpu, 2);
+    let drained = writer.drain(trace, 0);
+    run(cpu, 10);
+    drained = writer.drain(trace, drained);
+    writer.close();
+
+    const { records, summary } = readAll(file);
+    expect(drained).toBe(12);
+    expect(summary.lost).toBe(6);
+    expect(summary.blocks).toBe(2);
+    expect(records.slice(2)).toEqual(trace.getRecords());
+  });
+
+  it('should reject files that are not traces', () => {
+    const file = path.join(directory, 'other.bin');
+    fs.writeFileSync(file, 'not a trace file at all');
+    expect(() => readTraceFile(file, () => {})).toThrow('Not a trace file');
+  });
+});